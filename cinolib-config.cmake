@@ -37,7 +37,7 @@ option(CINOLIB_USES_SHEWCHUK_PREDICATES "Use Shewchuk Predicates"    OFF)
 option(CINOLIB_USES_INDIRECT_PREDICATES "Use Indirect Predicates"    OFF)
 option(CINOLIB_USES_GRAPH_CUT           "Use Graph Cut"              OFF)
 option(CINOLIB_USES_BOOST               "Use Boost"                  OFF)
-option(CINOLIB_USES_VTK                 "Use VTK"                    OFF)
+option(CINOLIB_USES_ZLIB                "Use zlib"                   OFF)
 option(CINOLIB_USES_SPECTRA             "Use Spectra"                OFF)
 option(CINOLIB_USES_CGAL                "Use CGAL"                   OFF)
 
@@ -135,17 +135,15 @@ endif()
 
 #::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-if(CINOLIB_USES_VTK)
-    message("CINOLIB OPTIONAL MODULE: VTK")
-    find_package(VTK OPTIONAL_COMPONENTS IOGeometry IOImport IOExport)
-    if(VTK_FOUND)
-        # https://vtk.org/doc/nightly/html/md__builds_gitlab-kitware-sciviz-ci_Documentation_Doxygen_ModuleMigration.html
-        target_link_libraries(cinolib INTERFACE VTK::IOGeometry VTK::IOImport VTK::IOExport)
-        vtk_module_autoinit(TARGETS cinolib MODULES VTK::IOGeometry VTK::IOImport VTK::IOExport)
-        target_compile_definitions(cinolib INTERFACE CINOLIB_USES_VTK)
+if(CINOLIB_USES_ZLIB)
+    message("CINOLIB OPTIONAL MODULE: zlib")
+    find_package(ZLIB)
+    if(ZLIB_FOUND)
+        target_link_libraries(cinolib INTERFACE ZLIB::ZLIB)
+        target_compile_definitions(cinolib INTERFACE CINOLIB_USES_ZLIB)
     else()
-        message("Could not find VTK!")
-        set(CINOLIB_USES_VTK OFF)
+        message("Could not find zlib!")
+        set(CINOLIB_USES_ZLIB OFF)
     endif()
 endif()
 
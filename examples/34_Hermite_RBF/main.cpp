@@ -23,10 +23,13 @@ int main(int argc, char **argv)
     std::vector<uint> dummy;
     tetgen_wrap(srf_target.bbox().corners(1.5), srf_target.bbox().tris(), dummy, "qa0.00002", vol_sampling);
 
-    // HRBF computatin,  using x^3 as RBF kernel
+    // HRBF computatin,  using x^3 as RBF kernel. Dense systems are only viable for a few
+    // thousands points: larger meshes are split into overlapping patches (partition of unity)
+    HermiteRBFOptions opt;
+    if(srf_target.num_verts()>2000) opt.solver = HRBF_PARTITION_OF_UNITY;
     Profiler profiler;
     profiler.push("Make HRBF");
-    Hermite_RBF<CubicRBF> HRBF(srf_target.vector_verts(), srf_target.vector_vert_normals());
+    Hermite_RBF<CubicRBF> HRBF(srf_target.vector_verts(), srf_target.vector_vert_normals(), opt);
     profiler.pop();
 
     // evaluate the BRBF at each volume point
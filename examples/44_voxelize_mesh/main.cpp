@@ -17,12 +17,13 @@ int main(int argc, char *argv[])
     uint max_voxels_per_side = (argc>=3) ? atoi(argv[2]) : 64;
     int  voxel_type = (argc>=4) ? atoi(argv[3]) : VOXEL_BOUNDARY | VOXEL_INSIDE;
 
-    VoxelGrid g;
+    SparseVoxelGrid g; // only voxels near the surface are stored explicitly
     Profiler p;
     p.push("voxelize");
     voxelize(m, max_voxels_per_side, g);
     p.pop();
     std::cout << "grid dimensions : " << g.dim[0] << " x " << g.dim[1] << " x " << g.dim[2] << std::endl;
+    std::cout << "grid memory     : " << g.memory_usage()/1024 << "KB (" << g.num_bricks() << " bricks)" << std::endl;
 
     DrawableHexmesh<> h;
     p.push("voxel grid to hexmesh");
@@ -0,0 +1,61 @@
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/octree.h>
+#include <cinolib/bvh.h>
+#include <cinolib/how_many_seconds.h>
+#include <random>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class SpatialStructure>
+void benchmark(const std::string        & name,
+               const Trimesh<>          & m,
+               const std::vector<vec3d> & points,
+               const std::vector<vec3d> & dirs)
+{
+    typedef std::chrono::steady_clock Time;
+
+    uint   id;
+    vec3d  pos;
+    double dist, t;
+
+    SpatialStructure sds;
+    Time::time_point t0 = Time::now();
+    sds.build_from_mesh_polys(m);
+    Time::time_point t1 = Time::now();
+    for(const vec3d & p : points) sds.closest_point(p, id, pos, dist);
+    Time::time_point t2 = Time::now();
+    for(uint i=0; i<points.size(); ++i) sds.intersects_ray(points.at(i), dirs.at(i), t, id);
+    Time::time_point t3 = Time::now();
+
+    std::cout << name << "\tbuild: "           << how_many_seconds(t0,t1) << "s"
+                      << "\tclosest points: "  << how_many_seconds(t1,t2) << "s"
+                      << "\tray first hits: "  << how_many_seconds(t2,t3) << "s" << std::endl;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char *argv[])
+{
+    std::string s = (argc>=2) ? std::string(argv[1]) : std::string(DATA_PATH) + "/bunny.obj";
+    uint n_queries = (argc>=3) ? atoi(argv[2]) : 100000;
+    Trimesh<> m(s.c_str());
+
+    // random query points in a slightly enlarged bounding box, and random ray directions
+    AABB box = m.bbox();
+    box.scale(1.5);
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> unif(0,1);
+    std::vector<vec3d> points(n_queries), dirs(n_queries);
+    for(uint i=0; i<n_queries; ++i)
+    {
+        points.at(i) = box.min + vec3d(unif(rng)*box.delta_x(), unif(rng)*box.delta_y(), unif(rng)*box.delta_z());
+        dirs.at(i)   = vec3d(unif(rng)-0.5, unif(rng)-0.5, unif(rng)-0.5);
+    }
+
+    std::cout << m.num_polys() << " triangles, " << n_queries << " queries" << std::endl;
+    benchmark<Octree>("Octree", m, points, dirs);
+    benchmark<BVH>   ("BVH   ", m, points, dirs);
+    return 0;
+}
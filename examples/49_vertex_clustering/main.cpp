@@ -0,0 +1,47 @@
+#include <cinolib/vertex_clustering.h>
+#include <cinolib/geometry/vec_mat.h>
+#include <cinolib/how_many_seconds.h>
+#include <random>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Scalability test for vertex clustering. Each input is a synthetic soup, where
+// points come in groups of 1 to 6 copies of the same point (as it happens for the
+// vertices of a triangle soup), perturbed with a noise smaller than the threshold
+
+int main(int argc, char *argv[])
+{
+    uint   max_points = (argc>=2) ? atoi(argv[1]) : 10000000;
+    double thresh     = 1e-6;
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> unif(0,1);
+
+    for(uint n=10000; n<=max_points; n*=10)
+    {
+        std::vector<vec3d> points;
+        points.reserve(n);
+        while(points.size()<n)
+        {
+            vec3d p(unif(rng), unif(rng), unif(rng));
+            uint  copies = 1 + rng()%6;
+            for(uint i=0; i<copies && points.size()<n; ++i)
+            {
+                vec3d noise(unif(rng)-0.5, unif(rng)-0.5, unif(rng)-0.5);
+                points.push_back(p + noise*0.5*thresh);
+            }
+        }
+        std::shuffle(points.begin(), points.end(), rng);
+
+        typedef std::chrono::steady_clock Time;
+        Time::time_point t0 = Time::now();
+        std::vector<std::unordered_set<uint>> clusters;
+        vertex_clustering(points, thresh, clusters);
+        Time::time_point t1 = Time::now();
+
+        std::cout << n << " points\t" << clusters.size() << " clusters\t" << how_many_seconds(t0,t1) << "s" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/exact_geodesics.h>
+#include <cinolib/geodesics.h>
+#include <cinolib/dijkstra.h>
+#include <cinolib/how_many_seconds.h>
+#include <random>
+
+using namespace cinolib;
+
+// mean and max absolute difference between an approximation and the exact distances,
+// relative to the largest exact distance
+void errors(const std::vector<double> & approx,
+            const std::vector<double> & exact,
+                  double              & mean_err,
+                  double              & max_err)
+{
+    double max_dist = *std::max_element(exact.begin(), exact.end());
+    mean_err = max_err = 0.0;
+    for(uint vid=0; vid<exact.size(); ++vid)
+    {
+        double err = std::fabs(approx.at(vid)-exact.at(vid))/max_dist;
+        mean_err += err;
+        max_err   = std::max(max_err, err);
+    }
+    mean_err /= exact.size();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char *argv[])
+{
+    typedef std::chrono::steady_clock Time;
+
+    std::string s = (argc>=2) ? std::string(argv[1]) : std::string(DATA_PATH) + "/bunny.obj";
+    uint n_sources = (argc>=3) ? atoi(argv[2]) : 10;
+    Trimesh<> m(s.c_str());
+
+    std::mt19937 rng(0);
+    std::vector<uint> sources(n_sources);
+    for(uint & vid : sources) vid = rng()%m.num_verts();
+
+    Time::time_point t0 = Time::now();
+    ExactGeodesics<> exact(m);
+    Time::time_point t1 = Time::now();
+    std::cout << m.num_verts() << " verts, " << n_sources << " sources (ExactGeodesics setup: " << how_many_seconds(t0,t1) << "s)" << std::endl;
+
+    double t_exact = 0, t_heat = 0, t_dijkstra = 0;
+    double heat_mean = 0, heat_max = 0, dijkstra_mean = 0, dijkstra_max = 0;
+    uint   n_windows = 0;
+    for(uint vid : sources)
+    {
+        t0 = Time::now();
+        exact.compute({vid});
+        t1 = Time::now();
+        t_exact   += how_many_seconds(t0,t1);
+        n_windows += exact.num_windows();
+        const std::vector<double> & d = exact.distances();
+
+        // the heat method returns a field normalized in [0,1], which is 1 at the source
+        t0 = Time::now();
+        ScalarField heat = compute_geodesics(m, {vid});
+        t1 = Time::now();
+        t_heat += how_many_seconds(t0,t1);
+        double max_dist = *std::max_element(d.begin(), d.end());
+        std::vector<double> h(m.num_verts());
+        for(uint i=0; i<m.num_verts(); ++i) h.at(i) = (1.0-heat[i])*max_dist;
+
+        std::vector<double> dj;
+        t0 = Time::now();
+        dijkstra_exhaustive(m, vid, dj);
+        t1 = Time::now();
+        t_dijkstra += how_many_seconds(t0,t1);
+
+        double mean_err, max_err;
+        errors(h, d, mean_err, max_err);
+        heat_mean += mean_err;
+        heat_max   = std::max(heat_max, max_err);
+        errors(dj, d, mean_err, max_err);
+        dijkstra_mean += mean_err;
+        dijkstra_max   = std::max(dijkstra_max, max_err);
+    }
+
+    std::cout << "Exact    \ttime per field: " << t_exact/n_sources    << "s\t(" << n_windows/n_sources << " windows per field)" << std::endl;
+    std::cout << "Heat     \ttime per field: " << t_heat/n_sources     << "s\tmean err: " << heat_mean/n_sources     << "\tmax err: " << heat_max     << std::endl;
+    std::cout << "Dijkstra \ttime per field: " << t_dijkstra/n_sources << "s\tmean err: " << dijkstra_mean/n_sources << "\tmax err: " << dijkstra_max << std::endl;
+
+    // point to point queries and distance cutoff stop the propagation early
+    double t_path = 0, t_cutoff = 0;
+    std::vector<vec3d> path;
+    for(uint i=0; i+1<n_sources; ++i)
+    {
+        t0 = Time::now();
+        exact.compute_path(sources.at(i), sources.at(i+1), path);
+        t1 = Time::now();
+        exact.compute({sources.at(i)}, 0.1*m.bbox().diag());
+        Time::time_point t2 = Time::now();
+        t_path   += how_many_seconds(t0,t1);
+        t_cutoff += how_many_seconds(t1,t2);
+    }
+    if(n_sources>1)
+    {
+        std::cout << "Exact point to point path: " << t_path/(n_sources-1)   << "s" << std::endl;
+        std::cout << "Exact with cutoff (10% of bbox diagonal): " << t_cutoff/(n_sources-1) << "s" << std::endl;
+    }
+    return 0;
+}
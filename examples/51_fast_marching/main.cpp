@@ -0,0 +1,77 @@
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/fast_marching.h>
+#include <cinolib/geodesics.h>
+#include <cinolib/dijkstra.h>
+#include <cinolib/how_many_seconds.h>
+
+using namespace cinolib;
+
+// mean and max absolute difference between an approximation and the straight line distance
+// from the source (which is the exact geodesic distance in a convex volume), relative to
+// the largest distance
+void errors(const Tetmesh<>             & m,
+            const uint                    source,
+            const ScalarField           & approx,
+                  double                & mean_err,
+                  double                & max_err)
+{
+    double max_dist = 0;
+    for(uint vid=0; vid<m.num_verts(); ++vid) max_dist = std::max(max_dist, m.vert(vid).dist(m.vert(source)));
+    mean_err = max_err = 0.0;
+    for(uint vid=0; vid<m.num_verts(); ++vid)
+    {
+        double err = std::fabs(approx[vid] - m.vert(vid).dist(m.vert(source)))/max_dist;
+        mean_err += err;
+        max_err   = std::max(max_err, err);
+    }
+    mean_err /= m.num_verts();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char *argv[])
+{
+    typedef std::chrono::steady_clock Time;
+
+    // errors are measured against straight line distances: use a convex tetmesh!
+    std::string s = (argc>=2) ? std::string(argv[1]) : std::string(DATA_PATH) + "/sphere.mesh";
+    bool  do_heat = (argc>=3) ? atoi(argv[2]) : true; // the heat method may not fit in memory for big meshes
+    Tetmesh<> m(s.c_str());
+    uint source = 0;
+
+    Time::time_point t0 = Time::now();
+    ScalarField fmm = fast_marching(m, {source});
+    Time::time_point t1 = Time::now();
+    double t_fmm = how_many_seconds(t0,t1);
+
+    std::vector<double> dj;
+    t0 = Time::now();
+    dijkstra_exhaustive(m, source, dj);
+    t1 = Time::now();
+    double t_dijkstra = how_many_seconds(t0,t1);
+
+    double mean_err, max_err;
+    errors(m, source, fmm, mean_err, max_err);
+    std::cout << "Fast Marching\ttime: " << t_fmm << "s\tmean err: " << mean_err << "\tmax err: " << max_err << std::endl;
+    errors(m, source, ScalarField(dj), mean_err, max_err);
+    std::cout << "Dijkstra     \ttime: " << t_dijkstra << "s\tmean err: " << mean_err << "\tmax err: " << max_err << std::endl;
+
+    if(do_heat)
+    {
+        t0 = Time::now();
+        std::vector<ScalarField> heat = compute_geodesics_batched(m, {{source}});
+        t1 = Time::now();
+        errors(m, source, heat.front(), mean_err, max_err);
+        std::cout << "Heat         \ttime: " << how_many_seconds(t0,t1) << "s\tmean err: " << mean_err << "\tmax err: " << max_err << std::endl;
+    }
+
+    // non uniform speed: the front is twice as fast in the upper half of the volume
+    std::vector<double> speed(m.num_verts());
+    double z_mid = m.bbox().center().z();
+    for(uint vid=0; vid<m.num_verts(); ++vid) speed.at(vid) = (m.vert(vid).z()>z_mid) ? 2.0 : 1.0;
+    t0 = Time::now();
+    ScalarField arrival_time = fast_marching(m, {source}, speed);
+    t1 = Time::now();
+    std::cout << "Fast Marching with variable speed\ttime: " << how_many_seconds(t0,t1) << "s\tmax arrival time: " << arrival_time.maxCoeff() << std::endl;
+    return 0;
+}
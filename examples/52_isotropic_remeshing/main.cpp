@@ -0,0 +1,76 @@
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/remesh_isotropic.h>
+#include <cinolib/remesh_BotschKobbelt2004.h>
+#include <cinolib/bvh.h>
+#include <cinolib/how_many_seconds.h>
+
+using namespace cinolib;
+
+// edge length statistics w.r.t. the target length, and max/mean distance from the input surface (relative to the target length)
+void quality(const Trimesh<> & m,
+             const BVH       & input,
+             const double      target)
+{
+    double in_range = 0;
+    for(uint eid=0; eid<m.num_edges(); ++eid)
+    {
+        double l = m.edge_length(eid)/target;
+        if(l>=4./5. && l<=4./3.) ++in_range;
+    }
+    double max_dist = 0, mean_dist = 0;
+    for(uint vid=0; vid<m.num_verts(); ++vid)
+    {
+        double d   = input.closest_point(m.vert(vid)).dist(m.vert(vid))/target;
+        max_dist   = std::max(max_dist,d);
+        mean_dist += d;
+    }
+    std::cout << m.num_polys() << " triangles\t"
+              << "edge length: " << m.edge_avg_length()/target << " (target 1)\t"
+              << 100.0*in_range/m.num_edges() << "% in [4/5,4/3]\t"
+              << "dist from input: " << mean_dist/m.num_verts() << " (mean) " << max_dist << " (max)" << std::endl;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char *argv[])
+{
+    typedef std::chrono::steady_clock Time;
+
+    std::string s     = (argc>=2) ? std::string(argv[1]) : std::string(DATA_PATH) + "/bunny.obj";
+    double      scale = (argc>=3) ? atof(argv[2]) : 0.5; // target edge length, relative to the average edge length of the input
+    bool        old   = (argc>=4) ? atoi(argv[3]) : true; // the serial remesher may take long for big meshes
+
+    Trimesh<> input(s.c_str());
+    BVH bvh;
+    bvh.build_from_mesh_polys(input);
+
+    RemeshOptions opt;
+    opt.target_edge_length = scale*input.edge_avg_length();
+    opt.verbose            = true;
+
+    Trimesh<> m = input;
+    Time::time_point t0 = Time::now();
+    std::vector<RemeshStats> stats = remesh_isotropic(m, opt);
+    Time::time_point t1 = Time::now();
+    std::cout << "\nIsotropic remesher (" << stats.size() << " iterations)\t" << how_many_seconds(t0,t1) << "s" << std::endl;
+    quality(m, bvh, opt.target_edge_length);
+
+    if(old)
+    {
+        m  = input;
+        t0 = Time::now();
+        for(uint i=0; i<stats.size(); ++i) remesh_Botsch_Kobbelt_2004(m, opt.target_edge_length, false);
+        t1 = Time::now();
+        std::cout << "\nBotsch-Kobbelt remesher (" << stats.size() << " iterations)\t" << how_many_seconds(t0,t1) << "s" << std::endl;
+        quality(m, bvh, opt.target_edge_length);
+    }
+
+    opt.adaptive = true;
+    m  = input;
+    t0 = Time::now();
+    stats = remesh_isotropic(m, opt);
+    t1 = Time::now();
+    std::cout << "\nAdaptive remesher (" << stats.size() << " iterations)\t" << how_many_seconds(t0,t1) << "s" << std::endl;
+    std::cout << m.num_polys() << " triangles" << std::endl;
+    return 0;
+}
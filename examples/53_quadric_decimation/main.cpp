@@ -0,0 +1,61 @@
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/quadric_decimation.h>
+#include <cinolib/bvh.h>
+#include <cinolib/how_many_seconds.h>
+
+using namespace cinolib;
+
+// max distance from the verts of the input mesh to the decimated mesh, relative to the bbox diagonal
+double hausdorff(const Trimesh<> & input, const Trimesh<> & m)
+{
+    BVH bvh;
+    bvh.build_from_mesh_polys(m);
+    double d = 0;
+    for(uint vid=0; vid<input.num_verts(); ++vid)
+    {
+        d = std::max(d, bvh.closest_point(input.vert(vid)).dist(input.vert(vid)));
+    }
+    return d/input.bbox().diag();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char *argv[])
+{
+    typedef std::chrono::steady_clock Time;
+
+    std::string s        = (argc>=2) ? std::string(argv[1]) : std::string(DATA_PATH) + "/bunny.obj";
+    uint        n_blocks = (argc>=3) ? atoi(argv[2]) : 16; // blocks for the parallel decimation
+
+    Trimesh<> input(s.c_str());
+
+    for(double ratio : {0.5, 0.1, 0.01})
+    {
+        QuadricDecimationOptions opt;
+        opt.target_polys = uint(ratio*input.num_polys());
+
+        for(uint n : {1u, n_blocks})
+        {
+            opt.n_partitions = n;
+            Trimesh<> m = input;
+            Time::time_point t0 = Time::now();
+            double err = quadric_decimation(m, opt);
+            Time::time_point t1 = Time::now();
+            std::cout << "LOD " << 100*ratio << "%\t" << ((n>1) ? "parallel" : "serial  ") << "\t"
+                      << m.num_polys() << " triangles\t"
+                      << how_many_seconds(t0,t1) << "s\t"
+                      << "QEM error: " << err/input.bbox().diag() << "\t"
+                      << "Hausdorff: " << hausdorff(input,m) << " (relative to bbox diagonal)" << std::endl;
+        }
+    }
+
+    // uv aware decimation (seams are boundaries, hence they are preserved anyways)
+    std::string tex = std::string(DATA_PATH) + "/blub_triangulated.obj";
+    Trimesh<> m(tex.c_str());
+    QuadricDecimationOptions opt;
+    opt.target_polys = m.num_polys()/10;
+    opt.use_uv       = true;
+    quadric_decimation(m, opt);
+    std::cout << "UV aware LOD 10%\t" << m.num_polys() << " triangles" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/signed_distance_grid.h>
+#include <cinolib/fast_winding_number.h>
+#include <cinolib/winding_number.h>
+#include <cinolib/voxelize.h>
+#include <cinolib/bvh.h>
+#include <cinolib/how_many_seconds.h>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char *argv[])
+{
+    typedef std::chrono::steady_clock Time;
+
+    std::string s   = (argc>=2) ? std::string(argv[1]) : std::string(DATA_PATH) + "/bunny.obj";
+    uint        res = (argc>=3) ? atoi(argv[2]) : 64;
+
+    Trimesh<> m(s.c_str());
+    AABB bbox = m.bbox();
+    bbox.scale(1.2);
+
+    // signed distance grids
+    Time::time_point t0 = Time::now();
+    SignedDistanceGrid dense = signed_distance_grid(m, bbox, res);
+    Time::time_point t1 = Time::now();
+    SignedDistanceOptions opt;
+    opt.sparse = true;
+    SignedDistanceGrid sparse = signed_distance_grid(m, bbox, res, opt);
+    Time::time_point t2 = Time::now();
+    std::cout << "grid nodes   : " << dense.dim[0] << " x " << dense.dim[1] << " x " << dense.dim[2] << std::endl;
+    std::cout << "dense  grid  : " << how_many_seconds(t0,t1) << "s\t" << dense .memory_usage()/1e6 << "MB" << std::endl;
+    std::cout << "sparse grid  : " << how_many_seconds(t1,t2) << "s\t" << sparse.memory_usage()/1e6 << "MB" << std::endl;
+
+    // per sample queries (closest point + winding number), on a subset of the nodes
+    BVH bvh;
+    bvh.build_from_mesh_polys(m);
+    FastWindingNumber fwn(m);
+    double err = 0, t_exact = 0, t_fast = 0;
+    uint   n_samples = 0, n_fwn_flips = 0, n_grid_flips = 0;
+    for(uint i=0; i<dense.dim[0]; i+=4)
+    for(uint j=0; j<dense.dim[1]; j+=4)
+    for(uint k=0; k<dense.dim[2]; k+=4)
+    {
+        vec3d p = dense.node(i,j,k);
+        Time::time_point t3 = Time::now();
+        double d = bvh.closest_point(p).dist(p);
+        bool   w = winding_number(m,p)>0;
+        Time::time_point t4 = Time::now();
+        bool   f = fwn.is_inside(p);
+        Time::time_point t5 = Time::now();
+        t_exact += how_many_seconds(t3,t4);
+        t_fast  += how_many_seconds(t4,t5);
+        if(w) d = -d;
+        if(w!=f) ++n_fwn_flips;
+        if((dense.value(i,j,k)<0)!=w) ++n_grid_flips;
+        err = std::max(err, std::fabs(dense.value(i,j,k)-d));
+        ++n_samples;
+    }
+    std::cout << "per sample   : " << 1e6*t_exact/n_samples << "us (closest point + winding number), "
+                                   << 1e6*t_fast /n_samples << "us (fast winding number)" << std::endl;
+    std::cout << "max error    : " << err/dense.len << " cells (" << n_samples << " samples, " << n_grid_flips << " sign mismatches)" << std::endl;
+    std::cout << "fast winding : " << n_fwn_flips << " inside/outside mismatches" << std::endl;
+
+    // the grid can be directly used to voxelize the object
+    VoxelGrid g;
+    voxelize([&](const vec3d & p){ return sparse.sample(p); }, bbox, res, g);
+    uint n_inside = 0;
+    for(uint i=0; i<g.dim[0]*g.dim[1]*g.dim[2]; ++i) if(g.voxels[i]==VOXEL_INSIDE) ++n_inside;
+    std::cout << "voxelization : " << n_inside << " voxels inside" << std::endl;
+    return 0;
+}
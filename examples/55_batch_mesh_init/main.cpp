@@ -0,0 +1,135 @@
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/io/read_OBJ.h>
+#include <cinolib/io/read_OFF.h>
+#include <cinolib/string_utilities.h>
+#include <cinolib/how_many_seconds.h>
+#include <filesystem>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// n x n grid of quads, each split into two triangles
+void make_grid(const uint n, std::vector<vec3d> & verts, std::vector<std::vector<uint>> & polys)
+{
+    for(uint i=0; i<=n; ++i)
+    for(uint j=0; j<=n; ++j)
+    {
+        verts.push_back(vec3d(i,j,0));
+    }
+    for(uint i=0; i<n; ++i)
+    for(uint j=0; j<n; ++j)
+    {
+        uint v0 = i*(n+1)+j;
+        uint v1 = v0+1;
+        uint v2 = v0+n+2;
+        uint v3 = v0+n+1;
+        polys.push_back({v0,v1,v2});
+        polys.push_back({v0,v2,v3});
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// n triangles around vertex zero (the worst case for incremental construction)
+void make_fan(const uint n, std::vector<vec3d> & verts, std::vector<std::vector<uint>> & polys)
+{
+    verts.push_back(vec3d(0,0,0));
+    for(uint i=0; i<n; ++i)
+    {
+        double a = 2*M_PI*i/n;
+        verts.push_back(vec3d(cos(a),sin(a),0));
+    }
+    for(uint i=0; i<n; ++i) polys.push_back({0, 1+i, 1+(i+1)%n});
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void benchmark(const std::string & name, const std::vector<vec3d> & verts, const std::vector<std::vector<uint>> & polys)
+{
+    typedef std::chrono::steady_clock Time;
+
+    // batch: AbstractPolygonMesh::init builds all the connectivity at once (polys_add)
+    Time::time_point t0 = Time::now();
+    Polygonmesh<> batch(verts, polys);
+    Time::time_point t1 = Time::now();
+
+    // incremental: one poly_add per polygon
+    Polygonmesh<> incremental;
+    for(const vec3d & p : verts) incremental.vert_add(p);
+    for(const auto  & p : polys) incremental.poly_add(p);
+    Time::time_point t2 = Time::now();
+
+    auto same_list = [](const Span<uint> & a, const Span<uint> & b)
+    {
+        return a.size()==b.size() && std::equal(a.begin(), a.end(), b.begin());
+    };
+    bool same = batch.num_edges()==incremental.num_edges() && batch.num_polys()==incremental.num_polys();
+    for(uint pid=0; same && pid<batch.num_polys(); ++pid) same = same_list(batch.adj_p2p(pid), incremental.adj_p2p(pid));
+    for(uint vid=0; same && vid<batch.num_verts(); ++vid) same = same_list(batch.adj_v2e(vid), incremental.adj_v2e(vid));
+
+    // batch inside begin_batch()/end_batch(): normals and tessellations are deferred to
+    // end_batch(), and must come out the same as above also with many worker threads
+    Time::time_point t3 = Time::now();
+    Polygonmesh<> deferred;
+    deferred.begin_batch();
+    for(const vec3d & p : verts) deferred.vert_add(p);
+    deferred.polys_add(polys);
+    deferred.end_batch();
+    Time::time_point t4 = Time::now();
+
+    bool same_deferred = batch.num_polys()==deferred.num_polys();
+    for(uint pid=0; same_deferred && pid<batch.num_polys(); ++pid)
+    {
+        same_deferred = batch.poly_data(pid).normal==deferred.poly_data(pid).normal &&
+                        batch.poly_tessellation(pid)==deferred.poly_tessellation(pid);
+    }
+    for(uint vid=0; same_deferred && vid<batch.num_verts(); ++vid)
+    {
+        same_deferred = batch.vert_data(vid).normal==deferred.vert_data(vid).normal;
+    }
+
+    std::cout << name << "\t" << polys.size() << " polys\t"
+              << "batch: "       << how_many_seconds(t0,t1) << "s\t"
+              << "incremental: " << how_many_seconds(t1,t2) << "s\t"
+              << "speedup: "     << how_many_seconds(t1,t2)/how_many_seconds(t0,t1) << "x\t"
+              << "same connectivity: " << (same ? "yes" : "NO") << std::endl;
+
+    std::cout << name << "\t" << polys.size() << " polys\t"
+              << "deferred batch: " << how_many_seconds(t3,t4) << "s\t"
+              << "threads: " << ThreadPool::instance().num_threads() << "\t"
+              << "same normals and tessellations: " << (same_deferred ? "yes" : "NO") << std::endl;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char *argv[])
+{
+    // a large OBJ or OFF file. If none is given, a 1M triangle grid is written to a temporary OBJ
+    std::string s = (argc>=2) ? std::string(argv[1]) : "";
+    if(s.empty())
+    {
+        std::vector<vec3d>             verts;
+        std::vector<std::vector<uint>> polys;
+        make_grid(708, verts, polys);
+        s = (std::filesystem::temp_directory_path() / "cinolib_grid.obj").string();
+        Polygonmesh<>(verts, polys).save(s.c_str());
+    }
+
+    std::vector<vec3d>             verts;
+    std::vector<std::vector<uint>> polys;
+    std::string ext = get_file_extension(s);
+    if(ext=="obj" || ext=="OBJ") read_OBJ(s.c_str(), verts, polys); else
+    if(ext=="off" || ext=="OFF") read_OFF(s.c_str(), verts, polys); else
+    {
+        std::cerr << "unsupported file format (only OBJ and OFF)" << std::endl;
+        return -1;
+    }
+    benchmark(get_file_name(s), verts, polys);
+
+    verts.clear();
+    polys.clear();
+    make_fan(20000, verts, polys);
+    benchmark("fan", verts, polys);
+    return 0;
+}
@@ -40,6 +40,7 @@
 #include <cinolib/3d_printing/supports_volume.h>
 #include <cinolib/3d_printing/shadow_on_build_platform.h>
 #include <cinolib/sphere_coverage.h>
+#include <cinolib/bvh.h>
 
 namespace cinolib
 {
@@ -61,8 +62,8 @@ vec3d optimal_build_dir(const DrawableTrimesh<M,V,E,P> & m,
     // cache everything that can be cached to speed up computation
     GLFWwindow *GL_context = create_offline_GL_context(opt.buffer_size, opt.buffer_size);
     u_int8_t   *data       = new u_int8_t[opt.buffer_size*opt.buffer_size];
-    Octree octree;
-    octree.build_from_mesh_polys(m);
+    BVH bvh;
+    bvh.build_from_mesh_polys(m);
 
     // compute scores for all candidate directions. scores are stored separately because this will
     // allow to normalize them in the same range and combine them in a meaningful way...
@@ -87,7 +88,7 @@ vec3d optimal_build_dir(const DrawableTrimesh<M,V,E,P> & m,
 
         // NOTE: this call is 90% of the computational cost
         std::vector<std::pair<uint,uint>> polys_hanging;
-        overhangs(m, opt.overhang_threshold, dirs[i], polys_hanging, octree);
+        overhangs(m, opt.overhang_threshold, dirs[i], polys_hanging, bvh);
 
         // projection of the "lowest" mesh vertex along the build direction
         // this is used further down to estimate the volume of support structures
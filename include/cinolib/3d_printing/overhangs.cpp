@@ -35,8 +35,7 @@
 *********************************************************************************/
 #include <cinolib/3d_printing/overhangs.h>
 #include <cinolib/parallel_for.h>
-#include <cinolib/octree.h>
-#include <cinolib/find_intersections.h>
+#include <cinolib/bvh.h>
 #include <mutex>
 
 namespace cinolib
@@ -69,34 +68,30 @@ void overhangs(const Trimesh<M,V,E,P>                  & m,
                const float                               thresh, // degrees
                const vec3d                             & build_dir,
                      std::vector<std::pair<uint,uint>> & polys_hanging,
-               const Octree                            & octree) // cached
+               const SpatialDataStructure              & sds) // cached
 {
     // find overhanging triangles
     std::vector<uint> tmp;
     overhangs(m, thresh, build_dir, tmp);
 
     // cast a ray from each overhang to find the first triangle below it
-    std::mutex mutex;
+    // (the hanging triangle itself is not considered)
+    std::vector<vec3d> p(tmp.size());
+    std::vector<vec3d> dir(tmp.size(), -build_dir);
+    std::vector<int>   ignore(tmp.begin(), tmp.end());
     PARALLEL_FOR(0, tmp.size(), 1000, [&](const uint i)
     {
-        uint pid  = tmp[i];
-        auto pair = std::make_pair(pid,pid);
-        std::set<std::pair<double,uint>> hits;
-        if(octree.intersects_ray(m.poly_centroid(pid), -build_dir, hits))
-        {
-            auto hit = hits.begin();
-            if(hit->second==pid) ++hit; // skip the first hit, it's the starting polygon
-            if(hit!=hits.end())
-            {
-                pair.second = hit->second;
-            }
-        }
-        // critical section
-        {
-            std::lock_guard<std::mutex> guard(mutex);
-            polys_hanging.push_back(pair);
-        }
+        p[i] = m.poly_centroid(tmp[i]);
     });
+    std::vector<double> t;
+    std::vector<int>    hits;
+    sds.intersects_rays(p, dir, t, hits, ignore);
+
+    polys_hanging.reserve(polys_hanging.size()+tmp.size());
+    for(uint i=0; i<tmp.size(); ++i)
+    {
+        polys_hanging.push_back(std::make_pair(tmp[i], (hits[i]>=0) ? uint(hits[i]) : tmp[i]));
+    }
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -108,9 +103,9 @@ void overhangs(const Trimesh<M,V,E,P>                  & m,
                const vec3d                             & build_dir,
                      std::vector<std::pair<uint,uint>> & polys_hanging)
 {
-    Octree octree;
-    octree.build_from_mesh_polys(m);
-    overhangs(m, thresh, build_dir, polys_hanging, octree);
+    BVH bvh;
+    bvh.build_from_mesh_polys(m);
+    overhangs(m, thresh, build_dir, polys_hanging, bvh);
 }
 
 }
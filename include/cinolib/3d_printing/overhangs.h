@@ -37,7 +37,7 @@
 #define CINO_OVERHANGS_H
 
 #include <cinolib/meshes/trimesh.h>
-#include <cinolib/octree.h>
+#include <cinolib/spatial_data_structure.h>
 
 namespace cinolib
 {
@@ -77,8 +77,9 @@ void overhangs(const Trimesh<M,V,E,P>                  & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// in case the function is called multiple times, it is convenient to
-// pay the cost for building the octree just once
+// in case the function is called multiple times, it is convenient to pay the cost for
+// building the spatial data structure just once. Rays are shot all together, with
+// a batched query (a BVH will be faster than an Octree here)
 //
 template<class M, class V, class E, class P>
 CINO_INLINE
@@ -86,7 +87,7 @@ void overhangs(const Trimesh<M,V,E,P>                  & m,
                const float                               thresh, // degrees
                const vec3d                             & build_dir,
                      std::vector<std::pair<uint,uint>> & polys_hanging,
-               const Octree                            & octree); // cached
+               const SpatialDataStructure              & sds); // cached
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -34,81 +34,403 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/RBF_Hermite.h>
+#include <cinolib/RBF_kernels.h>
+#include <cinolib/parallel_for.h>
+#include <Eigen/Sparse>
+#include <Eigen/IterativeLinearSolvers>
+#include <numeric>
 
 namespace cinolib
 {
 
+namespace
+{
+
+// kernel psi(d) = phi(|d|/s), its gradient g and its Hessian H
+template<class RBF>
+CINO_INLINE
+void hrbf_kernel(const Eigen::Vector3d & d,
+                 const double            s,
+                       double          & w,
+                       Eigen::Vector3d & g,
+                       Eigen::Matrix3d & H)
+{
+    double l = d.norm();
+    if(l==0)
+    {
+        w = RBF::eval_f(0);
+        g.setZero();
+        H = Eigen::Matrix3d::Identity() * RBF::eval_ddf(0)/(s*s);
+        return;
+    }
+    double dw_l = RBF::eval_df (l/s)/(s*l);
+    double ddw  = RBF::eval_ddf(l/s)/(s*s);
+    w = RBF::eval_f(l/s);
+    g = d*dw_l;
+    H = (ddw - dw_l)/(l*l) * (d*d.transpose());
+    H.diagonal().array() += dw_l;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* The Hermite system [w g^T; g H] [alpha; beta] = [0; n] becomes symmetric if
+ * the beta columns are flipped, i.e. solving for [alpha; -beta]. For positive
+ * definite kernels the resulting matrix is also positive definite. Returns the
+ * coefficients of points ids as (alpha_i, beta_i) quadruples
+*/
+template<class RBF>
+CINO_INLINE
+Eigen::VectorXd hrbf_solve_dense(const std::vector<vec3d> & points,
+                                 const std::vector<vec3d> & normals,
+                                 const std::vector<uint>  & ids,
+                                 const double               s)
+{
+    uint size = 4*uint(ids.size());
+    Eigen::MatrixXd A(size, size);
+    Eigen::VectorXd f(size);
+
+    double w;
+    Eigen::Vector3d g;
+    Eigen::Matrix3d H;
+    for(uint i=0; i<ids.size(); ++i)
+    {
+        const vec3d & p = points.at(ids[i]);
+        const vec3d & n = normals.at(ids[i]);
+        uint ii = 4*i;
+        f(ii)   = 0;
+        f(ii+1) = n.x();
+        f(ii+2) = n.y();
+        f(ii+3) = n.z();
+
+        for(uint j=0; j<ids.size(); ++j)
+        {
+            const vec3d & q = points.at(ids[j]);
+            uint jj = 4*j;
+            hrbf_kernel<RBF>(Eigen::Vector3d(p.x()-q.x(), p.y()-q.y(), p.z()-q.z()), s, w, g, H);
+            A(ii,jj) = w;
+            A.row(ii).template segment<3>(jj+1) = -g.transpose();
+            A.col(jj).template segment<3>(ii+1) =  g;
+            A.template block<3,3>(ii+1,jj+1)   = -H;
+        }
+    }
+
+    Eigen::VectorXd x;
+    if(RBF::compact)
+    {
+        Eigen::LLT<Eigen::MatrixXd> llt(A);
+        if(llt.info()==Eigen::Success) x = llt.solve(f);
+        else                           x = A.lu().solve(f);
+    }
+    else x = A.lu().solve(f);
+
+    for(uint i=0; i<ids.size(); ++i) x.template segment<3>(4*i+1) *= -1;
+    return x;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// average distance between a point and its nearest neighbor, estimated on a subset of the points
+CINO_INLINE
+double hrbf_avg_spacing(const Octree & octree, const std::vector<vec3d> & points)
+{
+    uint   np   = uint(points.size());
+    uint   step = std::max(1u, np/1000);
+    double diag = octree.nodes.front().bbox.diag();
+    double sum  = 0;
+    uint   cnt  = 0;
+    std::vector<uint> ids;
+    for(uint i=0; i<np; i+=step)
+    {
+        double r = diag/std::sqrt(double(np));
+        while(r<diag)
+        {
+            double d = inf_double;
+            octree.items_within(points.at(i), r, ids);
+            for(uint j : ids)
+            {
+                double dj = points.at(i).dist(points.at(j));
+                if(dj>0 && dj<d) d = dj;
+            }
+            if(d<=r) // the nearest neighbor is within r only if it was found
+            {
+                sum += d;
+                ++cnt;
+                break;
+            }
+            r *= 2;
+        }
+    }
+    return (cnt>0) ? sum/cnt : diag;
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class RBF>
 CINO_INLINE
 Hermite_RBF<RBF>::Hermite_RBF(const std::vector<vec3d> & points,
-                              const std::vector<vec3d> & normals)
+                              const std::vector<vec3d> & normals,
+                              const HermiteRBFOptions  & opt)
 {
     assert(points.size()==normals.size());
+    if(points.empty()) return;
+
+    solver = opt.solver;
+    if(solver==HRBF_SPARSE && !RBF::compact)
+    {
+        std::cerr << "WARNING - the sparse HRBF solver requires a compactly supported kernel. Switching to dense" << std::endl;
+        solver = HRBF_DENSE;
+    }
+
+    if(solver==HRBF_PARTITION_OF_UNITY) solve_pu    (points, normals, opt);
+    else                                solve_global(points, normals, opt);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class RBF>
+CINO_INLINE
+void Hermite_RBF<RBF>::solve_global(const std::vector<vec3d> & points,
+                                    const std::vector<vec3d> & normals,
+                                    const HermiteRBFOptions  & opt)
+{
     uint np = uint(points.size());
     alpha.resize(np);
     beta.resize(3, np);
     center.resize(3, np);
 
-    uint size = 4*np;
-    Eigen::MatrixXd A(size, size);
-    Eigen::VectorXd f(size);
-    Eigen::VectorXd x(size);
-
     // copy the node centers
     for(uint i=0; i<np; ++i)
     {
         center.col(i) = Eigen::Vector3d(points.at(i).x(), points.at(i).y(), points.at(i).z());
     }
 
-    for(uint i=0; i<np; ++i)
+    // compact kernels only see the centers within their support
+    support = 1.0;
+    if(RBF::compact)
     {
-        Eigen::Vector3d p = Eigen::Vector3d(points.at(i).x(),  points.at(i).y(),  points.at(i).z());
-        Eigen::Vector3d n = Eigen::Vector3d(normals.at(i).x(), normals.at(i).y(), normals.at(i).z());
+        octree = Octree(16, 16);
+        for(uint i=0; i<np; ++i) octree.push_point(i, points.at(i));
+        octree.build();
+        support = (opt.support>0) ? opt.support : opt.support_factor * hrbf_avg_spacing(octree, points);
+    }
 
-        uint ii = 4*i;
-        f(ii) = 0;
-        f.template segment<3>(ii+1) = n;
+    Eigen::VectorXd x;
+    if(solver==HRBF_DENSE)
+    {
+        std::vector<uint> ids(np);
+        std::iota(ids.begin(), ids.end(), 0);
+        x = hrbf_solve_dense<RBF>(points, normals, ids, support);
+    }
+    else
+    {
+        assert(solver==HRBF_SPARSE);
+
+        // the support is symmetric, hence so is the sparsity pattern, and
+        // the (4x4) blocks of column j are the neighbors of point j
+        std::vector<std::vector<uint>> nbrs(np);
+        PARALLEL_FOR(0, np, 1000, [&](uint i)
+        {
+            octree.items_within(points.at(i), support, nbrs.at(i));
+        });
 
+        std::vector<size_t> off(np+1, 0);
+        for(uint j=0; j<np; ++j) off[j+1] = off[j] + nbrs[j].size();
+        assert(16*off[np] < size_t(std::numeric_limits<int>::max()) && "too many non zeros: reduce the support");
+
+        Eigen::SparseMatrix<double> A(4*np, 4*np);
+        A.resizeNonZeros(Eigen::Index(16*off[np]));
+        int    *outer = A.outerIndexPtr();
+        int    *inner = A.innerIndexPtr();
+        double *value = A.valuePtr();
         for(uint j=0; j<np; ++j)
+        for(uint c=0; c<4; ++c)
         {
-            uint jj = 4*j;
-            Eigen::Vector3d diff = p-center.col(j);
-            double len=diff.norm();
-            if(len==0)
+            outer[4*j+c] = int(16*off[j] + 4*c*nbrs[j].size());
+        }
+        outer[4*np] = int(16*off[np]);
+
+        PARALLEL_FOR(0, np, 1000, [&](uint j)
+        {
+            double w;
+            Eigen::Vector3d g;
+            Eigen::Matrix3d H;
+            const vec3d & q = points.at(j);
+            for(uint k=0; k<nbrs[j].size(); ++k)
             {
-                A.template block<4,4>(ii,jj).setZero();
+                uint i = nbrs[j][k];
+                const vec3d & p = points.at(i);
+                hrbf_kernel<RBF>(Eigen::Vector3d(p.x()-q.x(), p.y()-q.y(), p.z()-q.z()), support, w, g, H);
+                for(uint c=0; c<4; ++c)
+                {
+                    int pos = outer[4*j+c] + int(4*k);
+                    for(uint r=0; r<4; ++r) inner[pos+r] = int(4*i+r);
+                    if(c==0)
+                    {
+                        value[pos  ] = w;
+                        value[pos+1] = g[0];
+                        value[pos+2] = g[1];
+                        value[pos+3] = g[2];
+                    }
+                    else
+                    {
+                        value[pos  ] = -g[c-1];
+                        value[pos+1] = -H(0,c-1);
+                        value[pos+2] = -H(1,c-1);
+                        value[pos+3] = -H(2,c-1);
+                    }
+                }
             }
+        });
+        std::vector<std::vector<uint>>().swap(nbrs);
+
+        Eigen::VectorXd f(4*np);
+        for(uint i=0; i<np; ++i)
+        {
+            f(4*i  ) = 0;
+            f(4*i+1) = normals.at(i).x();
+            f(4*i+2) = normals.at(i).y();
+            f(4*i+3) = normals.at(i).z();
+        }
+
+        if(opt.sparse_direct)
+        {
+            Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> llt(A);
+            if(llt.info()==Eigen::Success) x = llt.solve(f);
             else
             {
-                double w    = RBF::eval_f(len);
-                double dw_l = RBF::eval_df(len)/len;
-                double ddw  = RBF::eval_ddf(len);
-                Eigen::Vector3d g = diff*dw_l;
-                A(ii,jj) = w;
-                A.row(ii).template segment<3>(jj+1) = g.transpose();
-                A.col(jj).template segment<3>(ii+1) = g;
-                A.template block<3,3>(ii+1,jj+1)  = (ddw - dw_l)/(len*len) * (diff*diff.transpose());
-                A.template block<3,3>(ii+1,jj+1).diagonal().array() += dw_l;
+                std::cerr << "WARNING - HRBF sparse Cholesky failed. Falling back to sparse LU" << std::endl;
+                Eigen::SparseLU<Eigen::SparseMatrix<double>> lu(A);
+                x = lu.solve(f);
+            }
+        }
+        else
+        {
+            Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower|Eigen::Upper> cg;
+            cg.setTolerance(opt.cg_tolerance);
+            cg.setMaxIterations(int(opt.cg_max_iter));
+            cg.compute(A);
+            x = cg.solve(f);
+            if(cg.info()!=Eigen::Success)
+            {
+                std::cerr << "WARNING - HRBF conjugate gradient did not converge (#iter: " << cg.iterations()
+                          << ", error: " << cg.error() << ")" << std::endl;
             }
         }
+        for(uint i=0; i<np; ++i) x.template segment<3>(4*i+1) *= -1;
     }
 
-    x = A.lu().solve(f);
     Eigen::Map<Eigen::Matrix4Xd> mx(x.data(), 4, np);
-
     alpha = mx.row(0);
     beta  = mx.template bottomRows<3>();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class RBF>
+CINO_INLINE
+void Hermite_RBF<RBF>::solve_pu(const std::vector<vec3d> & points,
+                                const std::vector<vec3d> & normals,
+                                const HermiteRBFOptions  & opt)
+{
+    uint np = uint(points.size());
+
+    Octree tree(16, std::max(1u, opt.patch_size));
+    for(uint i=0; i<np; ++i) tree.push_point(i, points.at(i));
+    tree.build();
+
+    support = 1.0;
+    if(RBF::compact)
+    {
+        support = (opt.support>0) ? opt.support : opt.support_factor * hrbf_avg_spacing(tree, points);
+    }
+
+    // one patch for each non empty leaf: the bounding sphere of its points, enlarged by
+    // patch_overlap and further (if needed) until it contains at least patch_min_points
+    std::vector<uint> leaves;
+    for(uint nid : tree.leaves) if(tree.nodes.at(nid).num_items()>0) leaves.push_back(nid);
+    uint n_patches = uint(leaves.size());
+    uint min_pts   = std::min(np, opt.patch_min_points);
+    uint max_pts   = std::max(min_pts, opt.patch_max_points);
+
+    patch_center.resize(n_patches);
+    patch_radius.resize(n_patches);
+    std::vector<std::vector<uint>> ids(n_patches);
+    PARALLEL_FOR(0, n_patches, 100, [&](uint pid)
+    {
+        uint   nid = leaves.at(pid);
+        vec3d  c(0,0,0);
+        double r = 0;
+        for(uint vid : tree.node_items(nid)) c += points.at(vid);
+        c /= double(tree.nodes.at(nid).num_items());
+        for(uint vid : tree.node_items(nid)) r = std::max(r, c.dist(points.at(vid)));
+        r *= opt.patch_overlap;
+        if(r==0) r = tree.nodes.at(nid).bbox.diag()*0.01;
+
+        std::vector<uint> & list = ids.at(pid);
+        tree.items_within(c, r, list);
+        while(list.size()<min_pts)
+        {
+            r *= 1.25;
+            tree.items_within(c, r, list);
+        }
+        if(list.size()>max_pts) // keep the max_pts points closest to the center
+        {
+            auto closer = [&](const uint a, const uint b){ return c.dist_sqrd(points.at(a)) < c.dist_sqrd(points.at(b)); };
+            std::nth_element(list.begin(), list.begin()+max_pts-1, list.end(), closer);
+            list.resize(max_pts);
+            r = c.dist(points.at(list.back()));
+        }
+        patch_center.at(pid) = c;
+        patch_radius.at(pid) = r;
+    });
+
+    patch_offset.resize(n_patches+1);
+    patch_offset.front() = 0;
+    for(uint pid=0; pid<n_patches; ++pid) patch_offset[pid+1] = patch_offset[pid] + uint(ids[pid].size());
+
+    uint nc = patch_offset.back();
+    alpha.resize(nc);
+    beta.resize(3, nc);
+    center.resize(3, nc);
+
+    // patches have rather different costs, hence small chunks
+    PARALLEL_FOR(0, n_patches, 8, 4, [&](uint pid)
+    {
+        Eigen::VectorXd x = hrbf_solve_dense<RBF>(points, normals, ids.at(pid), support);
+        for(uint i=0; i<ids[pid].size(); ++i)
+        {
+            uint  col = patch_offset[pid] + i;
+            const vec3d & p = points.at(ids[pid][i]);
+            center.col(col) = Eigen::Vector3d(p.x(), p.y(), p.z());
+            alpha(col)      = x(4*i);
+            beta.col(col)   = x.template segment<3>(4*i+1);
+        }
+        std::vector<uint>().swap(ids.at(pid));
+    });
+
+    octree = Octree(16, 16);
+    for(uint pid=0; pid<n_patches; ++pid) octree.push_point(pid, patch_center.at(pid));
+    octree.build();
+    max_radius = *std::max_element(patch_radius.begin(), patch_radius.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class RBF>
 CINO_INLINE
 ScalarField Hermite_RBF<RBF>::eval(const std::vector<vec3d> & plist) const
 {
-    ScalarField f(uint(plist.size()));
-    for(uint i=0; i<plist.size(); ++i) f[i] = eval(plist.at(i));
+    uint np  = uint(plist.size());
+    uint bs  = 256;
+    uint nch = (np+bs-1)/bs;
+    ScalarField f(np);
+    PARALLEL_FOR(0, nch, 4, [&](uint ch)
+    {
+        std::vector<uint> tmp;
+        for(uint i=ch*bs; i<std::min(np,(ch+1)*bs); ++i) f[i] = eval(plist[i], nullptr, tmp);
+    });
     return f;
 }
 
@@ -117,19 +439,102 @@ ScalarField Hermite_RBF<RBF>::eval(const std::vector<vec3d> & plist) const
 template<class RBF>
 CINO_INLINE
 double Hermite_RBF<RBF>::eval(const vec3d & p) const
+{
+    std::vector<uint> tmp;
+    return eval(p, nullptr, tmp);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class RBF>
+CINO_INLINE
+std::vector<vec3d> Hermite_RBF<RBF>::eval_grad(const std::vector<vec3d> & plist) const
+{
+    uint np  = uint(plist.size());
+    uint bs  = 256;
+    uint nch = (np+bs-1)/bs;
+    std::vector<vec3d> grad(np);
+    PARALLEL_FOR(0, nch, 4, [&](uint ch)
+    {
+        std::vector<uint> tmp;
+        for(uint i=ch*bs; i<std::min(np,(ch+1)*bs); ++i) eval(plist[i], &grad[i], tmp);
+    });
+    return grad;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class RBF>
+CINO_INLINE
+vec3d Hermite_RBF<RBF>::eval_grad(const vec3d & p) const
+{
+    std::vector<uint> tmp;
+    vec3d grad;
+    eval(p, &grad, tmp);
+    return grad;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class RBF>
+CINO_INLINE
+double Hermite_RBF<RBF>::eval(const vec3d & p, vec3d * grad, std::vector<uint> & tmp) const
 {
     Eigen::Vector3d pp(p.x(), p.y(), p.z());
+    Eigen::Vector3d g = Eigen::Vector3d::Zero();
+    Eigen::Vector3d *gp = (grad!=nullptr) ? &g : nullptr;
     double val = 0;
-    for(uint i=0; i<center.cols(); ++i)
+
+    if(solver==HRBF_PARTITION_OF_UNITY)
     {
-        Eigen::Vector3d diff = pp-center.col(i);
-        double l = diff.norm();
-        if(l>0)
+        // blend the local interpolants with weights w_i(p) = phi(|p-c_i|/r_i)
+        // f = sum(w_i f_i) / sum(w_i)
+        // grad f = (sum(w_i grad f_i + f_i grad w_i) - f sum(grad w_i)) / sum(w_i)
+        double          w_sum  = 0;
+        Eigen::Vector3d dw_sum = Eigen::Vector3d::Zero();
+        octree.items_within(p, max_radius, tmp);
+        for(uint pid : tmp)
         {
-            val += alpha(i) * RBF::eval_f(l);
-            val += beta.col(i).dot(diff)*RBF::eval_df(l)/l;
+            double d = p.dist(patch_center[pid]);
+            double r = patch_radius[pid];
+            if(d>=r) continue;
+            double fi = 0;
+            Eigen::Vector3d gi = Eigen::Vector3d::Zero();
+            sum(pp, patch_offset[pid], patch_offset[pid+1], fi, (gp!=nullptr) ? &gi : nullptr);
+            double w = WendlandC2RBF::eval_f(d/r);
+            w_sum += w;
+            val   += w*fi;
+            if(gp!=nullptr && d>0)
+            {
+                vec3d u = (p-patch_center[pid])/d;
+                Eigen::Vector3d dw = Eigen::Vector3d(u.x(), u.y(), u.z()) * WendlandC2RBF::eval_df(d/r)/r;
+                dw_sum += dw;
+                g      += w*gi + fi*dw;
+            }
+            else if(gp!=nullptr) g += w*gi;
         }
+        if(w_sum>0)
+        {
+            val /= w_sum;
+            g    = (g - val*dw_sum)/w_sum;
+        }
+        else if(!patch_center.empty()) // outside of all patches: use the closest one
+        {
+            uint   pid;
+            vec3d  pos;
+            double dist;
+            octree.closest_point(p, pid, pos, dist);
+            sum(pp, patch_offset[pid], patch_offset[pid+1], val, gp);
+        }
+    }
+    else if(RBF::compact)
+    {
+        octree.items_within(p, support, tmp);
+        for(uint i : tmp) sum(pp, i, val, gp);
     }
+    else sum(pp, 0, uint(center.cols()), val, gp);
+
+    if(grad!=nullptr) *grad = vec3d(g[0], g[1], g[2]);
     return val;
 }
 
@@ -137,35 +542,46 @@ double Hermite_RBF<RBF>::eval(const vec3d & p) const
 
 template<class RBF>
 CINO_INLINE
-vec3d Hermite_RBF<RBF>::eval_grad(const vec3d &p) const
+void Hermite_RBF<RBF>::sum(const Eigen::Vector3d & p,
+                           const uint              beg,
+                           const uint              end,
+                                 double          & val,
+                                 Eigen::Vector3d * grad) const
 {
-    Eigen::Vector3d pp(p.x(), p.y(), p.z());
-    Eigen::Vector3d grad = Eigen::Vector3d::Zero();
+    for(uint i=beg; i<end; ++i) sum(p, i, val, grad);
+}
 
-    for(uint i=0; i<center.cols(); i++)
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class RBF>
+CINO_INLINE
+void Hermite_RBF<RBF>::sum(const Eigen::Vector3d & p,
+                           const uint              i,
+                                 double          & val,
+                                 Eigen::Vector3d * grad) const
+{
+    Eigen::Vector3d diff = p - center.col(i);
+    double l = diff.norm();
+    if(l==0)
     {
-        Eigen::Vector3d node = center.col(i);
-        Eigen::Vector3d beta = this->beta.col(i);
-        Eigen::Vector3d diff = pp - node;
+        val += alpha(i) * RBF::eval_f(0);
+        if(grad!=nullptr) *grad += beta.col(i) * RBF::eval_ddf(0)/(support*support);
+        return;
+    }
+    if(RBF::compact && l>=support) return;
 
-        float len=diff.norm();
-        if(len>0.00001f)
-        {
-            Eigen::Vector3d diffNormalized = diff;
-            diffNormalized.normalize();
+    double dphi  = RBF::eval_df (l/support)/support;
+    double ddphi = RBF::eval_ddf(l/support)/(support*support);
+    double bDotd = beta.col(i).dot(diff);
 
-            float dphi       = RBF::eval_df(len);
-            float ddphi      = RBF::eval_ddf(len);
-            float alpha_dphi = alpha(i) * dphi;
-            float bDotd_l    = beta.dot(diff)/len;
-            float squared_l  = diff.squaredNorm();
+    val += alpha(i) * RBF::eval_f(l/support);
+    val += bDotd*dphi/l;
 
-            grad += alpha_dphi * diffNormalized;
-            grad += bDotd_l * (ddphi*diffNormalized - diff*dphi/squared_l) + beta*dphi/len ;
-        }
+    if(grad!=nullptr)
+    {
+        *grad += alpha(i)*dphi/l * diff;
+        *grad += (ddphi - dphi/l)/(l*l) * bDotd * diff + beta.col(i)*dphi/l;
     }
-
-    return vec3d(grad[0], grad[1], grad[2]);
 }
 
 }
@@ -38,6 +38,7 @@
 
 #include <cinolib/geometry/vec_mat.h>
 #include <cinolib/scalar_field.h>
+#include <cinolib/octree.h>
 #include <Eigen/Dense>
 
 namespace cinolib
@@ -60,8 +61,60 @@ namespace cinolib
  *     A Closed-Form Formulation of HRBF-Based Surface Reconstruction
  *     S. Liu, C.C.L. Wang, G. Brunnett, J. Wang
  *     Computer-Aided Design (2016)
+ *
+ * Three solvers are available:
+ *
+ *     HRBF_DENSE              one global dense system, solved with LU (LLT for compact kernels).
+ *                             Cubic and memory quadratic in the number of points (a few thousands at most)
+ *
+ *     HRBF_SPARSE             one global sparse system, solved with sparse Cholesky or with (diagonally
+ *                             preconditioned) conjugate gradient. Requires a compactly supported kernel
+ *                             (e.g. WendlandC2RBF), whose support controls both the number of non zeros
+ *                             and the quality of the fit
+ *
+ *     HRBF_PARTITION_OF_UNITY the points are split into overlapping spherical patches (one for each
+ *                             non empty leaf of an octree), and a small dense system is solved for each
+ *                             patch, in parallel. Local interpolants are blended with compactly supported
+ *                             weights. Memory and time are linear in the number of points, making it the
+ *                             method of choice for large point clouds (e.g. millions of points)
+ *
+ * Note that interpolants built on compactly supported kernels vanish farther than one support
+ * radius from the samples, hence their sign is meaningful only in a narrow band around the data.
+ * Cubic kernels combined with the partition of unity do not suffer from this limitation.
+ *
+ * Evaluation only visits the centers (or patches) whose support contains the query point,
+ * and the batched versions of eval/eval_grad run in parallel. Reference for the partition
+ * of unity approach:
+ *
+ *     Multi-level Partition of Unity Implicits
+ *     Y. Ohtake, A. Belyaev, M. Alexa, G. Turk, H.P. Seidel
+ *     ACM Transactions on Graphics (2003)
 */
 
+enum
+{
+    HRBF_DENSE,
+    HRBF_SPARSE,
+    HRBF_PARTITION_OF_UNITY,
+};
+
+struct HermiteRBFOptions
+{
+    int    solver           = HRBF_DENSE;
+    double support          = 0;     // support radius of compact kernels (0: support_factor times the avg sample spacing)
+    double support_factor   = 4;     // used to estimate the support radius, if not prescribed
+    bool   sparse_direct    = true;  // sparse Cholesky (HRBF_SPARSE). Otherwise conjugate gradient, which uses
+                                     // less memory but converges slowly if samples are not evenly spaced
+    double cg_tolerance     = 1e-10; // relative residual at which conjugate gradient stops
+    uint   cg_max_iter      = 2000;  // max number of conjugate gradient iterations
+    uint   patch_size       = 24;    // max number of points in each octree leaf (HRBF_PARTITION_OF_UNITY)
+    uint   patch_min_points = 32;    // patches are enlarged until they contain at least this many points
+    uint   patch_max_points = 128;   // patches are shrunk until they contain at most this many points
+    double patch_overlap    = 1.5;   // patch radius, relative to the bounding sphere of the points in its octree leaf
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class RBF>
 class Hermite_RBF
 {
@@ -69,19 +122,47 @@ class Hermite_RBF
 
         Hermite_RBF(){}
         Hermite_RBF(const std::vector<vec3d> & points,
-                    const std::vector<vec3d> & normals);
+                    const std::vector<vec3d> & normals,
+                    const HermiteRBFOptions  & opt = HermiteRBFOptions());
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        ScalarField eval     (const std::vector<vec3d> & plist) const; // evaluate RBF at points plist
-        double      eval     (const vec3d & p) const;                  // evaluate RBF at point p
-        vec3d       eval_grad(const vec3d & p) const;                  // evaluate nabla RBF at point p
+        ScalarField        eval     (const std::vector<vec3d> & plist) const; // evaluate RBF at points plist (in parallel)
+        double             eval     (const vec3d & p) const;                  // evaluate RBF at point p
+        std::vector<vec3d> eval_grad(const std::vector<vec3d> & plist) const; // evaluate nabla RBF at points plist (in parallel)
+        vec3d              eval_grad(const vec3d & p) const;                  // evaluate nabla RBF at point p
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         Eigen::VectorXd  alpha;  // vector of scalar values alpha
         Eigen::Matrix3Xd beta;   // each column represents beta_i: VectorX bi = beta.col(i);
         Eigen::Matrix3Xd center; // each column represents p_i:    VectorX pi = centers.col(i);
+
+        int    solver  = HRBF_DENSE;
+        double support = 1.0; // kernels are evaluated at |p-p_i|/support (1 for globally supported kernels)
+
+        // partition of unity only: the coefficients of the i-th patch are
+        // stored in the range [patch_offset[i], patch_offset[i+1])
+        std::vector<uint>   patch_offset;
+        std::vector<vec3d>  patch_center;
+        std::vector<double> patch_radius;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+    protected:
+
+        void solve_global(const std::vector<vec3d> & points, const std::vector<vec3d> & normals, const HermiteRBFOptions & opt);
+        void solve_pu    (const std::vector<vec3d> & points, const std::vector<vec3d> & normals, const HermiteRBFOptions & opt);
+
+        // value (and gradient, if grad is not null) at p, using tmp as scratch buffer
+        double eval(const vec3d & p, vec3d * grad, std::vector<uint> & tmp) const;
+
+        // adds the contribution of the centers in [beg,end) to val (and grad, if not null)
+        void sum(const Eigen::Vector3d & p, const uint beg, const uint end, double & val, Eigen::Vector3d * grad) const;
+        void sum(const Eigen::Vector3d & p, const uint i,                   double & val, Eigen::Vector3d * grad) const;
+
+        Octree octree;          // centers (global solvers, compact kernels) or patch centers (partition of unity)
+        double max_radius = 0;  // largest patch radius
 };
 
 }
@@ -39,14 +39,51 @@
 namespace cinolib
 {
 
+/* Radial kernels phi(x), with x the distance from the center. Compactly supported
+ * kernels vanish for x>=1 (i.e. they have unit support, and should be evaluated at
+ * x/s to obtain a support of radius s). Globally supported ones set compact=false.
+ * Wendland kernels are positive definite in R^3, hence they produce (sparse)
+ * symmetric positive definite interpolation matrices. Reference:
+ *
+ *     Piecewise polynomial, positive definite and compactly supported radial
+ *     functions of minimal degree
+ *     H. Wendland
+ *     Advances in Computational Mathematics (1995)
+*/
+
 class CubicRBF
 {
     public:
+    static const bool compact = false;
     static inline double eval_f  (const double x) { return x*x*x; }
     static inline double eval_df (const double x) { return 3*x*x; } // first  derivative
     static inline double eval_ddf(const double x) { return 6*x;   } // second derivative
 };
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// phi(x) = (1-x)^4 (4x+1), C2
+class WendlandC2RBF
+{
+    public:
+    static const bool compact = true;
+    static inline double eval_f  (const double x) { if(x>=1) return 0; double t=1-x; return t*t*t*t*(4*x+1);  }
+    static inline double eval_df (const double x) { if(x>=1) return 0; double t=1-x; return -20*x*t*t*t;       }
+    static inline double eval_ddf(const double x) { if(x>=1) return 0; double t=1-x; return 20*t*t*(4*x-1);    }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// phi(x) = (1-x)^6 (35x^2+18x+3), C4
+class WendlandC4RBF
+{
+    public:
+    static const bool compact = true;
+    static inline double eval_f  (const double x) { if(x>=1) return 0; double t=1-x, t3=t*t*t; return t3*t3*(35*x*x+18*x+3);  }
+    static inline double eval_df (const double x) { if(x>=1) return 0; double t=1-x, t2=t*t;   return -56*x*(5*x+1)*t2*t2*t; }
+    static inline double eval_ddf(const double x) { if(x>=1) return 0; double t=1-x, t2=t*t;   return 56*(35*x*x-4*x-1)*t2*t2; }
+};
+
 }
 
 #endif // CINO_RBF_KERNELS_H
@@ -0,0 +1,826 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/bvh.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/parallel_for.h>
+#include <algorithm>
+#include <cstdint>
+#include <stack>
+
+namespace cinolib
+{
+
+// before C++17 static constexpr members are not implicitly inline, hence constants that
+// are ODR-used need a definition, which can be emitted only when building the static lib
+#if __cplusplus < 201703L && defined(CINO_STATIC_LIB)
+constexpr uint   BVH::n_bins;
+constexpr uint   BVH::packet_size;
+constexpr uint   BVH::max_leaf_size;
+constexpr double BVH::traversal_cost;
+#endif
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+BVH::BVH(const uint items_per_leaf)
+: items_per_leaf(std::max(1u,items_per_leaf))
+{}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::build()
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    if(items.empty()) return;
+    assert(nodes.empty());
+
+    // gather item AABBs in a contiguous buffer, which is partitioned in place while
+    // splitting nodes. This keeps memory accesses sequential at all levels of the tree
+    std::vector<PrimRef> refs(items.size());
+    PARALLEL_FOR(0, num_items(), 1000, [&](uint i)
+    {
+        const AABB & b = item(i).aabb;
+        refs[i].min    = b.min;
+        refs[i].max    = b.max;
+        refs[i].index  = i;
+    });
+    AABB root_bbox = PARALLEL_REDUCE(0, num_items(), 1000, AABB(),
+                                     [&](uint i) -> const AABB & { return item(i).aabb; },
+                                     [](AABB a, const AABB & b){ a.push(b); return a; });
+    AABB root_cbox = PARALLEL_REDUCE(0, num_items(), 1000, AABB(),
+                                     [&](uint i) { vec3d c = refs[i].centroid(); return AABB(c,c); },
+                                     [](AABB a, const AABB & b){ a.push(b); return a; });
+
+    nodes.push_back(BVHNode(root_bbox, 0, num_items()));
+    tree_depth = 1;
+
+    // split all the nodes in the current level in parallel. Each node owns a separate
+    // range of refs, which is partitioned in place. Centroid bounds (used for binning)
+    // are not stored in the nodes, and are passed from one level to the next
+    std::vector<uint> frontier;
+    std::vector<AABB> frontier_cbox;
+    if(num_items()>items_per_leaf)
+    {
+        frontier.push_back(0);
+        frontier_cbox.push_back(root_cbox);
+    }
+    while(!frontier.empty())
+    {
+        std::vector<Split> splits(frontier.size());
+        PARALLEL_FOR(0, uint(frontier.size()), 2, 1, [&](uint i)
+        {
+            const BVHNode & node = nodes[frontier[i]];
+            split_items(node.first, node.first+node.count, frontier_cbox[i], refs, splits[i]);
+        });
+
+        std::vector<uint> next_frontier;
+        std::vector<AABB> next_frontier_cbox;
+        for(uint i=0; i<frontier.size(); ++i)
+        {
+            if(splits[i].leaf) continue;
+            uint nid   = frontier[i];
+            uint first = nodes[nid].first;
+            uint child = uint(nodes.size());
+            nodes.push_back(BVHNode(splits[i].bbox[0], first,                    splits[i].count[0]));
+            nodes.push_back(BVHNode(splits[i].bbox[1], first+splits[i].count[0], splits[i].count[1]));
+            nodes[nid].first = child;
+            nodes[nid].count = 0;
+            for(uint j=0; j<2; ++j)
+            {
+                if(splits[i].count[j]>items_per_leaf)
+                {
+                    next_frontier.push_back(child+j);
+                    next_frontier_cbox.push_back(splits[i].cbox[j]);
+                }
+            }
+        }
+        frontier.swap(next_frontier);
+        frontier_cbox.swap(next_frontier_cbox);
+        ++tree_depth;
+    }
+
+    leaf_items.resize(items.size());
+    PARALLEL_FOR(0, num_items(), 1000, [&](uint i)
+    {
+        leaf_items[i] = refs[i].index;
+    });
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        double t = how_many_seconds(t0,t1);
+        std::cout << ":::::::::::::::::::::::::::::::::::::::::::::::::::" << std::endl;
+        std::cout << "BVH created (" << t << "s)                         " << std::endl;
+        std::cout << "#Items                   : " << items.size()         << std::endl;
+        std::cout << "#Nodes                   : " << nodes.size()         << std::endl;
+        std::cout << "Depth                    : " << tree_depth           << std::endl;
+        std::cout << "Max items per leaf       : " << items_per_leaf       << std::endl;
+        std::cout << ":::::::::::::::::::::::::::::::::::::::::::::::::::" << std::endl;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Binned SAH: item centroids are distributed in a fixed number of bins along
+// each axis, and the best split is searched among the planes between bins.
+// For big ranges (i.e. the top levels of the tree) binning is done in parallel
+CINO_INLINE
+void BVH::split_items(const uint                   beg,
+                      const uint                   end,
+                      const AABB                 & cbox,
+                            std::vector<PrimRef> & refs,
+                            Split                & split) const
+{
+    const uint n = end - beg;
+
+    // bins are plain boxes (no AABB) to keep the loops as tight as possible
+    struct Bin
+    {
+        vec3d min   = vec3d( inf_double,  inf_double,  inf_double);
+        vec3d max   = vec3d(-inf_double, -inf_double, -inf_double);
+        uint  count = 0;
+        void push(const vec3d & lo, const vec3d & hi)
+        {
+            for(uint j=0; j<3; ++j)
+            {
+                min[j] = std::min(min[j], lo[j]);
+                max[j] = std::max(max[j], hi[j]);
+            }
+        }
+        void push(const vec3d & p)
+        {
+            push(p,p);
+        }
+        void push(const Bin & b)
+        {
+            push(b.min, b.max);
+            count += b.count;
+        }
+        double area() const
+        {
+            vec3d d = max - min;
+            return d.x()*d.y() + d.y()*d.z() + d.z()*d.x();
+        }
+    };
+
+    vec3d k;
+    for(uint d=0; d<3; ++d) k[d] = (cbox.max[d]>cbox.min[d]) ? (n_bins*(1-1e-6))/(cbox.max[d]-cbox.min[d]) : 0.0;
+    auto bin = [&](const vec3d & c, const uint d) -> uint
+    {
+        return std::min(n_bins-1, uint(k[d]*(c[d]-cbox.min[d])));
+    };
+    auto fill_bins = [&](const uint b, const uint e, Bin *bins)
+    {
+        for(uint i=b; i<e; ++i)
+        {
+            const PrimRef & r = refs[i];
+            vec3d c = r.centroid();
+            for(uint d=0; d<3; ++d)
+            {
+                Bin & bin_d = bins[d*n_bins + bin(c,d)];
+                bin_d.push(r.min, r.max);
+                bin_d.count++;
+            }
+        }
+    };
+
+    // small ranges are binned serially, big ranges per chunk in parallel
+    Bin bins[3*n_bins];
+    const uint n_chunks = std::min(64u, (n+16383)/16384);
+    if(n_chunks<2) fill_bins(beg, end, bins); else
+    {
+        const uint size = (n+n_chunks-1)/n_chunks;
+        std::vector<Bin> chunk_bins(n_chunks*3*n_bins);
+        PARALLEL_FOR(0, n_chunks, 2, 1, [&](uint c)
+        {
+            fill_bins(beg+c*size, std::min(end, beg+(c+1)*size), &chunk_bins[c*3*n_bins]);
+        });
+        for(uint c=0; c<n_chunks; ++c)
+        for(uint i=0; i<3*n_bins; ++i)
+        {
+            if(chunk_bins[c*3*n_bins+i].count>0) bins[i].push(chunk_bins[c*3*n_bins+i]);
+        }
+    }
+
+    // sweep the bins to evaluate the SAH cost of each candidate plane
+    double best_cost = inf_double;
+    for(uint d=0; d<3; ++d)
+    {
+        if(k[d]==0.0) continue;
+        const Bin *b = &bins[d*n_bins];
+        double right_cost[n_bins];
+        Bin    acc;
+        for(uint i=n_bins-1; i>0; --i)
+        {
+            if(b[i].count>0) acc.push(b[i]);
+            right_cost[i] = (acc.count>0) ? acc.area()*acc.count : 0.0;
+        }
+        acc = Bin();
+        for(uint i=0; i<n_bins-1; ++i)
+        {
+            if(b[i].count>0) acc.push(b[i]);
+            if(acc.count==0 || acc.count==n) continue;
+            double cost = acc.area()*acc.count + right_cost[i+1];
+            if(cost<best_cost)
+            {
+                best_cost  = cost;
+                split.axis = int(d);
+                split.bin  = i;
+            }
+        }
+    }
+
+    // leaf termination: keep the node as a leaf if testing all its items costs less than
+    // visiting the children and testing theirs. SAH costs are relative to the node area
+    if(n<=max_leaf_size)
+    {
+        Bin node;
+        for(uint i=0; i<n_bins; ++i) if(bins[i].count>0) node.push(bins[i]);
+        double leaf_cost = node.area()*n;
+        if(split.axis<0 || traversal_cost*node.area() + best_cost >= leaf_cost)
+        {
+            split.leaf = true;
+            return;
+        }
+    }
+
+    Bin child[2];
+    if(split.axis>=0)
+    {
+        // partition the range, and compute the centroid bounds of
+        // the children while doing so (each item is classified once)
+        const uint d = uint(split.axis);
+        Bin  cb[2];
+        uint i = beg;
+        uint j = end;
+        while(true)
+        {
+            vec3d c;
+            while(i<j && bin(c = refs[i  ].centroid(),d)<=split.bin) { cb[0].push(c); ++i; }
+            while(i<j && bin(c = refs[j-1].centroid(),d)> split.bin) { cb[1].push(c); --j; }
+            if(i>=j) break;
+            std::swap(refs[i], refs[j-1]);
+        }
+        for(uint b=0; b<n_bins; ++b)
+        {
+            if(bins[d*n_bins+b].count>0) child[(b<=split.bin) ? 0 : 1].push(bins[d*n_bins+b]);
+        }
+        split.cbox[0] = AABB(cb[0].min, cb[0].max);
+        split.cbox[1] = AABB(cb[1].min, cb[1].max);
+    }
+    else // all centroids coincide: any partition is as good as the others
+    {
+        for(uint i=beg; i<end; ++i)
+        {
+            Bin & b = child[(i-beg<n/2) ? 0 : 1];
+            b.push(refs[i].min, refs[i].max);
+            b.count++;
+        }
+        split.cbox[0] = split.cbox[1] = cbox;
+    }
+    for(uint i=0; i<2; ++i)
+    {
+        split.bbox [i] = AABB(child[i].min, child[i].max);
+        split.count[i] = child[i].count;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+Span<uint> BVH::node_items(const uint nid) const
+{
+    const BVHNode & node = nodes.at(nid);
+    if(node.is_inner()) return Span<uint>();
+    return Span<uint>(leaf_items.data()+node.first, node.count);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+vec3d BVH::closest_point(const vec3d & p) const
+{
+    uint   id;
+    vec3d  pos;
+    double dist;
+    closest_point(p, id, pos, dist);
+    return pos;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Depth first branch and bound: the closest child is visited first, and
+// nodes farther than the closest item found so far are discarded
+CINO_INLINE
+void BVH::closest_point(const vec3d  & p,          // query point
+                              uint   & id,         // id of the item T closest to p
+                              vec3d  & pos,        // point in T closest to p
+                              double & dist) const // distance between pos and p
+{
+    assert(!nodes.empty());
+
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    int    best_index = -1;
+    double best_dist  = inf_double;
+    vec3d  best_pos;
+
+    std::stack<std::pair<double,uint>> lifo; // (distance,node)
+    lifo.push(std::make_pair(nodes.front().bbox.dist_sqrd(p),0));
+
+    while(!lifo.empty())
+    {
+        double d = lifo.top().first;
+        const BVHNode & node = nodes[lifo.top().second];
+        lifo.pop();
+        if(d>=best_dist) continue;
+
+        if(node.is_inner())
+        {
+            double d0 = nodes[node.child(0)].bbox.dist_sqrd(p);
+            double d1 = nodes[node.child(1)].bbox.dist_sqrd(p);
+            uint   c0 = node.child(0);
+            uint   c1 = node.child(1);
+            if(d1<d0) { std::swap(d0,d1); std::swap(c0,c1); }
+            if(d1<best_dist) lifo.push(std::make_pair(d1,c1));
+            if(d0<best_dist) lifo.push(std::make_pair(d0,c0));
+        }
+        else
+        {
+            for(uint i=node.first; i<node.first+node.count; ++i)
+            {
+                uint index = leaf_items[i];
+                if(item(index).aabb.dist_sqrd(p)>=best_dist) continue;
+                vec3d  pos = item_point_closest_to(index, p);
+                double d   = pos.dist_sqrd(p);
+                if(d<best_dist)
+                {
+                    best_index = int(index);
+                    best_dist  = d;
+                    best_pos   = pos;
+                }
+            }
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Closest point\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+
+    assert(best_index>=0);
+    id   = item(best_index).id;
+    pos  = best_pos;
+    dist = best_dist;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
+CINO_INLINE
+bool BVH::contains(const vec3d & p, const bool strict, uint & id) const
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.contains(p,strict))
+    {
+        lifo.push(0);
+    }
+
+    while(!lifo.empty())
+    {
+        const BVHNode & node = nodes[lifo.top()];
+        lifo.pop();
+        assert(node.bbox.contains(p,strict));
+
+        if(node.is_inner())
+        {
+            for(uint i=0; i<2; ++i)
+            {
+                if(nodes[node.child(i)].bbox.contains(p,strict)) lifo.push(node.child(i));
+            }
+        }
+        else
+        {
+            for(uint i=node.first; i<node.first+node.count; ++i)
+            {
+                if(item_contains(leaf_items[i],p,strict))
+                {
+                    id = item(leaf_items[i]).id;
+                    if(print_debug_info)
+                    {
+                        Time::time_point t1 = Time::now();
+                        std::cout << "Contains query (first item)\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+                    }
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
+CINO_INLINE
+bool BVH::contains(const vec3d & p, const bool strict, std::unordered_set<uint> & ids) const
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.contains(p,strict))
+    {
+        lifo.push(0);
+    }
+
+    while(!lifo.empty())
+    {
+        const BVHNode & node = nodes[lifo.top()];
+        lifo.pop();
+        assert(node.bbox.contains(p,strict));
+
+        if(node.is_inner())
+        {
+            for(uint i=0; i<2; ++i)
+            {
+                if(nodes[node.child(i)].bbox.contains(p,strict)) lifo.push(node.child(i));
+            }
+        }
+        else
+        {
+            for(uint i=node.first; i<node.first+node.count; ++i)
+            {
+                if(item_contains(leaf_items[i],p,strict))
+                {
+                    ids.insert(item(leaf_items[i]).id);
+                }
+            }
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Contains query (all items)\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+
+    return !ids.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Depth first, visiting first the child that the ray enters first. Nodes
+// entered after the closest hit found so far are discarded
+CINO_INLINE
+bool BVH::intersects_ray(const vec3d & p, const vec3d & dir, double & min_t, uint & id) const
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    vec3d  pos;
+    double t = 0.0;
+    if(nodes.empty() || !nodes.front().bbox.intersects_ray(p, dir, t, pos)) return false;
+
+    int    best_index = -1;
+    double best_t     = inf_double;
+
+    std::stack<std::pair<double,uint>> lifo; // (entry point,node)
+    lifo.push(std::make_pair(t,0));
+
+    while(!lifo.empty())
+    {
+        double t_in = lifo.top().first;
+        const BVHNode & node = nodes[lifo.top().second];
+        lifo.pop();
+        if(t_in>best_t) continue;
+
+        if(node.is_inner())
+        {
+            double t_0, t_1;
+            uint   c_0  = node.child(0);
+            uint   c_1  = node.child(1);
+            bool   hit0 = nodes[c_0].bbox.intersects_ray(p, dir, t_0, pos) && t_0<=best_t;
+            bool   hit1 = nodes[c_1].bbox.intersects_ray(p, dir, t_1, pos) && t_1<=best_t;
+            if(hit0 && hit1)
+            {
+                if(t_1<t_0) { std::swap(t_0,t_1); std::swap(c_0,c_1); }
+                lifo.push(std::make_pair(t_1,c_1));
+                lifo.push(std::make_pair(t_0,c_0));
+            }
+            else if(hit0) lifo.push(std::make_pair(t_0,c_0));
+            else if(hit1) lifo.push(std::make_pair(t_1,c_1));
+        }
+        else
+        {
+            for(uint i=node.first; i<node.first+node.count; ++i)
+            {
+                if(item_intersects_ray(leaf_items[i], p, dir, t, pos) && t<best_t)
+                {
+                    best_index = int(leaf_items[i]);
+                    best_t     = t;
+                }
+            }
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Intersects ray\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+
+    if(best_index<0) return false;
+    id    = item(best_index).id;
+    min_t = best_t;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BVH::intersects_ray(const vec3d & p, const vec3d & dir, std::set<std::pair<double,uint>> & all_hits) const
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    vec3d  pos;
+    double t=0.0;
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.intersects_ray(p, dir, t, pos))
+    {
+        lifo.push(0);
+    }
+
+    while(!lifo.empty())
+    {
+        const BVHNode & node = nodes[lifo.top()];
+        lifo.pop();
+
+        if(node.is_inner())
+        {
+            for(uint i=0; i<2; ++i)
+            {
+                if(nodes[node.child(i)].bbox.intersects_ray(p, dir, t, pos)) lifo.push(node.child(i));
+            }
+        }
+        else
+        {
+            for(uint i=node.first; i<node.first+node.count; ++i)
+            {
+                if(item_intersects_ray(leaf_items[i], p, dir, t, pos))
+                {
+                    all_hits.insert(std::make_pair(t,item(leaf_items[i]).id));
+                }
+            }
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Intersects ray\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+
+    if(all_hits.empty()) return false;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::intersects_rays(const std::vector<vec3d>  & p,
+                          const std::vector<vec3d>  & dir,
+                                std::vector<double> & min_t,
+                                std::vector<int>    & ids,
+                          const std::vector<int>    & ignore) const
+{
+    assert(p.size()==dir.size());
+    assert(ignore.empty() || ignore.size()==p.size());
+
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint n = uint(p.size());
+    min_t.assign(n, inf_double);
+    ids.assign(n, -1);
+    if(nodes.empty() || n==0) return;
+
+    // sort rays along a Morton curve, using the octant of their direction as most
+    // significant bits, so that each packet gathers rays with similar origins and directions
+    const AABB & box = nodes.front().bbox;
+    std::vector<std::pair<uint64_t,uint>> order(n);
+    PARALLEL_FOR(0, n, 1000, [&](uint i)
+    {
+        uint64_t key = 0;
+        for(uint d=0; d<3; ++d)
+        {
+            double   x = (box.max[d]>box.min[d]) ? (p[i][d]-box.min[d])/(box.max[d]-box.min[d]) : 0.0;
+            uint64_t q = uint64_t(std::min(1023.0, std::max(0.0, 1024*x)));
+            for(uint b=0; b<10; ++b) key |= ((q>>b)&1) << (3*b+d);
+            if(dir[i][d]<0) key |= uint64_t(1) << (30+d);
+        }
+        order[i] = std::make_pair(key,i);
+    });
+    std::sort(order.begin(), order.end());
+    std::vector<uint> rays(n);
+    for(uint i=0; i<n; ++i) rays[i] = order[i].second;
+
+    uint n_packets = (n+packet_size-1)/packet_size;
+    PARALLEL_FOR(0, n_packets, 16, [&](uint i)
+    {
+        uint beg = i*packet_size;
+        intersects_packet(p, dir, ignore, rays.data()+beg, std::min(uint(packet_size),n-beg), min_t, ids);
+    });
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Intersects " << n << " rays\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Rays are stored in SoA layout, and packets always have packet_size rays (short packets
+// are padded with copies of their last ray), so that the slab test of a whole packet
+// against a node is a fixed length loop which the compiler can vectorize
+CINO_INLINE
+void BVH::intersects_packet(const std::vector<vec3d>  & p,
+                            const std::vector<vec3d>  & dir,
+                            const std::vector<int>    & ignore,
+                            const uint                * rays,
+                            const uint                  n_rays,
+                                  std::vector<double> & min_t,
+                                  std::vector<int>    & ids) const
+{
+    assert(n_rays>0 && n_rays<=packet_size);
+
+    double o  [3][packet_size];
+    double ood[3][packet_size];
+    double best_t[packet_size];
+    int    best_index[packet_size];
+    for(uint j=0; j<packet_size; ++j)
+    {
+        uint r = rays[std::min(j,n_rays-1)];
+        for(uint d=0; d<3; ++d)
+        {
+            o  [d][j] = p[r][d];
+            ood[d][j] = (std::fabs(dir[r][d])<1e-15) ? inf_double : 1.0/dir[r][d];
+        }
+        best_t    [j] = (j<n_rays) ? inf_double : -1.0; // padding rays never hit anything
+        best_index[j] = -1;
+    }
+
+    // same as AABB::intersects_ray. Rays parallel to a slab get infinite (or NaN, if the
+    // origin is on a slab plane) entry/exit points, and NaNs leave the interval unchanged
+    bool hit[packet_size];
+    auto slab_test = [&](const AABB & b) -> bool
+    {
+        bool any = false;
+        for(uint j=0; j<packet_size; ++j)
+        {
+            double t_min = 0.0;
+            double t_max = best_t[j];
+            for(uint d=0; d<3; ++d)
+            {
+                double t_near = (b.min[d] - o[d][j]) * ood[d][j];
+                double t_far  = (b.max[d] - o[d][j]) * ood[d][j];
+                if(t_near > t_far) std::swap(t_near, t_far);
+                if(t_near > t_min) t_min = t_near;
+                if(t_far  < t_max) t_max = t_far;
+            }
+            hit[j] = (t_min<=t_max);
+            any   |= hit[j];
+        }
+        return any;
+    };
+
+    std::stack<uint> lifo;
+    lifo.push(0);
+    while(!lifo.empty())
+    {
+        const BVHNode & node = nodes[lifo.top()];
+        lifo.pop();
+        if(!slab_test(node.bbox)) continue;
+
+        if(node.is_inner())
+        {
+            // rays in a packet are coherent: visit first the child that
+            // comes first along the direction of the first active ray
+            uint j = 0;
+            while(!hit[j]) ++j;
+            vec3d delta = nodes[node.child(1)].bbox.center() - nodes[node.child(0)].bbox.center();
+            uint  d     = 0;
+            if(std::fabs(delta[1])>std::fabs(delta[d])) d = 1;
+            if(std::fabs(delta[2])>std::fabs(delta[d])) d = 2;
+            uint first = (delta[d]*ood[d][j]<0) ? 1 : 0;
+            lifo.push(node.child(1-first));
+            lifo.push(node.child(first));
+        }
+        else
+        {
+            for(uint i=node.first; i<node.first+node.count; ++i)
+            {
+                int id = int(item(leaf_items[i]).id);
+                for(uint j=0; j<n_rays; ++j)
+                {
+                    if(!hit[j]) continue;
+                    if(!ignore.empty() && ignore[rays[j]]==id) continue;
+                    vec3d  pos;
+                    double t = inf_double;
+                    if(item_intersects_ray(leaf_items[i], p[rays[j]], dir[rays[j]], t, pos) && t<best_t[j])
+                    {
+                        best_index[j] = int(leaf_items[i]);
+                        best_t    [j] = t;
+                    }
+                }
+            }
+        }
+    }
+
+    for(uint j=0; j<n_rays; ++j)
+    {
+        if(best_index[j]<0) continue;
+        min_t[rays[j]] = best_t[j];
+        ids  [rays[j]] = int(item(best_index[j]).id);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::items_intersecting_box(const AABB & b, std::vector<uint> & list) const
+{
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.intersects_box(b))
+    {
+        lifo.push(0);
+    }
+
+    while(!lifo.empty())
+    {
+        const BVHNode & node = nodes[lifo.top()];
+        lifo.pop();
+        assert(node.bbox.intersects_box(b));
+
+        if(node.is_inner())
+        {
+            for(uint i=0; i<2; ++i)
+            {
+                if(nodes[node.child(i)].bbox.intersects_box(b)) lifo.push(node.child(i));
+            }
+        }
+        else
+        {
+            for(uint i=node.first; i<node.first+node.count; ++i)
+            {
+                if(item(leaf_items[i]).aabb.intersects_box(b)) list.push_back(leaf_items[i]);
+            }
+        }
+    }
+}
+
+}
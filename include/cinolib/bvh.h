@@ -0,0 +1,194 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_BVH_H
+#define CINO_BVH_H
+
+#include <cinolib/spatial_data_structure.h>
+#include <cinolib/span.h>
+
+namespace cinolib
+{
+
+/* Nodes are stored in a linear array (BVH::nodes), with the root at position zero.
+ * Each node fits a cache line: inner nodes have two children, stored consecutively
+ * starting at position first, whereas leaves refer to the range [first,first+count)
+ * of the flat buffer BVH::leaf_items, which stores the indices of their items.
+*/
+
+class BVHNode
+{
+    public:
+        BVHNode() {}
+        BVHNode(const AABB & bbox, const uint first, const uint count) : bbox(bbox), first(first), count(count) {}
+        AABB bbox;
+        uint first = 0;
+        uint count = 0; // leaves always contain at least one item, hence zero means inner node
+        bool is_inner() const { return count==0; }
+        uint child(const uint i) const { return first+i; }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* Bounding Volume Hierarchy with Surface Area Heuristic (SAH) splits.
+ * Differently from the Octree, each item is referenced by exactly one leaf,
+ * and node bounding boxes tightly fit their content, which makes the BVH
+ * well suited for highly anisotropic data (e.g. CAD models), where the fixed
+ * spatial subdivision of an Octree produces unbalanced and crowded leaves.
+ *
+ * Usage is the same as Octree:
+ *
+ *  i)   Create an empty BVH
+ *  ii)  Use the push_segment/triangle/tetrahedron facilities to populate it
+ *  iii) Call build to make the tree
+ *
+ * The tree is built top down, one level at a time. All the nodes in a level
+ * are split in parallel, and the split planes of the most crowded nodes (i.e.
+ * the top levels of the tree) are found with a parallel binning of the items.
+ *
+ * Ref: On fast Construction of SAH-based Bounding Volume Hierarchies
+ *      I. Wald
+ *      IEEE Symposium on Interactive Ray Tracing, 2007
+*/
+
+class BVH : public SpatialDataStructure
+{
+    public:
+
+        explicit BVH(const uint items_per_leaf = 4);
+
+        virtual ~BVH() {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void build() override;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // indices of the items contained in a leaf node (empty for inner nodes)
+        Span<uint> node_items(const uint nid) const;
+
+        // QUERIES :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // returns pos, id and distance of the item that is closest to query point p
+        void  closest_point(const vec3d & p, uint & id, vec3d & pos, double & dist) const;
+        vec3d closest_point(const vec3d & p) const;
+
+        // returns respectively the first item and the full list of items containing query point p
+        // note: this query becomes exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
+        bool contains(const vec3d & p, const bool strict, uint & id) const;
+        bool contains(const vec3d & p, const bool strict, std::unordered_set<uint> & ids) const;
+
+        // returns respectively the first and the full list of intersections
+        // between items in the BVH and a ray R(t) := p + t * dir
+        bool intersects_ray(const vec3d & p, const vec3d & dir, double & min_t, uint & id) const; // first hit
+        bool intersects_ray(const vec3d & p, const vec3d & dir, std::set<std::pair<double,uint>> & all_hits) const;
+
+        // batched version of the first hit query. Rays are sorted into spatially coherent packets,
+        // and all the rays in a packet traverse the tree together. Packets are processed in parallel
+        void intersects_rays(const std::vector<vec3d>  & p,
+                             const std::vector<vec3d>  & dir,
+                                   std::vector<double> & min_t,
+                                   std::vector<int>    & ids,
+                             const std::vector<int>    & ignore = {}) const override;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // nodes live here (root first), and leaf nodes only store ranges of leaf_items
+        std::vector<BVHNode> nodes;
+        std::vector<uint>    leaf_items;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        protected:
+
+        uint items_per_leaf; // nodes with more items than this are split, if the SAH says it pays off
+        uint tree_depth = 0; // actual depth of the tree
+
+        // SUPPORT STRUCTURES ::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        struct PrimRef
+        {
+            vec3d min;   // AABB of the item
+            vec3d max;
+            uint  index; // index of vector items
+            vec3d centroid() const { return (min+max)*0.5; }
+        };
+
+        struct Split
+        {
+            int  axis = -1;    // -1 means split at the median item
+            uint bin  =  0;    // items falling in bins [0,bin] go to the left child
+            AABB bbox[2];      // AABBs of the children
+            AABB cbox[2];      // AABBs of the centroids of the items in the children
+            uint count[2];     // #items in the children
+            bool leaf = false; // splitting does not pay off (SAH): the node stays a leaf
+        };
+
+        static constexpr uint   n_bins         = 16;
+        static constexpr uint   packet_size    = 8;
+        static constexpr uint   max_leaf_size  = 32;  // nodes bigger than this are always split
+        static constexpr double traversal_cost = 1.0; // cost of visiting a node, relative to testing an item
+
+        // finds the best split for the items in refs[beg,end), and partitions them accordingly
+        void split_items(const uint                   beg,
+                         const uint                   end,
+                         const AABB                 & cbox, // AABB of the centroids
+                               std::vector<PrimRef> & refs,
+                               Split                & split) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // first hits of the rays in a packet (at most packet_size rays, listed in rays)
+        void intersects_packet(const std::vector<vec3d>  & p,
+                               const std::vector<vec3d>  & dir,
+                               const std::vector<int>    & ignore,
+                               const uint                * rays,
+                               const uint                  n_rays,
+                                     std::vector<double> & min_t,
+                                     std::vector<int>    & ids) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void items_intersecting_box(const AABB & b, std::vector<uint> & list) const override;
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "bvh.cpp"
+#endif
+
+#endif // CINO_BVH_H
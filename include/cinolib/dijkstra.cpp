@@ -36,30 +36,71 @@
 #include <cinolib/dijkstra.h>
 #include <cinolib/min_max_inf.h>
 #include <cinolib/stl_container_utilities.h>
+#include <algorithm>
 
 namespace cinolib
 {
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// LITTLE NOTE ON MY DIJKSTRA IMPLEMENTATIONS: why std::set and not
-// std::unordered_set or std::priority_queue?
+// LITTLE NOTE ON MY DIJKSTRA IMPLEMENTATIONS: why not std::set or
+// std::priority_queue?
 //
-// The reason why I am using std::set is that Dijkstra requires priority
-// update, which is supported by none of the STL containers. Options are:
+// Dijkstra requires priority update, which is supported by none of the STL
+// containers. The options are: (1) remove an element from a std::set and
+// re-add it with updated priority, or (2) leave "dead" copies of an element
+// in a std::priority_queue and discard them when popped. Both are slow and
+// memory hungry, hence all the implementations below use an IndexedHeap,
+// which updates priorities in place.
 //
-//  1) remove an element and re-add it with updated priority. In this
-//     case std::set has the best remove performances
-//
-//  2) leave "dead" copies of an element in the container, and just add a
-//     new copy each time its priority needs an update. Regardless the waste
-//     of memory, which is an issue by itself, in this case at each iteration
-//     you need a mechanism that allows you to discard the current element
-//     if it is not the one with the most recent priority...
-//
-// I therefore decided to go for (1).
-// See also:
-// https://stackoverflow.com/questions/649640/how-to-do-an-efficient-priority-update-in-stl-priority-queue
+// Point-to-point queries typically visit a tiny fraction of the mesh. To
+// avoid paying O(#verts) allocations and initializations at each call, they
+// operate on a per thread DijkstraScratch, which is reset in O(#visited).
+// Since the IndexedHeap pops elements with same priority in the same order
+// of a std::set<std::pair<double,uint>>, results (including tie breaking
+// among equally long paths) are the same as the original implementation.
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void DijkstraScratch::init(const uint n)
+{
+    for(uint id : touched)
+    {
+        dist[id] = inf_double;
+        prev[id] = -1;
+    }
+    touched.clear();
+    q.clear();
+
+    if(dist.size()<n)
+    {
+        dist.resize(n, inf_double);
+        prev.resize(n, -1);
+        q.reserve(n);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void DijkstraScratch::relax(const uint id, const double d, const int from)
+{
+    if(dist[id]==inf_double) touched.push_back(id);
+    dist[id] = d;
+    prev[id] = from;
+    q.push(id,d);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+DijkstraScratch & dijkstra_scratch(const uint i)
+{
+    assert(i<2);
+    thread_local DijkstraScratch s[2];
+    return s[i];
+}
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -72,13 +113,12 @@ void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
     dist = std::vector<double>(m.num_verts(), inf_double);
     dist.at(source) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    IndexedHeap q(m.num_verts());
+    q.push(source,0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint nbr : m.adj_v2v(vid))
         {
@@ -86,14 +126,8 @@ void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
                 dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
+                q.push(nbr,new_dist);
             }
         }
     }
@@ -110,13 +144,12 @@ void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
     dist = std::vector<double>(m.num_verts(), inf_double);
     for(uint vid : sources) dist.at(vid) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    for(uint vid : sources) q.insert(std::make_pair(0.0,vid));
+    IndexedHeap q(m.num_verts());
+    for(uint vid : sources) q.push(vid,0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint nbr : m.adj_v2v(vid))
         {
@@ -124,14 +157,8 @@ void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
                 dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
+                q.push(nbr,new_dist);
             }
         }
     }
@@ -148,13 +175,12 @@ void dijkstra_exhaustive_srf_only(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
     dist = std::vector<double>(m.num_verts(), inf_double);
     for(uint vid : sources) dist.at(vid) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    for(uint vid : sources) q.insert(std::make_pair(0.0,vid));
+    IndexedHeap q(m.num_verts());
+    for(uint vid : sources) q.push(vid,0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint eid : m.adj_v2e(vid))
         {
@@ -165,14 +191,8 @@ void dijkstra_exhaustive_srf_only(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
 
                 if(dist.at(nbr) > new_dist)
                 {
-                    if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                    {
-                        auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                        assert(it!=q.end());
-                        q.erase(it);
-                    }
                     dist.at(nbr) = new_dist;
-                    q.insert(std::make_pair(new_dist,nbr));
+                    q.push(nbr,new_dist);
                 }
             }
         }
@@ -192,13 +212,12 @@ void dijkstra_exhaustive_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
     dist = std::vector<double>(m.num_verts(), inf_double);
     for(uint vid : sources) dist.at(vid) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    for(uint vid : sources) q.insert(std::make_pair(0.0,vid));
+    IndexedHeap q(m.num_verts());
+    for(uint vid : sources) q.push(vid,0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint eid : m.adj_v2e(vid))
         {
@@ -209,14 +228,8 @@ void dijkstra_exhaustive_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
                 dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
+                q.push(nbr,new_dist);
             }
         }
     }
@@ -233,18 +246,17 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -260,15 +272,7 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -288,18 +292,17 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -315,15 +318,7 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -344,18 +339,17 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -373,15 +367,7 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -404,18 +390,17 @@ double dijkstra_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -436,15 +421,7 @@ double dijkstra_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -470,18 +447,17 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
     path.clear();
     assert(mask.size() == m.num_verts());
 
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -499,15 +475,7 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -533,18 +501,17 @@ double dijkstra_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
     path.clear();
     assert(mask.size() == m.num_edges());
 
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -565,15 +532,7 @@ double dijkstra_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -600,18 +559,17 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
     path.clear();
     assert(mask.size() == m.num_verts());
 
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(CONTAINS(dest,vid))
         {
@@ -629,15 +587,7 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -649,6 +599,147 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+double dijkstra_bidirectional(const AbstractMesh<M,V,E,P> & m,
+                              const uint                    source,
+                              const uint                    dest,
+                                    std::vector<uint>     & path)
+{
+    path.clear();
+
+    if(source==dest)
+    {
+        path.push_back(source);
+        return 0.0;
+    }
+
+    DijkstraScratch & fwd = dijkstra_scratch(0);
+    DijkstraScratch & bwd = dijkstra_scratch(1);
+    fwd.init(m.num_verts());
+    bwd.init(m.num_verts());
+    fwd.relax(source, 0.0, -1);
+    bwd.relax(dest,   0.0, -1);
+
+    double best = inf_double; // length of the shortest path found so far
+    int    meet = -1;         // vertex in which the two searches meet along such path
+
+    while(!fwd.q.empty() && !bwd.q.empty())
+    {
+        // no path passing through unvisited vertices can be shorter than best
+        if(fwd.q.top_key() + bwd.q.top_key() >= best) break;
+
+        // grow the search having the smaller front
+        bool              is_fwd = fwd.q.size() <= bwd.q.size();
+        DijkstraScratch & s      = is_fwd ? fwd : bwd;
+        DijkstraScratch & other  = is_fwd ? bwd : fwd;
+
+        uint vid = s.q.pop();
+        for(uint nbr : m.adj_v2v(vid))
+        {
+            double new_dist = s.dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+
+            if(s.dist.at(nbr) > new_dist)
+            {
+                s.relax(nbr, new_dist, vid);
+            }
+
+            if(other.dist.at(nbr) < inf_double && s.dist.at(nbr) + other.dist.at(nbr) < best)
+            {
+                best = s.dist.at(nbr) + other.dist.at(nbr);
+                meet = nbr;
+            }
+        }
+    }
+
+    // dest is not reachable from source
+    if(meet<0) return 0.0;
+
+    int tmp = meet;
+    do { path.push_back(tmp); tmp = fwd.prev.at(tmp); } while (tmp != -1);
+    std::reverse(path.begin(), path.end());
+    tmp = bwd.prev.at(meet);
+    while(tmp != -1) { path.push_back(tmp); tmp = bwd.prev.at(tmp); }
+    return best;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_multi_target(const AbstractMesh<M,V,E,P> & m,
+                           const uint                    source,
+                           const std::vector<uint>     & targets,
+                                 std::vector<double>   & dist)
+{
+    std::vector<uint> to_reach = targets;
+    std::sort(to_reach.begin(), to_reach.end());
+    to_reach.erase(std::unique(to_reach.begin(), to_reach.end()), to_reach.end());
+    uint n_left = to_reach.size();
+
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    s.relax(source, 0.0, -1);
+
+    while(!s.q.empty() && n_left>0)
+    {
+        uint vid = s.q.pop();
+
+        if(std::binary_search(to_reach.begin(), to_reach.end(), vid)) --n_left;
+
+        for(uint nbr : m.adj_v2v(vid))
+        {
+            double new_dist = s.dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+
+            if(s.dist.at(nbr) > new_dist)
+            {
+                s.relax(nbr, new_dist, vid);
+            }
+        }
+    }
+
+    // if the queue emptied before, unreached targets still have inf_double distance
+    dist.resize(targets.size());
+    for(uint i=0; i<targets.size(); ++i) dist.at(i) = s.dist.at(targets.at(i));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_within_radius(const AbstractMesh<M,V,E,P> & m,
+                            const std::vector<uint>     & sources,
+                            const double                  radius,
+                                  std::vector<uint>     & verts,
+                                  std::vector<double>   & dist)
+{
+    verts.clear();
+    dist.clear();
+
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_verts());
+    for(uint vid : sources) s.relax(vid, 0.0, -1);
+
+    while(!s.q.empty())
+    {
+        uint vid = s.q.pop();
+        verts.push_back(vid);
+        dist.push_back(s.dist.at(vid));
+
+        for(uint nbr : m.adj_v2v(vid))
+        {
+            double new_dist = s.dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+
+            if(new_dist <= radius && s.dist.at(nbr) > new_dist)
+            {
+                s.relax(nbr, new_dist, vid);
+            }
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 void dijkstra_exhaustive_on_dual(const AbstractMesh<M,V,E,P> & m,
@@ -658,13 +749,12 @@ void dijkstra_exhaustive_on_dual(const AbstractMesh<M,V,E,P> & m,
     dist = std::vector<double>(m.num_polys(), inf_double);
     dist.at(source) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    IndexedHeap q(m.num_polys());
+    q.push(source,0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint nbr : m.adj_p2p(vid))
         {
@@ -672,14 +762,8 @@ void dijkstra_exhaustive_on_dual(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
                 dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
+                q.push(nbr,new_dist);
             }
         }
     }
@@ -695,18 +779,17 @@ void dijkstra_exhaustive_on_dual(const AbstractMesh<M,V,E,P> & m,
 {
     dist = std::vector<double>(m.num_polys(), inf_double);
 
-    std::set<std::pair<double,uint>> q;
+    IndexedHeap q(m.num_polys());
 
     for(uint s : sources)
     {
         dist.at(s) = 0.0;
-        q.insert(std::make_pair(0.0,s));
+        q.push(s,0.0);
     }
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint nbr : m.adj_p2p(vid))
         {
@@ -714,14 +797,8 @@ void dijkstra_exhaustive_on_dual(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
                 dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
+                q.push(nbr,new_dist);
             }
         }
     }
@@ -738,18 +815,17 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_polys(), -1);
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_polys());
+    s.relax(source, 0.0, -1);
 
-    std::vector<double> dist(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -765,15 +841,7 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -793,18 +861,17 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_polys(), -1);
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_polys());
+    s.relax(source, 0.0, -1);
 
-    std::vector<double> dist(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -822,15 +889,7 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -852,18 +911,17 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_polys(), -1);
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_polys());
+    s.relax(source, 0.0, -1);
 
-    std::vector<double> dist(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(CONTAINS(dest,vid))
         {
@@ -881,15 +939,7 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
@@ -910,18 +960,17 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 {
     path.clear();
 
-    std::vector<int> prev(m.num_polys(), -1);
+    DijkstraScratch & s = dijkstra_scratch();
+    s.init(m.num_polys());
+    s.relax(source, 0.0, -1);
 
-    std::vector<double> dist(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    const std::vector<double> & dist = s.dist;
+    const std::vector<int>    & prev = s.prev;
+          IndexedHeap         & q    = s.q;
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(CONTAINS(dest,vid))
         {
@@ -937,15 +986,7 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
 
             if(dist.at(nbr) > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                s.relax(nbr, new_dist, vid);
             }
         }
     }
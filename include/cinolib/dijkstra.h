@@ -40,12 +40,32 @@
 #include <sys/types.h>
 #include <vector>
 #include <cinolib/cino_inline.h>
+#include <cinolib/indexed_heap.h>
 #include <cinolib/meshes/abstract_mesh.h>
 #include <cinolib/meshes/abstract_polyhedralmesh.h>
 
 namespace cinolib
 {
 
+// Working memory for (point-to-point) Dijkstra queries. Entries of dist/prev
+// that are not touched by the current query are always inf_double/-1, and
+// init() only resets what was touched by the previous query. This way many
+// queries on a big mesh cost proportionally to the area they visit
+struct DijkstraScratch
+{
+    void init (const uint n);                                   // starts a new query on a graph with n nodes
+    void relax(const uint id, const double d, const int from);  // sets dist/prev of id, and pushes it in the queue
+
+    std::vector<double> dist;
+    std::vector<int>    prev;
+    std::vector<uint>   touched;
+    IndexedHeap         q;
+};
+
+// per thread scratch (i in {0,1}: bidirectional searches use two of them)
+CINO_INLINE
+DijkstraScratch & dijkstra_scratch(const uint i = 0);
+
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 //:::::::::::::::: DIJKSTRAs ON PRIMAL GRAPH (VERTICES) ::::::::::::::::::
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -163,6 +183,43 @@ double dijkstra_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
                               const std::vector<bool>     & mask,    // if mask[e] = true, path cannot pass through edge e
                                     std::vector<uint>     & path);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Same as dijkstra(m,source,dest,path), but the search grows from both
+// source and dest, visiting roughly half of the vertices. The distance is
+// the same up to round off, the path may differ among equally long ones.
+// If dest is not reachable from source the path is empty and 0 is returned
+template<class M, class V, class E, class P>
+CINO_INLINE
+double dijkstra_bidirectional(const AbstractMesh<M,V,E,P> & m,
+                              const uint                    source,
+                              const uint                    dest,
+                                    std::vector<uint>     & path);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Distances from source to each of the targets (inf_double if unreachable).
+// The search stops as soon as all the targets have been reached
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_multi_target(const AbstractMesh<M,V,E,P> & m,
+                           const uint                    source,
+                           const std::vector<uint>     & targets,
+                                 std::vector<double>   & dist);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Vertices having distance from the sources not bigger than radius, sorted by
+// increasing distance. The cost depends on the number of vertices within the
+// radius, not on the size of the mesh
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_within_radius(const AbstractMesh<M,V,E,P> & m,
+                            const std::vector<uint>     & sources,
+                            const double                  radius,
+                                  std::vector<uint>     & verts,
+                                  std::vector<double>   & dist);
+
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 //::::::::::::: DIJKSTRAs ON DUAL GRAPH (POLYGONS/POLYHEDRA) :::::::::::::
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
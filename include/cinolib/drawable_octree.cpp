@@ -61,8 +61,8 @@ void DrawableOctree::draw(const float ) const
 CINO_INLINE
 vec3d DrawableOctree::scene_center() const
 {
-    if(this->root==nullptr) return vec3d(0,0,0);
-    return this->root->bbox.center();
+    if(this->nodes.empty()) return vec3d(0,0,0);
+    return this->nodes.front().bbox.center();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -70,8 +70,8 @@ vec3d DrawableOctree::scene_center() const
 CINO_INLINE
 float DrawableOctree::scene_radius() const
 {
-    if(this->root==nullptr) return 0.f;
-    return float(this->root->bbox.diag());
+    if(this->nodes.empty()) return 0.f;
+    return float(this->nodes.front().bbox.diag());
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -80,20 +80,21 @@ CINO_INLINE
 void DrawableOctree::updateGL()
 {
     render_list.clear();
-    if(this->root==nullptr) return;
-    updateGL(this->root);
+    if(this->nodes.empty()) return;
+    updateGL(0);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void DrawableOctree::updateGL(const OctreeNode *node)
+void DrawableOctree::updateGL(const uint nid)
 {
-    render_list.push_back(DrawableAABB(node->bbox.min, node->bbox.max));
-    if(node->is_inner())
+    const OctreeNode & node = this->nodes.at(nid);
+    render_list.push_back(DrawableAABB(node.bbox.min, node.bbox.max));
+    if(node.is_inner())
     {
-        assert(node->item_indices.empty());
-        for(int i=0; i<8; ++i) updateGL(node->children[i]);
+        assert(node.num_items()==0);
+        for(uint i=0; i<8; ++i) updateGL(node.child(i));
     }
 }
 
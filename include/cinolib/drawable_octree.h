@@ -65,7 +65,7 @@ class DrawableOctree : public Octree, public DrawableObject
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         void updateGL();
-        void updateGL(const OctreeNode * node);
+        void updateGL(const uint nid);
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
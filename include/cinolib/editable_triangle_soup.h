@@ -0,0 +1,180 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_EDITABLE_TRIANGLE_SOUP_H
+#define CINO_EDITABLE_TRIANGLE_SOUP_H
+
+#include <cinolib/geometry/vec_mat.h>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Triangle soup with vertex to triangle adjacency, used as working space by the
+ * algorithms that edit triangle meshes with local operators (e.g. the isotropic
+ * remesher and the quadric decimator). It only holds the topology, and shares
+ * the queries and the validity checks for edge collapses, so that all these
+ * algorithms apply the same criteria. Vertex positions are stored by the derived
+ * class (CRTP), which must expose them with: vec3d vert(const uint vid) const
+*/
+
+template<class Derived>
+class EditableTriangleSoup
+{
+    public:
+
+        std::vector<uint>              tris;  // three vids per triangle
+        std::vector<std::vector<uint>> v2t;
+        std::vector<char>              v_bnd;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint tri_vert(const uint tid, const uint i) const
+        {
+            return tris[3*tid+i];
+        }
+
+        bool tri_has(const uint tid, const uint vid) const
+        {
+            return tris[3*tid]==vid || tris[3*tid+1]==vid || tris[3*tid+2]==vid;
+        }
+
+        uint tri_opposite(const uint tid, const uint a, const uint b) const
+        {
+            for(uint i=0; i<3; ++i)
+            {
+                uint vid = tris[3*tid+i];
+                if(vid!=a && vid!=b) return vid;
+            }
+            assert(false);
+            return 0;
+        }
+
+        void tri_replace(const uint tid, const uint from, const uint to)
+        {
+            for(uint i=0; i<3; ++i) if(tris[3*tid+i]==from) tris[3*tid+i] = to;
+        }
+
+        vec3d tri_normal(const uint tid) const // not normalized (twice the area)
+        {
+            vec3d A = derived().vert(tris[3*tid  ]);
+            vec3d B = derived().vert(tris[3*tid+1]);
+            vec3d C = derived().vert(tris[3*tid+2]);
+            return (B-A).cross(C-A);
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // triangles incident to edge (a,b). Returns their number, and stores (at most) the first two in t
+        uint edge_tris(const uint a, const uint b, uint t[2]) const
+        {
+            uint n = 0;
+            for(uint tid : v2t[a])
+            {
+                if(!tri_has(tid,b)) continue;
+                if(n<2) t[n] = tid;
+                ++n;
+            }
+            return n;
+        }
+
+        bool edge_exists(const uint a, const uint b) const
+        {
+            for(uint tid : v2t[a]) if(tri_has(tid,b)) return true;
+            return false;
+        }
+
+        uint valence(const uint vid) const
+        {
+            return uint(v2t[vid].size()) + (v_bnd[vid] ? 1 : 0);
+        }
+
+        void remove_tri_from_vert(const uint vid, const uint tid)
+        {
+            std::vector<uint> & vt = v2t[vid];
+            vt.erase(std::find(vt.begin(), vt.end(), tid));
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // checks whether vertex a can be merged into b, moving b to p. Same criteria of
+        // Trimesh::edge_is_collapsible (link condition, no flips, no degenerate triangles)
+        bool collapse_is_valid(const uint a, const uint b, const vec3d & p) const
+        {
+            uint t[2];
+            uint n = edge_tris(a,b,t);
+            if(n<1 || n>2) return false;
+            if(n==1 && v2t[a].size()==1) return false; // ear
+
+            // link condition: the only verts adjacent to both a and b are those opposite to the edge
+            uint c[2] = { tri_opposite(t[0],a,b), (n==2) ? tri_opposite(t[1],a,b) : tri_opposite(t[0],a,b) };
+            if(n==2 && c[0]==c[1]) return false;
+            for(uint tid : v2t[a])
+            for(uint i=0; i<3; ++i)
+            {
+                uint vid = tri_vert(tid,i);
+                if(vid==a || vid==b || vid==c[0] || vid==c[1]) continue;
+                if(edge_exists(b,vid)) return false;
+            }
+
+            // do not create verts with valence lower than 3
+            for(uint i=0; i<n; ++i) if(valence(c[i])<=3) return false;
+            if(valence(a)+valence(b)<7) return false;
+
+            // do not create degenerate triangles or fold overs
+            for(uint vid : {a,b})
+            for(uint tid : v2t[vid])
+            {
+                if(tri_has(tid,a) && tri_has(tid,b)) continue;
+                vec3d P[3];
+                for(uint i=0; i<3; ++i) P[i] = (tri_vert(tid,i)==vid) ? p : derived().vert(tri_vert(tid,i));
+                vec3d n_old = tri_normal(tid);
+                vec3d n_new = (P[1]-P[0]).cross(P[2]-P[0]);
+                if(n_new.dot(n_old) <= 0) return false;
+                if(n_new.norm() <= 1e-10*n_old.norm()) return false;
+            }
+            return true;
+        }
+
+    protected:
+
+        const Derived & derived() const { return static_cast<const Derived &>(*this); }
+};
+
+}
+
+#endif // CINO_EDITABLE_TRIANGLE_SOUP_H
@@ -0,0 +1,555 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/exact_geodesics.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace cinolib
+{
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+ExactGeodesics<M,V,E,P>::ExactGeodesics(const Trimesh<M,V,E,P> & m) : m(m), max_dist(inf_double)
+{
+    edge_len.resize(m.num_edges());
+    for(uint eid=0; eid<m.num_edges(); ++eid) edge_len.at(eid) = m.edge_length(eid);
+
+    tri_verts.resize(3*m.num_polys());
+    tri_edges.resize(3*m.num_polys());
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    for(uint i=0; i<3; ++i)
+    {
+        uint vid = m.poly_vert_id(pid,i);
+        tri_verts.at(3*pid+i) = vid;
+        tri_edges.at(3*pid+i) = m.edge_opposite_to(pid,vid);
+    }
+
+    // shortest paths may bend only at vertices with more than 2PI
+    // incident angle (saddles) and at boundary/non manifold vertices
+    pseudo_src.resize(m.num_verts());
+    for(uint vid=0; vid<m.num_verts(); ++vid)
+    {
+        if(m.vert_is_boundary(vid) || !m.vert_is_manifold(vid))
+        {
+            pseudo_src.at(vid) = true;
+            continue;
+        }
+        double angle = 0.0;
+        for(uint pid : m.adj_v2p(vid)) angle += m.poly_angle_at_vert(pid,vid);
+        pseudo_src.at(vid) = (angle > 2.0*M_PI + 1e-8);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::compute(const std::vector<uint> & sources, const double max_dist)
+{
+    run(sources, max_dist, -1);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+double ExactGeodesics<M,V,E,P>::compute_path(const uint source, const uint dest, std::vector<vec3d> & path)
+{
+    run(std::vector<uint>(1,source), inf_double, int(dest));
+    path_to(dest, path);
+    return dist.at(dest);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::path_to(const uint vid, std::vector<vec3d> & path) const
+{
+    path.clear();
+    if(dist.at(vid)==inf_double) return;
+
+    auto add_point = [&](const vec3d & p)
+    {
+        if(path.empty() || path.back().dist(p)>0) path.push_back(p);
+    };
+
+    uint v = vid;
+    add_point(m.vert(v));
+    for(;;)
+    {
+        if(src_vert.at(v)>=0)
+        {
+            v = src_vert.at(v);
+            add_point(m.vert(v));
+            continue;
+        }
+
+        int wid = src_window.at(v);
+        if(wid<0) break; // v is a source
+
+        // v is the tip of a triangle reached by the window (other than the one it comes from)
+        const Window & w0 = windows.at(wid);
+        int pid = -1;
+        for(uint nbr : m.adj_e2p(w0.eid))
+        {
+            if(nbr!=w0.from_pid && m.poly_contains_vert(nbr,v)) pid = nbr;
+        }
+        assert(pid>=0);
+        double p[2];
+        unfold(w0.eid, pid, p[0], p[1]);
+
+        // walk back along the straight line towards the pseudo source, crossing the edges of the window chain
+        for(;;)
+        {
+            const Window & w = windows.at(wid);
+            double L = edge_len.at(w.eid);
+            double x = (p[1]>0) ? p[0] + (w.sx-p[0]) * p[1]/(p[1]-w.sy) : p[0];
+            x = std::max(0.0, std::min(L, x));
+            vec3d a = m.vert(m.edge_vert_id(w.eid,0));
+            vec3d b = m.vert(m.edge_vert_id(w.eid,1));
+            add_point(a + (b-a)*(x/L));
+
+            if(w.parent<0)
+            {
+                v = w.src_vid;
+                add_point(m.vert(v));
+                break;
+            }
+
+            // express the crossing point in the frame of the parent window, which
+            // propagated into from_pid and generated w on one of its edges
+            const Window & pw = windows.at(w.parent);
+            double u0[2], u1[2];
+            for(uint i=0; i<2; ++i)
+            {
+                uint   ev = m.edge_vert_id(w.eid,i);
+                double *u = (i==0) ? u0 : u1;
+                if(ev==m.edge_vert_id(pw.eid,0)) { u[0] = 0.0;                   u[1] = 0.0; } else
+                if(ev==m.edge_vert_id(pw.eid,1)) { u[0] = edge_len.at(pw.eid); u[1] = 0.0; } else
+                unfold(pw.eid, w.from_pid, u[0], u[1]);
+            }
+            p[0] = u0[0] + (u1[0]-u0[0])*(x/L);
+            p[1] = u0[1] + (u1[1]-u0[1])*(x/L);
+            wid  = w.parent;
+        }
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::run(const std::vector<uint> & sources, const double max_dist, const int target)
+{
+    this->max_dist = max_dist;
+    dist.assign(m.num_verts(), inf_double);
+    dist_propagated.assign(m.num_verts(), inf_double);
+    src_window.assign(m.num_verts(), -1);
+    src_vert.assign(m.num_verts(), -1);
+    windows.clear();
+    q.clear();
+    edge_windows.resize(m.num_edges());
+    for(auto & list : edge_windows) list.clear();
+
+    std::greater<std::pair<double,int>> cmp;
+    for(uint vid : sources)
+    {
+        dist.at(vid) = 0.0;
+        q.push_back(std::make_pair(0.0, -int(vid)-1));
+        std::push_heap(q.begin(), q.end(), cmp);
+    }
+
+    while(!q.empty())
+    {
+        std::pair<double,int> top = q.front();
+        std::pop_heap(q.begin(), q.end(), cmp);
+        q.pop_back();
+
+        // all that remains in the queue is farther than the cutoff (or than the target)
+        if(top.first>max_dist) break;
+        if(target>=0 && top.first>=dist.at(target)) break;
+
+        if(top.second<0)
+        {
+            uint vid = uint(-top.second-1);
+            if(top.first>dist.at(vid) || dist_propagated.at(vid)==dist.at(vid)) continue; // outdated
+            dist_propagated.at(vid) = dist.at(vid);
+            propagate_vert(vid);
+        }
+        else propagate_window(uint(top.second));
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::propagate_vert(const uint vid)
+{
+    // first reach the neighbors, so that their distances can be used to trim the windows
+    for(uint eid : m.adj_v2e(vid))
+    {
+        relax(m.vert_opposite_to(eid,vid), dist.at(vid)+edge_len.at(eid), -1, int(vid));
+    }
+
+    for(uint pid : m.adj_v2p(vid))
+    {
+        Window w;
+        w.eid      = opposite_edge(pid,vid);
+        w.from_pid = pid;
+        w.b0       = 0.0;
+        w.b1       = edge_len.at(w.eid);
+        w.sigma    = dist.at(vid);
+        w.parent   = -1;
+        w.src_vid  = vid;
+        unfold(w.eid, pid, w.sx, w.sy);
+        w.sy = -w.sy;
+        add_window(w);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::propagate_window(const uint wid)
+{
+    Window w = windows.at(wid);  // copy: children will be appended to windows
+    if(!trim(w,int(wid))) return; // shorter paths may have been found since w was queued
+
+    double L  = edge_len.at(w.eid);
+    uint   a  = m.edge_vert_id(w.eid,0);
+    uint   b  = m.edge_vert_id(w.eid,1);
+    double pa[2] = { 0.0, 0.0 };
+    double pb[2] = { L,   0.0 };
+
+    for(uint pid : m.adj_e2p(w.eid))
+    {
+        if(pid==w.from_pid) continue;
+
+        uint c = 0;
+        for(uint i=0; i<3; ++i) if(tri_edges.at(3*pid+i)==w.eid) c = tri_verts.at(3*pid+i);
+        double pc[2];
+        unfold(w.eid, pid, pc[0], pc[1]);
+        if(pc[1]<=0) continue; // degenerate triangle
+
+        // abscissa at which the line from the pseudo source to c crosses the edge
+        double xc = w.sx + (pc[0]-w.sx) * (-w.sy)/(pc[1]-w.sy);
+        double tol = 1e-9*L;
+        if(xc>=w.b0-tol && xc<=w.b1+tol)
+        {
+            relax(c, w.sigma + std::sqrt((pc[0]-w.sx)*(pc[0]-w.sx) + (pc[1]-w.sy)*(pc[1]-w.sy)), int(wid), -1);
+        }
+
+        // rays on the left of c hit edge (a,c), rays on its right hit edge (c,b)
+        if(w.b0<xc) add_child(wid, pid, opposite_edge(pid,b), a, c, b, pa, pc, pb, w.b0, std::min(w.b1,xc));
+        if(w.b1>xc) add_child(wid, pid, opposite_edge(pid,a), c, b, a, pc, pb, pa, std::max(w.b0,xc), w.b1);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::add_child(const uint   wid,
+                                        const uint   pid,
+                                        const uint   eid,
+                                        const uint   v_beg,
+                                        const uint   v_end,
+                                        const uint   v_opp,
+                                        const double beg[2],
+                                        const double end[2],
+                                        const double opp[2],
+                                        const double x0,
+                                        const double x1)
+{
+    const Window & pw = windows.at(wid);
+    double sx = pw.sx;
+    double sy = pw.sy;
+
+    // the ray from the pseudo source through (x,0) hits segment beg-end at beg + mu * (end-beg)
+    double d2[2] = { end[0]-beg[0], end[1]-beg[1] };
+    auto mu = [&](const double x)
+    {
+        double d1[2] = { x-sx, -sy };
+        double t = (d1[0]*(sy-beg[1]) - d1[1]*(sx-beg[0])) / (d1[0]*d2[1] - d1[1]*d2[0]);
+        return std::min(1.0, std::max(0.0, t));
+    };
+    double mu0 = mu(x0);
+    double mu1 = mu(x1);
+
+    // express the pseudo source in the frame of the new edge, with pid in the y<0 half plane
+    const double *o = beg;
+    const double *t = end;
+    if(m.edge_vert_id(eid,0)!=v_beg)
+    {
+        assert(m.edge_vert_id(eid,0)==v_end);
+        (void)v_end; // only used by the assertion
+        std::swap(o,t);
+        mu0 = 1.0-mu0;
+        mu1 = 1.0-mu1;
+    }
+    double len = std::sqrt((t[0]-o[0])*(t[0]-o[0]) + (t[1]-o[1])*(t[1]-o[1]));
+    double ux  = (t[0]-o[0])/len;
+    double uy  = (t[1]-o[1])/len;
+
+    Window w;
+    w.eid      = eid;
+    w.from_pid = pid;
+    w.sigma    = pw.sigma;
+    w.parent   = int(wid);
+    w.src_vid  = pw.src_vid;
+    w.sx       = (sx-o[0])*ux + (sy-o[1])*uy;
+    w.sy       = ux*(sy-o[1]) - uy*(sx-o[0]);
+    if(ux*(opp[1]-o[1]) - uy*(opp[0]-o[0]) > 0) w.sy = -w.sy;
+    w.sy       = std::min(w.sy, 0.0);
+    w.b0       = std::min(mu0,mu1) * edge_len.at(eid);
+    w.b1       = std::max(mu0,mu1) * edge_len.at(eid);
+
+    // discard the window if both its endpoints are reached with shorter paths passing through
+    // the opposite vertex. If d(opp) >= sigma the set of points for which this happens is convex
+    // (it is bounded by a branch of hyperbola having the pseudo source and opp as foci), hence
+    // the whole window is dominated too
+    double d_opp = dist.at(v_opp);
+    if(d_opp<inf_double && d_opp>=w.sigma)
+    {
+        double ox  = (opp[0]-o[0])*ux + (opp[1]-o[1])*uy;
+        double oy  = ux*(opp[1]-o[1]) - uy*(opp[0]-o[0]);
+        double tol = 1e-10*edge_len.at(eid);
+        auto dominated = [&](const double x)
+        {
+            return w.sigma + std::sqrt((x-w.sx)*(x-w.sx) + w.sy*w.sy) > d_opp + std::sqrt((x-ox)*(x-ox) + oy*oy) + tol;
+        };
+        if(dominated(w.b0) && dominated(w.b1)) return;
+    }
+    add_window(w);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::add_window(Window & w)
+{
+    // a pseudo source lying on the edge line generates no (non degenerate) window
+    if(!(w.sy<0) || !trim(w,-1)) return;
+
+    double dx = std::max(0.0, std::max(w.b0-w.sx, w.sx-w.b1));
+    double d  = w.sigma + std::sqrt(dx*dx + w.sy*w.sy);
+    if(d>max_dist) return;
+
+    windows.push_back(w);
+    edge_windows.at(w.eid).push_back(uint(windows.size()-1));
+    q.push_back(std::make_pair(d, int(windows.size()-1)));
+    std::push_heap(q.begin(), q.end(), std::greater<std::pair<double,int>>());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Trims the portions of the window that are reached with a shorter path passing
+// through one of the edge endpoints, returning false if nothing is left. Points
+// beyond a trimmed portion would be reached with a shorter path too, hence the
+// trimmed parts can be discarded for good. Since the distance through the first
+// (second) endpoint grows (decreases) faster than the distance through the window,
+// dominated points always form a prefix (suffix) of the interval
+//
+template<class M, class V, class E, class P>
+CINO_INLINE
+bool ExactGeodesics<M,V,E,P>::trim(Window & w, const int wid) const
+{
+    double L   = edge_len.at(w.eid);
+    double tol = 1e-10*L;
+    if(!(w.b1-w.b0>tol)) return false;
+
+    auto f = [&](const double x) { return w.sigma + std::sqrt((x-w.sx)*(x-w.sx) + w.sy*w.sy); };
+
+    double d0 = dist.at(m.edge_vert_id(w.eid,0));
+    if(d0<inf_double)
+    {
+        if(f(w.b1) > d0 + w.b1 + tol) return false;
+        if(f(w.b0) > d0 + w.b0 + tol)
+        {
+            // solve f(x) = d0 + x
+            double K   = d0 - w.sigma;
+            double den = 2.0*(w.sx + K);
+            if(den!=0) w.b0 = std::max(w.b0, std::min(w.b1, (w.sx*w.sx + w.sy*w.sy - K*K)/den));
+        }
+    }
+
+    double d1 = dist.at(m.edge_vert_id(w.eid,1));
+    if(d1<inf_double)
+    {
+        if(f(w.b0) > d1 + L - w.b0 + tol) return false;
+        if(f(w.b1) > d1 + L - w.b1 + tol)
+        {
+            // solve f(x) = d1 + L - x
+            double K   = d1 + L - w.sigma;
+            double den = 2.0*(K - w.sx);
+            if(den!=0) w.b1 = std::min(w.b1, std::max(w.b0, (K*K - w.sx*w.sx - w.sy*w.sy)/den));
+        }
+    }
+
+    // same as above, but considering the paths defined by the other windows on the same edge.
+    // Within their overlap, the two distance functions are equal at most at two points (the
+    // intersections between the edge line and the hyperbola having the two pseudo sources as
+    // foci), which split the overlap in up to three intervals, each dominated by one window
+    for(uint id : edge_windows.at(w.eid))
+    {
+        if(int(id)==wid) continue;
+        const Window & o = windows.at(id);
+        double lo = std::max(w.b0, o.b0);
+        double hi = std::min(w.b1, o.b1);
+        if(!(hi-lo>tol)) continue;
+
+        auto g = [&](const double x) { return o.sigma + std::sqrt((x-o.sx)*(x-o.sx) + o.sy*o.sy); };
+
+        // solve f(x) = g(x) squaring twice (in coordinates local to the overlap, for accuracy).
+        // Squaring makes the root (and its spurious twin) nearly double when the sigmas are close,
+        // hence a negative discriminant is treated as zero. Spurious roots are harmless: they just
+        // split the overlap in more intervals
+        double wx    = w.sx - lo;
+        double ox    = o.sx - lo;
+        double delta = o.sigma - w.sigma;
+        double A     = 2.0*(ox - wx);
+        double B     = wx*wx + w.sy*w.sy - ox*ox - o.sy*o.sy - delta*delta;
+        double qa    = A*A - 4.0*delta*delta;
+        double qb    = 2.0*A*B + 8.0*delta*delta*ox;
+        double qc    = B*B - 4.0*delta*delta*(ox*ox + o.sy*o.sy);
+        double xs[4] = { lo, hi, hi, hi };
+        uint   n     = 1;
+        if(std::fabs(qa) > 1e-12*(std::fabs(qb)+std::fabs(qc)))
+        {
+            double disc = std::max(0.0, qb*qb - 4.0*qa*qc);
+            double r0   = lo + (-qb - std::sqrt(disc))/(2.0*qa);
+            double r1   = lo + (-qb + std::sqrt(disc))/(2.0*qa);
+            if(r0>r1) std::swap(r0,r1);
+            if(r0>lo && r0<hi) xs[n++] = r0;
+            if(r1>lo && r1<hi && r1>xs[n-1]) xs[n++] = r1;
+        }
+        else if(qb!=0)
+        {
+            double r = lo - qc/qb;
+            if(r>lo && r<hi) xs[n++] = r;
+        }
+        xs[n++] = hi;
+
+        // remove the dominated prefix and suffix of w (a dominated interval in the middle is kept).
+        // Windows coming from the same side with the same distance function (e.g. unfoldings that
+        // differ only for a flat vertex) are redundant: ties are broken in favour of the older one
+        bool older = (o.from_pid==w.from_pid) && (wid<0 || int(id)<wid);
+        bool dominated[3];
+        for(uint i=0; i<n-1; ++i)
+        {
+            double x = 0.5*(xs[i]+xs[i+1]);
+            dominated[i] = older ? f(x) > g(x) - tol : f(x) > g(x) + tol;
+        }
+        uint beg = 0;
+        uint end = n-1;
+        if(lo<=w.b0) while(beg<end && dominated[beg])   ++beg;
+        if(hi>=w.b1) while(end>beg && dominated[end-1]) --end;
+        if(beg==end && lo<=w.b0 && hi>=w.b1) return false;
+        if(beg>0)   w.b0 = std::max(w.b0, xs[beg]-tol);
+        if(end<n-1) w.b1 = std::min(w.b1, xs[end]+tol);
+
+        if(!(w.b1-w.b0>tol)) return false;
+    }
+
+    return w.b1-w.b0>tol;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::relax(const uint vid, const double d, const int wid, const int from_vid)
+{
+    if(d<dist.at(vid) && d<=max_dist)
+    {
+        dist.at(vid)       = d;
+        src_window.at(vid) = wid;
+        src_vert.at(vid)   = from_vid;
+        if(pseudo_src.at(vid))
+        {
+            q.push_back(std::make_pair(d, -int(vid)-1));
+            std::push_heap(q.begin(), q.end(), std::greater<std::pair<double,int>>());
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// position of the vertex of triangle pid opposite to edge eid, in the frame of
+// eid. Returns the solution with y >= 0
+//
+template<class M, class V, class E, class P>
+CINO_INLINE
+void ExactGeodesics<M,V,E,P>::unfold(const uint eid, const uint pid, double & x, double & y) const
+{
+    double L  = edge_len.at(eid);
+    double la = edge_len.at(opposite_edge(pid, m.edge_vert_id(eid,1))); // distance from edge_vert_id(eid,0)
+    double lb = edge_len.at(opposite_edge(pid, m.edge_vert_id(eid,0))); // distance from edge_vert_id(eid,1)
+    x = (la*la - lb*lb + L*L)/(2.0*L);
+    y = std::sqrt(std::max(0.0, la*la - x*x));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+uint ExactGeodesics<M,V,E,P>::opposite_edge(const uint pid, const uint vid) const
+{
+    for(uint i=0; i<3; ++i) if(tri_verts.at(3*pid+i)==vid) return tri_edges.at(3*pid+i);
+    assert(false);
+    return 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+ScalarField compute_geodesics_exact(const Trimesh<M,V,E,P> & m,
+                                    const std::vector<uint>  & sources,
+                                    const double               max_dist)
+{
+    ExactGeodesics<M,V,E,P> eg(m);
+    eg.compute(sources, max_dist);
+    return eg.field();
+}
+
+}
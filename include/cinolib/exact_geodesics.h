@@ -0,0 +1,166 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_EXACT_GEODESICS_H
+#define CINO_EXACT_GEODESICS_H
+
+#include <vector>
+#include <sys/types.h>
+#include <cinolib/cino_inline.h>
+#include <cinolib/meshes/trimesh.h>
+#include <cinolib/scalar_field.h>
+#include <cinolib/min_max_inf.h>
+
+namespace cinolib
+{
+
+/* Exact polyhedral geodesic distances on triangle meshes, computed by window
+ * propagation. A window is an interval of an edge whose points are all reached
+ * by straight lines (in the unfolding of the triangles crossed so far) from
+ * the same pseudo source, i.e. either a source or a saddle/boundary vertex at
+ * which shortest paths can bend. The method was introduced in
+ *
+ *     The Discrete Geodesic Problem
+ *     Joseph S.B. Mitchell, David M. Mount and Christos H. Papadimitriou
+ *     SIAM Journal on Computing, 1987
+ *
+ * Windows are propagated across triangles in order of distance. As in MMP, a
+ * window is trimmed where other windows on the same edge provide shorter
+ * paths, and it is also trimmed (or discarded) where the vertices of the
+ * triangle it crosses do, which is the filtering rule of
+ *
+ *     Improving Chen and Han's Algorithm on the Discrete Geodesic Problem
+ *     Shi-Qing Xin and Guo-Jin Wang
+ *     ACM Transactions on Graphics, 2009
+ *
+ * Differently from the heat method (cinolib/geodesics.h) and from Dijkstra
+ * (cinolib/dijkstra.h) distances are exact (up to round off) on the
+ * polyhedral surface. Per mesh data is precomputed at construction,
+ * and buffers are reused across queries. Queries can be limited to vertices
+ * within a maximum distance, and shortest paths are extracted by backtracking
+ * the windows as polylines running across the triangles.
+*/
+
+template<class M = Mesh_std_attributes, // default template arguments
+         class V = Vert_std_attributes,
+         class E = Edge_std_attributes,
+         class P = Polygon_std_attributes>
+class ExactGeodesics
+{
+    public:
+
+        explicit ExactGeodesics(const Trimesh<M,V,E,P> & m);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // distance from the closest source. Vertices farther than max_dist are not reached (inf_double distance)
+        void compute(const std::vector<uint> & sources, const double max_dist = inf_double);
+
+        // shortest path from source to dest (a polyline going from source to dest). The search stops
+        // as soon as dest is reached. Returns the path length (inf_double and empty path if unreachable)
+        double compute_path(const uint source, const uint dest, std::vector<vec3d> & path);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // results of the last query
+        const std::vector<double> & distances()  const { return dist; }
+              ScalarField           field()      const { return ScalarField(dist); }
+              uint                  num_windows() const { return uint(windows.size()); }
+
+        // shortest path from the closest source to vid (as computed in the last query)
+        void path_to(const uint vid, std::vector<vec3d> & path) const;
+
+    protected:
+
+        struct Window
+        {
+            uint   eid;      // edge hosting the window. The interval [b0,b1] is measured from edge_vert_id(eid,0)
+            uint   from_pid; // triangle the window comes from
+            double b0, b1;   // interval
+            double sx, sy;   // pseudo source unfolded in the edge frame (edge along +x, from_pid in the y<0 half plane)
+            double sigma;    // distance between the pseudo source and the closest source
+            int    parent;   // window that generated this one (-1 if generated by the pseudo source itself)
+            uint   src_vid;  // pseudo source
+        };
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void run(const std::vector<uint> & sources, const double max_dist, const int target);
+
+        void propagate_vert  (const uint vid);
+        void propagate_window(const uint wid);
+        void add_child       (const uint wid, const uint pid, const uint eid, const uint v_beg, const uint v_end, const uint v_opp,
+                              const double beg[2], const double end[2], const double opp[2], const double x0, const double x1);
+        void add_window      (Window & w);
+        bool trim            (Window & w, const int wid) const;
+        void relax           (const uint vid, const double d, const int wid, const int from_vid);
+
+        void unfold(const uint eid, const uint pid, double & x, double & y) const;
+        uint opposite_edge(const uint pid, const uint vid) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        const Trimesh<M,V,E,P> & m;
+
+        std::vector<double>   edge_len;
+        std::vector<uint>     tri_verts;  // 3 verts per triangle
+        std::vector<uint>     tri_edges;  // 3 edges per triangle (the i-th is opposite to the i-th vert)
+        std::vector<bool>     pseudo_src; // true for saddle, boundary and non manifold verts
+
+        double                max_dist;
+        std::vector<double>   dist;
+        std::vector<double>   dist_propagated; // distance at which a vert was used as pseudo source
+        std::vector<int>      src_window;      // window that defined the distance of a vert (if any)
+        std::vector<int>      src_vert;        // otherwise, the pseudo source connected to it by an edge
+        std::vector<Window>   windows;
+        std::vector<std::vector<uint>> edge_windows; // windows generated on each edge
+        std::vector<std::pair<double,int>> q;  // binary heap (distance, window id if >=0, -vid-1 otherwise)
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+ScalarField compute_geodesics_exact(const Trimesh<M,V,E,P> & m,
+                                    const std::vector<uint>  & sources,
+                                    const double               max_dist = inf_double);
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "exact_geodesics.cpp"
+#endif
+
+#endif // CINO_EXACT_GEODESICS_H
@@ -0,0 +1,257 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/fast_marching.h>
+#include <cinolib/indexed_heap.h>
+#include <cmath>
+
+namespace cinolib
+{
+
+namespace detail
+{
+
+// shared by triangle and tetrahedral meshes: the only difference is the number of
+// vertices per element, hence the dimension of the simplices used for the updates
+template<class Mesh>
+CINO_INLINE
+ScalarField fast_marching_simplicial(const Mesh                & m,
+                                     const std::vector<uint>   & sources,
+                                     const std::vector<double> & speed,
+                                     const double                max_dist)
+{
+    assert(speed.empty() || speed.size()==m.num_verts());
+
+    std::vector<double> slowness;
+    if(!speed.empty())
+    {
+        slowness.resize(m.num_verts());
+        for(uint vid=0; vid<m.num_verts(); ++vid)
+        {
+            assert(speed.at(vid)>0);
+            slowness.at(vid) = 1.0/speed.at(vid);
+        }
+    }
+    auto f = [&](const uint vid) { return slowness.empty() ? 1.0 : slowness[vid]; };
+
+    std::vector<double> u(m.num_verts(), inf_double);
+    std::vector<bool>   done(m.num_verts(), false);
+    IndexedHeap q(m.num_verts());
+
+    for(uint vid : sources)
+    {
+        u.at(vid) = 0;
+        q.push(vid, 0);
+    }
+
+    while(!q.empty())
+    {
+        if(q.top_key()>max_dist) break;
+        uint vid = q.pop();
+        done[vid] = true;
+
+        auto relax = [&](const uint x, const double ux)
+        {
+            if(ux<u[x])
+            {
+                u[x] = ux;
+                q.push(x, ux);
+            }
+        };
+
+        // edge updates (i.e. Dijkstra)
+        for(uint x : m.adj_v2v(vid))
+        {
+            if(done[x]) continue;
+            relax(x, u[vid] + 0.5*(f(x)+f(vid))*m.vert(x).dist(m.vert(vid)));
+        }
+
+        // triangle and tet updates
+        for(uint pid : m.adj_v2p(vid))
+        {
+            uint nv = m.verts_per_poly(pid);
+            uint pv[4];
+            for(uint i=0; i<nv; ++i) pv[i] = m.poly_vert_id(pid,i);
+
+            for(uint i=0; i<nv; ++i)
+            {
+                uint x = pv[i];
+                if(done[x]) continue;
+
+                // simplices made of vid plus a non empty subset of the other accepted
+                // verts. Those without vid were tested when they were accepted
+                uint others[2], n_others = 0;
+                for(uint j=0; j<nv; ++j)
+                {
+                    if(pv[j]!=x && pv[j]!=vid && done[pv[j]]) others[n_others++] = pv[j];
+                }
+
+                for(uint mask=1; mask<(1u<<n_others); ++mask)
+                {
+                    const vec3d * y[3] = { &m.vert(vid) };
+                    double        t[3] = { u[vid] };
+                    double        s    = f(x) + f(vid);
+                    uint          k    = 0;
+                    for(uint j=0; j<n_others; ++j)
+                    {
+                        if(!(mask & (1u<<j))) continue;
+                        ++k;
+                        y[k] = &m.vert(others[j]);
+                        t[k] = u[others[j]];
+                        s   += f(others[j]);
+                    }
+                    relax(x, fast_marching_update(m.vert(x), y, t, k, s/(k+2)));
+                }
+            }
+        }
+    }
+
+    // verts left in the narrow band are beyond max_dist
+    for(uint vid=0; vid<m.num_verts(); ++vid) if(!done[vid]) u[vid] = inf_double;
+
+    return ScalarField(u);
+}
+
+} // end namespace detail
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+ScalarField fast_marching(const Trimesh<M,V,E,P>    & m,
+                          const std::vector<uint>   & sources,
+                          const std::vector<double> & speed,
+                          const double                max_dist)
+{
+    return detail::fast_marching_simplicial(m, sources, speed, max_dist);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+ScalarField fast_marching(const Tetmesh<M,V,E,F,P>  & m,
+                          const std::vector<uint>   & sources,
+                          const std::vector<double> & speed,
+                          const double                max_dist)
+{
+    return detail::fast_marching_simplicial(m, sources, speed, max_dist);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* Let p = y0 + P*l be a point of the simplex (P has columns y_i-y0, l are the
+ * barycentric coordinates of y1..yk) and r = p-x. Minimizing
+ *
+ *                  u0 + t^T*l + f*|r|,  with t_i = u_i-u0
+ *
+ * gives P^T*r/|r| = -t/f, i.e. the component of r in the span of P is fixed
+ * by t, whereas its orthogonal component does not depend on l. With G=P^T*P
+ * this yields |r|^2 = |r_perp|^2 / (1 - t^T*G^-1*t/f^2), from which l follows.
+*/
+CINO_INLINE
+double fast_marching_update(const vec3d  & x,
+                            const vec3d  * y[],
+                            const double   u[],
+                            const uint     k,
+                            const double   f)
+{
+    assert(k<=2);
+    vec3d q = *y[0] - x;
+    if(k==0) return u[0] + f*q.norm();
+
+    vec3d  P[2];
+    double t[2], b[2];
+    for(uint i=0; i<k; ++i)
+    {
+        P[i] = *y[i+1] - *y[0];
+        t[i] = u[i+1] - u[0];
+        b[i] = P[i].dot(q);
+    }
+
+    // inverse of G (1x1 or 2x2)
+    double Gi[2][2] = {{0,0},{0,0}};
+    if(k==1)
+    {
+        double g = P[0].dot(P[0]);
+        if(g<=0) return inf_double;
+        Gi[0][0] = 1.0/g;
+    }
+    else
+    {
+        double g00 = P[0].dot(P[0]);
+        double g01 = P[0].dot(P[1]);
+        double g11 = P[1].dot(P[1]);
+        double det = g00*g11 - g01*g01;
+        if(det<=1e-12*g00*g11) return inf_double; // degenerate face
+        Gi[0][0] =  g11/det;
+        Gi[0][1] = -g01/det;
+        Gi[1][0] = -g01/det;
+        Gi[1][1] =  g00/det;
+    }
+
+    double Git[2] = {0,0}, Gib[2] = {0,0};
+    for(uint i=0; i<k; ++i)
+    for(uint j=0; j<k; ++j)
+    {
+        Git[i] += Gi[i][j]*t[j];
+        Gib[i] += Gi[i][j]*b[j];
+    }
+    double tGt = 0, bGb = 0;
+    for(uint i=0; i<k; ++i)
+    {
+        tGt += t[i]*Git[i];
+        bGb += b[i]*Gib[i];
+    }
+
+    double ff = f*f;
+    if(tGt>=ff) return inf_double; // the front moves faster than the speed along the simplex
+
+    double r_perp = std::max(0.0, q.dot(q) - bGb);
+    double r      = std::sqrt(r_perp/(1.0 - tGt/ff));
+
+    double ux = u[0] + f*r, sum = 0;
+    for(uint i=0; i<k; ++i)
+    {
+        double l = -Git[i]*r/f - Gib[i];
+        if(l<0) return inf_double;
+        sum += l;
+        ux  += t[i]*l;
+    }
+    if(sum>1) return inf_double;
+    return ux;
+}
+
+}
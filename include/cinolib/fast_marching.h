@@ -0,0 +1,113 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_FAST_MARCHING_H
+#define CINO_FAST_MARCHING_H
+
+#include <vector>
+#include <sys/types.h>
+#include <cinolib/cino_inline.h>
+#include <cinolib/meshes/trimesh.h>
+#include <cinolib/meshes/tetmesh.h>
+#include <cinolib/scalar_field.h>
+#include <cinolib/min_max_inf.h>
+
+namespace cinolib
+{
+
+/* Fast Marching solver for the eikonal equation
+ *
+ *                  |grad(u)| = 1 / speed,   u = 0 at the sources
+ *
+ * on triangle and tetrahedral meshes, as in
+ *
+ *     Computing Geodesic Paths on Manifolds
+ *     R. Kimmel and J.A. Sethian
+ *     Proceedings of the National Academy of Sciences, 1998
+ *
+ * Vertices are accepted in increasing order of arrival time, and only the
+ * narrow band (the vertices adjacent to the accepted region) is kept in a
+ * priority queue. A vertex is updated from each simplex (tetrahedron, triangle
+ * or edge) incident to it whose other vertices have already been accepted,
+ * taking the point p of the simplex that minimizes u(p) + |x-p| / speed, where
+ * u is linearly interpolated in the simplex. This is the exact solution of the
+ * discrete problem in each simplex, and falls back to the faces/edges of the
+ * simplex when the optimal ray does not cross its interior (e.g. obtuse
+ * elements). Differently from Dijkstra (cinolib/dijkstra.h) paths are not
+ * constrained to the edges, and differently from the heat method
+ * (cinolib/geodesics.h) no linear system is solved: memory is linear in the
+ * number of vertices, on top of the mesh itself.
+ *
+ * Speed is a per vertex (strictly positive) function. If empty, speed is one
+ * everywhere, and the output field is the geodesic distance from the sources.
+ * Within each simplex the slowness (1/speed) is averaged between its vertices.
+ * Vertices farther than max_dist (in arrival time), or that cannot be reached
+ * from the sources, get infinite value.
+*/
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+ScalarField fast_marching(const Trimesh<M,V,E,P>    & m,
+                          const std::vector<uint>   & sources,
+                          const std::vector<double> & speed    = std::vector<double>(),
+                          const double                max_dist = inf_double);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+ScalarField fast_marching(const Tetmesh<M,V,E,F,P>  & m,
+                          const std::vector<uint>   & sources,
+                          const std::vector<double> & speed    = std::vector<double>(),
+                          const double                max_dist = inf_double);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// arrival time at a vertex x from a simplex spanned by k+1 (k<=2) vertices y with known
+// arrival times u, assuming constant slowness f. Returns inf_double if the optimal ray
+// does not cross the interior of the simplex (the update must then come from its faces)
+CINO_INLINE
+double fast_marching_update(const vec3d  & x,
+                            const vec3d  * y[],
+                            const double   u[],
+                            const uint     k,
+                            const double   f);
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "fast_marching.cpp"
+#endif
+
+#endif // CINO_FAST_MARCHING_H
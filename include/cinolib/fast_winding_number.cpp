@@ -0,0 +1,175 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2022: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/fast_winding_number.h>
+#include <cinolib/solid_angle.h>
+#include <cinolib/parallel_for.h>
+#include <cinolib/pi.h>
+
+namespace cinolib
+{
+
+CINO_INLINE
+FastWindingNumber::FastWindingNumber(const std::vector<vec3d> & verts,
+                                     const std::vector<uint>  & tris,
+                                     const double               beta)
+    : beta(beta)
+{
+    init(verts, tris);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+FastWindingNumber::FastWindingNumber(const AbstractPolygonMesh<M,V,E,P> & m,
+                                     const double                         beta)
+    : beta(beta)
+{
+    std::vector<uint> tris;
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        const std::vector<uint> & tess = m.poly_tessellation(pid);
+        tris.insert(tris.end(), tess.begin(), tess.end());
+    }
+    init(m.vector_verts(), tris);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void FastWindingNumber::init(const std::vector<vec3d> & verts, const std::vector<uint> & tris)
+{
+    tri_verts.resize(tris.size());
+    for(uint i=0; i<tris.size(); ++i) tri_verts[i] = verts.at(tris[i]);
+    bvh.build_from_vectors(verts, tris);
+
+    // children always follow their parent in the node list, hence
+    // a backward visit computes the expansions bottom up
+    uint nn = uint(bvh.nodes.size());
+    node_c.assign(nn, vec3d(0,0,0));
+    node_n.assign(nn, vec3d(0,0,0));
+    node_r.assign(nn, 0);
+    std::vector<double> node_a(nn, 0); // per node: total area of its triangles
+    for(int nid=int(nn)-1; nid>=0; --nid)
+    {
+        const BVHNode & node = bvh.nodes[nid];
+        double area = 0;
+        vec3d  c(0,0,0);
+        vec3d  n(0,0,0);
+        if(node.is_inner())
+        {
+            for(uint i=0; i<2; ++i)
+            {
+                uint cid = node.child(i);
+                c    += node_c[cid] * node_a[cid];
+                n    += node_n[cid];
+                area += node_a[cid];
+            }
+        }
+        else
+        {
+            for(uint tid : bvh.node_items(uint(nid)))
+            {
+                const vec3d * t  = &tri_verts[3*tid];
+                vec3d         an = (t[1]-t[0]).cross(t[2]-t[0]) * 0.5;
+                double        a  = an.norm();
+                c    += (t[0]+t[1]+t[2]) * (a/3.0);
+                n    += an;
+                area += a;
+            }
+        }
+        // the centroid is only used to place the expansion, hence for (near) degenerate
+        // nodes any point in the node is fine
+        node_c[nid] = (area>0) ? c/area : (node.bbox.min+node.bbox.max)*0.5;
+        node_n[nid] = n;
+        node_a[nid] = area;
+
+        // the ball centered at node_c that contains the node's bounding box
+        vec3d d = (node_c[nid]-node.bbox.min).max(node.bbox.max-node_c[nid]);
+        node_r[nid] = d.norm();
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double FastWindingNumber::eval(const uint nid, const vec3d & p) const
+{
+    const BVHNode & node = bvh.nodes[nid];
+
+    vec3d  d  = node_c[nid] - p;
+    double d2 = d.norm_sqrd();
+    if(d2 > beta*beta*node_r[nid]*node_r[nid])
+    {
+        // dipole term of the expansion
+        return node_n[nid].dot(d) / (4*M_PI*d2*sqrt(d2));
+    }
+
+    if(node.is_inner())
+    {
+        return eval(node.child(0),p) + eval(node.child(1),p);
+    }
+
+    double w = 0;
+    for(uint tid : bvh.node_items(nid))
+    {
+        w += solid_angle(tri_verts[3*tid], tri_verts[3*tid+1], tri_verts[3*tid+2], p);
+    }
+    return w;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double FastWindingNumber::eval(const vec3d & p) const
+{
+    if(bvh.nodes.empty()) return 0;
+    return eval(0,p);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void FastWindingNumber::eval(const std::vector<vec3d> & p, std::vector<double> & w) const
+{
+    w.resize(p.size());
+    PARALLEL_FOR(0, uint(p.size()), 256, [&](uint i)
+    {
+        w[i] = eval(p[i]);
+    });
+}
+
+}
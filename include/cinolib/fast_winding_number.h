@@ -0,0 +1,104 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2022: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_FAST_WINDING_NUMBER_H
+#define CINO_FAST_WINDING_NUMBER_H
+
+#include <cinolib/bvh.h>
+#include <cinolib/meshes/abstract_polygonmesh.h>
+
+namespace cinolib
+{
+
+/* Hierarchical evaluation of the generalized winding number of a triangle soup.
+ * Triangles are organized in a BVH, and each node stores the first order (dipole)
+ * expansion of the solid angle subtended by its triangles. Far away nodes (i.e.
+ * nodes whose distance from the query point exceeds beta times their radius) are
+ * evaluated with the expansion, whereas close leaves sum the exact solid angles of
+ * their triangles. The query costs O(log n) instead of the O(n) of winding_number,
+ * and remains well defined (and robust) for meshes with holes or self intersections,
+ * where the winding number smoothly varies between 0 (outside) and 1 (inside).
+ *
+ * Ref: Fast Winding Numbers for Soups and Clouds
+ *      G. Barill, N. Dickson, R. Schmidt, D.I.W. Levin, A. Jacobson
+ *      ACM Transactions on Graphics (SIGGRAPH), 2018
+*/
+
+class FastWindingNumber
+{
+    public:
+
+        FastWindingNumber(const std::vector<vec3d> & verts,
+                          const std::vector<uint>  & tris,
+                          const double               beta = 2.0);
+
+        template<class M, class V, class E, class P>
+        FastWindingNumber(const AbstractPolygonMesh<M,V,E,P> & m,
+                          const double                         beta = 2.0);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        double eval(const vec3d & p) const;                                     // winding number at point p
+        void   eval(const std::vector<vec3d> & p, std::vector<double> & w) const; // same, for many points (in parallel)
+
+        bool is_inside(const vec3d & p) const { return eval(p) > 0.5; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        const BVH & tree() const { return bvh; }
+
+    protected:
+
+        void init(const std::vector<vec3d> & verts, const std::vector<uint> & tris);
+
+        double eval(const uint nid, const vec3d & p) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        double             beta;
+        BVH                bvh;
+        std::vector<vec3d> tri_verts; // three per triangle, in the order they were pushed in the BVH
+        std::vector<vec3d> node_c;    // per node: area weighted centroid of its triangles
+        std::vector<vec3d> node_n;    // per node: sum of the area weighted normals of its triangles
+        std::vector<double> node_r;   // per node: radius of the ball centered at node_c that contains its triangles
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "fast_winding_number.cpp"
+#endif
+
+#endif // CINO_FAST_WINDING_NUMBER_H
@@ -35,55 +35,311 @@
 *********************************************************************************/
 #include <cinolib/find_intersections.h>
 #include <cinolib/parallel_for.h>
+#include <cinolib/thread_pool.h>
 #include <cinolib/octree.h>
-#include <mutex>
+#include <cinolib/bvh.h>
+#include <algorithm>
+#include <cmath>
 
 namespace cinolib
 {
 
-template<class M, class V, class E, class P>
+namespace
+{
+
+// supporting plane of a triangle, used to quickly discard pairs of triangles
+// that are separated by the plane of one of them
+struct TriPlane
+{
+    vec3d  n;
+    double d;
+    double tol; // bound on the floating point error of n.dot(p)-d
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
-void find_intersections(const Trimesh<M,V,E,P> & m,
-                              std::set<ipair>  & intersections)
+std::vector<TriPlane> tri_planes(const std::vector<Triangle> & tris)
 {
-    auto tris = serialized_vids_from_polys(m.vector_polys());
-    find_intersections(m.vector_verts(), tris, intersections);
+    // the error of n.dot(p)-d scales with |e0|*|e1|*(|p|+|v0|), which is
+    // bounded using the largest coordinate in the mesh. The safety factor
+    // is orders of magnitude above the actual rounding error, and only
+    // affects pairs that are almost touching
+    double max_coord = PARALLEL_REDUCE(0, uint(tris.size()), 1000, 0.0, [&](uint i)
+    {
+        const AABB & b = tris[i].aabb;
+        double m = 0;
+        for(uint d=0; d<3; ++d) m = std::max(m, std::max(std::fabs(b.min[d]), std::fabs(b.max[d])));
+        return m;
+    },
+    [](double a, double b){ return std::max(a,b); });
+
+    std::vector<TriPlane> planes(tris.size());
+    PARALLEL_FOR(0, uint(tris.size()), 1000, [&](uint i)
+    {
+        const vec3d * v  = tris[i].v;
+        vec3d         e0 = v[1] - v[0];
+        vec3d         e1 = v[2] - v[0];
+        planes[i].n   = e0.cross(e1);
+        planes[i].d   = planes[i].n.dot(v[0]);
+        planes[i].tol = 1e-12 * e0.norm() * e1.norm() * 4.0 * max_coord;
+    });
+    return planes;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// true if triangle t meets the plane of triangle t0 at most at vertices shared
+// with t0. This also applies to adjacent triangles, which cannot intersect other
+// than along the shared vertex/edge unless they are (almost) coplanar
 CINO_INLINE
-void find_intersections(const std::vector<vec3d> & verts,
-                        const std::vector<uint>  & tris,
-                              std::set<ipair>    & intersections)
+bool separated(const TriPlane & pl, const vec3d t0[], const vec3d t[])
+{
+    bool above = false;
+    bool below = false;
+    for(uint i=0; i<3; ++i)
+    {
+        if(t[i]==t0[0] || t[i]==t0[1] || t[i]==t0[2]) continue;
+        double s = pl.n.dot(t[i]) - pl.d;
+        if     (s> pl.tol) above = true;
+        else if(s<-pl.tol) below = true;
+        else return false;
+    }
+    return above!=below;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// AABBs are assumed to be already overlapping
+CINO_INLINE
+bool intersect(const std::vector<Triangle> & tris,
+               const std::vector<TriPlane> & planes,
+               const uint                    tid0,
+               const uint                    tid1)
+{
+    const Triangle & t0 = tris[tid0];
+    const Triangle & t1 = tris[tid1];
+    if(separated(planes[tid0], t0.v, t1.v)) return false;
+    if(separated(planes[tid1], t1.v, t0.v)) return false;
+    return t0.intersects_triangle(t1.v,true); // exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// the leaf that contains the minimum corner of the intersection between two
+// overlapping AABBs. Both items are referenced by this leaf, and points on a
+// splitting plane go to the max side (consistently with Octree::build, which
+// sends an item to both sides if it touches the plane)
+CINO_INLINE
+uint owner_leaf(const Octree & o, const AABB & b0, const AABB & b1)
+{
+    static const uint octant[8] = { 0, 1, 3, 2, 4, 5, 7, 6 }; // see Octree::build
+    vec3d p(std::max(b0.min[0], b1.min[0]),
+            std::max(b0.min[1], b1.min[1]),
+            std::max(b0.min[2], b1.min[2]));
+    uint nid = 0;
+    while(o.nodes[nid].is_inner())
+    {
+        vec3d avg = o.nodes[nid].bbox.center();
+        uint  i   = (p[0]>=avg[0] ? 1 : 0) |
+                    (p[1]>=avg[1] ? 2 : 0) |
+                    (p[2]>=avg[2] ? 4 : 0);
+        nid = o.nodes[nid].child(octant[i]);
+    }
+    return nid;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void octree_intersections(const std::vector<vec3d>              & verts,
+                          const std::vector<uint>               & tris,
+                                std::vector<std::vector<ipair>> & hits)
 {
     Octree o(8,1000); // max 1000 elements per leaf, depth permitting
     o.build_from_vectors(verts, tris);
+    std::vector<TriPlane> planes = tri_planes(o.triangles); // o only contains triangles, hence item
+                                                            // and triangle indices coincide
+    hits.resize(o.leaves.size());
+    PARALLEL_FOR(0, uint(o.leaves.size()), 1, 1, [&](uint i)
+    {
+        uint nid  = o.leaves.at(i);
+        auto leaf = o.node_items(nid);
+        if(leaf.size()<2) return;
 
-    std::mutex mutex;
-    PARALLEL_FOR(0, uint(o.leaves.size()), 1, [&](uint i)
-    {        
-        auto & leaf = o.leaves.at(i);
-        if(leaf->item_indices.empty()) return;
-        for(uint j=0;   j<leaf->item_indices.size()-1; ++j)
-        for(uint k=j+1; k<leaf->item_indices.size();   ++k)
+        // sweep and prune along the x axis
+        std::vector<uint> items(leaf.begin(), leaf.end());
+        std::sort(items.begin(), items.end(), [&](const uint a, const uint b)
+        {
+            return o.triangles[a].aabb.min[0] < o.triangles[b].aabb.min[0];
+        });
+        for(uint j=0; j<items.size(); ++j)
         {
-            uint tid0 = leaf->item_indices.at(j);
-            uint tid1 = leaf->item_indices.at(k);
-            auto T0 = o.items.at(tid0);
-            auto T1 = o.items.at(tid1);
-            if(T0->aabb.intersects_box(T1->aabb)) // early reject based on AABB intersection
+            const AABB & b0 = o.triangles[items[j]].aabb;
+            for(uint k=j+1; k<items.size() && o.triangles[items[k]].aabb.min[0]<=b0.max[0]; ++k)
             {
-                const Triangle *t0 = dynamic_cast<Triangle*>(T0);
-                const Triangle *t1 = dynamic_cast<Triangle*>(T1);
-                if(t0->intersects_triangle(t1->v,true)) // precise check (exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined)
+                const AABB & b1 = o.triangles[items[k]].aabb;
+                if(!b0.intersects_box(b1))         continue;
+                if(owner_leaf(o, b0, b1)!=nid)     continue; // the pair is tested in another leaf
+                if(intersect(o.triangles, planes, items[j], items[k]))
                 {
-                    std::lock_guard<std::mutex> guard(mutex);
-                    intersections.insert(unique_pair(tid0,tid1));
+                    hits[i].push_back(unique_pair(items[j], items[k]));
                 }
             }
         }
     });
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void bvh_intersections(const std::vector<vec3d>              & verts,
+                       const std::vector<uint>               & tris,
+                             std::vector<std::vector<ipair>> & hits)
+{
+    BVH bvh;
+    bvh.build_from_vectors(verts, tris);
+    if(bvh.nodes.empty()) return;
+    std::vector<TriPlane> planes = tri_planes(bvh.triangles); // bvh only contains triangles, hence item
+                                                              // and triangle indices coincide
+
+    // a pair of nodes (a,b) stands for all pairs of items with one item in a and the other
+    // in b. Pair (a,a) stands for all pairs of items in a. This function replaces a pair
+    // with the pairs of children that may contain intersecting items, splitting the largest
+    // node. It returns false if both nodes are leaves (i.e. if the pair cannot be split)
+    auto split = [&](const ipair & p, std::vector<ipair> & out) -> bool
+    {
+        const BVHNode & a = bvh.nodes[p.first];
+        const BVHNode & b = bvh.nodes[p.second];
+        auto push = [&](const uint n0, const uint n1)
+        {
+            if(n0==n1 || bvh.nodes[n0].bbox.intersects_box(bvh.nodes[n1].bbox)) out.push_back(ipair(n0,n1));
+        };
+        if(p.first==p.second)
+        {
+            if(!a.is_inner()) return false;
+            push(a.child(0), a.child(0));
+            push(a.child(1), a.child(1));
+            push(a.child(0), a.child(1));
+            return true;
+        }
+        if(!a.is_inner() && !b.is_inner()) return false;
+        if(a.is_inner() && (!b.is_inner() || a.bbox.diag()>=b.bbox.diag()))
+        {
+            push(a.child(0), p.second);
+            push(a.child(1), p.second);
+        }
+        else
+        {
+            push(p.first, b.child(0));
+            push(p.first, b.child(1));
+        }
+        return true;
+    };
+
+    auto test_leaves = [&](const ipair & p, std::vector<ipair> & res)
+    {
+        auto l0 = bvh.node_items(p.first);
+        auto l1 = bvh.node_items(p.second);
+        for(uint j=0; j<l0.size(); ++j)
+        for(uint k=(p.first==p.second) ? j+1 : 0; k<l1.size(); ++k)
+        {
+            if(!bvh.triangles[l0[j]].aabb.intersects_box(bvh.triangles[l1[k]].aabb)) continue;
+            if(intersect(bvh.triangles, planes, l0[j], l1[k]))
+            {
+                res.push_back(unique_pair(l0[j], l1[k]));
+            }
+        }
+    };
+
+    // expand the top of the traversal breadth first, until there are enough
+    // independent pairs of subtrees to keep all threads busy
+    std::vector<ipair> tasks(1, ipair(0,0));
+    uint min_tasks = 64 * ThreadPool::instance().num_threads();
+    while(tasks.size()<min_tasks)
+    {
+        std::vector<ipair> next;
+        bool progress = false;
+        for(const ipair & p : tasks)
+        {
+            if(split(p,next)) progress = true;
+            else              next.push_back(p);
+        }
+        tasks.swap(next);
+        if(!progress) break;
+    }
+
+    hits.resize(tasks.size());
+    PARALLEL_FOR(0, uint(tasks.size()), 1, 1, [&](uint i)
+    {
+        std::vector<ipair> stack(1, tasks[i]);
+        while(!stack.empty())
+        {
+            ipair p = stack.back();
+            stack.pop_back();
+            if(!split(p,stack)) test_leaves(p, hits[i]);
+        }
+    });
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void find_intersections(const Trimesh<M,V,E,P> & m,
+                              std::vector<ipair> & intersections,
+                        const bool                 use_bvh)
+{
+    auto tris = serialized_vids_from_polys(m.vector_polys());
+    find_intersections(m.vector_verts(), tris, intersections, use_bvh);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void find_intersections(const std::vector<vec3d> & verts,
+                        const std::vector<uint>  & tris,
+                              std::vector<ipair> & intersections,
+                        const bool                 use_bvh)
+{
+    // each unit of work has its own buffer, hence no locking is necessary
+    std::vector<std::vector<ipair>> hits;
+    if(use_bvh) bvh_intersections   (verts, tris, hits);
+    else        octree_intersections(verts, tris, hits);
+
+    size_t n = 0;
+    for(const auto & h : hits) n += h.size();
+    intersections.clear();
+    intersections.reserve(n);
+    for(const auto & h : hits) intersections.insert(intersections.end(), h.begin(), h.end());
+    std::sort(intersections.begin(), intersections.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void find_intersections(const Trimesh<M,V,E,P> & m,
+                              std::set<ipair>    & intersections,
+                        const bool                 use_bvh)
+{
+    auto tris = serialized_vids_from_polys(m.vector_polys());
+    find_intersections(m.vector_verts(), tris, intersections, use_bvh);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void find_intersections(const std::vector<vec3d> & verts,
+                        const std::vector<uint>  & tris,
+                              std::set<ipair>    & intersections,
+                        const bool                 use_bvh)
+{
+    std::vector<ipair> res;
+    find_intersections(verts, tris, res, use_bvh);
+    intersections.insert(res.begin(), res.end());
+}
+
 }
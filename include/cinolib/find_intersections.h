@@ -40,17 +40,35 @@
 #include <cinolib/meshes/trimesh.h>
 #include <cinolib/ipair.h>
 #include <set>
+#include <vector>
 
 namespace cinolib
 {
 
-/* This method puts all the input polygons into an octree, then
- * performs pairwise intersection tests within each leaf, retunrning
- * a set of pairs of intersecting triangles.
+/* This method finds all pairs of intersecting triangles in a mesh. Triangles
+ * that share a vertex or an edge are considered intersecting only if they
+ * overlap elsewhere (i.e. if they do not form a valid simplicial complex).
  *
- * The output must be a set and not a vector because triangles will
- * appear in all the leaves that have non empty overlap with it. Therefore,
- * the same intersection can be detected multiple times.
+ * Candidate pairs are found either with a self traversal of a Bounding Volume
+ * Hierarchy (default), or with pairwise tests within the leaves of an Octree.
+ * The BVH is more expensive to build, but its leaves stay small also for highly
+ * anisotropic inputs (e.g. CAD models with long skinny triangles), which crowd
+ * Octree leaves and make the Octree variant degrade to (almost) quadratic time.
+ * On uniformly sampled surfaces (e.g. scans) the Octree is faster. In the
+ * Octree a triangle may be referenced by multiple leaves, and each pair of
+ * triangles is tested only in the leaf that contains the minimum corner of the
+ * intersection of their AABBs, so that no pair is ever tested (or reported)
+ * twice. Within leaves, candidates are found with a sweep along the x axis.
+ *
+ * Both variants run in parallel without any locking: each unit of work (a
+ * leaf, or a pair of BVH subtrees) stores its hits in its own buffer, and
+ * buffers are merged at the end. Before the exact test, candidate pairs go
+ * through a conservative floating point filter that discards them if the
+ * vertices of one triangle (except those shared with the other triangle)
+ * lie strictly on the same side of the plane of the other one.
+ *
+ * Intersecting pairs are returned sorted and without duplicates, with the
+ * smallest triangle index first.
  *
  * IMPORTANT: intersections tests are based on the orient predicates contained
  * in cinolib/predicates.h. These predicates are exact if the symbol
@@ -60,14 +78,32 @@ namespace cinolib
 template<class M, class V, class E, class P>
 CINO_INLINE
 void find_intersections(const Trimesh<M,V,E,P> & m,
-                        std::set<ipair>        & intersections);
+                              std::vector<ipair> & intersections,
+                        const bool                 use_bvh = true);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void find_intersections(const std::vector<vec3d> & verts,
+                        const std::vector<uint>  & tris,
+                              std::vector<ipair> & intersections,
+                        const bool                 use_bvh = true);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void find_intersections(const Trimesh<M,V,E,P> & m,
+                              std::set<ipair>    & intersections,
+                        const bool                 use_bvh = true);
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
 void find_intersections(const std::vector<vec3d> & verts,
                         const std::vector<uint>  & tris,
-                              std::set<ipair>    & intersections);
+                              std::set<ipair>    & intersections,
+                        const bool                 use_bvh = true);
 
 }
 
@@ -39,6 +39,10 @@
 #include <cinolib/laplacian.h>
 #include <cinolib/vertex_mass.h>
 #include <cinolib/linear_solvers.h>
+#include <cinolib/connected_components.h>
+#include <cinolib/parallel_for.h>
+#include <algorithm>
+#include <limits>
 
 namespace cinolib
 {
@@ -166,4 +170,141 @@ ScalarField compute_geodesics_amortized(      Mesh              & m,
 
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Mesh>
+CINO_INLINE
+std::vector<ScalarField> compute_geodesics_batched(const Mesh                           & m,
+                                                   const std::vector<std::vector<uint>> & sources,
+                                                   const int                              laplacian_mode,
+                                                   const float                            time_scalar,
+                                                   const uint                             batch_size,
+                                                   const bool                             parallel)
+{
+    assert(batch_size>0);
+    uint nv = m.num_verts();
+
+    // use the squared avg edge length as time step, as suggested in the original paper
+    double time = m.edge_avg_length();
+    time *= time;
+    time *= time_scalar;
+
+    Eigen::SparseMatrix<double> L  = laplacian(m, laplacian_mode);
+    Eigen::SparseMatrix<double> MM = mass_matrix(m);
+
+    // mass weighted gradient K = A*G. Green-Gauss gradients divide by the element
+    // mass (clamped from below to avoid degeneracies, which is why the functions
+    // above rescale the mesh). Multiplying back cancels both mass and clamping,
+    // hence K does not depend on the scale of the mesh. The normalized gradient
+    // of the heat is the same for G and K, and K^T X is the integrated divergence
+    // of the vector field X, i.e. the right hand side of the Poisson problem
+    Eigen::SparseMatrix<double,Eigen::RowMajor> K = gradient_matrix(m);
+    Eigen::VectorXd inv_mass(3*m.num_polys());
+    PARALLEL_FOR(0, m.num_polys(), 1000, [&](const uint pid)
+    {
+        double mass = m.poly_mass(pid);
+        double w    = std::max(mass, 1e-5);
+        for(uint i=3*pid; i<3*pid+3; ++i)
+        {
+            for(Eigen::SparseMatrix<double,Eigen::RowMajor>::InnerIterator it(K,i); it; ++it)
+            {
+                it.valueRef() *= w;
+            }
+            inv_mass[i] = (mass>0) ? 1.0/mass : 0.0;
+        }
+    });
+    Eigen::SparseMatrix<double,Eigen::RowMajor> Kt = K.transpose();
+
+    // the Poisson problem uses the stiffness matrix S = G^T*A*G = K^T*A^-1*K,
+    // which is consistent with the divergence operator K^T. For simplicial
+    // meshes this is the cotangent Laplacian (with sign flipped), but without
+    // clamping negative weights, which would bias distances (e.g. on tetmeshes,
+    // where obtuse dihedral angles are common)
+    Eigen::SparseMatrix<double> S = Eigen::SparseMatrix<double>(Kt * inv_mass.asDiagonal() * K);
+
+    // the Laplacian has a null space for each connected component (the constant
+    // functions). Fixing one vertex per component makes the Poisson problem
+    // positive definite, and distances are then shifted to vanish at the sources
+    std::vector<std::unordered_set<uint>> ccs;
+    connected_components(m, ccs);
+    std::vector<uint> cc_id(nv);
+    std::map<uint,double> pins;
+    for(uint i=0; i<ccs.size(); ++i)
+    {
+        uint pin = *std::min_element(ccs.at(i).begin(), ccs.at(i).end());
+        pins[pin] = 0.0;
+        for(uint vid : ccs.at(i)) cc_id.at(vid) = i;
+    }
+
+    SparseSolverCache heat_solver   (SIMPLICIAL_LLT);
+    SparseSolverCache poisson_solver(SIMPLICIAL_LLT);
+    if(!heat_solver.factorize(MM - time * L))       assert(false && "Factorization failed");
+    if(!poisson_solver.factorize_with_bc(S, pins)) assert(false && "Factorization failed");
+
+    std::vector<ScalarField> dist(sources.size());
+    uint n_batches = (sources.size() + batch_size - 1) / batch_size;
+    PARALLEL_FOR(0, n_batches, parallel ? 2 : n_batches+1, 1, [&](const uint batch)
+    {
+        uint beg = batch * batch_size;
+        uint end = std::min<uint>(beg + batch_size, sources.size());
+        uint n   = end - beg;
+
+        Eigen::MatrixXd u0 = Eigen::MatrixXd::Zero(nv,n);
+        for(uint i=0; i<n; ++i)
+        {
+            for(uint vid : sources.at(beg+i)) u0(vid,i) = 1.0;
+        }
+        Eigen::MatrixXd u;
+        heat_solver.solve(u0, u);
+
+        // heat decreases away from the sources, hence the (normalized) gradient
+        // of the distance is the opposite of the (normalized) gradient of u
+        // (sparse-dense products are done column by column, as Eigen
+        // would otherwise scan the dense matrices along rows)
+        Eigen::MatrixXd X(K.rows(),n);
+        for(uint i=0; i<n; ++i)
+        {
+            X.col(i) = K * u.col(i);
+            double *x = X.col(i).data();
+            for(uint pid=0; pid<m.num_polys(); ++pid, x+=3)
+            {
+                double norm = std::sqrt(x[0]*x[0] + x[1]*x[1] + x[2]*x[2]);
+                if(norm>0)
+                {
+                    x[0] /= -norm;
+                    x[1] /= -norm;
+                    x[2] /= -norm;
+                }
+            }
+        }
+
+        Eigen::MatrixXd div(nv,n);
+        for(uint i=0; i<n; ++i) div.col(i) = Kt * X.col(i);
+        Eigen::MatrixXd phi;
+        poisson_solver.solve_with_bc(div, phi, Eigen::MatrixXd::Zero(pins.size(),n));
+
+        for(uint i=0; i<n; ++i)
+        {
+            // for each connected component, subtract the avg value at its sources
+            std::vector<double> offset(ccs.size(), 0.0);
+            std::vector<uint>   count (ccs.size(), 0);
+            for(uint vid : sources.at(beg+i))
+            {
+                offset.at(cc_id.at(vid)) += phi(vid,i);
+                ++count.at(cc_id.at(vid));
+            }
+            ScalarField & d = dist.at(beg+i);
+            d = ScalarField(nv);
+            for(uint vid=0; vid<nv; ++vid)
+            {
+                uint cc = cc_id.at(vid);
+                d[vid] = (count.at(cc)>0) ? phi(vid,i) - offset.at(cc)/count.at(cc)
+                                          : std::numeric_limits<double>::infinity();
+            }
+        }
+    });
+
+    return dist;
+}
+
 }
@@ -95,6 +95,31 @@ ScalarField compute_geodesics_amortized(      Mesh              & m,
                                         const std::vector<uint> & heat_charges,
                                         const int                 laplacian_mode = COTANGENT,
                                         const float               time_scalar = 1.0);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* Batched heat method, for computing many distance fields at once (e.g. from
+ * a set of landmarks). Field i measures the distance from the vertices in
+ * sources[i]. Differently from the functions above:
+ *
+ *  - distances are metric (not normalized), and vanish at the sources;
+ *  - the mesh is not modified (no temporary rescaling);
+ *  - the heat flow and Poisson matrices are factorized only once, and source
+ *    sets are solved in blocks of batch_size columns (dense multi RHS). If
+ *    parallel is true, blocks are processed concurrently.
+ *
+ * Vertices that cannot be reached from any source (i.e. that belong to a
+ * connected component that does not contain sources) get infinite distance.
+*/
+
+template<class Mesh>
+CINO_INLINE
+std::vector<ScalarField> compute_geodesics_batched(const Mesh                           & m,
+                                                   const std::vector<std::vector<uint>> & sources,
+                                                   const int                              laplacian_mode = COTANGENT,
+                                                   const float                            time_scalar    = 1.0,
+                                                   const uint                             batch_size     = 32,
+                                                   const bool                             parallel       = true);
 }
 
 #ifndef  CINO_STATIC_LIB
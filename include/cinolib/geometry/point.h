@@ -42,7 +42,7 @@
 namespace cinolib
 {
 
-class Point : public SpatialDataStructureItem
+class Point final : public SpatialDataStructureItem
 {
     public:
 
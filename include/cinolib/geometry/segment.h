@@ -42,7 +42,7 @@
 namespace cinolib
 {
 
-class Segment : public SpatialDataStructureItem
+class Segment final : public SpatialDataStructureItem
 {
     public:
 
@@ -42,7 +42,7 @@
 namespace cinolib
 {
 
-class Sphere : public SpatialDataStructureItem
+class Sphere final : public SpatialDataStructureItem
 {
     public:
 
@@ -41,7 +41,7 @@
 namespace cinolib
 {
 
-class Tetrahedron : public SpatialDataStructureItem
+class Tetrahedron final : public SpatialDataStructureItem
 {
     public:
 
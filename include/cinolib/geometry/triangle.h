@@ -41,7 +41,7 @@
 namespace cinolib
 {
 
-class Triangle : public SpatialDataStructureItem
+class Triangle final : public SpatialDataStructureItem
 {
     public:
 
@@ -42,11 +42,49 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/gradient.h>
+#include <cinolib/sparse_matrix_alloc.h>
+#include <cinolib/parallel_for.h>
+#include <algorithm>
 
 namespace cinolib
 {
 
-typedef Eigen::Triplet<double> Entry;
+// Writes row triplet (row, row+1, row+2) of a row major matrix having the
+// same entries (col,vec3d) for each of the three rows. If a column appears
+// multiple times its contributions are summed, in order of appearance
+CINO_INLINE
+static void gradient_fill_rows(Eigen::SparseMatrix<double,Eigen::RowMajor> & G,
+                               const uint                                    row,
+                               std::vector<std::pair<uint,vec3d>>          & entries)
+{
+    std::stable_sort(entries.begin(), entries.end(), [](const std::pair<uint,vec3d> & a,
+                                                        const std::pair<uint,vec3d> & b)
+    {
+        return a.first < b.first;
+    });
+
+    const auto *outer = G.outerIndexPtr();
+    auto       *inner = G.innerIndexPtr();
+    double     *value = G.valuePtr();
+    for(uint i=0; i<3; ++i)
+    {
+        int off = outer[row+i]-1;
+        for(uint j=0; j<entries.size(); ++j)
+        {
+            if(j>0 && entries.at(j).first==entries.at(j-1).first)
+            {
+                value[off] += entries.at(j).second[i];
+            }
+            else
+            {
+                ++off;
+                inner[off] = entries.at(j).first;
+                value[off] = entries.at(j).second[i];
+            }
+        }
+        assert(off+1 == outer[row+i+1]);
+    }
+}
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -54,79 +92,82 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> gradient_matrix(const AbstractPolygonMesh<M,V,E,P> & m, const bool per_poly)
 {
-    if(per_poly)
+    // per corner sum of the (scaled) normals of its two incident edges.
+    // These are computed once and shared between the per poly and the
+    // per vertex assembly. Matrices are filled in parallel, one row triplet
+    // at a time, straight into the CRS arrays of a row major matrix
+    std::vector<uint> poly_off(m.num_polys()+1,0);
+    for(uint pid=0; pid<m.num_polys(); ++pid)
     {
-        Eigen::SparseMatrix<double> G(m.num_polys()*3, m.num_verts());
-        std::vector<Entry> entries;
+        poly_off.at(pid+1) = poly_off.at(pid) + m.verts_per_poly(pid);
+    }
 
-        for(uint pid=0; pid<m.num_polys(); ++pid)
+    std::vector<double> area(m.num_polys());
+    std::vector<vec3d>  contr(poly_off.back());
+    PARALLEL_FOR(0, m.num_polys(), 1000, [&](const uint pid)
+    {
+        area[pid] = std::max(m.poly_area(pid), 1e-5) * 2.0; // (2 is the average term : two verts for each edge)
+        vec3d n   = m.poly_data(pid).normal;
+
+        for(uint off=0; off<m.verts_per_poly(pid); ++off)
         {
-            double area = std::max(m.poly_area(pid), 1e-5) * 2.0; // (2 is the average term : two verts for each edge)
-            vec3d n     = m.poly_data(pid).normal;
+            uint  prev = m.poly_vert_id(pid,off);
+            uint  curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
+            uint  next = m.poly_vert_id(pid,(off+2)%m.verts_per_poly(pid));
+            vec3d u    = m.vert(next) - m.vert(curr);
+            vec3d v    = m.vert(curr) - m.vert(prev);
+            vec3d u_90 = u.cross(n); u_90.normalize();
+            vec3d v_90 = v.cross(n); v_90.normalize();
 
-            for(uint off=0; off<m.verts_per_poly(pid); ++off)
-            {
-                uint  prev = m.poly_vert_id(pid,off);
-                uint  curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
-                uint  next = m.poly_vert_id(pid,(off+2)%m.verts_per_poly(pid));
-                vec3d u    = m.vert(next) - m.vert(curr);
-                vec3d v    = m.vert(curr) - m.vert(prev);
-                vec3d u_90 = u.cross(n); u_90.normalize();
-                vec3d v_90 = v.cross(n); v_90.normalize();
-
-                vec3d per_vert_sum_over_edge_normals = u_90 * u.norm() + v_90 * v.norm();
-                per_vert_sum_over_edge_normals /= area;
-
-                uint row = 3 * pid;
-                entries.push_back(Entry(row, curr, per_vert_sum_over_edge_normals.x())); ++row;
-                entries.push_back(Entry(row, curr, per_vert_sum_over_edge_normals.y())); ++row;
-                entries.push_back(Entry(row, curr, per_vert_sum_over_edge_normals.z()));
-            }
+            contr[poly_off[pid]+off] = u_90 * u.norm() + v_90 * v.norm();
         }
+    });
 
-        G.setFromTriplets(entries.begin(), entries.end());
-        return G;
-    }
-    else // per vertex
+    // gathers the entries of the gradient of poly pid (or of the polys incident to vertex vid)
+    auto poly_entries = [&](const uint pid, std::vector<std::pair<uint,vec3d>> & entries)
     {
-        Eigen::SparseMatrix<double> G(m.num_verts()*3, m.num_verts());
-        std::vector<Entry> entries;
-
-        for(uint vid=0; vid<m.num_verts(); ++vid)
+        entries.clear();
+        for(uint off=0; off<m.verts_per_poly(pid); ++off)
         {
-            std::vector<std::pair<uint,vec3d>> vert_contr;
-            double area=0.f;
-            for(uint pid : m.adj_v2p(vid))
-            {
-                area   += std::max(m.poly_area(pid), 1e-5) * 2.0;
-                vec3d n = m.poly_data(pid).normal;
-
-                for(uint off=0; off<m.verts_per_poly(pid); ++off)
-                {
-                    uint  prev = m.poly_vert_id(pid,off);
-                    uint  curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
-                    uint  next = m.poly_vert_id(pid,(off+2)%m.verts_per_poly(pid));
-                    vec3d u    = m.vert(next) - m.vert(curr);
-                    vec3d v    = m.vert(curr) - m.vert(prev);
-                    vec3d u_90 = u.cross(n); u_90.normalize();
-                    vec3d v_90 = v.cross(n); v_90.normalize();
-
-                    // note: Eigen::setFromTriplets will take care of summing contributs w.r.t. multiple polys
-                    vert_contr.push_back(std::make_pair(curr, u_90*u.norm()+v_90*v.norm()));
-                }
-            }
-            uint row = vid * 3;
-            for(auto c : vert_contr)
-            {
-                entries.push_back(Entry(row  , c.first, c.second.x()/area));
-                entries.push_back(Entry(row+1, c.first, c.second.y()/area));
-                entries.push_back(Entry(row+2, c.first, c.second.z()/area));
-            }
+            uint curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
+            entries.push_back(std::make_pair(curr, contr[poly_off[pid]+off]/area[pid]));
         }
+    };
+    auto vert_entries = [&](const uint vid, std::vector<std::pair<uint,vec3d>> & entries)
+    {
+        double a = 0.0;
+        for(uint pid : m.adj_v2p(vid)) a += area[pid];
+        entries.clear();
+        for(uint pid : m.adj_v2p(vid))
+        for(uint off=0; off<m.verts_per_poly(pid); ++off)
+        {
+            uint curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
+            entries.push_back(std::make_pair(curr, contr[poly_off[pid]+off]/a));
+        }
+    };
 
-        G.setFromTriplets(entries.begin(), entries.end());
-        return G;
-    }
+    uint nr = per_poly ? m.num_polys() : m.num_verts();
+    std::vector<uint> row_nnz(3*nr);
+    PARALLEL_FOR(0, nr, 1000, [&](const uint id)
+    {
+        std::vector<uint> cols;
+        if(per_poly) cols.assign(m.adj_p2v(id).begin(), m.adj_p2v(id).end());
+        else for(uint pid : m.adj_v2p(id)) cols.insert(cols.end(), m.adj_p2v(pid).begin(), m.adj_p2v(pid).end());
+        std::sort(cols.begin(), cols.end());
+        row_nnz[3*id] = row_nnz[3*id+1] = row_nnz[3*id+2] = std::unique(cols.begin(), cols.end()) - cols.begin();
+    });
+
+    Eigen::SparseMatrix<double,Eigen::RowMajor> G;
+    sparse_matrix_alloc(G, 3*nr, m.num_verts(), row_nnz);
+    PARALLEL_FOR(0, nr, 1000, [&](const uint id)
+    {
+        std::vector<std::pair<uint,vec3d>> entries;
+        if(per_poly) poly_entries(id, entries);
+        else         vert_entries(id, entries);
+        gradient_fill_rows(G, 3*id, entries);
+    });
+
+    return G;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -135,92 +176,82 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> gradient_matrix(const AbstractPolyhedralMesh<M,V,E,F,P> & m, const bool per_poly)
 {
-    if(per_poly)
+    // face areas and poly volumes are computed once, as they are
+    // shared by multiple vertices (and, for faces, by two polys)
+    std::vector<double> f_area(m.num_faces());
+    std::vector<double> p_vol(m.num_polys());
+    PARALLEL_FOR(0, m.num_faces(), 1000, [&](const uint fid){ f_area[fid] = m.face_area(fid);   });
+    PARALLEL_FOR(0, m.num_polys(), 1000, [&](const uint pid){ p_vol[pid]  = m.poly_volume(pid); });
+
+    std::vector<uint> row_nnz(3*m.num_polys());
+    for(uint pid=0; pid<m.num_polys(); ++pid)
     {
-        Eigen::SparseMatrix<double> G(m.num_polys()*3, m.num_verts());
-        std::vector<Entry> entries;
+        row_nnz.at(3*pid) = row_nnz.at(3*pid+1) = row_nnz.at(3*pid+2) = m.verts_per_poly(pid);
+    }
 
-        for(uint pid=0; pid<m.num_polys(); ++pid)
-        {
-            double vol = std::max(m.poly_volume(pid), 1e-5);
+    Eigen::SparseMatrix<double,Eigen::RowMajor> G;
+    sparse_matrix_alloc(G, m.num_polys()*3, m.num_verts(), row_nnz);
+    PARALLEL_FOR(0, m.num_polys(), 1000, [&](const uint pid)
+    {
+        double vol = std::max(p_vol[pid], 1e-5);
 
-            for(uint vid : m.adj_p2v(pid))
+        std::vector<std::pair<uint,vec3d>> entries;
+        for(uint vid : m.adj_p2v(pid))
+        {
+            vec3d per_vert_sum_over_f_normals(0,0,0);
+            for(uint fid : m.adj_p2f(pid))
             {
-                vec3d per_vert_sum_over_f_normals(0,0,0);
-                for(uint fid : m.adj_p2f(pid))
+                if (m.face_contains_vert(fid,vid))
                 {
-                    if (m.face_contains_vert(fid,vid))
-                    {
-                        vec3d  n   = m.poly_face_normal(pid,fid);
-                        double a   = m.face_area(fid);
-                        double avg = static_cast<double>(m.verts_per_face(fid));
-                        per_vert_sum_over_f_normals += (n*a)/avg;
-                    }
+                    vec3d  n   = m.poly_face_normal(pid,fid);
+                    double a   = f_area[fid];
+                    double avg = static_cast<double>(m.verts_per_face(fid));
+                    per_vert_sum_over_f_normals += (n*a)/avg;
                 }
-                per_vert_sum_over_f_normals /= vol;
-                uint row = 3 * pid;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.x())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.y())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.z()));
             }
+            per_vert_sum_over_f_normals /= vol;
+            entries.push_back(std::make_pair(vid, per_vert_sum_over_f_normals));
         }
+        gradient_fill_rows(G, 3*pid, entries);
+    });
 
-        G.setFromTriplets(entries.begin(), entries.end());
-        return G;
-    }
-    else // per vert
+    if(per_poly) return G;
+
+    // per vert: average of the gradients of the incident polys, weighted by their volume
+    std::vector<uint> A_nnz(3*m.num_verts());
+    for(uint vid=0; vid<m.num_verts(); ++vid)
     {
-        Eigen::SparseMatrix<double> G(m.num_polys()*3, m.num_verts());
-        std::vector<Entry> entries;
+        A_nnz.at(3*vid) = A_nnz.at(3*vid+1) = A_nnz.at(3*vid+2) = m.adj_v2p(vid).size();
+    }
 
-        for(uint pid=0; pid<m.num_polys(); ++pid)
+    Eigen::SparseMatrix<double,Eigen::RowMajor> A;
+    sparse_matrix_alloc(A, m.num_verts()*3, m.num_polys()*3, A_nnz);
+    PARALLEL_FOR(0, m.num_verts(), 1000, [&](const uint vid)
+    {
+        double total_volume=0;
+        for(uint pid : m.adj_v2p(vid))
         {
-            double vol = std::max(m.poly_volume(pid), 1e-5);
-
-            for(uint vid : m.adj_p2v(pid))
-            {
-                vec3d per_vert_sum_over_f_normals(0,0,0);
-                for(uint fid : m.adj_p2f(pid))
-                {
-                    if (m.face_contains_vert(fid,vid))
-                    {
-                        vec3d  n   = m.poly_face_normal(pid,fid);
-                        double a   = m.face_area(fid);
-                        double avg = static_cast<double>(m.verts_per_face(fid));
-                        per_vert_sum_over_f_normals += (n*a)/avg;
-                    }
-                }
-                per_vert_sum_over_f_normals /= vol;
-                uint row = 3 * pid;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.x())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.y())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.z()));
-            }
+            total_volume += p_vol[pid];
         }
-        G.setFromTriplets(entries.begin(), entries.end());
-
-        Eigen::SparseMatrix<double> A(m.num_verts()*3, m.num_polys()*3);
-        entries.clear();
+        std::vector<uint> polys(m.adj_v2p(vid).begin(), m.adj_v2p(vid).end());
+        std::sort(polys.begin(), polys.end());
 
-        for(uint vid=0;vid<m.num_verts();++vid)
+        for(uint i=0; i<3; ++i)
         {
-            double total_volume=0;
-            for(uint pid : m.adj_v2p(vid))
+            int off = A.outerIndexPtr()[3*vid+i];
+            for(uint pid : polys)
             {
-                total_volume += m.poly_volume(pid);
-            }
-            uint row = 3*vid;
-            for(uint pid : m.adj_v2p(vid))
-            {
-                uint col=3*pid;
-                entries.push_back(Entry(row,  col,   m.poly_volume(pid)/total_volume));
-                entries.push_back(Entry(row+1,col+1, m.poly_volume(pid)/total_volume));
-                entries.push_back(Entry(row+2,col+2, m.poly_volume(pid)/total_volume));
+                A.innerIndexPtr()[off] = 3*pid+i;
+                A.valuePtr()[off]      = p_vol[pid]/total_volume;
+                ++off;
             }
         }
-        A.setFromTriplets(entries.begin(), entries.end());
-        return A*G;
-    }
+    });
+
+    // Eigen sparse products require operands with the same storage order
+    Eigen::SparseMatrix<double> A_cm = A;
+    Eigen::SparseMatrix<double> G_cm = G;
+    return A_cm*G_cm;
 }
 
 }
@@ -0,0 +1,158 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/indexed_heap.h>
+#include <algorithm>
+#include <assert.h>
+
+namespace cinolib
+{
+
+CINO_INLINE
+void IndexedHeap::reserve(const uint n)
+{
+    if(pos.size()<n) pos.resize(n,-1);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IndexedHeap::clear()
+{
+    for(const auto & e : heap) pos[e.second] = -1;
+    heap.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IndexedHeap::push(const uint id, const double key)
+{
+    if(id>=pos.size()) pos.resize(id+1,-1);
+
+    int i = pos[id];
+    if(i<0)
+    {
+        heap.push_back(std::make_pair(key,id));
+        sift_up(uint(heap.size()-1));
+    }
+    else if(key<heap[i].first)
+    {
+        heap[i].first = key;
+        sift_up(uint(i));
+    }
+    else
+    {
+        heap[i].first = key;
+        sift_down(uint(i));
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint IndexedHeap::pop()
+{
+    assert(!heap.empty());
+    uint id = heap.front().second;
+    pos[id] = -1;
+    std::pair<double,uint> last = heap.back();
+    heap.pop_back();
+    if(!heap.empty())
+    {
+        heap.front() = last;
+        sift_down(0);
+    }
+    return id;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IndexedHeap::remove(const uint id)
+{
+    if(!contains(id)) return;
+    uint i = uint(pos[id]);
+    pos[id] = -1;
+    std::pair<double,uint> last = heap.back();
+    heap.pop_back();
+    if(i==heap.size()) return; // id was the last element
+    heap[i] = last;
+    if(i>0 && last<heap[(i-1)/arity]) sift_up(i);
+    else sift_down(i);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IndexedHeap::sift_up(uint i)
+{
+    std::pair<double,uint> e = heap[i];
+    while(i>0)
+    {
+        uint parent = (i-1)/arity;
+        if(!(e<heap[parent])) break;
+        heap[i] = heap[parent];
+        pos[heap[i].second] = int(i);
+        i = parent;
+    }
+    heap[i] = e;
+    pos[e.second] = int(i);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IndexedHeap::sift_down(uint i)
+{
+    std::pair<double,uint> e = heap[i];
+    uint n = uint(heap.size());
+    for(;;)
+    {
+        uint first = arity*i+1;
+        if(first>=n) break;
+        uint last = std::min(first+arity, n);
+        uint best = first;
+        for(uint c=first+1; c<last; ++c) if(heap[c]<heap[best]) best = c;
+        if(!(heap[best]<e)) break;
+        heap[i] = heap[best];
+        pos[heap[i].second] = int(i);
+        i = best;
+    }
+    heap[i] = e;
+    pos[e.second] = int(i);
+}
+
+}
@@ -0,0 +1,102 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_INDEXED_HEAP_H
+#define CINO_INDEXED_HEAP_H
+
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+#include <cinolib/cino_inline.h>
+
+namespace cinolib
+{
+
+/* Min priority queue of integer ids in [0,n), implemented as a 4-ary heap
+ * with an index that keeps track of the position of each id in the heap.
+ * This allows to update the priority of an element already in the queue in
+ * O(log n), which is what Dijkstra-like algorithms need (no dead copies, no
+ * remove and re-insert as with std::set).
+ *
+ * Elements are ordered by (key,id), hence elements with same key are popped
+ * in increasing id order, exactly as in a std::set<std::pair<double,uint>>.
+ * Clearing the queue costs O(size), not O(n), so the same queue can be reused
+ * across many small queries on a big domain.
+*/
+
+class IndexedHeap
+{
+    public:
+
+        explicit IndexedHeap(const uint n = 0) { reserve(n); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void   reserve(const uint n); // ids will range in [0,n)
+        void   clear();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool   empty()                   const { return heap.empty();         }
+        uint   size()                    const { return uint(heap.size());    }
+        bool   contains(const uint id)   const { return id<pos.size() && pos[id]>=0; }
+        uint   top()                     const { return heap.front().second;  }
+        double top_key()                 const { return heap.front().first;   }
+        double key(const uint id)        const { return heap.at(pos.at(id)).first; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void   push(const uint id, const double key); // inserts id, or updates its key if already in the queue
+        uint   pop();                                 // removes and returns the id with minimum key
+        void   remove(const uint id);                 // removes id from the queue (if present)
+
+    protected:
+
+        void sift_up  (uint i);
+        void sift_down(uint i);
+
+        static const uint arity = 4;
+
+        std::vector<std::pair<double,uint>> heap; // (key,id)
+        std::vector<int>                    pos;  // position of each id in the heap (-1 if not in the queue)
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "indexed_heap.cpp"
+#endif
+
+#endif // CINO_INDEXED_HEAP_H
@@ -35,6 +35,10 @@
 *********************************************************************************/
 #include <cinolib/io/io_utilities.h>
 #include <string.h>
+#include <cctype>
+#include <cstdint>
+#include <locale>
+#include <sstream>
 
 namespace cinolib
 {
@@ -108,4 +112,102 @@ bool eat_uint(FILE * f, uint & i)
     return true;
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool seek_keyword(const char *& p, const char * end, const char * keyword)
+{
+    size_t len = strlen(keyword);
+    while(p<end)
+    {
+        while(p<end &&  isspace((unsigned char)*p)) ++p;
+        const char *word = p;
+        while(p<end && !isspace((unsigned char)*p)) ++p;
+        if(size_t(p-word)==len && strncmp(word, keyword, len)==0) return true;
+    }
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Numbers with at most 15 significant digits and a small exponent are computed with a single
+// (hence correctly rounded) floating point operation (Clinger's fast path). Anything else is
+// delegated to the standard library
+CINO_INLINE
+bool eat_double(const char *& p, const char * end, double & d)
+{
+    static const double pow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    while(p<end && isspace((unsigned char)*p)) ++p;
+    const char *s = p;
+    bool neg = false;
+    if(s<end && (*s=='-' || *s=='+')) neg = (*s++=='-');
+
+    uint64_t mantissa   = 0;
+    int      n_digits   = 0; // significant digits
+    int      exp10      = 0;
+    bool     any_digit  = false;
+    for(; s<end && isdigit((unsigned char)*s); ++s, any_digit=true)
+    {
+        if(n_digits<19) { mantissa = mantissa*10 + uint64_t(*s-'0'); if(mantissa>0) ++n_digits; }
+        else            { ++exp10; ++n_digits; }
+    }
+    if(s<end && *s=='.')
+    {
+        for(++s; s<end && isdigit((unsigned char)*s); ++s, any_digit=true)
+        {
+            if(n_digits<19) { mantissa = mantissa*10 + uint64_t(*s-'0'); if(mantissa>0) ++n_digits; --exp10; }
+            else            { ++n_digits; }
+        }
+    }
+    if(!any_digit) return false;
+    if(s<end && (*s=='e' || *s=='E'))
+    {
+        const char *e = s+1;
+        bool exp_neg  = false;
+        if(e<end && (*e=='-' || *e=='+')) exp_neg = (*e++=='-');
+        if(e<end && isdigit((unsigned char)*e))
+        {
+            int x = 0;
+            for(; e<end && isdigit((unsigned char)*e); ++e) if(x<100000) x = x*10 + (*e-'0');
+            exp10 += exp_neg ? -x : x;
+            s = e;
+        }
+    }
+
+    if(n_digits<=15 && exp10>=-22 && exp10<=22)
+    {
+        d = double(mantissa);
+        d = (exp10<0) ? d/pow10[-exp10] : d*pow10[exp10];
+        if(neg) d = -d;
+    }
+    else
+    {
+        std::istringstream ss(std::string(p,s));
+        ss.imbue(std::locale::classic());
+        ss >> d;
+    }
+    p = s;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool eat_int(const char *& p, const char * end, int & i)
+{
+    while(p<end && isspace((unsigned char)*p)) ++p;
+    const char *s = p;
+    bool neg = false;
+    if(s<end && (*s=='-' || *s=='+')) neg = (*s++=='-');
+    if(s==end || !isdigit((unsigned char)*s)) return false;
+    long x = 0;
+    for(; s<end && isdigit((unsigned char)*s); ++s) x = x*10 + (*s-'0');
+    i = int(neg ? -x : x);
+    p = s;
+    return true;
+}
+
 }
@@ -72,6 +72,26 @@ bool eat_uint(FILE * f, uint & i);
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// Same facilities, for parsing a memory buffer (e.g. a MappedFile) in the range [p,end).
+// Leading white spaces are skipped, and on success p is moved past the parsed token.
+// Numbers are parsed independently of the current locale (i.e. "." is always the decimal
+// separator), and doubles are correctly rounded, exactly as strtod would do
+
+CINO_INLINE
+bool seek_keyword(const char *& p, const char * end, const char * keyword);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool eat_double(const char *& p, const char * end, double & d);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool eat_int(const char *& p, const char * end, int & i);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -0,0 +1,94 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/io/mapped_file.h>
+#include <cstdio>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cinolib
+{
+
+CINO_INLINE
+MappedFile::MappedFile(const char * filename)
+{
+#ifndef _WIN32
+    int fd = ::open(filename, O_RDONLY);
+    if(fd<0) return;
+    struct stat st;
+    if(fstat(fd, &st)==0)
+    {
+        sz = size_t(st.st_size);
+        if(sz==0) open = true; else
+        {
+            void *p = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p!=MAP_FAILED)
+            {
+                madvise(p, sz, MADV_SEQUENTIAL);
+                ptr  = static_cast<const char*>(p);
+                open = true;
+            }
+        }
+    }
+    ::close(fd);
+#else
+    FILE *fp = fopen(filename, "rb");
+    if(!fp) return;
+    fseek(fp, 0, SEEK_END);
+    buffer.resize(size_t(ftell(fp)));
+    fseek(fp, 0, SEEK_SET);
+    open = (fread(buffer.data(), 1, buffer.size(), fp)==buffer.size());
+    fclose(fp);
+    ptr = buffer.data();
+    sz  = buffer.size();
+#endif
+    if(!open) sz = 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if(ptr!=nullptr) munmap(const_cast<char*>(ptr), sz);
+#endif
+}
+
+}
@@ -0,0 +1,113 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/io/read_CINOBIN.h>
+#include <cstdint>
+#include <iostream>
+
+namespace cinolib
+{
+
+CINO_INLINE
+CinobinFile::CinobinFile(const char * filename) : f(filename)
+{
+    if(!f.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_CINOBIN() : couldn't open input file " << filename << std::endl;
+        return;
+    }
+
+    uint32_t header[4];
+    if(f.size()<24 || strncmp(f.begin(), "CINOBIN", 8)!=0)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_CINOBIN() : " << filename << " is not a CINOBIN file" << std::endl;
+        return;
+    }
+    memcpy(header, f.begin()+8, 16);
+    if(header[1]!=0x01020304)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_CINOBIN() : " << filename << " was written on a machine with different byte order" << std::endl;
+        return;
+    }
+    if(header[0]>CINOBIN_VERSION)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_CINOBIN() : " << filename << " has version " << header[0] << " (max supported: " << CINOBIN_VERSION << ")" << std::endl;
+        return;
+    }
+    ver  = header[0];
+    type = int(header[2]);
+
+    uint n_sections = header[3];
+    if(f.size() < 24 + 48*size_t(n_sections))
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_CINOBIN() : " << filename << " is truncated" << std::endl;
+        return;
+    }
+    for(uint i=0; i<n_sections; ++i)
+    {
+        const char *entry = f.begin() + 24 + 48*size_t(i);
+        char name[32];
+        memcpy(name, entry, 32);
+        name[31] = '\0';
+        uint64_t pos[2];
+        memcpy(pos, entry+32, 16);
+        if(pos[0]>f.size() || pos[1]>f.size()-pos[0])
+        {
+            std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_CINOBIN() : " << filename << " is truncated" << std::endl;
+            table.clear();
+            return;
+        }
+        table[std::string(name)] = std::make_pair(size_t(pos[0]), size_t(pos[1]));
+    }
+    valid = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const char * CinobinFile::data(const std::string & name) const
+{
+    return f.begin() + table.at(name).first;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t CinobinFile::bytes(const std::string & name) const
+{
+    return table.at(name).second;
+}
+
+}
@@ -0,0 +1,104 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_READ_CINOBIN_H
+#define CINO_READ_CINOBIN_H
+
+#include <sys/types.h>
+#include <cstring>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <cinolib/cino_inline.h>
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/io/write_CINOBIN.h>
+
+namespace cinolib
+{
+
+/* Memory mapped view of a CINOBIN file (see write_CINOBIN.h for a description of
+ * the format). Sections can be either accessed in place, or copied into vectors
+ * with a single memcpy (no parsing is involved).
+*/
+
+class CinobinFile
+{
+    public:
+
+        explicit CinobinFile(const char * filename);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool is_open()   const { return valid;     }
+        int  mesh_type() const { return type;      }
+        uint version()   const { return ver;       }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool         has  (const std::string & name) const { return table.find(name)!=table.end(); }
+        const char * data (const std::string & name) const;
+        size_t       bytes(const std::string & name) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // returns false (and leaves v untouched) if the section does not exist
+        // or its size is not a multiple of sizeof(T)
+        template<typename T>
+        bool read(const std::string & name, std::vector<T> & v) const
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "CINOBIN sections can only store plain data");
+            if(!has(name) || bytes(name)%sizeof(T)!=0) return false;
+            v.resize(bytes(name)/sizeof(T));
+            if(!v.empty()) memcpy((void*)v.data(), data(name), bytes(name));
+            return true;
+        }
+
+    private:
+
+        MappedFile f;
+        bool       valid = false;
+        int        type  = -1;
+        uint       ver   = 0;
+        std::map<std::string,std::pair<size_t,size_t>> table; // name => (offset, size)
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "read_CINOBIN.cpp"
+#endif
+
+#endif // CINO_READ_CINOBIN_H
@@ -42,6 +42,9 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/read_OBJ.h>
+#include <cinolib/io/io_utilities.h>
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/parallel_for.h>
 #include <cinolib/to_openGL_unified_verts.h>
 #include <cinolib/string_utilities.h>
 #include <sstream>
@@ -56,16 +59,114 @@ namespace cinolib
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// https://stackoverflow.com/questions/9310327/sscanf-optional-column
+// parses a face corner in any of the forms v, v/vt, v//vn, v/vt/vn. Missing
+// (or unparsable) ids are set to zero, which is not a valid OBJ index
 //
-CINO_INLINE
-void read_point_id(char * s, int & v, int & vt, int & vn)
+static CINO_INLINE
+void read_point_id(const char *& p, const char * end, int & v, int & vt, int & vn)
+{
+    v = vt = vn = 0;
+    if(eat_int(p, end, v) && p<end && *p=='/')
+    {
+        ++p;
+        if(p<end && *p=='/') { ++p; eat_int(p, end, vn); }
+        else if(eat_int(p, end, vt) && p<end && *p=='/') { ++p; eat_int(p, end, vn); }
+    }
+    while(p<end && !isspace((unsigned char)*p)) ++p; // skip anything left of the token
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Content of a portion of an OBJ file. Polygons are flattened. Their ids are
+// global (OBJ ids are global, 1-based), except for relative (negative) ids,
+// which are stored w.r.t. the first element of the chunk and are fixed when
+// chunks are merged
+//
+struct OBJ_chunk
 {
-    v = vt = vn = -1;
-         if(sscanf(s, "%d/%d/%d", &v, &vt, &vn) == 3) { --v; --vt; --vn; }
-    else if(sscanf(s, "%d/%d",    &v, &vt     ) == 2) { --v; --vt;       }
-    else if(sscanf(s, "%d//%d",   &v, &vn     ) == 2) { --v; --vn;       }
-    else if(sscanf(s, "%d",       &v          ) == 1) { --v;             }
+    std::vector<vec3d>  pos, tex, nor;
+    std::vector<uint>   poly_pos, poly_tex, poly_nor; // flattened polygons...
+    std::vector<uint>   size_pos, size_tex, size_nor; // ...and their sizes
+    std::vector<size_t> rel_pos,  rel_tex,  rel_nor;  // relative ids in poly_xxx
+    std::vector<int>    lab;                          // per face count of groups seen so far
+    int                 n_groups = 0;
+    std::vector<std::pair<uint,std::string>> mtl;     // "mtllib"/"usemtl" lines, and #polys preceding them
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+static CINO_INLINE
+void read_OBJ_chunk(const char * beg, const char * end, OBJ_chunk & c)
+{
+    auto push_id = [](const int id, const size_t n, std::vector<uint> & poly, std::vector<size_t> & rel)
+    {
+        if(id>0) poly.push_back(uint(id-1)); else
+        if(id<0)
+        {
+            rel.push_back(poly.size());
+            poly.push_back(uint(int64_t(n)+id)); // may wrap around: fixed once offsets are known
+        }
+    };
+
+    const char *p = beg;
+    while(p<end)
+    {
+        const char *eol = (const char*)memchr(p, '\n', size_t(end-p));
+        if(eol==nullptr) eol = end;
+
+        switch(*p)
+        {
+            case 'v':
+            {
+                const char *q = p+1;
+                vec3d x(0,0,0);
+                if(q<eol && *q=='t')
+                {
+                    ++q;
+                    if(eat_double(q, eol, x[0]) && eat_double(q, eol, x[1]))
+                    {
+                        eat_double(q, eol, x[2]);
+                        c.tex.push_back(x);
+                    }
+                }
+                else if(q<eol && *q=='n')
+                {
+                    ++q;
+                    if(eat_double(q, eol, x[0]) && eat_double(q, eol, x[1]) && eat_double(q, eol, x[2])) c.nor.push_back(x);
+                }
+                else if(eat_double(q, eol, x[0]) && eat_double(q, eol, x[1]) && eat_double(q, eol, x[2])) c.pos.push_back(x);
+                break;
+            }
+
+            case 'f':
+            {
+                const char *q = p+1;
+                size_t n_pos = c.poly_pos.size();
+                size_t n_tex = c.poly_tex.size();
+                size_t n_nor = c.poly_nor.size();
+                while(true)
+                {
+                    while(q<eol && isspace((unsigned char)*q)) ++q;
+                    if(q==eol) break;
+                    int v_pos, v_tex, v_nor;
+                    read_point_id(q, eol, v_pos, v_tex, v_nor);
+                    push_id(v_pos, c.pos.size(), c.poly_pos, c.rel_pos);
+                    push_id(v_tex, c.tex.size(), c.poly_tex, c.rel_tex);
+                    push_id(v_nor, c.nor.size(), c.poly_nor, c.rel_nor);
+                }
+                if(c.poly_pos.size()>n_pos) c.size_pos.push_back(uint(c.poly_pos.size()-n_pos));
+                if(c.poly_tex.size()>n_tex) c.size_tex.push_back(uint(c.poly_tex.size()-n_tex));
+                if(c.poly_nor.size()>n_nor) c.size_nor.push_back(uint(c.poly_nor.size()-n_nor));
+                c.lab.push_back(c.n_groups);
+                break;
+            }
+
+            case 'u':
+            case 'm': c.mtl.push_back(std::make_pair(uint(c.size_pos.size()), std::string(p,eol))); break;
+            case 'g': c.n_groups++; break;
+        }
+        p = (eol<end) ? eol+1 : end;
+    }
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -132,8 +233,6 @@ void read_OBJ(const char                     * filename,
               std::string                    & specular_path, // path of the image encoding the specular texture component
               std::string                    & normal_path)   // path of the image encoding the normal   texture component
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
-
     pos.clear();
     tex.clear();
     nor.clear();
@@ -146,64 +245,111 @@ void read_OBJ(const char                     * filename,
     specular_path.clear();
     normal_path.clear();
 
-    std::ifstream f(filename);
+    MappedFile f(filename);
     if(!f.is_open())
     {
         std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_OBJ() : couldn't open input file " << filename << std::endl;
         exit(-1);
     }
 
-    int fresh_label = 0;
+    // split the file in chunks of whole lines, and parse them in parallel
+    const size_t chunk_size = 1 << 22;
+    const uint   n_chunks   = uint(std::max(size_t(1), f.size()/chunk_size));
+    std::vector<const char*> chunk_beg(n_chunks+1, f.end());
+    chunk_beg.front() = f.begin();
+    for(uint i=1; i<n_chunks; ++i)
+    {
+        const char *p = std::max(chunk_beg.at(i-1), f.begin() + i*chunk_size);
+        while(p<f.end() && *p!='\n') ++p;
+        chunk_beg.at(i) = (p<f.end()) ? p+1 : f.end();
+    }
+    std::vector<OBJ_chunk> chunks(n_chunks);
+    PARALLEL_FOR(0, n_chunks, 2, 1, [&](const uint i)
+    {
+        read_OBJ_chunk(chunk_beg.at(i), chunk_beg.at(i+1), chunks.at(i));
+    });
+
+    // merge chunks: vertices and polygons are concatenated in order, relative
+    // ids are offset by the number of elements in all previous chunks
+    uint n_pos = 0, n_tex = 0, n_nor = 0;
+    uint n_poly_pos = 0, n_poly_tex = 0, n_poly_nor = 0;
+    uint n_lab = 0;
+    std::vector<uint> off_pos(n_chunks), off_tex(n_chunks), off_nor(n_chunks);
+    std::vector<uint> off_poly_pos(n_chunks), off_poly_tex(n_chunks), off_poly_nor(n_chunks);
+    std::vector<uint> off_lab(n_chunks);
+    std::vector<int>  off_group(n_chunks);
+    int n_groups = 0;
+    for(uint i=0; i<n_chunks; ++i)
+    {
+        const OBJ_chunk & c = chunks.at(i);
+        off_pos.at(i)      = n_pos;      n_pos      += uint(c.pos.size());
+        off_tex.at(i)      = n_tex;      n_tex      += uint(c.tex.size());
+        off_nor.at(i)      = n_nor;      n_nor      += uint(c.nor.size());
+        off_poly_pos.at(i) = n_poly_pos; n_poly_pos += uint(c.size_pos.size());
+        off_poly_tex.at(i) = n_poly_tex; n_poly_tex += uint(c.size_tex.size());
+        off_poly_nor.at(i) = n_poly_nor; n_poly_nor += uint(c.size_nor.size());
+        off_lab.at(i)      = n_lab;      n_lab      += uint(c.lab.size());
+        off_group.at(i)    = n_groups;   n_groups   += c.n_groups;
+    }
+    pos.resize(n_pos);
+    tex.resize(n_tex);
+    nor.resize(n_nor);
+    poly_pos.resize(n_poly_pos);
+    poly_tex.resize(n_poly_tex);
+    poly_nor.resize(n_poly_nor);
+    poly_lab.resize(n_lab);
+
+    auto unflatten = [](const std::vector<uint>             & flat,
+                        const std::vector<uint>             & sizes,
+                              std::vector<size_t>           & rel,
+                        const uint                            off,
+                              std::vector<std::vector<uint>>::iterator polys)
+    {
+        auto rel_it = rel.begin();
+        size_t i = 0;
+        for(uint s : sizes)
+        {
+            std::vector<uint> & p = *polys++;
+            p.assign(flat.begin()+i, flat.begin()+i+s);
+            for(; rel_it!=rel.end() && *rel_it<i+s; ++rel_it) p.at(*rel_it-i) += off;
+            i += s;
+        }
+    };
+
+    PARALLEL_FOR(0, n_chunks, 2, 1, [&](const uint i)
+    {
+        OBJ_chunk & c = chunks.at(i);
+        std::copy(c.pos.begin(), c.pos.end(), pos.begin()+off_pos.at(i));
+        std::copy(c.tex.begin(), c.tex.end(), tex.begin()+off_tex.at(i));
+        std::copy(c.nor.begin(), c.nor.end(), nor.begin()+off_nor.at(i));
+        unflatten(c.poly_pos, c.size_pos, c.rel_pos, off_pos.at(i), poly_pos.begin()+off_poly_pos.at(i));
+        unflatten(c.poly_tex, c.size_tex, c.rel_tex, off_tex.at(i), poly_tex.begin()+off_poly_tex.at(i));
+        unflatten(c.poly_nor, c.size_nor, c.rel_nor, off_nor.at(i), poly_nor.begin()+off_poly_nor.at(i));
+        for(uint j=0; j<c.lab.size(); ++j) poly_lab.at(off_lab.at(i)+j) = off_group.at(i) + c.lab.at(j);
+        auto mtl = std::move(c.mtl);
+        c = OBJ_chunk(); // release memory asap, keeping only materials
+        c.mtl = std::move(mtl);
+    });
+
+    // materials are resolved sequentially, as "mtllib" and "usemtl" lines
+    // affect all polygons that follow them in the file
     std::map<std::string,Color> color_map;
     Color curr_color = Color::WHITE();     // set WHITE as default color
     bool has_per_face_color = false;
-    bool has_groups         = false;
+    bool has_groups         = (n_groups>0);
 
-    std::string line;
-    while(std::getline(f,line))
+    poly_col.reserve(n_poly_pos);
+    for(uint i=0; i<n_chunks; ++i)
     {
-        switch(line[0])
+        for(const auto & e : chunks.at(i).mtl)
         {
-            case 'v':
-            {
-                // http://stackoverflow.com/questions/16839658/printf-width-specifier-to-maintain-precision-of-floating-point-value
-                //
-                double a, b, c;
-                     if(sscanf(line.data(), "v  %lf %lf %lf", &a, &b, &c) == 3) pos.push_back(vec3d(a,b,c));
-                else if(sscanf(line.data(), "vt %lf %lf %lf", &a, &b, &c) == 3) tex.push_back(vec3d(a,b,c));
-                else if(sscanf(line.data(), "vt %lf %lf %lf", &a, &b, &c) == 2) tex.push_back(vec3d(a,b,0));
-                else if(sscanf(line.data(), "vn %lf %lf %lf", &a, &b, &c) == 3) nor.push_back(vec3d(a,b,c));
-                break;
-            }
+            poly_col.resize(off_poly_pos.at(i)+e.first, curr_color);
+            const char *line = e.second.c_str();
 
-            case 'f':
-            {
-                line = line.substr(1,line.size()-1); // discard the 'f' letter
-                std::istringstream ss(line);
-                std::vector<uint> p_pos, p_tex, p_nor;
-                for(std::string sub_str; ss >> sub_str;)
-                {
-                    int v_pos, v_tex, v_nor;
-                    read_point_id(strdup(sub_str.c_str()), v_pos, v_tex, v_nor);
-                    if (v_pos >= 0) p_pos.push_back(v_pos);
-                    if (v_tex >= 0) p_tex.push_back(v_tex);
-                    if (v_nor >= 0) p_nor.push_back(v_nor);
-                }
-                if (!p_tex.empty()) poly_tex.push_back(p_tex);
-                if (!p_nor.empty()) poly_nor.push_back(p_nor);
-                if (!p_pos.empty())
-                {
-                    poly_pos.push_back(p_pos);
-                    poly_col.push_back(curr_color);
-                }
-                poly_lab.push_back(fresh_label);
-                break;
-            }
-
-            case 'u':
+            if(line[0]=='u')
             {
                 char mat_c[1024];
-                if (sscanf(line.data(), "usemtl %s", mat_c) == 1)
+                if (sscanf(line, "usemtl %1023s", mat_c) == 1)
                 {
                     auto query = color_map.find(std::string(mat_c));
                     if (query != color_map.end())
@@ -212,13 +358,11 @@ void read_OBJ(const char                     * filename,
                     }
                     else std::cerr << "WARNING: could not find material: " << mat_c << std::endl;
                 }
-                break;
             }
-
-            case 'm':
+            else
             {
                 char mtu_c[1024];
-                if(sscanf(line.data(), "mtllib %[^\n]s", mtu_c) == 1)
+                if(sscanf(line, "mtllib %1023[^\n]s", mtu_c) == 1)
                 {
                     std::string s0(filename);
                     std::string s1(mtu_c);
@@ -236,18 +380,10 @@ void read_OBJ(const char                     * filename,
                         has_per_face_color = true;
                     }
                 }
-                break;
-            }
-
-            case 'g':
-            {
-                has_groups = true;
-                fresh_label++;
-                break;
             }
         }
     }
-    f.close();
+    poly_col.resize(n_poly_pos, curr_color);
 
     if(!has_per_face_color) poly_col.clear();
     if(!has_groups)         poly_lab.clear();
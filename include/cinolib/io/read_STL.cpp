@@ -43,11 +43,193 @@
 *********************************************************************************/
 #include <cinolib/io/read_STL.h>
 #include <cinolib/io/io_utilities.h>
-#include <map>
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/parallel_for.h>
+#include <cinolib/vertex_clustering.h>
+#include <chrono>
+#include <cstring>
 
 namespace cinolib
 {
 
+// https://en.wikipedia.org/wiki/STL_(file_format)
+//
+// In Thingi10K some binary files start with the "solid" keyword as ASCII files do, hence
+// the header cannot be trusted. A file is binary if its size matches the number of triangles
+// written at byte 80, and ASCII if this does not happen and it starts with "solid"
+static CINO_INLINE
+bool STL_is_binary(const MappedFile & f)
+{
+    if(f.size()>=84)
+    {
+        uint32_t nt;
+        memcpy(&nt, f.begin()+80, 4);
+        if(f.size()==84+50*size_t(nt)) return true;
+    }
+    const char *p = f.begin();
+    while(p<f.end() && isspace((unsigned char)*p)) ++p;
+    return !(size_t(f.end()-p)>=5 && strncmp(p, "solid", 5)==0);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+static CINO_INLINE
+void STL_parse_binary(const MappedFile       & f,
+                            std::vector<vec3d> & normals,
+                            std::vector<vec3d> & soup)
+{
+    uint32_t nt = 0;
+    if(f.size()>=84) memcpy(&nt, f.begin()+80, 4);
+    if(84+50*size_t(nt)>f.size())
+    {
+        std::cerr << "WARNING : " << __FILE__ << ", line " << __LINE__ << " : load_STL() : truncated file" << std::endl;
+        nt = uint32_t((f.size()<84) ? 0 : (f.size()-84)/50);
+    }
+
+    // each triangle is 50 bytes: normal, three vertices (12 floats) and a 2 bytes attribute
+    normals.resize(nt);
+    soup.resize(3*size_t(nt));
+    PARALLEL_FOR(0, nt, 10000, [&](const uint i)
+    {
+        float data[12];
+        memcpy(data, f.begin()+84+50*size_t(i), 48);
+        normals[i] = vec3d(data[0], data[1], data[2]);
+        for(uint j=0; j<3; ++j) soup[3*i+j] = vec3d(data[3+3*j], data[4+3*j], data[5+3*j]);
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// the file is split in chunks, which are parsed in parallel. Each facet is
+// parsed by the chunk containing its "facet" keyword, even if it spans across
+// multiple chunks. Partial results are finally concatenated in order
+static CINO_INLINE
+void STL_parse_ASCII(const MappedFile       & f,
+                           std::vector<vec3d> & normals,
+                           std::vector<vec3d> & soup)
+{
+    // skip the first line ("solid name"), as the name may contain any keyword
+    const char *body = f.begin();
+    while(body<f.end() && *body!='\n') ++body;
+
+    const size_t chunk_size = 1 << 22;
+    const uint   n_chunks   = uint(std::max(size_t(1), size_t(f.end()-body)/chunk_size));
+    std::vector<std::vector<vec3d>> chunk_normals(n_chunks);
+    std::vector<std::vector<vec3d>> chunk_soup(n_chunks);
+
+    PARALLEL_FOR(0, n_chunks, 2, 1, [&](const uint c)
+    {
+        const char *chunk_beg = body + c*chunk_size;
+        const char *chunk_end = (c==n_chunks-1) ? f.end() : chunk_beg + chunk_size;
+        const char *p         = chunk_beg;
+        if(c>0 && !isspace((unsigned char)p[-1]))
+        {
+            while(p<f.end() && !isspace((unsigned char)*p)) ++p; // belongs to the previous chunk
+        }
+        while(seek_keyword(p, f.end(), "facet") && p-5<chunk_end)
+        {
+            vec3d n;
+            if(!seek_keyword(p, f.end(), "normal") ||
+               !eat_double(p, f.end(), n.x())      ||
+               !eat_double(p, f.end(), n.y())      ||
+               !eat_double(p, f.end(), n.z()))
+            {
+                assert(false && "could not parse facet normal");
+                break;
+            }
+            chunk_normals[c].push_back(n);
+            for(uint i=0; i<3; ++i)
+            {
+                vec3d v;
+                if(!seek_keyword(p, f.end(), "vertex") ||
+                   !eat_double(p, f.end(), v.x())      ||
+                   !eat_double(p, f.end(), v.y())      ||
+                   !eat_double(p, f.end(), v.z()))
+                {
+                    assert(false && "could not parse facet vertex");
+                }
+                chunk_soup[c].push_back(v);
+            }
+        }
+    });
+
+    size_t n_facets = 0;
+    for(const auto & n : chunk_normals) n_facets += n.size();
+    normals.reserve(n_facets);
+    soup.reserve(3*n_facets);
+    for(uint c=0; c<n_chunks; ++c)
+    {
+        normals.insert(normals.end(), chunk_normals[c].begin(), chunk_normals[c].end());
+        soup.insert(soup.end(), chunk_soup[c].begin(), chunk_soup[c].end());
+        std::vector<vec3d>().swap(chunk_normals[c]);
+        std::vector<vec3d>().swap(chunk_soup[c]);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// open addressing hash table (linear probing) storing vertex ids. Hash
+// keys are computed in parallel, whereas insertions are sequential, so
+// that ids are assigned in order of first appearance
+static CINO_INLINE
+void STL_merge_duplicated_verts(const std::vector<vec3d> & soup,
+                                      std::vector<vec3d> & verts,
+                                      std::vector<uint>  & tris)
+{
+    auto hash = [](const vec3d & v) -> uint64_t
+    {
+        uint64_t h = 0;
+        for(uint i=0; i<3; ++i)
+        {
+            double   d = v[i] + 0.0; // maps -0 to +0, as they compare equal
+            uint64_t b;
+            memcpy(&b, &d, 8);
+            h = (h ^ b) * 0x9E3779B97F4A7C15ull;
+            h ^= h >> 29;
+        }
+        return h;
+    };
+
+    uint n = uint(soup.size());
+    std::vector<uint64_t> soup_hash(n);
+    PARALLEL_FOR(0, n, 10000, [&](const uint i)
+    {
+        soup_hash[i] = hash(soup[i]);
+    });
+
+    uint64_t          mask = 1023;
+    std::vector<uint> table;
+    auto rehash = [&](const uint64_t size)
+    {
+        mask = size-1;
+        table.assign(size, UINT32_MAX);
+        for(uint vid=0; vid<verts.size(); ++vid)
+        {
+            uint64_t h = hash(verts[vid]) & mask;
+            while(table[h]!=UINT32_MAX) h = (h+1) & mask;
+            table[h] = vid;
+        }
+    };
+    while(mask+1 < 2*uint64_t(n/6+1)) mask = 2*mask+1; // closed meshes have #verts ~= #corners/6
+    rehash(mask+1);
+
+    tris.resize(n);
+    for(uint i=0; i<n; ++i)
+    {
+        uint64_t h = soup_hash[i] & mask;
+        while(table[h]!=UINT32_MAX && !(verts[table[h]]==soup[i])) h = (h+1) & mask;
+        if(table[h]==UINT32_MAX)
+        {
+            tris[i] = table[h] = uint(verts.size());
+            verts.push_back(soup[i]);
+            if(2*verts.size() > mask+1) rehash(2*(mask+1)); // keep load factor below 0.5
+        }
+        else tris[i] = table[h];
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 void read_STL(const char         * filename,
               std::vector<vec3d> & verts,
@@ -67,134 +249,64 @@ void read_STL(const char         * filename,
               std::vector<uint>  & tris,
               const bool           merge_duplicated_verts)
 {
-    // https://en.wikipedia.org/wiki/STL_(file_format)
+    read_STL(filename, verts, normals, tris, merge_duplicated_verts, 0.0);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void read_STL(const char         * filename,
+              std::vector<vec3d> & verts,
+              std::vector<vec3d> & normals,
+              std::vector<uint>  & tris,
+              const bool           merge_duplicated_verts,
+              const double         merge_eps,
+              const bool           verbose)
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
 
     verts.clear();
     normals.clear();
     tris.clear();
 
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
-
-    FILE *fp = fopen(filename, "r");
-    if(!fp)
+    MappedFile f(filename);
+    if(!f.is_open())
     {
         std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_STL() : couldn't open input file " << filename << std::endl;
         exit(-1);
     }
 
-    std::map<vec3d,uint> vmap;
+    std::vector<vec3d> soup; // three vertices per triangle
+    if(STL_is_binary(f)) STL_parse_binary(f, normals, soup);
+    else                 STL_parse_ASCII (f, normals, soup);
 
-    /* This is a horrible trick to cope with the fact that in Thingi10K
-     * binary files start with the header of ASCII files even if they shouldn't.
-     * As a result it becomes messy to figure out whether a file is binary or not.
-     * I assume it is, then I try to parse it as if it was ASCII first, and if I fail
-     * then I know that is indeed binary.
-    */
-    bool is_binary = true;
-
-    if(seek_keyword(fp, "solid")) // ASCII file
+    if(merge_duplicated_verts)
     {
-        while(seek_keyword(fp, "facet"))
+        STL_merge_duplicated_verts(soup, verts, tris);
+        if(merge_eps>0)
         {
-            is_binary = false;
-
-            vec3d n;
-            if(!seek_keyword(fp, "normal")) assert(false && "could not find keyword NORMAL");
-            if(!eat_double(fp, n.x()))      assert(false && "could not parse x coord");
-            if(!eat_double(fp, n.y()))      assert(false && "could not parse y coord");
-            if(!eat_double(fp, n.z()))      assert(false && "could not parse z coord");
-            normals.push_back(n);
-
-            if(!seek_keyword(fp, "outer")) assert(false && "could not find keyword OUTER");
-            if(!seek_keyword(fp, "loop"))  assert(false && "could not find keyword LOOP");
-            for(int i=0; i<3; ++i)
-            {
-                vec3d v;
-                if(!seek_keyword(fp, "vertex")) assert(false && "could not find keyword VERTEX");
-                if(!eat_double(fp, v.x()))      assert(false && "could not parse x coord");
-                if(!eat_double(fp, v.y()))      assert(false && "could not parse y coord");
-                if(!eat_double(fp, v.z()))      assert(false && "could not parse z coord");
-
-                if(merge_duplicated_verts)
-                {
-                    auto it = vmap.find(v);
-                    if(it == vmap.end())
-                    {
-                        uint fresh_id = uint(vmap.size());
-                        vmap[v] = fresh_id;
-                        verts.push_back(v);
-                        tris.push_back(fresh_id);
-                    }
-                    else tris.push_back(it->second);
-                }
-                else
-                {
-                    tris.push_back(uint(verts.size()));
-                    verts.push_back(v);
-                }
-            }
-            if(!seek_keyword(fp, "endloop"))  assert(false && "could not find keyword ENDLOOP");
-            if(!seek_keyword(fp, "endfacet")) assert(false && "could not find keyword ENDFACET");
+            std::vector<uint> cluster;
+            uint n_clusters = vertex_clustering(verts, merge_eps, cluster);
+            std::vector<vec3d> tmp(n_clusters);
+            for(uint vid=verts.size(); vid-->0;) tmp[cluster[vid]] = verts[vid]; // first vertex wins
+            for(uint & vid : tris) vid = cluster[vid];
+            verts.swap(tmp);
         }
     }
-    fclose(fp);
-
-    if(is_binary)
+    else
     {
-        // open the file in binary mode
-        FILE *fp = fopen(filename, "rb");
-        if(!fp)
-        {
-            std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_STL() : couldn't open input file " << filename << std::endl;
-            exit(-1);
-        }
-
-        // read header
-        char header[80];
-        if(fread(header, 1, 80, fp)!=80) assert(false && "error reading STL binary header");
-
-        // read triangles
-        unsigned int nt;
-        if(fread(&nt, sizeof(unsigned int), 1, fp)!=1) assert(false && "error reading number of triangles");
-        for(unsigned int i=0; i<nt; ++i)
-        {
-            // read normal
-            float nf[3];
-            if(fread(&nf, sizeof(float), 3, fp)!=3) assert(false && "error reading normal");
-            vec3d n(nf[0], nf[1], nf[2]);
-            normals.push_back(n);
-
-            // read verts
-            for(int j=0; j<3; ++j)
-            {
-                float vf[3];
-                if(fread(&vf, sizeof(float), 3, fp)!=3) assert(false && "error reading vertex");
-
-                vec3d v(vf[0], vf[1], vf[2]);                
-                if(merge_duplicated_verts)
-                {
-                    auto it = vmap.find(v);
-                    if(it == vmap.end())
-                    {
-                        uint fresh_id = uint(vmap.size());
-                        vmap[v] = fresh_id;
-                        verts.push_back(v);
-                        tris.push_back(fresh_id);
-                    }
-                    else tris.push_back(it->second);
-                }
-                else
-                {
-                    tris.push_back(uint(verts.size()));
-                    verts.push_back(v);
-                }
-            }
+        verts.swap(soup);
+        tris.resize(verts.size());
+        for(uint i=0; i<tris.size(); ++i) tris[i] = i;
+    }
 
-            // read (and discard) attribute
-            unsigned short attribute;
-            if(fread(&attribute, sizeof(unsigned short), 1, fp)!=1) assert(false && "error reading attribute");
-        }
-        fclose(fp);
+    if(verbose)
+    {
+        Time::time_point t1 = Time::now();
+        double secs = std::chrono::duration<double>(t1-t0).count();
+        double MB   = double(f.size())/(1024*1024);
+        std::cout << "read STL\t" << MB << "MB [" << secs << "s, " << MB/secs << "MB/s]" << std::endl;
     }
 }
 
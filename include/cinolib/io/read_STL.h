@@ -42,6 +42,11 @@
 namespace cinolib
 {
 
+/* Binary files are memory mapped and decoded in parallel. ASCII files are split in chunks
+ * which are tokenized in parallel. Duplicated vertices are merged with a hash table, and
+ * vertex ids are assigned in order of first appearance in the file.
+*/
+
 CINO_INLINE
 void read_STL(const char         * filename,
               std::vector<vec3d> & verts,
@@ -56,6 +61,21 @@ void read_STL(const char         * filename,
               std::vector<vec3d> & normals,
               std::vector<uint>  & tris,
               const bool           merge_duplicated_verts = true);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// if merge_eps is positive, vertices closer than merge_eps are merged too (transitively).
+// Each group of merged vertices is placed where its first vertex (in file order) was.
+// If verbose is true, the parsing throughput (MB/s) is printed
+//
+CINO_INLINE
+void read_STL(const char         * filename,
+              std::vector<vec3d> & verts,
+              std::vector<vec3d> & normals,
+              std::vector<uint>  & tris,
+              const bool           merge_duplicated_verts,
+              const double         merge_eps,
+              const bool           verbose = false);
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -34,161 +34,384 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/read_VTK.h>
-
-#ifdef CINOLIB_USES_VTK
-#include <vtkGenericDataObjectReader.h>
-#include <vtkSmartPointer.h>
-#include <vtkPolyData.h>
-#include <string>
-#endif
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/io/io_utilities.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 
 namespace cinolib
 {
 
-#ifdef CINOLIB_USES_VTK
+namespace
+{
 
+// tokens of the next non empty line. On return p points to the beginning of the line after
+//
 CINO_INLINE
-void read_VTK(const char                      * filename,
-               std::vector<vec3d>             & verts,
-               std::vector<std::vector<uint>> & poly)
+bool next_line(const char *& p, const char * end, std::vector<std::string> & tokens)
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
+    tokens.clear();
+    while(p<end && tokens.empty())
+    {
+        const char *eol = static_cast<const char*>(memchr(p, '\n', size_t(end-p)));
+        if(eol==nullptr) eol = end;
+        const char *s = p;
+        while(s<eol)
+        {
+            while(s<eol &&  isspace((unsigned char)*s)) ++s;
+            const char *e = s;
+            while(e<eol && !isspace((unsigned char)*e)) ++e;
+            if(e>s) tokens.push_back(std::string(s,e));
+            s = e;
+        }
+        p = (eol<end) ? eol+1 : end;
+    }
+    return !tokens.empty();
+}
 
-    vtkSmartPointer<vtkGenericDataObjectReader> reader = vtkSmartPointer<vtkGenericDataObjectReader>::New();
-    reader->SetFileName(filename);
-    reader->Update();
-    vtkSmartPointer<vtkUnstructuredGrid> grid(reader->GetUnstructuredGridOutput());
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<grid->GetNumberOfPoints(); ++i)
-    {
-        double pnt[3];
-        grid->GetPoint(i, pnt);
+CINO_INLINE
+std::string to_upper(std::string s)
+{
+    for(char & c : s) c = char(toupper((unsigned char)c));
+    return s;
+}
 
-        verts.push_back(vec3d(pnt[0],pnt[1],pnt[2]));
-    }
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<grid->GetNumberOfCells(); ++i)
+// reads n values of the given type. Binary data starts at p (i.e. right after
+// the line introducing it) and is always big endian
+//
+template<typename T>
+CINO_INLINE
+bool read_values(const char *& p, const char * end, const size_t n, const std::string & type, const bool binary, std::vector<T> & out)
+{
+    out.resize(n);
+    if(!binary)
     {
-        vtkCell *c = grid->GetCell(i);
-
-        std::vector<uint> polyhedron;
-        switch (c->GetCellType())
+        double d;
+        for(size_t i=0; i<n; ++i)
         {
-            case VTK_TETRA:      for(uint j=0; j<4; ++j) polyhedron.push_back(c->GetPointId(j)); break;
-            case VTK_HEXAHEDRON: for(uint j=0; j<8; ++j) polyhedron.push_back(c->GetPointId(j)); break;
+            if(!eat_double(p, end, d)) return false;
+            out[i] = static_cast<T>(d);
         }
+        return true;
+    }
+    uint size = vtk_type_size(type);
+    if(size==0 || size_t(end-p)<n*size) return false;
+    vtk_convert<T>(type, reinterpret_cast<const uint8_t*>(p), n, host_is_little_endian(), out.data());
+    p += n*size;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        if(!polyhedron.empty()) poly.push_back(polyhedron);
+CINO_INLINE
+void skip_metadata(const char *& p, const char * end)
+{
+    // METADATA blocks end with an empty line
+    while(p<end)
+    {
+        const char *eol = static_cast<const char*>(memchr(p, '\n', size_t(end-p)));
+        if(eol==nullptr) { p = end; return; }
+        bool empty = true;
+        for(const char *s=p; s<eol; ++s) if(!isspace((unsigned char)*s)) { empty = false; break; }
+        p = eol+1;
+        if(empty) return;
     }
 }
 
+}
+
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void read_VTK(const char                      * filename,
-               std::vector<double>            & xyz,
-               std::vector<std::vector<uint>> & poly)
+bool read_VTK(const char * filename,
+              VTKGrid    & grid)
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
+    grid.clear();
+
+    MappedFile file(filename);
+    if(!file.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_VTK() : couldn't open input file " << filename << std::endl;
+        return false;
+    }
 
-    vtkSmartPointer<vtkGenericDataObjectReader> reader = vtkSmartPointer<vtkGenericDataObjectReader>::New();
-    reader->SetFileName(filename);
-    reader->Update();
-    vtkSmartPointer<vtkUnstructuredGrid> grid(reader->GetUnstructuredGridOutput());
+    const char *p   = file.begin();
+    const char *end = file.end();
+    std::vector<std::string> tk;
 
-    for(uint i=0; i<grid->GetNumberOfPoints(); ++i)
+    auto error = [&](const char * msg)
     {
-        double pnt[3];
-        grid->GetPoint(i, pnt);
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_VTK() : " << msg << " (" << filename << ")" << std::endl;
+        grid.clear();
+        return false;
+    };
+
+    // header: version, title, file type, dataset type
+    if(!next_line(p, end, tk) || tk.at(0).at(0)!='#') return error("not a legacy VTK file");
+    const char *eol = static_cast<const char*>(memchr(p, '\n', size_t(end-p))); // title may be empty
+    p = (eol!=nullptr) ? eol+1 : end;
+    if(!next_line(p, end, tk)) return error("missing file type");
+    bool binary = (to_upper(tk.at(0))=="BINARY");
+    if(!next_line(p, end, tk) || tk.size()<2 || to_upper(tk.at(1))!="UNSTRUCTURED_GRID") return error("not an unstructured grid");
+
+    std::vector<int64_t>   cells;       // classic layout: [n, ids...] for each cell
+    std::vector<int64_t>   offsets;     // 5.1 layout
+    std::vector<VTKArray>* data  = nullptr;
+    size_t                 n_elems = 0;
+
+    // binary data starts right after the line that introduces it
+    while(next_line(p, end, tk))
+    {
+        std::string kw = to_upper(tk.at(0));
 
-        xyz.push_back(pnt[0]);
-        xyz.push_back(pnt[1]);
-        xyz.push_back(pnt[2]);
+        if(kw=="POINTS" && tk.size()>=3)
+        {
+            std::vector<double> xyz;
+            if(!read_values(p, end, 3*size_t(atoll(tk.at(1).c_str())), tk.at(2), binary, xyz)) return error("bad POINTS");
+            grid.verts.resize(xyz.size()/3);
+            for(size_t i=0; i<grid.verts.size(); ++i) grid.verts[i] = vec3d(xyz[3*i], xyz[3*i+1], xyz[3*i+2]);
+        }
+        else if(kw=="CELLS" && tk.size()>=3)
+        {
+            size_t a = size_t(atoll(tk.at(1).c_str()));
+            size_t b = size_t(atoll(tk.at(2).c_str()));
+            const char *q = p;
+            std::vector<std::string> next;
+            if(next_line(q, end, next) && to_upper(next.at(0))=="OFFSETS")
+            {
+                // version 5.1: OFFSETS (a values) followed by CONNECTIVITY (b values)
+                if(next.size()<2 || !read_values(q, end, a, next.at(1), binary, offsets)) return error("bad OFFSETS");
+                if(!next_line(q, end, next) || to_upper(next.at(0))!="CONNECTIVITY" || next.size()<2 ||
+                   !read_values(q, end, b, next.at(1), binary, grid.conn)) return error("bad CONNECTIVITY");
+                p = q;
+            }
+            else if(!read_values(p, end, b, "int", binary, cells)) return error("bad CELLS");
+        }
+        else if(kw=="CELL_TYPES" && tk.size()>=2)
+        {
+            std::vector<int> types;
+            if(!read_values(p, end, size_t(atoll(tk.at(1).c_str())), "int", binary, types)) return error("bad CELL_TYPES");
+            grid.types.assign(types.begin(), types.end());
+        }
+        else if((kw=="POINT_DATA" || kw=="CELL_DATA") && tk.size()>=2)
+        {
+            data    = (kw=="POINT_DATA") ? &grid.point_data : &grid.cell_data;
+            n_elems = size_t(atoll(tk.at(1).c_str()));
+        }
+        else if(data!=nullptr && (kw=="SCALARS" || kw=="VECTORS" || kw=="NORMALS" || kw=="TENSORS") && tk.size()>=3)
+        {
+            VTKArray a;
+            a.name    = tk.at(1);
+            a.n_comps = (kw=="VECTORS" || kw=="NORMALS") ? 3 : (kw=="TENSORS") ? 9 : 1;
+            if(kw=="SCALARS" && tk.size()>=4) a.n_comps = uint(std::max(1, atoi(tk.at(3).c_str())));
+            if(kw=="SCALARS")
+            {
+                // the lookup table is optional
+                const char *q = p;
+                std::vector<std::string> next;
+                if(next_line(q, end, next) && to_upper(next.at(0))=="LOOKUP_TABLE") p = q;
+            }
+            if(!read_values(p, end, n_elems*a.n_comps, tk.at(2), binary, a.values)) return error("bad attribute");
+            data->push_back(a);
+        }
+        else if(data!=nullptr && kw=="TEXTURE_COORDINATES" && tk.size()>=4)
+        {
+            VTKArray a;
+            a.name    = tk.at(1);
+            a.n_comps = uint(std::max(1, atoi(tk.at(2).c_str())));
+            if(!read_values(p, end, n_elems*a.n_comps, tk.at(3), binary, a.values)) return error("bad TEXTURE_COORDINATES");
+            data->push_back(a);
+        }
+        else if(data!=nullptr && kw=="COLOR_SCALARS" && tk.size()>=3)
+        {
+            VTKArray a;
+            a.name    = tk.at(1);
+            a.n_comps = uint(std::max(1, atoi(tk.at(2).c_str())));
+            if(!read_values(p, end, n_elems*a.n_comps, binary ? "unsigned_char" : "float", binary, a.values)) return error("bad COLOR_SCALARS");
+            if(binary) for(double & d : a.values) d /= 255.0;
+            data->push_back(a);
+        }
+        else if(kw=="FIELD" && tk.size()>=3)
+        {
+            int n_arrays = atoi(tk.at(2).c_str());
+            for(int i=0; i<n_arrays; ++i)
+            {
+                if(!next_line(p, end, tk)) return error("bad FIELD");
+                if(to_upper(tk.at(0))=="METADATA") { skip_metadata(p, end); --i; continue; }
+                if(tk.size()<4) return error("bad FIELD");
+                VTKArray a;
+                a.name    = tk.at(0);
+                a.n_comps = uint(std::max(1, atoi(tk.at(1).c_str())));
+                size_t n  = size_t(atoll(tk.at(2).c_str()));
+                if(!read_values(p, end, n*a.n_comps, tk.at(3), binary, a.values)) return error("bad FIELD array");
+                if(data!=nullptr && n==n_elems) data->push_back(a);
+            }
+        }
+        else if(kw=="LOOKUP_TABLE" && tk.size()>=3)
+        {
+            std::vector<double> table;
+            size_t n = 4*size_t(atoll(tk.at(2).c_str()));
+            if(!read_values(p, end, n, binary ? "unsigned_char" : "float", binary, table)) return error("bad LOOKUP_TABLE");
+        }
+        else if(kw=="METADATA")
+        {
+            skip_metadata(p, end);
+        }
     }
 
-    for(uint i=0; i<grid->GetNumberOfCells(); ++i)
+    // assemble cells
+    if(!offsets.empty())
     {
-        vtkCell *c = grid->GetCell(i);
-
-        std::vector<uint> polyhedron;
-        switch (c->GetCellType())
+        grid.offsets.assign(offsets.begin()+1, offsets.end());
+        for(size_t cid=0; cid<grid.types.size() && cid<grid.offsets.size(); ++cid)
         {
-            case VTK_TETRA:      for(uint j=0; j<4; ++j) polyhedron.push_back(c->GetPointId(j)); break;
-            case VTK_HEXAHEDRON: for(uint j=0; j<8; ++j) polyhedron.push_back(c->GetPointId(j)); break;
+            if(grid.types.at(cid)==VTK_CELL_POLYHEDRON)
+            {
+                std::cerr << "WARNING : read_VTK() : polyhedral cells in the OFFSETS/CONNECTIVITY layout are not supported and will be skipped" << std::endl;
+                break;
+            }
         }
+    }
+    else
+    {
+        bool has_polyhedra = (std::find(grid.types.begin(), grid.types.end(), uint8_t(VTK_CELL_POLYHEDRON))!=grid.types.end());
+        if(has_polyhedra) grid.face_offsets.reserve(grid.types.size());
+        size_t pos = 0;
+        for(size_t cid=0; cid<grid.types.size(); ++cid)
+        {
+            if(pos>=cells.size()) return error("CELLS and CELL_TYPES do not match");
+            size_t n = size_t(cells.at(pos++));
+            if(pos+n>cells.size()) return error("bad CELLS");
+            if(grid.types.at(cid)==VTK_CELL_POLYHEDRON)
+            {
+                // the cell is encoded as a face stream. The vertex list
+                // of the cell is made of the (unique) face vertices
+                size_t beg = grid.conn.size();
+                grid.faces.insert(grid.faces.end(), cells.begin()+pos, cells.begin()+pos+n);
+                size_t q  = pos;
+                size_t nf = size_t(cells.at(q++));
+                for(size_t i=0; i<nf && q<pos+n; ++i)
+                {
+                    size_t nv = size_t(cells.at(q++));
+                    for(size_t j=0; j<nv && q<pos+n; ++j) grid.conn.push_back(uint(cells.at(q++)));
+                }
+                std::sort(grid.conn.begin()+beg, grid.conn.end());
+                grid.conn.erase(std::unique(grid.conn.begin()+beg, grid.conn.end()), grid.conn.end());
+                grid.face_offsets.push_back(int64_t(grid.faces.size()));
+            }
+            else
+            {
+                grid.conn.insert(grid.conn.end(), cells.begin()+pos, cells.begin()+pos+n);
+                if(has_polyhedra) grid.face_offsets.push_back(-1);
+            }
+            grid.offsets.push_back(grid.conn.size());
+            pos += n;
+        }
+    }
 
-        if(!polyhedron.empty()) poly.push_back(polyhedron);
+    if(grid.offsets.size()!=grid.types.size() || (!grid.offsets.empty() && grid.offsets.back()>grid.conn.size()))
+    {
+        return error("inconsistent unstructured grid");
     }
+
+    // drop attributes that do not match the number of points/cells
+    auto bad_array = [](size_t n) { return [n](const VTKArray & a) { return a.values.size()!=n*a.n_comps; }; };
+    grid.point_data.erase(std::remove_if(grid.point_data.begin(), grid.point_data.end(), bad_array(grid.verts.size())), grid.point_data.end());
+    grid.cell_data.erase (std::remove_if(grid.cell_data.begin(),  grid.cell_data.end(),  bad_array(grid.num_cells())),  grid.cell_data.end());
+    return true;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void read_VTK(const char          * filename,
-               std::vector<double> & xyz,
-               std::vector<uint>  & tets,
-               std::vector<uint>  & hexa)
+void read_VTK(const char                      * filename,
+               std::vector<vec3d>             & verts,
+               std::vector<std::vector<uint>> & poly)
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
-
-    vtkSmartPointer<vtkGenericDataObjectReader> reader = vtkSmartPointer<vtkGenericDataObjectReader>::New();
-    reader->SetFileName(filename);
-    reader->Update();
-    vtkSmartPointer<vtkUnstructuredGrid> grid(reader->GetUnstructuredGridOutput());
-
-    for(uint i=0; i<grid->GetNumberOfPoints(); ++i)
-    {
-        double pnt[3];
-        grid->GetPoint(i, pnt);
+    VTKGrid grid;
+    read_VTK(filename, grid);
+    std::vector<int> labels;
+    vtk_grid_to_polys(grid, poly, labels);
+    verts.swap(grid.verts);
+}
 
-        xyz.push_back(pnt[0]);
-        xyz.push_back(pnt[1]);
-        xyz.push_back(pnt[2]);
-    }
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<grid->GetNumberOfCells(); ++i)
+CINO_INLINE
+void read_VTK(const char                      * filename,
+               std::vector<double>            & xyz,
+               std::vector<std::vector<uint>> & poly)
+{
+    std::vector<vec3d> verts;
+    read_VTK(filename, verts, poly);
+    xyz.clear();
+    xyz.reserve(3*verts.size());
+    for(const vec3d & v : verts)
     {
-        vtkCell *c = grid->GetCell(i);
-
-        switch (c->GetCellType())
-        {
-            case VTK_TETRA:      for(uint j=0; j<4; ++j) tets.push_back(c->GetPointId(j)); break;
-            case VTK_HEXAHEDRON: for(uint j=0; j<8; ++j) hexa.push_back(c->GetPointId(j)); break;
-        }
+        xyz.push_back(v.x());
+        xyz.push_back(v.y());
+        xyz.push_back(v.z());
     }
-
 }
 
-#else
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void read_VTK(const char          *,
-               std::vector<double> &,
-               std::vector<uint>   &,
-               std::vector<uint>   &)
+void read_VTK(const char           * filename,
+               std::vector<double> & xyz,
+               std::vector<uint>   & tets,
+               std::vector<uint>   & hexa)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    std::vector<std::vector<uint>> poly;
+    read_VTK(filename, xyz, poly);
+    tets.clear();
+    hexa.clear();
+    for(const auto & p : poly)
+    {
+        if(p.size()==4) tets.insert(tets.end(), p.begin(), p.end());
+        else            hexa.insert(hexa.end(), p.begin(), p.end());
+    }
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
-void read_VTK(const char                      *,
-               std::vector<double>            &,
-               std::vector<std::vector<uint>> &)
+void read_VTK(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    VTKGrid grid;
+    read_VTK(filename, grid);
+    vert_labels = vtk_labels(grid.point_data);
+    poly_labels = vtk_labels(grid.cell_data);
+    vtk_grid_to_polys(grid, polys, poly_labels);
+    verts.swap(grid.verts);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
-void read_VTK(const char                      *,
-               std::vector<vec3d>             &,
-               std::vector<std::vector<uint>> &)
+void read_VTK(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & faces,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<std::vector<bool>> & polys_face_winding,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    VTKGrid grid;
+    read_VTK(filename, grid);
+    vert_labels = vtk_labels(grid.point_data);
+    poly_labels = vtk_labels(grid.cell_data);
+    vtk_grid_to_polyhedra(grid, faces, polys, polys_face_winding, poly_labels);
+    verts.swap(grid.verts);
 }
 
-#endif
-
 }
@@ -40,16 +40,30 @@
 #include <vector>
 #include <cinolib/cino_inline.h>
 #include <cinolib/geometry/vec_mat.h>
+#include <cinolib/io/vtk_utilities.h>
 
 
 namespace cinolib
 {
 
+/* Native reader for the legacy format of unstructured grids (.vtk), both ASCII and BINARY.
+ * Cells can be given either in the classic layout (CELLS n size) or in the one introduced
+ * with version 5.1 (OFFSETS/CONNECTIVITY). The latter does not support general polyhedra.
+ * Point and cell attributes (SCALARS, VECTORS, NORMALS, TENSORS, TEXTURE_COORDINATES,
+ * COLOR_SCALARS and FIELD arrays) are all read as data arrays. The file is memory mapped.
+*/
+
+CINO_INLINE
+bool read_VTK(const char * filename,
+              VTKGrid    & grid);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 void read_VTK(const char          * filename,
                std::vector<double> & xyz,
-               std::vector<uint>  & tet,
-               std::vector<uint>  & hexa);
+               std::vector<uint>   & tet,
+               std::vector<uint>   & hexa);
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -66,6 +80,32 @@ void read_VTK(const char                      * filename,
                std::vector<vec3d>             & verts,
                std::vector<std::vector<uint>> & poly);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// tetrahedra and hexahedra only. Labels are read from the point/cell
+// data arrays named "label" (if any)
+//
+CINO_INLINE
+void read_VTK(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// any volumetric cell (tetrahedra, hexahedra, wedges, pyramids and general polyhedra),
+// in the face based representation used by Polyhedralmesh. Labels are read from the
+// point/cell data arrays named "label" (if any)
+//
+CINO_INLINE
+void read_VTK(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & faces,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<std::vector<bool>> & polys_face_winding,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels);
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -34,161 +34,508 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/read_VTU.h>
-
-#ifdef CINOLIB_USES_VTK
-#include <vtkSmartPointer.h>
-#include <vtkCell.h>
-#include <vtkUnstructuredGrid.h>
-#include <vtkXMLUnstructuredGridReader.h>
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/io/io_utilities.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef CINOLIB_USES_ZLIB
+#include <zlib.h>
 #endif
 
 namespace cinolib
 {
 
-#ifdef CINOLIB_USES_VTK
-
-CINO_INLINE
-void read_VTU(const char                      * filename,
-               std::vector<vec3d>             & verts,
-               std::vector<std::vector<uint>> & poly)
+namespace
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
 
-    vtkSmartPointer<vtkXMLUnstructuredGridReader> reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
-    reader->SetFileName(filename);
-    reader->Update();
-    vtkSmartPointer<vtkUnstructuredGrid> grid(reader->GetOutput());
-
-    for(uint i=0; i<grid->GetNumberOfPoints(); ++i)
-    {
-        double pnt[3];
-        grid->GetPoint(i, pnt);
+// a tag is the text between '<' and '>'
+struct XMLTag
+{
+    const char  * beg = nullptr;
+    const char  * end = nullptr;
+    std::string   name;
+    bool          closing      = false;
+    bool          self_closing = false;
+};
 
-        verts.push_back(vec3d(pnt[0],pnt[1],pnt[2]));
-    }
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<grid->GetNumberOfCells(); ++i)
+CINO_INLINE
+bool next_tag(const char *& p, const char * end, XMLTag & tag)
+{
+    while(p<end)
     {
-        vtkCell *c = grid->GetCell(i);
+        p = static_cast<const char*>(memchr(p, '<', size_t(end-p)));
+        if(p==nullptr) { p = end; return false; }
 
-        std::vector<uint> polyhedron;
-        switch (c->GetCellType())
+        if(end-p>=4 && strncmp(p, "<!--", 4)==0) // skip comments
         {
-            case VTK_TETRA:      for(uint j=0; j<4; ++j) polyhedron.push_back(c->GetPointId(j)); break;
-            case VTK_HEXAHEDRON: for(uint j=0; j<8; ++j) polyhedron.push_back(c->GetPointId(j)); break;
+            const char *q = p+4;
+            while(q+3<=end && strncmp(q, "-->", 3)!=0) ++q;
+            p = q+3;
+            continue;
         }
 
-        if(!polyhedron.empty()) poly.push_back(polyhedron);
+        const char *q = static_cast<const char*>(memchr(p, '>', size_t(end-p)));
+        if(q==nullptr) { p = end; return false; }
+
+        tag.beg          = p+1;
+        tag.end          = q;
+        tag.closing      = (tag.beg<q && *tag.beg=='/');
+        tag.self_closing = (q[-1]=='/');
+        const char *s = tag.beg + (tag.closing ? 1 : 0);
+        const char *e = s;
+        while(e<q && !isspace((unsigned char)*e) && *e!='/') ++e;
+        tag.name.assign(s,e);
+        p = q+1;
+        if(tag.name[0]=='?' || tag.name[0]=='!') continue; // skip declarations
+        return true;
     }
+    return false;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void read_VTU(const char                      * filename,
-               std::vector<double>            & xyz,
-               std::vector<std::vector<uint>> & poly)
+std::string attribute(const XMLTag & tag, const char * key, const char * default_value = "")
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
+    size_t len = strlen(key);
+    for(const char *p=tag.beg; p+len<tag.end; ++p)
+    {
+        if(strncmp(p, key, len)!=0 || !isspace((unsigned char)p[-1])) continue;
+        const char *q = p+len;
+        while(q<tag.end && isspace((unsigned char)*q)) ++q;
+        if(q>=tag.end || *q!='=') continue;
+        ++q;
+        while(q<tag.end && isspace((unsigned char)*q)) ++q;
+        if(q>=tag.end || (*q!='"' && *q!='\'')) continue;
+        char quote = *q++;
+        const char *e = q;
+        while(e<tag.end && *e!=quote) ++e;
+        return std::string(q,e);
+    }
+    return std::string(default_value);
+}
 
-    vtkSmartPointer<vtkXMLUnstructuredGridReader> reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
-    reader->SetFileName(filename);
-    reader->Update();
-    vtkSmartPointer<vtkUnstructuredGrid> grid(reader->GetOutput());
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<grid->GetNumberOfPoints(); ++i)
-    {
-        double pnt[3];
-        grid->GetPoint(i, pnt);
+enum { NO_SECTION, POINTS, CELLS, POINT_DATA, CELL_DATA };
 
-        xyz.push_back(pnt[0]);
-        xyz.push_back(pnt[1]);
-        xyz.push_back(pnt[2]);
+struct DataArray
+{
+    int         section = NO_SECTION;
+    std::string name;
+    std::string type;
+    std::string format;
+    uint        n_comps = 1;
+    size_t      offset  = 0;
+    const char *beg     = nullptr; // inline content
+    const char *end     = nullptr;
+};
+
+struct VTUFile
+{
+    const char *file_beg        = nullptr;
+    const char *file_end        = nullptr;
+    const char *appended        = nullptr; // first byte after the '_' marker
+    bool        appended_base64 = false;
+    bool        swap_bytes      = false;
+    uint        header_size     = 4;       // UInt32 or UInt64
+    bool        compressed      = false;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint64_t header_word(const VTUFile & vf, const uint8_t * p)
+{
+    uint64_t w = 0;
+    if(vf.header_size==4)
+    {
+        uint32_t w32;
+        vtk_convert<uint32_t>("UInt32", p, 1, vf.swap_bytes, &w32);
+        w = w32;
     }
+    else vtk_convert<uint64_t>("UInt64", p, 1, vf.swap_bytes, &w);
+    return w;
+}
 
-    for(uint i=0; i<grid->GetNumberOfCells(); ++i)
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// returns a pointer to the (uncompressed) binary content of a data array. Raw
+// uncompressed appended data is accessed in place, otherwise buf is filled
+//
+CINO_INLINE
+const uint8_t * fetch_bytes(const VTUFile        & vf,
+                            const DataArray      & da,
+                            std::vector<uint8_t> & buf,
+                            size_t               & n_bytes)
+{
+    const char *p;
+    const char *end;
+    bool        base64;
+    if(da.format=="appended")
     {
-        vtkCell *c = grid->GetCell(i);
+        if(vf.appended==nullptr) return nullptr;
+        p      = vf.appended + da.offset;
+        end    = vf.file_end;
+        base64 = vf.appended_base64;
+    }
+    else
+    {
+        p      = da.beg;
+        end    = da.end;
+        base64 = true;
+    }
+    if(p>=end) return nullptr;
+
+    const uint hs = vf.header_size;
+    buf.clear();
 
-        std::vector<uint> polyhedron;
-        switch (c->GetCellType())
+    if(!vf.compressed)
+    {
+        if(!base64)
         {
-            case VTK_TETRA:      for(uint j=0; j<4; ++j) polyhedron.push_back(c->GetPointId(j)); break;
-            case VTK_HEXAHEDRON: for(uint j=0; j<8; ++j) polyhedron.push_back(c->GetPointId(j)); break;
+            if(p+hs>end) return nullptr;
+            n_bytes = header_word(vf, reinterpret_cast<const uint8_t*>(p));
+            if(n_bytes>size_t(end-p-hs)) return nullptr;
+            return reinterpret_cast<const uint8_t*>(p+hs);
         }
+        // header and data are encoded as a single stream
+        base64_decode(p, end, hs, buf);
+        if(buf.size()<hs) return nullptr;
+        n_bytes = header_word(vf, buf.data());
+        buf.clear();
+        base64_decode(p, end, hs+n_bytes, buf);
+        if(buf.size()<hs+n_bytes) return nullptr;
+        return buf.data()+hs;
+    }
+
+#ifdef CINOLIB_USES_ZLIB
+    // header: [#blocks, block size, last block size, compressed size of each block]
+    std::vector<uint8_t> header;
+    const char *data = nullptr;
+    if(base64)
+    {
+        // header and compressed blocks are encoded as two separate streams
+        base64_decode(p, end, 3*hs, header);
+        if(header.size()<3*hs) return nullptr;
+        uint64_t nb = header_word(vf, header.data());
+        header.clear();
+        data = base64_decode(p, end, (3+nb)*hs, header);
+        if(header.size()<(3+nb)*hs) return nullptr;
+    }
+    else
+    {
+        if(p+3*hs>end) return nullptr;
+        uint64_t nb = header_word(vf, reinterpret_cast<const uint8_t*>(p));
+        if((3+nb)*hs>size_t(end-p)) return nullptr;
+        header.assign(p, p+(3+nb)*hs);
+        data = p+(3+nb)*hs;
+    }
 
-        if(!polyhedron.empty()) poly.push_back(polyhedron);
+    uint64_t nb   = header_word(vf, header.data());
+    uint64_t bs   = header_word(vf, header.data()+hs);
+    uint64_t lbs  = header_word(vf, header.data()+2*hs);
+    n_bytes = (nb==0) ? 0 : (nb-1)*bs + (lbs>0 ? lbs : bs);
+    buf.resize(n_bytes);
+
+    std::vector<uint8_t> compressed;
+    const uint8_t *src = reinterpret_cast<const uint8_t*>(data);
+    if(base64)
+    {
+        uint64_t tot = 0;
+        for(uint64_t i=0; i<nb; ++i) tot += header_word(vf, header.data()+(3+i)*hs);
+        base64_decode(data, end, tot, compressed);
+        if(compressed.size()<tot) return nullptr;
+        src = compressed.data();
+    }
+
+    const uint8_t *src_end = base64 ? compressed.data()+compressed.size() : reinterpret_cast<const uint8_t*>(end);
+    size_t pos = 0;
+    for(uint64_t i=0; i<nb; ++i)
+    {
+        uint64_t cs = header_word(vf, header.data()+(3+i)*hs);
+        if(src+cs>src_end) return nullptr;
+        uLongf len = uLongf(n_bytes-pos);
+        if(uncompress(buf.data()+pos, &len, src, uLong(cs))!=Z_OK) return nullptr;
+        pos += len;
+        src += cs;
     }
+    if(pos!=n_bytes) return nullptr;
+    return buf.data();
+#else
+    std::cerr << "ERROR : zlib missing. Install zlib and recompile defining symbol CINOLIB_USES_ZLIB to read compressed VTU files" << std::endl;
+    return nullptr;
+#endif
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<typename T>
 CINO_INLINE
-void read_VTU(const char           * filename,
-               std::vector<double> & xyz,
-               std::vector<uint>   & tets,
-               std::vector<uint>   & hexa)
+bool read_array(const VTUFile & vf, const DataArray & da, std::vector<T> & out)
 {
+    out.clear();
+    if(da.format=="ascii")
+    {
+        const char *p = da.beg;
+        double d;
+        while(eat_double(p, da.end, d)) out.push_back(static_cast<T>(d));
+        return true;
+    }
+
+    uint size = vtk_type_size(da.type);
+    if(size==0)
+    {
+        std::cerr << "ERROR : read_VTU() : unsupported data type " << da.type << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> buf;
+    size_t n_bytes = 0;
+    const uint8_t *data = fetch_bytes(vf, da, buf, n_bytes);
+    if(data==nullptr)
+    {
+        std::cerr << "ERROR : read_VTU() : corrupted data array " << da.name << std::endl;
+        return false;
+    }
+    out.resize(n_bytes/size);
+    return vtk_convert<T>(da.type, data, out.size(), vf.swap_bytes, out.data());
+}
 
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
+}
 
-    vtkSmartPointer<vtkXMLUnstructuredGridReader> reader = vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
-    reader->SetFileName(filename);
-    reader->Update();
-    vtkSmartPointer<vtkUnstructuredGrid> grid(reader->GetOutput());
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<grid->GetNumberOfPoints(); ++i)
+CINO_INLINE
+bool read_VTU(const char * filename,
+              VTKGrid    & grid)
+{
+    grid.clear();
+
+    MappedFile file(filename);
+    if(!file.is_open())
     {
-        double pnt[3];
-        grid->GetPoint(i, pnt);
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_VTU() : couldn't open input file " << filename << std::endl;
+        return false;
+    }
 
-        xyz.push_back(pnt[0]);
-        xyz.push_back(pnt[1]);
-        xyz.push_back(pnt[2]);
+    VTUFile vf;
+    vf.file_beg = file.begin();
+    vf.file_end = file.end();
+
+    // scan the XML structure (stopping at the appended data, which may
+    // contain anything), collecting the data arrays of the first piece
+    const char *p = file.begin();
+    XMLTag tag;
+    std::vector<DataArray> arrays;
+    int  section  = NO_SECTION;
+    int  n_pieces = 0;
+    bool is_vtu   = false;
+    size_t nv = 0, nc = 0;
+    while(next_tag(p, file.end(), tag))
+    {
+        if(tag.closing)
+        {
+            if(tag.name=="Points" || tag.name=="Cells" || tag.name=="PointData" || tag.name=="CellData") section = NO_SECTION;
+            continue;
+        }
+        if(tag.name=="VTKFile")
+        {
+            is_vtu = (attribute(tag, "type")=="UnstructuredGrid");
+            std::string byte_order = attribute(tag, "byte_order", "LittleEndian");
+            vf.swap_bytes  = (byte_order=="LittleEndian") != host_is_little_endian();
+            vf.header_size = (attribute(tag, "header_type", "UInt32")=="UInt64") ? 8 : 4;
+            vf.compressed  = !attribute(tag, "compressor").empty();
+        }
+        else if(tag.name=="Piece")
+        {
+            if(++n_pieces>1) continue;
+            nv = size_t(atoll(attribute(tag, "NumberOfPoints", "0").c_str()));
+            nc = size_t(atoll(attribute(tag, "NumberOfCells",  "0").c_str()));
+        }
+        else if(tag.name=="Points"   ) section = POINTS;
+        else if(tag.name=="Cells"    ) section = CELLS;
+        else if(tag.name=="PointData") section = POINT_DATA;
+        else if(tag.name=="CellData" ) section = CELL_DATA;
+        else if(tag.name=="DataArray")
+        {
+            DataArray da;
+            da.section = section;
+            da.name    = attribute(tag, "Name");
+            da.type    = attribute(tag, "type");
+            da.format  = attribute(tag, "format", "ascii");
+            da.n_comps = uint(std::max(1, atoi(attribute(tag, "NumberOfComponents", "1").c_str())));
+            da.offset  = size_t(atoll(attribute(tag, "offset", "0").c_str()));
+            if(!tag.self_closing)
+            {
+                static const char *close = "</DataArray>";
+                da.beg = p;
+                da.end = std::search(p, file.end(), close, close+strlen(close));
+                if(da.end==file.end()) break;
+                p = da.end + strlen(close);
+            }
+            if(n_pieces==1 && section!=NO_SECTION) arrays.push_back(da);
+        }
+        else if(tag.name=="AppendedData")
+        {
+            vf.appended_base64 = (attribute(tag, "encoding")=="base64");
+            const char *q = static_cast<const char*>(memchr(p, '_', size_t(file.end()-p)));
+            if(q!=nullptr) vf.appended = q+1;
+            break;
+        }
     }
 
-    for(uint i=0; i<grid->GetNumberOfCells(); ++i)
+    if(!is_vtu)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_VTU() : " << filename << " is not an unstructured grid" << std::endl;
+        return false;
+    }
+    if(n_pieces>1)
     {
-        vtkCell *c = grid->GetCell(i);
+        std::cerr << "WARNING : read_VTU() : " << filename << " has " << n_pieces << " pieces. Only the first one is read" << std::endl;
+    }
 
-        switch (c->GetCellType())
+    for(const DataArray & da : arrays)
+    {
+        bool ok = true;
+        switch(da.section)
         {
-            case VTK_TETRA:      for(uint j=0; j<4; ++j) tets.push_back(c->GetPointId(j)); break;
-            case VTK_HEXAHEDRON: for(uint j=0; j<8; ++j) hexa.push_back(c->GetPointId(j)); break;
+            case POINTS:
+            {
+                std::vector<double> xyz;
+                ok = read_array(vf, da, xyz);
+                grid.verts.resize(xyz.size()/3);
+                for(size_t i=0; i<grid.verts.size(); ++i) grid.verts[i] = vec3d(xyz[3*i], xyz[3*i+1], xyz[3*i+2]);
+                break;
+            }
+            case CELLS:
+            {
+                if(da.name=="connectivity") ok = read_array(vf, da, grid.conn);    else
+                if(da.name=="offsets"     ) ok = read_array(vf, da, grid.offsets); else
+                if(da.name=="types"       ) ok = read_array(vf, da, grid.types);   else
+                if(da.name=="faces"       ) ok = read_array(vf, da, grid.faces);   else
+                if(da.name=="faceoffsets" ) ok = read_array(vf, da, grid.face_offsets);
+                break;
+            }
+            case POINT_DATA:
+            case CELL_DATA:
+            {
+                VTKArray a;
+                a.name    = da.name;
+                a.n_comps = da.n_comps;
+                ok = read_array(vf, da, a.values);
+                size_t n = (da.section==POINT_DATA) ? nv : nc;
+                if(ok && a.values.size()==n*a.n_comps)
+                {
+                    if(da.section==POINT_DATA) grid.point_data.push_back(a);
+                    else                       grid.cell_data.push_back(a);
+                }
+                break;
+            }
         }
+        if(!ok) { grid.clear(); return false; }
     }
+
+    if(grid.verts.size()!=nv || grid.types.size()!=nc || grid.offsets.size()!=nc ||
+       (nc>0 && grid.offsets.back()>grid.conn.size()) ||
+       (!grid.face_offsets.empty() && grid.face_offsets.size()!=nc))
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_VTU() : inconsistent unstructured grid in " << filename << std::endl;
+        grid.clear();
+        return false;
+    }
+    return true;
 }
 
-#else
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void read_VTU(const char          *,
-               std::vector<double> &,
-               std::vector<uint>   &,
-               std::vector<uint>   &)
+void read_VTU(const char                      * filename,
+               std::vector<vec3d>             & verts,
+               std::vector<std::vector<uint>> & poly)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    VTKGrid grid;
+    read_VTU(filename, grid);
+    std::vector<int> labels;
+    vtk_grid_to_polys(grid, poly, labels);
+    verts.swap(grid.verts);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void read_VTU(const char                      * filename,
+               std::vector<double>            & xyz,
+               std::vector<std::vector<uint>> & poly)
+{
+    std::vector<vec3d> verts;
+    read_VTU(filename, verts, poly);
+    xyz.clear();
+    xyz.reserve(3*verts.size());
+    for(const vec3d & v : verts)
+    {
+        xyz.push_back(v.x());
+        xyz.push_back(v.y());
+        xyz.push_back(v.z());
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
-void read_VTU(const char                      *,
-               std::vector<double>            &,
-               std::vector<std::vector<uint>> &)
+void read_VTU(const char           * filename,
+               std::vector<double> & xyz,
+               std::vector<uint>   & tets,
+               std::vector<uint>   & hexa)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    std::vector<std::vector<uint>> poly;
+    read_VTU(filename, xyz, poly);
+    tets.clear();
+    hexa.clear();
+    for(const auto & p : poly)
+    {
+        if(p.size()==4) tets.insert(tets.end(), p.begin(), p.end());
+        else            hexa.insert(hexa.end(), p.begin(), p.end());
+    }
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
-void read_VTU(const char                      *,
-               std::vector<vec3d>             &,
-               std::vector<std::vector<uint>> &)
+void read_VTU(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    VTKGrid grid;
+    read_VTU(filename, grid);
+    vert_labels = vtk_labels(grid.point_data);
+    poly_labels = vtk_labels(grid.cell_data);
+    vtk_grid_to_polys(grid, polys, poly_labels);
+    verts.swap(grid.verts);
 }
 
-#endif
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void read_VTU(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & faces,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<std::vector<bool>> & polys_face_winding,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels)
+{
+    VTKGrid grid;
+    read_VTU(filename, grid);
+    vert_labels = vtk_labels(grid.point_data);
+    poly_labels = vtk_labels(grid.cell_data);
+    vtk_grid_to_polyhedra(grid, faces, polys, polys_face_winding, poly_labels);
+    verts.swap(grid.verts);
+}
 
 }
@@ -40,11 +40,25 @@
 #include <vector>
 #include <cinolib/cino_inline.h>
 #include <cinolib/geometry/vec_mat.h>
+#include <cinolib/io/vtk_utilities.h>
 
 
 namespace cinolib
 {
 
+/* Native reader for the XML format of unstructured grids (.vtu). Supports all the encodings
+ * written by VTK: ascii, binary (i.e. base64 within the XML) and appended data (either raw or
+ * base64), optionally zlib compressed, with 32 or 64 bits headers and both byte orders. The
+ * file is memory mapped, and each data array is decoded straight into its final destination.
+ * Only the first Piece of the file is read.
+*/
+
+CINO_INLINE
+bool read_VTU(const char * filename,
+              VTKGrid    & grid);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 void read_VTU(const char          * filename,
                std::vector<double> & xyz,
@@ -66,6 +80,32 @@ void read_VTU(const char                      * filename,
                std::vector<vec3d>             & verts,
                std::vector<std::vector<uint>> & poly);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// tetrahedra and hexahedra only. Labels are read from the point/cell
+// data arrays named "label" (if any)
+//
+CINO_INLINE
+void read_VTU(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// any volumetric cell (tetrahedra, hexahedra, wedges, pyramids and general polyhedra),
+// in the face based representation used by Polyhedralmesh. Labels are read from the
+// point/cell data arrays named "label" (if any)
+//
+CINO_INLINE
+void read_VTU(const char                     * filename,
+              std::vector<vec3d>             & verts,
+              std::vector<std::vector<uint>> & faces,
+              std::vector<std::vector<uint>> & polys,
+              std::vector<std::vector<bool>> & polys_face_winding,
+              std::vector<int>               & vert_labels,
+              std::vector<int>               & poly_labels);
 }
 
 #ifndef  CINO_STATIC_LIB
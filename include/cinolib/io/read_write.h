@@ -65,6 +65,11 @@
 #include <cinolib/io/write_OVM.h>
 
 
+// NATIVE BINARY FORMAT (ANY MESH)
+#include <cinolib/io/read_CINOBIN.h>
+#include <cinolib/io/write_CINOBIN.h>
+
+
 // SKELETON READERS
 #include <cinolib/io/read_LIVESU2012.h>
 #include <cinolib/io/read_TAGLIASACCHI2012.h>
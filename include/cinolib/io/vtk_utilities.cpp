@@ -0,0 +1,512 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/io/vtk_utilities.h>
+#include <cinolib/standard_elements_tables.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace cinolib
+{
+
+namespace
+{
+
+// faces of the VTK standard cells, oriented outwards (VTK uses the same
+// vertex ordering of cinolib for tetrahedra and hexahedra, but not for wedges)
+//
+static const uint VTK_WEDGE_FACES[5][4] =
+{
+    { 0, 1, 2,   },
+    { 3, 5, 4,   },
+    { 0, 3, 4, 1 },
+    { 1, 4, 5, 2 },
+    { 2, 5, 3, 0 },
+};
+
+static const uint VTK_PYRAMID_FACES[5][4] =
+{
+    { 0, 3, 2, 1 },
+    { 0, 1, 4,   },
+    { 1, 2, 4,   },
+    { 2, 3, 4,   },
+    { 3, 0, 4,   },
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum { T_INT8, T_UINT8, T_INT16, T_UINT16, T_INT32, T_UINT32, T_INT64, T_UINT64, T_FLOAT32, T_FLOAT64, T_UNKNOWN };
+
+CINO_INLINE
+int type_code(const std::string & type)
+{
+    if(type=="Int8"    || type=="char"          ) return T_INT8;
+    if(type=="UInt8"   || type=="unsigned_char" ) return T_UINT8;
+    if(type=="Int16"   || type=="short"         ) return T_INT16;
+    if(type=="UInt16"  || type=="unsigned_short") return T_UINT16;
+    if(type=="Int32"   || type=="int"           ) return T_INT32;
+    if(type=="UInt32"  || type=="unsigned_int"  ) return T_UINT32;
+    if(type=="Int64"   || type=="long"          || type=="vtktypeint64" || type=="vtkIdType") return T_INT64;
+    if(type=="UInt64"  || type=="unsigned_long" || type=="vtktypeuint64") return T_UINT64;
+    if(type=="Float32" || type=="float"         ) return T_FLOAT32;
+    if(type=="Float64" || type=="double"        ) return T_FLOAT64;
+    return T_UNKNOWN;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename S, typename T>
+CINO_INLINE
+void convert(const uint8_t * data, const size_t n, const bool swap_bytes, T * out)
+{
+    for(size_t i=0; i<n; ++i)
+    {
+        uint8_t bytes[sizeof(S)];
+        memcpy(bytes, data+i*sizeof(S), sizeof(S));
+        if(swap_bytes) std::reverse(bytes, bytes+sizeof(S));
+        S s;
+        memcpy(&s, bytes, sizeof(S));
+        out[i] = static_cast<T>(s);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct FaceHash
+{
+    size_t operator()(const std::vector<uint> & f) const
+    {
+        size_t h = f.size();
+        for(uint vid : f) h ^= std::hash<uint>()(vid) + 0x9e3779b9 + (h<<6) + (h>>2);
+        return h;
+    }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// extracts the (outward oriented) faces of a cell, as lists of vertices.
+// For polyhedra, face_beg is where the face stream of the cell begins
+// (i.e. where the stream of the previous polyhedron ends)
+//
+CINO_INLINE
+bool cell_faces(const VTKGrid                  & grid,
+                const size_t                     cid,
+                const size_t                     face_beg,
+                std::vector<std::vector<uint>> & faces)
+{
+    faces.clear();
+    const uint *v = grid.conn.data() + (cid>0 ? grid.offsets.at(cid-1) : 0);
+    size_t      n = grid.offsets.at(cid) - (cid>0 ? grid.offsets.at(cid-1) : 0);
+
+    switch(grid.types.at(cid))
+    {
+        case VTK_CELL_TETRA:
+        {
+            if(n!=4) return false;
+            for(uint i=0; i<4; ++i) faces.push_back({v[TET_FACES[i][0]], v[TET_FACES[i][1]], v[TET_FACES[i][2]]});
+            return true;
+        }
+        case VTK_CELL_HEXAHEDRON:
+        {
+            if(n!=8) return false;
+            for(uint i=0; i<6; ++i) faces.push_back({v[HEXA_FACES[i][0]], v[HEXA_FACES[i][1]], v[HEXA_FACES[i][2]], v[HEXA_FACES[i][3]]});
+            return true;
+        }
+        case VTK_CELL_WEDGE:
+        {
+            if(n!=6) return false;
+            for(uint i=0; i<5; ++i)
+            {
+                faces.push_back({v[VTK_WEDGE_FACES[i][0]], v[VTK_WEDGE_FACES[i][1]], v[VTK_WEDGE_FACES[i][2]]});
+                if(i>1) faces.back().push_back(v[VTK_WEDGE_FACES[i][3]]);
+            }
+            return true;
+        }
+        case VTK_CELL_PYRAMID:
+        {
+            if(n!=5) return false;
+            for(uint i=0; i<5; ++i)
+            {
+                faces.push_back({v[VTK_PYRAMID_FACES[i][0]], v[VTK_PYRAMID_FACES[i][1]], v[VTK_PYRAMID_FACES[i][2]]});
+                if(i==0) faces.back().push_back(v[VTK_PYRAMID_FACES[i][3]]);
+            }
+            return true;
+        }
+        case VTK_CELL_POLYHEDRON:
+        {
+            if(grid.face_offsets.size()!=grid.num_cells() || grid.face_offsets.at(cid)<0) return false;
+            size_t end = size_t(grid.face_offsets.at(cid));
+            if(face_beg>=end || end>grid.faces.size()) return false;
+            size_t pos = face_beg;
+            uint   nf  = grid.faces.at(pos++);
+            for(uint i=0; i<nf; ++i)
+            {
+                if(pos>=end) return false;
+                uint nv = grid.faces.at(pos++);
+                if(pos+nv>end) return false;
+                faces.emplace_back(grid.faces.begin()+pos, grid.faces.begin()+pos+nv);
+                pos += nv;
+            }
+            return nf>=4;
+        }
+    }
+    return false;
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void VTKGrid::clear()
+{
+    verts.clear();
+    types.clear();
+    conn.clear();
+    offsets.clear();
+    faces.clear();
+    face_offsets.clear();
+    point_data.clear();
+    cell_data.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const VTKArray * vtk_find_array(const std::vector<VTKArray> & arrays,
+                                const std::string           & name)
+{
+    for(const VTKArray & a : arrays) if(a.name==name) return &a;
+    return nullptr;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+std::vector<int> vtk_labels(const std::vector<VTKArray> & arrays,
+                            const std::string           & name)
+{
+    std::vector<int> labels;
+    const VTKArray *a = vtk_find_array(arrays, name);
+    if(a==nullptr || a->n_comps!=1) return labels;
+    labels.reserve(a->values.size());
+    for(double d : a->values) labels.push_back(int(std::lround(d)));
+    return labels;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void vtk_grid_to_polys(const VTKGrid                  & grid,
+                       std::vector<std::vector<uint>> & polys,
+                       std::vector<int>               & cell_labels)
+{
+    polys.clear();
+    bool filter_labels = (cell_labels.size()==grid.num_cells());
+    std::vector<int> kept_labels;
+
+    for(size_t cid=0; cid<grid.num_cells(); ++cid)
+    {
+        size_t beg = (cid>0) ? grid.offsets.at(cid-1) : 0;
+        size_t end = grid.offsets.at(cid);
+        if((grid.types.at(cid)==VTK_CELL_TETRA      && end-beg==4) ||
+           (grid.types.at(cid)==VTK_CELL_HEXAHEDRON && end-beg==8))
+        {
+            polys.emplace_back(grid.conn.begin()+beg, grid.conn.begin()+end);
+            if(filter_labels) kept_labels.push_back(cell_labels.at(cid));
+        }
+    }
+    cell_labels.swap(kept_labels);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void vtk_grid_to_polyhedra(const VTKGrid                  & grid,
+                           std::vector<std::vector<uint>> & faces,
+                           std::vector<std::vector<uint>> & polys,
+                           std::vector<std::vector<bool>> & polys_face_winding,
+                           std::vector<int>               & cell_labels)
+{
+    faces.clear();
+    polys.clear();
+    polys_face_winding.clear();
+    bool filter_labels = (cell_labels.size()==grid.num_cells());
+    std::vector<int> kept_labels;
+
+    // faces are identified by their sorted list of vertices. The first cell
+    // that uses a face defines its orientation, all the others see it flipped
+    std::unordered_map<std::vector<uint>,uint,FaceHash> face_map;
+    std::vector<std::vector<uint>> cell_f;
+    std::vector<uint> key;
+    size_t face_beg = 0;
+
+    for(size_t cid=0; cid<grid.num_cells(); ++cid)
+    {
+        bool ok = cell_faces(grid, cid, face_beg, cell_f);
+        if(cid<grid.face_offsets.size() && grid.face_offsets.at(cid)>=0) face_beg = size_t(grid.face_offsets.at(cid));
+        if(!ok) continue;
+
+        std::vector<uint> p;
+        std::vector<bool> w;
+        for(const auto & f : cell_f)
+        {
+            key = f;
+            std::sort(key.begin(), key.end());
+            auto query = face_map.insert(std::make_pair(key, uint(faces.size())));
+            if(query.second) faces.push_back(f);
+            p.push_back(query.first->second);
+            w.push_back(query.second);
+        }
+        polys.push_back(p);
+        polys_face_winding.push_back(w);
+        if(filter_labels) kept_labels.push_back(cell_labels.at(cid));
+    }
+    cell_labels.swap(kept_labels);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void vtk_polys_to_grid(const std::vector<vec3d>             & verts,
+                       const std::vector<std::vector<uint>> & polys,
+                       VTKGrid                              & grid)
+{
+    grid.clear();
+    grid.verts = verts;
+    grid.types.reserve(polys.size());
+    grid.offsets.reserve(polys.size());
+    for(const auto & p : polys)
+    {
+        switch(p.size())
+        {
+            case 4: grid.types.push_back(VTK_CELL_TETRA);      break;
+            case 8: grid.types.push_back(VTK_CELL_HEXAHEDRON); break;
+            default: assert(false && "Unsupported Polyhedron!"); continue;
+        }
+        grid.conn.insert(grid.conn.end(), p.begin(), p.end());
+        grid.offsets.push_back(grid.conn.size());
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void vtk_polyhedra_to_grid(const std::vector<vec3d>             & verts,
+                           const std::vector<std::vector<uint>> & faces,
+                           const std::vector<std::vector<uint>> & polys,
+                           const std::vector<std::vector<bool>> & polys_face_winding,
+                           VTKGrid                              & grid)
+{
+    grid.clear();
+    grid.verts = verts;
+    grid.types.assign(polys.size(), VTK_CELL_POLYHEDRON);
+    grid.offsets.reserve(polys.size());
+    grid.face_offsets.reserve(polys.size());
+
+    std::vector<uint> p_verts;
+    for(uint pid=0; pid<polys.size(); ++pid)
+    {
+        const std::vector<uint> & p = polys.at(pid);
+        grid.faces.push_back(uint(p.size()));
+        p_verts.clear();
+        for(uint i=0; i<p.size(); ++i)
+        {
+            const std::vector<uint> & f = faces.at(p.at(i));
+            grid.faces.push_back(uint(f.size()));
+            if(polys_face_winding.at(pid).at(i)) grid.faces.insert(grid.faces.end(), f.begin(),  f.end());
+            else                                 grid.faces.insert(grid.faces.end(), f.rbegin(), f.rend());
+            p_verts.insert(p_verts.end(), f.begin(), f.end());
+        }
+        grid.face_offsets.push_back(int64_t(grid.faces.size()));
+
+        // the cell connectivity lists each vertex of the polyhedron once
+        std::sort(p_verts.begin(), p_verts.end());
+        p_verts.erase(std::unique(p_verts.begin(), p_verts.end()), p_verts.end());
+        grid.conn.insert(grid.conn.end(), p_verts.begin(), p_verts.end());
+        grid.offsets.push_back(grid.conn.size());
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint vtk_type_size(const std::string & type)
+{
+    switch(type_code(type))
+    {
+        case T_INT8:    case T_UINT8:   return 1;
+        case T_INT16:   case T_UINT16:  return 2;
+        case T_INT32:   case T_UINT32:  return 4;
+        case T_INT64:   case T_UINT64:  return 8;
+        case T_FLOAT32:                 return 4;
+        case T_FLOAT64:                 return 8;
+    }
+    return 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename T>
+CINO_INLINE
+bool vtk_convert(const std::string & type,
+                 const uint8_t     * data,
+                 const size_t        n,
+                 const bool          swap_bytes,
+                 T                 * out)
+{
+    switch(type_code(type))
+    {
+        case T_INT8:    convert<int8_t,  T>(data, n, swap_bytes, out); return true;
+        case T_UINT8:   convert<uint8_t, T>(data, n, swap_bytes, out); return true;
+        case T_INT16:   convert<int16_t, T>(data, n, swap_bytes, out); return true;
+        case T_UINT16:  convert<uint16_t,T>(data, n, swap_bytes, out); return true;
+        case T_INT32:   convert<int32_t, T>(data, n, swap_bytes, out); return true;
+        case T_UINT32:  convert<uint32_t,T>(data, n, swap_bytes, out); return true;
+        case T_INT64:   convert<int64_t, T>(data, n, swap_bytes, out); return true;
+        case T_UINT64:  convert<uint64_t,T>(data, n, swap_bytes, out); return true;
+        case T_FLOAT32: convert<float,   T>(data, n, swap_bytes, out); return true;
+        case T_FLOAT64: convert<double,  T>(data, n, swap_bytes, out); return true;
+    }
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool host_is_little_endian()
+{
+    uint16_t x = 1;
+    uint8_t  b;
+    memcpy(&b, &x, 1);
+    return b==1;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const char * base64_decode(const char           * beg,
+                           const char           * end,
+                           const size_t           n_bytes,
+                           std::vector<uint8_t> & out)
+{
+    static int8_t table[256];
+    static bool   table_ready = false;
+    if(!table_ready)
+    {
+        const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for(int i=0; i<256; ++i) table[i] = -1;
+        for(int i=0; i<64;  ++i) table[(uint8_t)alphabet[i]] = int8_t(i);
+        table_ready = true;
+    }
+
+    // quads are decoded as a whole, padding ('=') flushes a partial quad
+    size_t       target = out.size() + n_bytes;
+    const char * p      = beg;
+    uint32_t     acc    = 0;
+    int          n_sym  = 0;
+    while(p<end && out.size()<target)
+    {
+        uint8_t c = (uint8_t)*p;
+        if(isspace(c)) { ++p; continue; }
+        if(c=='=')
+        {
+            ++p;
+            if(n_sym==2) { out.push_back(uint8_t(acc>>4)); }
+            if(n_sym==3) { out.push_back(uint8_t(acc>>10)); out.push_back(uint8_t(acc>>2)); }
+            n_sym = 0;
+            acc   = 0;
+            continue;
+        }
+        if(table[c]<0) break;
+        acc = (acc<<6) | uint32_t(table[c]);
+        ++p;
+        if(++n_sym==4)
+        {
+            out.push_back(uint8_t(acc>>16));
+            out.push_back(uint8_t(acc>>8));
+            out.push_back(uint8_t(acc));
+            n_sym = 0;
+            acc   = 0;
+        }
+    }
+    if(out.size()>target) out.resize(target);
+    return p;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const char * base64_decode(const char           * beg,
+                           const char           * end,
+                           std::vector<uint8_t> & out)
+{
+    return base64_decode(beg, end, size_t(-1)-out.size(), out);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void base64_encode(const uint8_t * data,
+                   const size_t    n_bytes,
+                   std::string   & out)
+{
+    static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    out.reserve(out.size() + 4*((n_bytes+2)/3));
+    size_t i = 0;
+    for(; i+2<n_bytes; i+=3)
+    {
+        uint32_t q = (uint32_t(data[i])<<16) | (uint32_t(data[i+1])<<8) | uint32_t(data[i+2]);
+        out.push_back(alphabet[(q>>18)&63]);
+        out.push_back(alphabet[(q>>12)&63]);
+        out.push_back(alphabet[(q>> 6)&63]);
+        out.push_back(alphabet[ q     &63]);
+    }
+    if(i<n_bytes)
+    {
+        uint32_t q = uint32_t(data[i])<<16;
+        if(i+1<n_bytes) q |= uint32_t(data[i+1])<<8;
+        out.push_back(alphabet[(q>>18)&63]);
+        out.push_back(alphabet[(q>>12)&63]);
+        out.push_back(i+1<n_bytes ? alphabet[(q>>6)&63] : '=');
+        out.push_back('=');
+    }
+}
+
+}
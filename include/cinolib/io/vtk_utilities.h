@@ -0,0 +1,242 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_VTK_UTILITIES_H
+#define CINO_VTK_UTILITIES_H
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <cinolib/cino_inline.h>
+#include <cinolib/geometry/vec_mat.h>
+
+namespace cinolib
+{
+
+/* Facilities shared by the native (i.e. VTK-free) readers and writers for the XML (.vtu)
+ * and legacy (.vtk) formats of unstructured grids. Compressed XML files are supported
+ * only if cinolib is compiled with CINOLIB_USES_ZLIB defined.
+*/
+
+// VTK cell types handled by the readers and writers. Other cell types
+// (e.g. lines, triangles, quadratic elements) are skipped when reading
+enum
+{
+    VTK_CELL_TETRA      = 10,
+    VTK_CELL_HEXAHEDRON = 12,
+    VTK_CELL_WEDGE      = 13,
+    VTK_CELL_PYRAMID    = 14,
+    VTK_CELL_POLYHEDRON = 42,
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// A point or cell data array. Values of multi component arrays are interleaved
+// (e.g. x0 y0 z0 x1 y1 z1 ...). Scalar arrays can be used straight away to build
+// a ScalarField (e.g. ScalarField f(array.values))
+//
+struct VTKArray
+{
+    VTKArray(){}
+    VTKArray(const std::string & name, const std::vector<double> & values, const uint n_comps = 1)
+        : name(name), n_comps(n_comps), values(values) {}
+
+    std::string         name;
+    uint                n_comps = 1;
+    std::vector<double> values;
+
+    size_t size() const { return values.size()/n_comps; }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Flat representation of an unstructured grid, laid out as in the XML format.
+// Cell i has vertices conn[offsets[i-1]...offsets[i]). If the grid contains
+// polyhedra, face_offsets has one entry per cell, which is -1 for standard
+// cells and the end of the cell face stream in faces otherwise. Each stream
+// is encoded as [#faces, #verts f0, verts f0, #verts f1, verts f1, ...]
+//
+struct VTKGrid
+{
+    std::vector<vec3d>    verts;
+    std::vector<uint8_t>  types;
+    std::vector<uint>     conn;
+    std::vector<size_t>   offsets;
+    std::vector<uint>     faces;
+    std::vector<int64_t>  face_offsets;
+    std::vector<VTKArray> point_data;
+    std::vector<VTKArray> cell_data;
+
+    size_t num_cells() const { return types.size(); }
+    void   clear();
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum
+{
+    VTK_FORMAT_ASCII    = 0, // human readable
+    VTK_FORMAT_BINARY   = 1, // base64 encoded within the XML (binary, big endian, for legacy files)
+    VTK_FORMAT_APPENDED = 2, // raw bytes, appended at the end of the XML (same as binary, for legacy files)
+};
+
+struct VTKWriteOptions
+{
+    int  format     = VTK_FORMAT_APPENDED;
+    bool compress   = true;  // zlib, XML files only. Ignored if CINOLIB_USES_ZLIB is not defined
+    uint block_size = 32768; // uncompressed size of compressed blocks (in bytes)
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const VTKArray * vtk_find_array(const std::vector<VTKArray> & arrays,
+                                const std::string           & name);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// converts the (scalar) array with the given name into integer labels.
+// Returns an empty vector if no such array exists
+//
+CINO_INLINE
+std::vector<int> vtk_labels(const std::vector<VTKArray> & arrays,
+                            const std::string           & name = "label");
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// keeps only tetrahedra and hexahedra, as vertex lists. If cell_labels
+// is not empty, it is filtered accordingly (i.e. one label per kept cell)
+//
+CINO_INLINE
+void vtk_grid_to_polys(const VTKGrid                  & grid,
+                       std::vector<std::vector<uint>> & polys,
+                       std::vector<int>               & cell_labels);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// converts all volumetric cells (tetrahedra, hexahedra, wedges, pyramids and
+// general polyhedra) into the face based representation used by Polyhedralmesh.
+// Faces shared by adjacent cells are stored once. If cell_labels is not empty,
+// it is filtered accordingly (i.e. one label per kept cell)
+//
+CINO_INLINE
+void vtk_grid_to_polyhedra(const VTKGrid                  & grid,
+                           std::vector<std::vector<uint>> & faces,
+                           std::vector<std::vector<uint>> & polys,
+                           std::vector<std::vector<bool>> & polys_face_winding,
+                           std::vector<int>               & cell_labels);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// polys with 4 (resp. 8) vertices become tetrahedra (resp. hexahedra)
+//
+CINO_INLINE
+void vtk_polys_to_grid(const std::vector<vec3d>             & verts,
+                       const std::vector<std::vector<uint>> & polys,
+                       VTKGrid                              & grid);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// all cells are written as VTK polyhedra, with faces oriented outwards
+//
+CINO_INLINE
+void vtk_polyhedra_to_grid(const std::vector<vec3d>             & verts,
+                           const std::vector<std::vector<uint>> & faces,
+                           const std::vector<std::vector<uint>> & polys,
+                           const std::vector<std::vector<bool>> & polys_face_winding,
+                           VTKGrid                              & grid);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// size (in bytes) of a scalar type, named either as in the XML format (e.g. "Float32")
+// or as in the legacy format (e.g. "float"). Returns 0 for unknown types
+//
+CINO_INLINE
+uint vtk_type_size(const std::string & type);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// converts n values of the given scalar type, stored at data (possibly unaligned,
+// and with opposite byte order if swap_bytes is true). Returns false for unknown types
+//
+template<typename T>
+CINO_INLINE
+bool vtk_convert(const std::string & type,
+                 const uint8_t     * data,
+                 const size_t        n,
+                 const bool          swap_bytes,
+                 T                 * out);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool host_is_little_endian();
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// appends to out the decoded bytes, skipping white spaces. Returns the
+// pointer to the first character that is not part of the base64 stream
+//
+CINO_INLINE
+const char * base64_decode(const char           * beg,
+                           const char           * end,
+                           std::vector<uint8_t> & out);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// decodes exactly n_bytes (or less if the stream ends before).
+// Returns the pointer to the first character that was not consumed
+//
+CINO_INLINE
+const char * base64_decode(const char           * beg,
+                           const char           * end,
+                           const size_t           n_bytes,
+                           std::vector<uint8_t> & out);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void base64_encode(const uint8_t * data,
+                   const size_t    n_bytes,
+                   std::string   & out);
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "vtk_utilities.cpp"
+#endif
+
+#endif // CINO_VTK_UTILITIES_H
@@ -0,0 +1,89 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/io/write_CINOBIN.h>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+namespace cinolib
+{
+
+CINO_INLINE
+void write_CINOBIN(const char                        * filename,
+                   const int                           mesh_type,
+                   const std::vector<CinobinSection> & sections)
+{
+    FILE *f = fopen(filename, "wb");
+    if(!f)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : write_CINOBIN() : couldn't write output file " << filename << std::endl;
+        exit(-1);
+    }
+
+    auto align = [](const uint64_t pos) { return (pos + 63) & ~uint64_t(63); };
+
+    // header
+    const char magic[8]  = { 'C','I','N','O','B','I','N','\0' };
+    uint32_t   header[4] = { CINOBIN_VERSION, 0x01020304, uint32_t(mesh_type), uint32_t(sections.size()) };
+    fwrite(magic,  1, 8, f);
+    fwrite(header, 4, 4, f);
+
+    // section table
+    uint64_t pos = align(24 + 48*sections.size());
+    for(const auto & s : sections)
+    {
+        char name[32];
+        memset(name, 0, 32);
+        strncpy(name, s.name.c_str(), 31);
+        uint64_t entry[2] = { pos, s.data.size() };
+        fwrite(name,  1, 32, f);
+        fwrite(entry, 8,  2, f);
+        pos = align(pos + s.data.size());
+    }
+
+    // payload
+    const char zeros[64] = {};
+    pos = 24 + 48*sections.size();
+    for(const auto & s : sections)
+    {
+        fwrite(zeros, 1, align(pos)-pos, f);
+        fwrite(s.data.data(), 1, s.data.size(), f);
+        pos = align(pos) + s.data.size();
+    }
+    fclose(f);
+}
+
+}
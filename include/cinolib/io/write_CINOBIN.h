@@ -0,0 +1,93 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_WRITE_CINOBIN_H
+#define CINO_WRITE_CINOBIN_H
+
+#include <sys/types.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <cinolib/cino_inline.h>
+
+namespace cinolib
+{
+
+/* CINOBIN is the native binary format of CinoLib. It is meant as a cache for meshes
+ * that are loaded over and over, as it stores not only vertices and elements, but also
+ * all the adjacency relations and the per element attributes, which therefore do not
+ * have to be recomputed at loading time. Data is stored in the byte order of the host.
+ *
+ * File layout:
+ *
+ *   header  : magic "CINOBIN\0", format version, byte order mark, mesh type, #sections
+ *   table   : for each section, its name (max 31 chars), offset and size (in bytes)
+ *   payload : raw content of each section, aligned at 64 bytes, so that arrays can be
+ *             accessed in place once the file is memory mapped
+ *
+ * Sections are named blobs of raw data. Their meaning is defined by the mesh classes
+ * (see AbstractMesh::export_CINOBIN). Readers ignore the sections they do not know.
+*/
+
+static const uint CINOBIN_VERSION = 1;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct CinobinSection
+{
+    std::string       name;
+    std::vector<char> data;
+
+    CinobinSection(const std::string & name, const void * ptr, const size_t bytes)
+        : name(name), data((const char*)ptr, (const char*)ptr + bytes) {}
+
+    template<typename T>
+    CinobinSection(const std::string & name, const std::vector<T> & v)
+        : CinobinSection(name, v.data(), v.size()*sizeof(T)) {}
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void write_CINOBIN(const char                        * filename,
+                   const int                           mesh_type,
+                   const std::vector<CinobinSection> & sections);
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "write_CINOBIN.cpp"
+#endif
+
+#endif // CINO_WRITE_CINOBIN_H
@@ -34,167 +34,249 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/write_VTK.h>
-
-
-#ifdef CINOLIB_USES_VTK
-#include <vtkSmartPointer.h>
-#include <vtkCell.h>
-#include <vtkCellData.h>
-#include <vtkIntArray.h>
-#include <vtkUnstructuredGrid.h>
-#include <vtkUnstructuredGridWriter.h>
-#endif
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
 
 namespace cinolib
 {
 
-#ifdef CINOLIB_USES_VTK
-
-CINO_INLINE
-void write_VTK(const char                           * filename,
-               const std::vector<vec3d>             & verts,
-               const std::vector<std::vector<uint>> & polys)
+namespace
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
-
-    vtkSmartPointer<vtkUnstructuredGridWriter> writer = vtkSmartPointer<vtkUnstructuredGridWriter>::New();
-    vtkSmartPointer<vtkUnstructuredGrid>       grid   = vtkSmartPointer<vtkUnstructuredGrid>::New();
-    vtkSmartPointer<vtkPoints>                 points = vtkSmartPointer<vtkPoints>::New();
-
-    points->SetDataTypeToDouble();
-
-    // generate some arrays that allow each element type to be viewed alone by thresholding
-    //
-    vtkSmartPointer<vtkIntArray> tetselector = vtkSmartPointer<vtkIntArray>::New();
-    vtkSmartPointer<vtkIntArray> hexselector = vtkSmartPointer<vtkIntArray>::New();
-    tetselector->SetName("tet_selector");
-    hexselector->SetName("hex_selector");
 
-    for(const vec3d & v : verts)
-    {
-        points->InsertNextPoint(v.x(), v.y(), v.z());
-    }
+// streams values either as text (a few per line) or as big endian binary data
+//
+class LegacyStream
+{
+    public:
 
-    bool has_tets = false;
-    bool has_hexa = false;
+        LegacyStream(std::ofstream & f, const bool binary) : f(f), binary(binary), swap(host_is_little_endian()) {}
 
-    for(auto p : polys)
-    {
-        switch (p.size())
+        void put(const double d)
         {
-            case 4:
+            if(binary) put_bytes(&d, 8);
+            else
             {
-                vtkIdType pid[] = { p.at(0), p.at(1), p.at(2), p.at(3) };
-                grid->InsertNextCell(VTK_TETRA, 4, pid);
-                tetselector->InsertNextValue(1);
-                hexselector->InsertNextValue(0);
-                has_tets = true;
-                break;
+                char str[32];
+                snprintf(str, 32, "%.17g", d);
+                put_text(str);
             }
+        }
 
-            case 8:
+        void put(const int32_t i)
+        {
+            if(binary) put_bytes(&i, 4);
+            else
             {
-                vtkIdType pid[] = { p.at(0), p.at(1), p.at(2), p.at(3),
-                                    p.at(4), p.at(5), p.at(6), p.at(7) };
-                grid->InsertNextCell(VTK_HEXAHEDRON, 8, pid);
-                tetselector->InsertNextValue(0);
-                hexselector->InsertNextValue(1);
-                has_hexa = true;
-                break;
+                char str[16];
+                snprintf(str, 16, "%d", i);
+                put_text(str);
             }
+        }
 
-            default: assert(false && "Unsupported Polyhedron!");
+        void finish()
+        {
+            f.write(buf.data(), std::streamsize(buf.size()));
+            f << "\n";
+            buf.clear();
+            count = 0;
         }
+
+    private:
+
+        void put_bytes(const void * data, const size_t size)
+        {
+            char bytes[8];
+            memcpy(bytes, data, size);
+            if(swap) std::reverse(bytes, bytes+size);
+            buf.insert(buf.end(), bytes, bytes+size);
+            if(buf.size()>65536) { f.write(buf.data(), std::streamsize(buf.size())); buf.clear(); }
+        }
+
+        void put_text(const char * str)
+        {
+            if(count>0) buf.push_back((count%9==0) ? '\n' : ' ');
+            buf.insert(buf.end(), str, str+strlen(str));
+            ++count;
+            if(buf.size()>65536) { f.write(buf.data(), std::streamsize(buf.size())); buf.clear(); }
+        }
+
+        std::ofstream   & f;
+        bool              binary;
+        bool              swap;
+        std::vector<char> buf;
+        size_t            count = 0;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void write_field(std::ofstream & f, const std::vector<VTKArray> & arrays, const bool binary)
+{
+    f << "FIELD FieldData " << arrays.size() << "\n";
+    for(const VTKArray & a : arrays)
+    {
+        // names cannot contain white spaces
+        std::string name = a.name.empty() ? "unnamed" : a.name;
+        std::replace(name.begin(), name.end(), ' ', '_');
+        f << name << " " << a.n_comps << " " << a.size() << " double\n";
+        LegacyStream s(f, binary);
+        for(double d : a.values) s.put(d);
+        s.finish();
     }
+}
 
-    grid->SetPoints(points);
-    if (has_tets) grid->GetCellData()->AddArray(tetselector);
-    if (has_hexa) grid->GetCellData()->AddArray(hexselector);
-
-#if VTK_MAJOR_VERSION < 6
-    writer->SetInput( grid );
-#else
-    writer->SetInputData(grid);
-#endif
-    writer->SetFileName(filename);
-    writer->Write();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void write_VTK(const char                * filename,
-               const std::vector<double> & xyz,
-               const std::vector<uint>   & tets,
-               const std::vector<uint>   & hexa)
+void write_VTK(const char            * filename,
+               const VTKGrid         & grid,
+               const VTKWriteOptions & opt)
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
+    std::ofstream f(filename, std::ios::out | std::ios::binary);
+    if(!f.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : write_VTK() : couldn't open output file " << filename << std::endl;
+        return;
+    }
 
-    vtkSmartPointer<vtkUnstructuredGridWriter> writer = vtkSmartPointer<vtkUnstructuredGridWriter>::New();
-    vtkSmartPointer<vtkUnstructuredGrid>       grid   = vtkSmartPointer<vtkUnstructuredGrid>::New();
-    vtkSmartPointer<vtkPoints>                 points = vtkSmartPointer<vtkPoints>::New();
+    bool binary = (opt.format!=VTK_FORMAT_ASCII);
 
-    // write the vertex coordinates
-    //
-    for(size_t i=0; i<xyz.size(); i+=3)
+    f << "# vtk DataFile Version 3.0\n";
+    f << "cinolib\n";
+    f << (binary ? "BINARY\n" : "ASCII\n");
+    f << "DATASET UNSTRUCTURED_GRID\n";
+
+    f << "POINTS " << grid.verts.size() << " double\n";
     {
-        points->InsertNextPoint(xyz[i+0], xyz[i+1], xyz[i+2]);
+        LegacyStream s(f, binary);
+        for(const vec3d & v : grid.verts) { s.put(v.x()); s.put(v.y()); s.put(v.z()); }
+        s.finish();
     }
 
-    // write the tetrahedra
-    //
-    for(size_t i=0; i<tets.size(); i+=4)
+    // classic layout: [n, ids...] for each cell. Polyhedra are encoded as face streams
+    size_t size      = 0;
+    size_t face_beg  = 0;
+    bool   polyhedra = (grid.face_offsets.size()==grid.num_cells());
+    for(size_t cid=0; cid<grid.num_cells(); ++cid)
     {
-        vtkIdType pid[] = { tets[i+0], tets[i+1], tets[i+2], tets[i+3] };
-        grid->InsertNextCell(VTK_TETRA, 4, pid);
+        if(polyhedra && grid.face_offsets.at(cid)>=0)
+        {
+            size     += 1 + size_t(grid.face_offsets.at(cid)) - face_beg;
+            face_beg  = size_t(grid.face_offsets.at(cid));
+        }
+        else size += 1 + grid.offsets.at(cid) - (cid>0 ? grid.offsets.at(cid-1) : 0);
     }
 
-    // write the hexahedra
-    //
-    for(size_t i=0; i<hexa.size(); i+=8 )
+    f << "CELLS " << grid.num_cells() << " " << size << "\n";
     {
-        vtkIdType pid[] = { hexa[i+0], hexa[i+1], hexa[i+2], hexa[i+3],
-                            hexa[i+4], hexa[i+5], hexa[i+6], hexa[i+7] };
-        grid->InsertNextCell(VTK_HEXAHEDRON, 8, pid);
+        LegacyStream s(f, binary);
+        face_beg = 0;
+        for(size_t cid=0; cid<grid.num_cells(); ++cid)
+        {
+            size_t beg, end;
+            const uint *ids;
+            if(polyhedra && grid.face_offsets.at(cid)>=0)
+            {
+                beg      = face_beg;
+                end      = size_t(grid.face_offsets.at(cid));
+                ids      = grid.faces.data();
+                face_beg = end;
+            }
+            else
+            {
+                beg = (cid>0) ? grid.offsets.at(cid-1) : 0;
+                end = grid.offsets.at(cid);
+                ids = grid.conn.data();
+            }
+            s.put(int32_t(end-beg));
+            for(size_t i=beg; i<end; ++i) s.put(int32_t(ids[i]));
+        }
+        s.finish();
     }
 
-    // create the output mesh
-    //
-    grid->SetPoints(points);
-
-#if VTK_MAJOR_VERSION < 6
-    writer->SetInput(grid);
-#else
-    writer->SetInputData(grid);
-#endif
-    writer->SetFileName(filename);
-    writer->Write();
+    f << "CELL_TYPES " << grid.num_cells() << "\n";
+    {
+        LegacyStream s(f, binary);
+        for(uint8_t t : grid.types) s.put(int32_t(t));
+        s.finish();
+    }
+
+    if(!grid.cell_data.empty())
+    {
+        f << "CELL_DATA " << grid.num_cells() << "\n";
+        write_field(f, grid.cell_data, binary);
+    }
+    if(!grid.point_data.empty())
+    {
+        f << "POINT_DATA " << grid.verts.size() << "\n";
+        write_field(f, grid.point_data, binary);
+    }
 }
 
-#else
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void write_VTK(const char                *,
-               const std::vector<double> &,
-               const std::vector<uint>   &,
-               const std::vector<uint>   &)
+void write_VTK(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & polys)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    VTKGrid grid;
+    vtk_polys_to_grid(verts, polys, grid);
+    write_VTK(filename, grid);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void write_VTK(const char                * filename,
+               const std::vector<double> & xyz,
+               const std::vector<uint>   & tets,
+               const std::vector<uint>   & hexa)
+{
+    std::vector<vec3d> verts;
+    for(size_t i=0; i+2<xyz.size(); i+=3) verts.push_back(vec3d(xyz[i], xyz[i+1], xyz[i+2]));
+    std::vector<std::vector<uint>> polys;
+    for(size_t i=0; i+3<tets.size(); i+=4) polys.push_back(std::vector<uint>(tets.begin()+i, tets.begin()+i+4));
+    for(size_t i=0; i+7<hexa.size(); i+=8) polys.push_back(std::vector<uint>(hexa.begin()+i, hexa.begin()+i+8));
+    write_VTK(filename, verts, polys);
+}
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void write_VTK(const char                           *,
-               const std::vector<vec3d>             &,
-               const std::vector<std::vector<uint>> &)
+void write_VTK(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<int>               & vert_labels,
+               const std::vector<int>               & poly_labels)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    VTKGrid grid;
+    vtk_polys_to_grid(verts, polys, grid);
+    if(!vert_labels.empty()) grid.point_data.push_back(VTKArray("label", std::vector<double>(vert_labels.begin(), vert_labels.end())));
+    if(!poly_labels.empty()) grid.cell_data.push_back (VTKArray("label", std::vector<double>(poly_labels.begin(), poly_labels.end())));
+    write_VTK(filename, grid);
 }
 
-#endif
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void write_VTK(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & faces,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<std::vector<bool>> & polys_face_winding,
+               const std::vector<int>               & vert_labels,
+               const std::vector<int>               & poly_labels)
+{
+    VTKGrid grid;
+    vtk_polyhedra_to_grid(verts, faces, polys, polys_face_winding, grid);
+    if(!vert_labels.empty()) grid.point_data.push_back(VTKArray("label", std::vector<double>(vert_labels.begin(), vert_labels.end())));
+    if(!poly_labels.empty()) grid.cell_data.push_back (VTKArray("label", std::vector<double>(poly_labels.begin(), poly_labels.end())));
+    write_VTK(filename, grid);
+}
 
 }
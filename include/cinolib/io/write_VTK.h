@@ -40,18 +40,30 @@
 #include <vector>
 #include <cinolib/cino_inline.h>
 #include <cinolib/geometry/vec_mat.h>
-
+#include <cinolib/io/vtk_utilities.h>
 
 namespace cinolib
 {
 
+/* Native writer for the legacy format of unstructured grids (.vtk). Files are ASCII
+ * if opt.format is VTK_FORMAT_ASCII, and BINARY (big endian) otherwise. Cells are
+ * written with the classic layout (CELLS n size), which is understood by all VTK
+ * versions, and point/cell data arrays as FIELD arrays. Compression is not available.
+*/
+
+CINO_INLINE
+void write_VTK(const char            * filename,
+               const VTKGrid         & grid,
+               const VTKWriteOptions & opt = VTKWriteOptions());
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 void write_VTK(const char                * filename,
                const std::vector<double> & xyz,
                const std::vector<uint>   & tets,
                const std::vector<uint>   & hexa);
 
-
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
@@ -59,6 +71,31 @@ void write_VTK(const char                           * filename,
                const std::vector<vec3d>             & verts,
                const std::vector<std::vector<uint>> & polys);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// labels are stored as point/cell data arrays named "label"
+//
+CINO_INLINE
+void write_VTK(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<int>               & vert_labels,
+               const std::vector<int>               & poly_labels);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// general polyhedra (e.g. Polyhedralmesh). Labels are stored as point/cell
+// data arrays named "label" (pass empty vectors to skip them)
+//
+CINO_INLINE
+void write_VTK(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & faces,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<std::vector<bool>> & polys_face_winding,
+               const std::vector<int>               & vert_labels = std::vector<int>(),
+               const std::vector<int>               & poly_labels = std::vector<int>());
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -34,179 +34,406 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/write_VTU.h>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
 
-
-#ifdef CINOLIB_USES_VTK
-#include <vtkSmartPointer.h>
-#include <vtkCell.h>
-#include <vtkCellData.h>
-#include <vtkIntArray.h>
-#include <vtkUnstructuredGrid.h>
-#include <vtkXMLUnstructuredGridWriter.h>
+#ifdef CINOLIB_USES_ZLIB
+#include <zlib.h>
 #endif
 
 namespace cinolib
 {
 
-#ifdef CINOLIB_USES_VTK
+namespace
+{
 
-CINO_INLINE
-void write_VTU(const char                           * filename,
-               const std::vector<vec3d>             & verts,
-               const std::vector<std::vector<uint>> & polys)
+struct OutArray
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
+    std::string          name;
+    std::string          type;          // XML scalar type
+    uint                 n_comps = 1;
+    const uint8_t      * data    = nullptr;
+    size_t               n_bytes = 0;
+    std::streampos       offset_pos;    // where the offset attribute must be written (appended data)
+    std::vector<int32_t> ints;          // storage for integer data arrays
+};
 
-    vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
-    vtkSmartPointer<vtkUnstructuredGrid>          grid   = vtkSmartPointer<vtkUnstructuredGrid>::New();
-    vtkSmartPointer<vtkPoints>                    points = vtkSmartPointer<vtkPoints>::New();
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    // generate some arrays that allow each element type to be viewed alone by thresholding
-    //
-    vtkSmartPointer<vtkIntArray> tetselector = vtkSmartPointer<vtkIntArray>::New();
-    vtkSmartPointer<vtkIntArray> hexselector = vtkSmartPointer<vtkIntArray>::New();
-    tetselector->SetName("tet_selector");
-    hexselector->SetName("hex_selector");
+template<typename T>
+CINO_INLINE
+void set_data(OutArray & a, const char * type, const std::vector<T> & v)
+{
+    a.type    = type;
+    a.data    = reinterpret_cast<const uint8_t*>(v.data());
+    a.n_bytes = v.size()*sizeof(T);
+}
 
-    for(const vec3d & v : verts)
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// point and cell data arrays made of integers only (e.g. labels) are stored as Int32
+//
+CINO_INLINE
+void set_data(OutArray & a, const VTKArray & va)
+{
+    a.name    = va.name;
+    a.n_comps = va.n_comps;
+    bool all_ints = !va.values.empty();
+    for(double d : va.values)
+    {
+        if(d!=std::floor(d) || std::fabs(d)>2147483647.0) { all_ints = false; break; }
+    }
+    if(all_ints)
     {
-        points->InsertNextPoint(v.x(), v.y(), v.z());
+        a.ints.reserve(va.values.size());
+        for(double d : va.values) a.ints.push_back(int32_t(d));
+        set_data(a, "Int32", a.ints);
     }
+    else set_data(a, "Float64", va.values);
+}
 
-    bool has_tets = false;
-    bool has_hexa = false;
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(auto p : polys)
+CINO_INLINE
+void write_ascii(std::ofstream & f, const OutArray & a)
+{
+    uint   size = vtk_type_size(a.type);
+    size_t n    = a.n_bytes/size;
+    char   str[32];
+    for(size_t i=0; i<n; ++i)
     {
-        switch (p.size())
+        const uint8_t *p = a.data + i*size;
+        if(a.type=="Float64") { double   d; memcpy(&d, p, 8); snprintf(str, 32, "%.17g", d); } else
+        if(a.type=="Int64"  ) { int64_t  x; memcpy(&x, p, 8); snprintf(str, 32, "%lld", (long long)x); } else
+        if(a.type=="UInt64" ) { uint64_t x; memcpy(&x, p, 8); snprintf(str, 32, "%llu", (unsigned long long)x); } else
+        if(a.type=="Int32"  ) { int32_t  x; memcpy(&x, p, 4); snprintf(str, 32, "%d",  x); } else
+        if(a.type=="UInt32" ) { uint32_t x; memcpy(&x, p, 4); snprintf(str, 32, "%u",  x); } else
+        if(a.type=="UInt8"  ) { snprintf(str, 32, "%u", uint(*p)); }
+        f << ((i%12==0) ? "\n          " : " ") << str;
+    }
+    f << "\n";
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// encodes a sequence of byte chunks as a single base64 stream
+//
+class Base64Stream
+{
+    public:
+
+        explicit Base64Stream(std::ofstream & f) : f(f) {}
+
+        void put(const uint8_t * data, size_t n)
         {
-            case 4:
+            while(n>0)
             {
-                vtkIdType pid[] = { p.at(0), p.at(1), p.at(2), p.at(3) };
-                grid->InsertNextCell(VTK_TETRA, 4, pid);
-                tetselector->InsertNextValue(1);
-                hexselector->InsertNextValue(0);
-                has_tets = true;
-                break;
+                if(n_rem>0 || n<3)
+                {
+                    rem[n_rem++] = *data++;
+                    --n;
+                    if(n_rem==3) { flush(rem, 3); n_rem = 0; }
+                    continue;
+                }
+                size_t chunk = std::min(n - n%3, size_t(3*16384));
+                flush(data, chunk);
+                data += chunk;
+                n    -= chunk;
             }
+        }
 
-            case 8:
-            {
-                vtkIdType pid[] = { p.at(0), p.at(1), p.at(2), p.at(3),
-                                    p.at(4), p.at(5), p.at(6), p.at(7) };
-                grid->InsertNextCell(VTK_HEXAHEDRON, 8, pid);
-                tetselector->InsertNextValue(0);
-                hexselector->InsertNextValue(1);
-                has_hexa = true;
-                break;
-            }
+        void finish()
+        {
+            if(n_rem>0) flush(rem, n_rem);
+            n_rem = 0;
+        }
+
+    private:
+
+        void flush(const uint8_t * data, size_t n)
+        {
+            str.clear();
+            base64_encode(data, n, str);
+            f.write(str.data(), std::streamsize(str.size()));
+        }
+
+        std::ofstream & f;
+        uint8_t         rem[3];
+        size_t          n_rem = 0;
+        std::string     str;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-            default: assert(false && "Unsupported Polyhedron!");
+// writes the array as it appears in the binary formats, i.e. header followed by data
+// (uncompressed) or [#blocks, block size, last block size, block sizes] followed by
+// compressed blocks. For inline (base64) arrays the whole array is compressed in memory,
+// appended arrays are compressed one block at a time, patching the header at the end
+//
+CINO_INLINE
+void write_binary(std::ofstream & f, const OutArray & a, const VTKWriteOptions & opt, const bool compress, const bool base64)
+{
+    if(!compress)
+    {
+        uint64_t header = a.n_bytes;
+        if(base64)
+        {
+            Base64Stream s(f);
+            s.put(reinterpret_cast<const uint8_t*>(&header), 8);
+            s.put(a.data, a.n_bytes);
+            s.finish();
+        }
+        else
+        {
+            f.write(reinterpret_cast<const char*>(&header), 8);
+            f.write(reinterpret_cast<const char*>(a.data), std::streamsize(a.n_bytes));
         }
+        return;
     }
 
-    grid->SetPoints(points);
-    if (has_tets) grid->GetCellData()->AddArray(tetselector);
-    if (has_hexa) grid->GetCellData()->AddArray(hexselector);
+#ifdef CINOLIB_USES_ZLIB
+    uint64_t bs = std::max(opt.block_size, 1u);
+    uint64_t nb = (a.n_bytes+bs-1)/bs;
+    std::vector<uint64_t> header = { nb, bs, a.n_bytes%bs };
+    header.resize(3+nb, 0);
 
-#if VTK_MAJOR_VERSION < 6
-    writer->SetInput( grid );
+    std::streampos       header_pos = f.tellp();
+    std::vector<uint8_t> inline_data;
+    if(!base64) f.write(reinterpret_cast<const char*>(header.data()), std::streamsize(8*header.size()));
+
+    std::vector<uint8_t> block(compressBound(uLong(bs)));
+    for(uint64_t i=0; i<nb; ++i)
+    {
+        uLong  src_len = uLong(std::min(bs, a.n_bytes-i*bs));
+        uLongf dst_len = uLongf(block.size());
+        compress2(block.data(), &dst_len, a.data+i*bs, src_len, Z_DEFAULT_COMPRESSION);
+        header.at(3+i) = dst_len;
+        if(base64) inline_data.insert(inline_data.end(), block.begin(), block.begin()+dst_len);
+        else       f.write(reinterpret_cast<const char*>(block.data()), std::streamsize(dst_len));
+    }
+
+    if(base64)
+    {
+        // header and data are encoded as two separate streams
+        Base64Stream s(f);
+        s.put(reinterpret_cast<const uint8_t*>(header.data()), 8*header.size());
+        s.finish();
+        s.put(inline_data.data(), inline_data.size());
+        s.finish();
+    }
+    else
+    {
+        std::streampos end_pos = f.tellp();
+        f.seekp(header_pos);
+        f.write(reinterpret_cast<const char*>(header.data()), std::streamsize(8*header.size()));
+        f.seekp(end_pos);
+    }
 #else
-    writer->SetInputData(grid);
+    (void)opt;
+    (void)base64;
+    assert(false && "zlib missing");
 #endif
-    writer->SetFileName(filename);
-    writer->Write();
+}
+
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void write_VTU(const char                * filename,
-               const std::vector<double> & xyz,
-               const std::vector<uint>   & tets,
-               const std::vector<uint>   & hexa)
+void write_VTU(const char            * filename,
+               const VTKGrid         & grid,
+               const VTKWriteOptions & opt)
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
-
-    vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
-    vtkSmartPointer<vtkUnstructuredGrid>          grid   = vtkSmartPointer<vtkUnstructuredGrid>::New();
-    vtkSmartPointer<vtkPoints>                    points = vtkSmartPointer<vtkPoints>::New();
-
-    // generate some arrays that allow each element type to be viewed alone by thresholding
-    //
-    vtkSmartPointer<vtkIntArray> tetselector = vtkSmartPointer<vtkIntArray>::New();
-    vtkSmartPointer<vtkIntArray> hexselector = vtkSmartPointer<vtkIntArray>::New();
-    tetselector->SetName("tet_selector");
-    hexselector->SetName("hex_selector");
-
-    // write the vertex coordinates
-    //
-    for(size_t i=0; i<xyz.size(); i+=3)
+    std::ofstream f(filename, std::ios::out | std::ios::binary);
+    if(!f.is_open())
     {
-        points->InsertNextPoint(xyz[i+0], xyz[i+1], xyz[i+2]);
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : write_VTU() : couldn't open output file " << filename << std::endl;
+        return;
     }
 
-    // write the tetrahedra
-    //
-    for(size_t i=0; i<tets.size(); i+=4)
+#ifdef CINOLIB_USES_ZLIB
+    bool compress = opt.compress && opt.format!=VTK_FORMAT_ASCII;
+#else
+    bool compress = false;
+#endif
+
+    std::vector<OutArray> point_data(grid.point_data.size());
+    std::vector<OutArray> cell_data (grid.cell_data.size());
+    for(size_t i=0; i<point_data.size(); ++i) set_data(point_data.at(i), grid.point_data.at(i));
+    for(size_t i=0; i<cell_data.size();  ++i) set_data(cell_data.at(i),  grid.cell_data.at(i));
+
+    std::vector<double> xyz;
+    xyz.reserve(3*grid.verts.size());
+    for(const vec3d & v : grid.verts)
     {
-        vtkIdType pid[] = { tets[i+0], tets[i+1], tets[i+2], tets[i+3] };
-        grid->InsertNextCell(VTK_TETRA, 4, pid);
-        tetselector->InsertNextValue(1);
-        hexselector->InsertNextValue(0);
+        xyz.push_back(v.x());
+        xyz.push_back(v.y());
+        xyz.push_back(v.z());
     }
 
-    // write the hexahedra
-    //
-    for(size_t i=0; i<hexa.size(); i+=8 )
+    OutArray points, conn, offsets, types, faces, face_offsets;
+    points.name       = "Points";
+    points.n_comps    = 3;
+    conn.name         = "connectivity";
+    offsets.name      = "offsets";
+    types.name        = "types";
+    faces.name        = "faces";
+    face_offsets.name = "faceoffsets";
+    set_data(points,       "Float64", xyz);
+    set_data(conn,         "UInt32",  grid.conn);
+    set_data(offsets,      (sizeof(size_t)==8) ? "UInt64" : "UInt32", grid.offsets);
+    set_data(types,        "UInt8",   grid.types);
+    set_data(faces,        "UInt32",  grid.faces);
+    set_data(face_offsets, "Int64",   grid.face_offsets);
+
+    const char *format = (opt.format==VTK_FORMAT_ASCII)  ? "ascii"  :
+                         (opt.format==VTK_FORMAT_BINARY) ? "binary" : "appended";
+
+    auto data_array = [&](OutArray & a)
+    {
+        f << "        <DataArray type=\"" << a.type << "\" Name=\"" << a.name << "\"";
+        if(a.n_comps>1) f << " NumberOfComponents=\"" << a.n_comps << "\"";
+        f << " format=\"" << format << "\"";
+        if(opt.format==VTK_FORMAT_APPENDED)
+        {
+            // offsets are known only once the (compressed) data has been written
+            f << " offset=\"";
+            a.offset_pos = f.tellp();
+            f << "                    \"/>\n";
+            return;
+        }
+        f << ">";
+        if(opt.format==VTK_FORMAT_ASCII) write_ascii(f, a);
+        else
+        {
+            f << "\n          ";
+            write_binary(f, a, opt, compress, true);
+            f << "\n";
+        }
+        f << "        </DataArray>\n";
+    };
+
+    f << "<?xml version=\"1.0\"?>\n";
+    f << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+      << (host_is_little_endian() ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\"";
+    if(compress) f << " compressor=\"vtkZLibDataCompressor\"";
+    f << ">\n";
+    f << "  <UnstructuredGrid>\n";
+    f << "    <Piece NumberOfPoints=\"" << grid.verts.size() << "\" NumberOfCells=\"" << grid.num_cells() << "\">\n";
+    f << "      <PointData>\n";
+    for(OutArray & a : point_data) data_array(a);
+    f << "      </PointData>\n";
+    f << "      <CellData>\n";
+    for(OutArray & a : cell_data) data_array(a);
+    f << "      </CellData>\n";
+    f << "      <Points>\n";
+    data_array(points);
+    f << "      </Points>\n";
+    f << "      <Cells>\n";
+    data_array(conn);
+    data_array(offsets);
+    data_array(types);
+    if(!grid.face_offsets.empty())
     {
-        vtkIdType pid[] = { hexa[i+0], hexa[i+1], hexa[i+2], hexa[i+3],
-                            hexa[i+4], hexa[i+5], hexa[i+6], hexa[i+7] };
-        grid->InsertNextCell(VTK_HEXAHEDRON, 8, pid);
-        tetselector->InsertNextValue(0);
-        hexselector->InsertNextValue(1);
+        data_array(faces);
+        data_array(face_offsets);
     }
+    f << "      </Cells>\n";
+    f << "    </Piece>\n";
+    f << "  </UnstructuredGrid>\n";
 
-    // create the output mesh
-    //
-    grid->SetPoints(points);
+    if(opt.format==VTK_FORMAT_APPENDED)
+    {
+        std::vector<OutArray*> all;
+        for(OutArray & a : point_data) all.push_back(&a);
+        for(OutArray & a : cell_data)  all.push_back(&a);
+        all.push_back(&points);
+        all.push_back(&conn);
+        all.push_back(&offsets);
+        all.push_back(&types);
+        if(!grid.face_offsets.empty())
+        {
+            all.push_back(&faces);
+            all.push_back(&face_offsets);
+        }
 
-    if (tets.size() > 0) grid->GetCellData()->AddArray(tetselector);
-    if (hexa.size() > 0) grid->GetCellData()->AddArray(hexselector);
+        f << "  <AppendedData encoding=\"raw\">\n   _";
+        std::streampos base = f.tellp();
+        for(OutArray *a : all)
+        {
+            std::streampos pos = f.tellp();
+            f.seekp(a->offset_pos);
+            f << (long long)(pos-base);
+            f.seekp(pos);
+            write_binary(f, *a, opt, compress, false);
+        }
+        f << "\n  </AppendedData>\n";
+    }
+    f << "</VTKFile>\n";
+}
 
-#if VTK_MAJOR_VERSION < 6
-    writer->SetInput( grid );
-#else
-    writer->SetInputData(grid);
-#endif
-    writer->SetFileName(filename);
-    writer->Write();
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void write_VTU(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & polys)
+{
+    VTKGrid grid;
+    vtk_polys_to_grid(verts, polys, grid);
+    write_VTU(filename, grid);
 }
 
-#else
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void write_VTU(const char                *,
-               const std::vector<double> &,
-               const std::vector<uint>   &,
-               const std::vector<uint>   &)
+void write_VTU(const char                * filename,
+               const std::vector<double> & xyz,
+               const std::vector<uint>   & tets,
+               const std::vector<uint>   & hexa)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    std::vector<vec3d> verts;
+    for(size_t i=0; i+2<xyz.size(); i+=3) verts.push_back(vec3d(xyz[i], xyz[i+1], xyz[i+2]));
+    std::vector<std::vector<uint>> polys;
+    for(size_t i=0; i+3<tets.size(); i+=4) polys.push_back(std::vector<uint>(tets.begin()+i, tets.begin()+i+4));
+    for(size_t i=0; i+7<hexa.size(); i+=8) polys.push_back(std::vector<uint>(hexa.begin()+i, hexa.begin()+i+8));
+    write_VTU(filename, verts, polys);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void write_VTU(const char                           *,
-               const std::vector<vec3d>             &,
-               const std::vector<std::vector<uint>> &)
+void write_VTU(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<int>               & vert_labels,
+               const std::vector<int>               & poly_labels)
 {
-    std::cerr << "ERROR : VTK missing. Install VTK and recompile defining symbol CINOLIB_USES_VTK" << std::endl;
-    exit(-1);
+    VTKGrid grid;
+    vtk_polys_to_grid(verts, polys, grid);
+    if(!vert_labels.empty()) grid.point_data.push_back(VTKArray("label", std::vector<double>(vert_labels.begin(), vert_labels.end())));
+    if(!poly_labels.empty()) grid.cell_data.push_back (VTKArray("label", std::vector<double>(poly_labels.begin(), poly_labels.end())));
+    write_VTU(filename, grid);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-#endif
+CINO_INLINE
+void write_VTU(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & faces,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<std::vector<bool>> & polys_face_winding,
+               const std::vector<int>               & vert_labels,
+               const std::vector<int>               & poly_labels)
+{
+    VTKGrid grid;
+    vtk_polyhedra_to_grid(verts, faces, polys, polys_face_winding, grid);
+    if(!vert_labels.empty()) grid.point_data.push_back(VTKArray("label", std::vector<double>(vert_labels.begin(), vert_labels.end())));
+    if(!poly_labels.empty()) grid.cell_data.push_back (VTKArray("label", std::vector<double>(poly_labels.begin(), poly_labels.end())));
+    write_VTU(filename, grid);
+}
 
 }
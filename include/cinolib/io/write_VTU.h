@@ -40,10 +40,24 @@
 #include <vector>
 #include <cinolib/cino_inline.h>
 #include <cinolib/geometry/vec_mat.h>
+#include <cinolib/io/vtk_utilities.h>
 
 namespace cinolib
 {
 
+/* Native writer for the XML format of unstructured grids (.vtu). Data arrays are written
+ * one at a time, either as ascii, base64 (binary) or raw appended data (default), and are
+ * zlib compressed if requested (and if cinolib is compiled with CINOLIB_USES_ZLIB). Point
+ * and cell data arrays containing only integer values are stored as Int32.
+*/
+
+CINO_INLINE
+void write_VTU(const char            * filename,
+               const VTKGrid         & grid,
+               const VTKWriteOptions & opt = VTKWriteOptions());
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 void write_VTU(const char                * filename,
                const std::vector<double> & xyz,
@@ -57,6 +71,31 @@ void write_VTU(const char                           * filename,
                const std::vector<vec3d>             & verts,
                const std::vector<std::vector<uint>> & polys);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// labels are stored as point/cell data arrays named "label"
+//
+CINO_INLINE
+void write_VTU(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<int>               & vert_labels,
+               const std::vector<int>               & poly_labels);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// general polyhedra (e.g. Polyhedralmesh). Labels are stored as point/cell
+// data arrays named "label" (pass empty vectors to skip them)
+//
+CINO_INLINE
+void write_VTU(const char                           * filename,
+               const std::vector<vec3d>             & verts,
+               const std::vector<std::vector<uint>> & faces,
+               const std::vector<std::vector<uint>> & polys,
+               const std::vector<std::vector<bool>> & polys_face_winding,
+               const std::vector<int>               & vert_labels = std::vector<int>(),
+               const std::vector<int>               & poly_labels = std::vector<int>());
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -55,6 +55,29 @@ Isosurface<M,V,E,F,P>::Isosurface(const Tetmesh<M,V,E,F,P> & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+std::vector<Isosurface<M,V,E,F,P>> Isosurface<M,V,E,F,P>::extract(const Tetmesh<M,V,E,F,P> & m,
+                                                                  const std::vector<float> & iso_values)
+{
+    std::vector<std::vector<vec3d>> verts;
+    std::vector<std::vector<uint>>  tris;
+    std::vector<std::vector<vec3d>> norms;
+    marching_tets(m, std::vector<double>(iso_values.begin(), iso_values.end()), verts, tris, norms);
+
+    std::vector<Isosurface<M,V,E,F,P>> res(iso_values.size());
+    for(uint i=0; i<iso_values.size(); ++i)
+    {
+        res[i].iso_value = iso_values[i];
+        res[i].verts.swap(verts[i]);
+        res[i].tris.swap (tris [i]);
+        res[i].norms.swap(norms[i]);
+    }
+    return res;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
 Trimesh<M,V,E,F> Isosurface<M,V,E,F,P>::export_as_trimesh() const
@@ -61,6 +61,12 @@ class Isosurface
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+        // extracts multiple isosurfaces with a single sweep over the tets (see marching_tets.h)
+        static std::vector<Isosurface<M,V,E,F,P>> extract(const Tetmesh<M,V,E,F,P> & m,
+                                                          const std::vector<float> & iso_values);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
         Trimesh<M,V,E,F> export_as_trimesh() const;
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
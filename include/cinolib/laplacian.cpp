@@ -34,14 +34,52 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/laplacian.h>
+#include <cinolib/sparse_matrix_alloc.h>
+#include <cinolib/parallel_for.h>
 #include <cinolib/symbols.h>
 #include <Eigen/Sparse>
+#include <algorithm>
 
 namespace cinolib
 {
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// Laplacian weights are symmetric, hence they can be computed once per edge
+// and shared by its two endpoints, instead of once per each vertex in the edge
+template<class M, class V, class E, class P>
+CINO_INLINE
+static std::vector<double> laplacian_edge_weights(const AbstractMesh<M,V,E,P> & m, const int mode)
+{
+    std::vector<double> w(m.num_edges());
+    PARALLEL_FOR(0, m.num_edges(), 1000, [&](const uint eid)
+    {
+        w[eid] = m.edge_weight(eid, mode);
+    });
+    return w;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+static double laplacian_diagonal(const AbstractMesh<M,V,E,P> & m, const std::vector<double> & w, const uint vid)
+{
+    double sum = 0.0;
+    for(uint eid : m.adj_v2e(vid)) sum -= w.at(eid);
+    return sum;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+static void laplacian_null_row_warning()
+{
+    std::cerr << "WARNING: null row in the matrix! (disconnected vertex? I put 1 in the diagonal)" << std::endl;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 std::vector<Eigen::Triplet<double>> laplacian_matrix_entries(const AbstractMesh<M,V,E,P> & m,
@@ -49,6 +87,7 @@ std::vector<Eigen::Triplet<double>> laplacian_matrix_entries(const AbstractMesh<
                                                              const int n) // diagonally replicate n times
 {
     std::vector<Entry> entries;
+    std::vector<double> w = laplacian_edge_weights(m, mode);
 
     uint nv = m.num_verts();
     std::vector<uint> base(n);
@@ -56,20 +95,18 @@ std::vector<Eigen::Triplet<double>> laplacian_matrix_entries(const AbstractMesh<
 
     for(uint vid=0; vid<m.num_verts(); ++vid)
     {
-        std::vector<std::pair<uint,double>> wgts;
-        m.vert_weights(vid, mode, wgts);
-        double sum = 0.0;
-        for(auto item : wgts)
+        for(uint eid : m.adj_v2e(vid))
         {
+            uint nbr = m.vert_opposite_to(eid, vid);
             for(int i=0; i<n; ++i)
             {
-                entries.push_back(Entry(base[i] + vid, base[i] + item.first, item.second));
+                entries.push_back(Entry(base[i] + vid, base[i] + nbr, w.at(eid)));
             }
-            sum -= item.second;
         }
+        double sum = laplacian_diagonal(m, w, vid);
         if(sum == 0.0)
         {
-            std::cerr << "WARNING: null row in the matrix! (disconnected vertex? I put 1 in the diagonal)" << std::endl;
+            laplacian_null_row_warning();
             sum = 1.0;
         }
         for(int i=0; i<n; ++i)
@@ -87,11 +124,64 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> laplacian(const AbstractMesh<M,V,E,P> & m, const int mode, const int n)
 {
-    std::vector<Entry> entries = laplacian_matrix_entries(m, mode, n);
+    // The sparsity pattern is known from the connectivity: column vid has
+    // an entry for each vertex adjacent to vid, plus the diagonal. Columns
+    // are filled independently (and in parallel) straight into the CSC
+    // arrays of the matrix. Since L is symmetric, columns and rows coincide.
+    uint nv = m.num_verts();
+    std::vector<double> w = laplacian_edge_weights(m, mode);
+
+    std::vector<uint> col_nnz(n*nv);
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        col_nnz.at(vid) = m.adj_v2e(vid).size() + 1;
+    }
+    for(int i=1; i<n; ++i)
+    {
+        std::copy(col_nnz.begin(), col_nnz.begin()+nv, col_nnz.begin()+i*nv);
+    }
+
+    Eigen::SparseMatrix<double> L;
+    sparse_matrix_alloc(L, n*nv, n*nv, col_nnz);
+    const auto *outer = L.outerIndexPtr();
+    auto       *inner = L.innerIndexPtr();
+    double     *value = L.valuePtr();
+
+    std::vector<uint> null_row(nv, 0); // not vector<bool>: concurrent writes on packed bits are unsafe
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
+    {
+        std::vector<std::pair<uint,double>> col;
+        col.reserve(m.adj_v2e(vid).size()+1);
+        for(uint eid : m.adj_v2e(vid))
+        {
+            col.push_back(std::make_pair(m.vert_opposite_to(eid,vid), w[eid]));
+        }
+        double sum = laplacian_diagonal(m, w, vid);
+        if(sum == 0.0)
+        {
+            null_row[vid] = 1;
+            sum = 1.0;
+        }
+        col.push_back(std::make_pair(vid, sum));
+        std::sort(col.begin(), col.end(), [](const std::pair<uint,double> & a,
+                                             const std::pair<uint,double> & b)
+        {
+            return a.first < b.first;
+        });
+
+        for(int i=0; i<n; ++i)
+        {
+            uint off = outer[i*nv + vid];
+            for(const auto & item : col)
+            {
+                inner[off] = i*nv + item.first;
+                value[off] = item.second;
+                ++off;
+            }
+        }
+    });
 
-    uint nv = n*m.num_verts();
-    Eigen::SparseMatrix<double> L(nv,nv);
-    L.setFromTriplets(entries.begin(), entries.end());
+    for(uint vid=0; vid<nv; ++vid) if(null_row.at(vid)) laplacian_null_row_warning();
 
     return L;
 }
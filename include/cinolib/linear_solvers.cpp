@@ -34,7 +34,9 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/linear_solvers.h>
+#include <cinolib/sparse_matrix_alloc.h>
 #include <cinolib/stl_container_utilities.h>
+#include <algorithm>
 
 namespace cinolib
 {
@@ -49,50 +51,9 @@ void solve_square_system(const Eigen::SparseMatrix<double> & A,
                                Eigen::VectorXd             & x,
                          int   solver)
 {
-    assert(A.rows() == A.cols());
-
-    switch (solver)
-    {
-        case SIMPLICIAL_LLT:
-        {
-            Eigen::SimplicialLLT< Eigen::SparseMatrix<double> > solver(A);
-            assert(solver.info() == Eigen::Success);
-            x = solver.solve(b).eval();
-            break;
-        }
-
-        case SIMPLICIAL_LDLT:
-        {
-            Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > solver(A);
-            assert(solver.info() == Eigen::Success);
-            x = solver.solve(b).eval();
-            break;
-        }
-
-        case BiCGSTAB:
-        {
-            Eigen::BiCGSTAB< Eigen::SparseMatrix<double> , Eigen::IncompleteLUT<double> > solver;
-            //solver.setMaxIterations(100);
-            solver.setTolerance(1e-5);
-            solver.compute(A);
-            assert(solver.info() == Eigen::Success);
-            x = solver.solve(b).eval();
-            break;
-        }
-
-        case SparseLU:
-        {
-            Eigen::SparseMatrix<double> Ac = A;
-            Ac.makeCompressed();
-            Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > solver;
-            solver.analyzePattern(Ac);
-            solver.factorize(Ac);
-            x = solver.solve(b);
-            break;
-        }
-
-        default: assert(false && "Unknown Solver");
-    }
+    SparseSolverCache cache(solver);
+    if(!cache.factorize(A)) assert(false && "Factorization failed");
+    cache.solve(b, x);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -104,77 +65,9 @@ void solve_square_system_with_bc(const Eigen::SparseMatrix<double> & A,
                                  const std::map<uint,double>       & bc, // Dirichlet boundary conditions
                                  int   solver)
 {
-    std::vector<int> col_map(A.rows(), 0);
-    for(const auto & obj : bc)
-    {
-        col_map[obj.first] = -1;
-    }
-    uint fresh_id = 0;
-    for(uint col=0; col<A.cols(); ++col)
-    {
-        if(col_map.at(col)==0)
-        {
-            col_map[col] = fresh_id++;
-        }
-    }
-
-    uint size = uint(A.rows() - bc.size());
-
-    std::vector<Entry> Aprime_entries;
-    Eigen::VectorXd    bprime(size);
-
-    for(uint row=0; row<A.rows(); ++row)
-    {
-        if (col_map[row] >= 0)
-        {
-            bprime[ col_map[row] ] = b[row];
-        }
-    }
-
-    //
-    // iterate over the non-zero entries
-    // of sparse matrix A
-    //
-    for (uint i=0; i<A.outerSize(); ++i)
-    {
-        for (Eigen::SparseMatrix<double>::InnerIterator it(A,i); it; ++it)
-        {
-            uint    row = uint(it.row());
-            uint    col = uint(it.col());
-            double val = it.value();
-
-            if (col_map[row] < 0) continue;
-
-            if (col_map[col] < 0)
-            {
-                bprime[ col_map[row] ] -= bc.at(col) * val;
-            }
-            else
-            {
-                Aprime_entries.push_back(Entry(col_map[row], col_map[col], val));
-            }
-        }
-    }
-
-    Eigen::SparseMatrix<double> Aprime(size, size);
-    Aprime.setFromTriplets(Aprime_entries.begin(), Aprime_entries.end());
-
-    Eigen::VectorXd tmp_x(size);
-
-    solve_square_system(Aprime, bprime, tmp_x, solver);
-
-    x.resize(A.cols());
-    for(uint col=0; col<A.cols(); ++col)
-    {
-        if (col_map[col] >= 0)
-        {
-            x[col] = tmp_x[ col_map[col] ];
-        }
-        else
-        {
-            x[col] = bc.at(col);
-        }
-    }
+    SparseSolverCache cache(solver);
+    if(!cache.factorize_with_bc(A, bc)) assert(false && "Factorization failed");
+    cache.solve_with_bc(b, x, bc);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -241,6 +134,302 @@ void solve_weighted_least_squares_with_bc(const Eigen::SparseMatrix<double> & A,
     solve_square_system_with_bc(AtWA, AtWb, x, bc, solver);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SparseSolverCache::factorize(const Eigen::SparseMatrix<double> & A)
+{
+    assert(A.rows() == A.cols());
+
+    A_ff = A;
+    A_ff.makeCompressed();
+
+    bool analyze = !same_pattern(A_ff, std::vector<uint>());
+    if(analyze) store_pattern(A_ff, std::vector<uint>());
+    col_map.clear();
+    nz_map.clear();
+
+    return factorize_system(analyze);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SparseSolverCache::factorize_with_bc(const Eigen::SparseMatrix<double> & A,
+                                          const std::map<uint,double>       & bc)
+{
+    assert(A.rows() == A.cols());
+
+    const Eigen::SparseMatrix<double> *Ap = &A;
+    Eigen::SparseMatrix<double> Ac;
+    if(!A.isCompressed())
+    {
+        Ac = A;
+        Ac.makeCompressed();
+        Ap = &Ac;
+    }
+
+    std::vector<uint> ids;
+    ids.reserve(bc.size());
+    for(const auto & obj : bc) ids.push_back(obj.first); // sorted, as std::map is ordered
+
+    uint n = uint(A.cols());
+    bool analyze = !same_pattern(*Ap, ids) || col_map.size()!=n;
+    if(analyze)
+    {
+        store_pattern(*Ap, ids);
+
+        // free variables are renumbered in increasing order, hence the rows of
+        // each column of the reduced matrices are already sorted
+        std::vector<int> fix_map(n,-1);
+        col_map.assign(n,0);
+        for(uint i=0; i<ids.size(); ++i)
+        {
+            col_map.at(ids.at(i)) = -1;
+            fix_map.at(ids.at(i)) = i;
+        }
+        uint fresh_id = 0;
+        for(uint col=0; col<n; ++col)
+        {
+            if(col_map.at(col)==0) col_map.at(col) = fresh_id++;
+        }
+
+        const int *A_outer = Ap->outerIndexPtr();
+        const int *A_inner = Ap->innerIndexPtr();
+
+        std::vector<uint> ff_nnz(fresh_id,0);
+        std::vector<uint> fc_nnz(ids.size(),0);
+        for(uint col=0; col<n; ++col)
+        for(int k=A_outer[col]; k<A_outer[col+1]; ++k)
+        {
+            if(col_map.at(A_inner[k])<0) continue;
+            if(col_map.at(col)<0) ++fc_nnz.at(fix_map.at(col));
+            else                  ++ff_nnz.at(col_map.at(col));
+        }
+        sparse_matrix_alloc(A_ff, fresh_id, fresh_id,   ff_nnz);
+        sparse_matrix_alloc(A_fc, fresh_id, ids.size(), fc_nnz);
+
+        nz_map.resize(Ap->nonZeros());
+        for(uint col=0; col<n; ++col)
+        {
+            int off = (col_map.at(col)<0) ? A_fc.outerIndexPtr()[fix_map.at(col)]
+                                          : A_ff.outerIndexPtr()[col_map.at(col)];
+            for(int k=A_outer[col]; k<A_outer[col+1]; ++k)
+            {
+                int row = col_map.at(A_inner[k]);
+                if(row<0)
+                {
+                    nz_map.at(k) = -1;
+                }
+                else if(col_map.at(col)<0)
+                {
+                    A_fc.innerIndexPtr()[off] = row;
+                    nz_map.at(k) = -off-2;
+                    ++off;
+                }
+                else
+                {
+                    A_ff.innerIndexPtr()[off] = row;
+                    nz_map.at(k) = off;
+                    ++off;
+                }
+            }
+        }
+    }
+
+    // scatter the coefficients of A into the reduced matrices
+    const double *val = Ap->valuePtr();
+    for(uint k=0; k<nz_map.size(); ++k)
+    {
+        int pos = nz_map[k];
+        if(pos>=0)       A_ff.valuePtr()[pos]    = val[k];
+        else if(pos<-1)  A_fc.valuePtr()[-pos-2] = val[k];
+    }
+
+    return factorize_system(analyze);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+CINO_INLINE
+void SparseSolverCache::solve(const Eigen::VectorXd & b, Eigen::VectorXd & x) const
+{
+    assert(col_map.empty() && "system was factorized with boundary conditions. Use solve_with_bc");
+    solve_system(b, x);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseSolverCache::solve(const Eigen::MatrixXd & B, Eigen::MatrixXd & X) const
+{
+    assert(col_map.empty() && "system was factorized with boundary conditions. Use solve_with_bc");
+    solve_system(B, X);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseSolverCache::solve_with_bc(const Eigen::VectorXd & b, Eigen::VectorXd & x, const std::map<uint,double> & bc) const
+{
+    assert(bc.size() == fixed.size());
+    Eigen::MatrixXd bc_vals(bc.size(),1);
+    uint i = 0;
+    for(const auto & obj : bc)
+    {
+        assert(obj.first == fixed.at(i) && "constrained ids differ from those used for the factorization");
+        bc_vals(i++,0) = obj.second;
+    }
+
+    Eigen::VectorXd b_free, x_free;
+    reduce_rhs(b, bc_vals, b_free);
+    solve_system(b_free, x_free);
+    expand_sol(x_free, bc_vals, x);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseSolverCache::solve_with_bc(const Eigen::MatrixXd & B, Eigen::MatrixXd & X, const Eigen::MatrixXd & bc_vals) const
+{
+    assert(bc_vals.rows() == (int)fixed.size() && bc_vals.cols() == B.cols());
+
+    Eigen::MatrixXd B_free, X_free;
+    reduce_rhs(B, bc_vals, B_free);
+    solve_system(B_free, X_free);
+    expand_sol(X_free, bc_vals, X);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SparseSolverCache::same_pattern(const Eigen::SparseMatrix<double> & A, const std::vector<uint> & fixed) const
+{
+    assert(A.isCompressed());
+    if(!has_pattern) return false;
+    if(fixed != this->fixed) return false;
+    if(outer.size() != size_t(A.outerSize()+1)) return false;
+    if(inner.size() != size_t(A.nonZeros()))     return false;
+    if(!std::equal(outer.begin(), outer.end(), A.outerIndexPtr())) return false;
+    if(!std::equal(inner.begin(), inner.end(), A.innerIndexPtr())) return false;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseSolverCache::store_pattern(const Eigen::SparseMatrix<double> & A, const std::vector<uint> & fixed)
+{
+    assert(A.isCompressed());
+    outer.assign(A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1);
+    inner.assign(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros());
+    this->fixed = fixed;
+    has_pattern = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SparseSolverCache::factorize_system(const bool analyze_pattern)
+{
+    if(analyze_pattern) ++n_analyses;
+    ++n_factorize;
+
+    switch (solver)
+    {
+        case SIMPLICIAL_LLT:
+        {
+            if(analyze_pattern) llt.analyzePattern(A_ff);
+            llt.factorize(A_ff);
+            return llt.info() == Eigen::Success;
+        }
+
+        case SIMPLICIAL_LDLT:
+        {
+            if(analyze_pattern) ldlt.analyzePattern(A_ff);
+            ldlt.factorize(A_ff);
+            return ldlt.info() == Eigen::Success;
+        }
+
+        case BiCGSTAB:
+        {
+            // the incomplete LU preconditioner is recomputed from scratch anyways
+            //bicgstab.setMaxIterations(100);
+            bicgstab.setTolerance(1e-5);
+            bicgstab.compute(A_ff);
+            return bicgstab.info() == Eigen::Success;
+        }
+
+        case SparseLU:
+        {
+            if(analyze_pattern) lu.analyzePattern(A_ff);
+            lu.factorize(A_ff);
+            return lu.info() == Eigen::Success;
+        }
+
+        default: assert(false && "Unknown Solver");
+    }
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Rhs, class Res>
+CINO_INLINE
+void SparseSolverCache::solve_system(const Rhs & b, Res & x) const
+{
+    switch (solver)
+    {
+        case SIMPLICIAL_LLT:  x = llt.solve(b).eval();      break;
+        case SIMPLICIAL_LDLT: x = ldlt.solve(b).eval();     break;
+        case BiCGSTAB:        x = bicgstab.solve(b).eval(); break;
+        case SparseLU:        x = lu.solve(b);              break;
+        default: assert(false && "Unknown Solver");
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Dense>
+CINO_INLINE
+void SparseSolverCache::reduce_rhs(const Dense & B, const Eigen::MatrixXd & bc_vals, Dense & B_free) const
+{
+    assert(B.rows() == (int)col_map.size());
+
+    // (column by column, as dense matrices are column major)
+    B_free.resize(A_ff.rows(), B.cols());
+    for(uint c=0; c<B.cols(); ++c)
+    {
+        for(uint row=0; row<col_map.size(); ++row)
+        {
+            if(col_map[row] >= 0) B_free(col_map[row],c) = B(row,c);
+        }
+
+        // move the known terms to the right hand side
+        for(uint i=0; i<A_fc.outerSize(); ++i)
+        for(Eigen::SparseMatrix<double>::InnerIterator it(A_fc,i); it; ++it)
+        {
+            B_free(it.row(),c) -= bc_vals(i,c) * it.value();
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Dense>
+CINO_INLINE
+void SparseSolverCache::expand_sol(const Dense & X_free, const Eigen::MatrixXd & bc_vals, Dense & X) const
+{
+    X.resize(col_map.size(), X_free.cols());
+    for(uint c=0; c<X_free.cols(); ++c)
+    {
+        uint i = 0;
+        for(uint row=0; row<col_map.size(); ++row)
+        {
+            if(col_map[row] >= 0) X(row,c) = X_free(col_map[row],c);
+            else                  X(row,c) = bc_vals(i++,c);
+        }
+    }
+}
 
 }
@@ -38,9 +38,11 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <sys/types.h>
 #include <cinolib/cino_inline.h>
 #include <Eigen/Sparse>
+#include <Eigen/SparseLU>
 
 namespace cinolib
 {
@@ -129,6 +131,102 @@ void solve_weighted_least_squares_with_bc(const Eigen::SparseMatrix<double> & A,
                                           const std::map<uint,double>       & bc, // Dirichlet boundary conditions
                                           int   solver = SIMPLICIAL_LLT);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* Linear solver for sequences of square systems sharing the same sparsity
+ * pattern (e.g. iterative algorithms, or interactive tools that keep the
+ * connectivity fixed and only update the geometry). The symbolic analysis
+ * (fill-reducing ordering, elimination tree) is done only when the pattern
+ * of the matrix changes w.r.t. the previous call. Otherwise factorize only
+ * recomputes the numeric factors.
+ *
+ * For Dirichlet boundary conditions the reduced system, restricted to the
+ * free variables, is built once, along with a map from each entry of the
+ * input matrix to the entry of the reduced one. As long as the pattern and
+ * the set of constrained variables stay the same, subsequent updates just
+ * scatter the new coefficients into the reduced matrix.
+ *
+ * Example of usage:
+ *
+ *     SparseSolverCache solver(SIMPLICIAL_LLT);
+ *     for(uint i=0; i<n_iters; ++i)
+ *     {
+ *         solver.factorize(A_i);  // pattern analyzed at the first iteration only
+ *         solver.solve(B_i, X_i); // B_i, X_i can have one column per right hand side
+ *     }
+*/
+
+class SparseSolverCache
+{
+    public:
+
+        explicit SparseSolverCache(const int solver = SIMPLICIAL_LLT) : solver(solver) {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool factorize        (const Eigen::SparseMatrix<double> & A);
+        bool factorize_with_bc(const Eigen::SparseMatrix<double> & A,
+                               const std::map<uint,double>       & bc); // only the constrained ids are used here
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // solvers are read only, hence multiple threads can share a factorization
+        void solve(const Eigen::VectorXd & b, Eigen::VectorXd & x) const;
+        void solve(const Eigen::MatrixXd & B, Eigen::MatrixXd & X) const;
+
+        // the system must have been factorized with factorize_with_bc, using the same
+        // set of constrained ids. In the multiple right hand sides version, row i of
+        // bc_vals contains the values of the i-th constrained variable (in increasing
+        // order of id), one for each column of B
+        void solve_with_bc(const Eigen::VectorXd & b, Eigen::VectorXd & x, const std::map<uint,double> & bc) const;
+        void solve_with_bc(const Eigen::MatrixXd & B, Eigen::MatrixXd & X, const Eigen::MatrixXd       & bc_vals) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint num_pattern_analyses() const { return n_analyses;  }
+        uint num_factorizations()   const { return n_factorize; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+    protected:
+
+        bool same_pattern(const Eigen::SparseMatrix<double> & A, const std::vector<uint> & fixed) const;
+        void store_pattern(const Eigen::SparseMatrix<double> & A, const std::vector<uint> & fixed);
+        bool factorize_system(const bool analyze_pattern);
+        template<class Rhs, class Res>
+        void solve_system(const Rhs & b, Res & x) const;
+        template<class Dense>
+        void reduce_rhs(const Dense & B, const Eigen::MatrixXd & bc_vals, Dense & B_free) const;
+        template<class Dense>
+        void expand_sol(const Dense & X_free, const Eigen::MatrixXd & bc_vals, Dense & X) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        int  solver;
+        bool has_pattern = false;
+        uint n_analyses  = 0;
+        uint n_factorize = 0;
+
+        // sparsity pattern of the last input matrix, and its constrained variables
+        std::vector<int>  outer;
+        std::vector<int>  inner;
+        std::vector<uint> fixed;
+
+        // Dirichlet boundary conditions: A_ff is the system actually factorized (restricted
+        // to the free variables), A_fc couples free and constrained variables, and goes to
+        // the right hand side. For each entry of the input matrix, nz_map stores either its
+        // position in A_ff (>=0), its position k in A_fc (as -k-2), or -1 (constrained row)
+        std::vector<int>            col_map; // input id => free id (-1 if constrained)
+        std::vector<int>            nz_map;
+        Eigen::SparseMatrix<double> A_ff;
+        Eigen::SparseMatrix<double> A_fc;
+
+        Eigen::SimplicialLLT <Eigen::SparseMatrix<double>>                              llt;
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>                              ldlt;
+        Eigen::SparseLU      <Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>>  lu;
+        Eigen::BiCGSTAB      <Eigen::SparseMatrix<double>, Eigen::IncompleteLUT<double>> bicgstab;
+};
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -43,7 +43,10 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/marching_tets.h>
-#include <array>
+#include <cinolib/parallel_for.h>
+#include <cinolib/min_max_inf.h>
+#include <algorithm>
+#include <numeric>
 
 namespace cinolib
 {
@@ -72,25 +75,59 @@ enum // Look-up Table
 
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
-void make_triangle(const Tetmesh<M,V,E,F,P> & m,
-                   const double               isovalue,
-                   const uint                 vids[],
-                   const double               func[],
-                   const std::array<uint,3> & e,
-                   std::map<ipair,uint>     & e2v_map,
-                   std::vector<vec3d>       & verts,
-                   std::vector<uint>        & tris,
-                   std::vector<vec3d>       & norms);
+TetFieldRanges::TetFieldRanges(const Tetmesh<M,V,E,F,P> & m, const uint block_size)
+: block_size(block_size)
+, num_tets(m.num_polys())
+{
+    uint n_blocks = (num_tets+block_size-1)/block_size;
+    min.resize(n_blocks);
+    max.resize(n_blocks);
+    PARALLEL_FOR(0, n_blocks, 64, [&](uint bid)
+    {
+        double lo =  inf_double;
+        double hi = -inf_double;
+        for(uint pid=bid*block_size; pid<std::min(num_tets, (bid+1)*block_size); ++pid)
+        {
+            for(uint i=0; i<4; ++i)
+            {
+                double f = m.vert_data(m.poly_vert_id(pid,i)).uvw[0];
+                lo = std::min(lo,f);
+                hi = std::max(hi,f);
+            }
+        }
+        min[bid] = lo;
+        max[bid] = hi;
+    });
+}
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+namespace
+{
+
+// true if the field is equal to isovalue at all the verts of the tet
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
-void marching_tets(const Tetmesh<M,V,E,F,P> & m,
+bool tet_on_iso(const Tetmesh<M,V,E,F,P> & m, const uint pid, const double isovalue)
+{
+    for(uint i=0; i<4; ++i)
+    {
+        if(m.vert_data(m.poly_vert_id(pid,i)).uvw[0]!=isovalue) return false;
+    }
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// triangles generated in tet pid by the isosurface, as triplets of local edges
+// (see TET_EDGES) stored in e. Returns the number of triangles (at most two)
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+uint tet_triangles(const Tetmesh<M,V,E,F,P> & m,
+                   const uint                 pid,
                    const double               isovalue,
-                   std::vector<vec3d>       & verts,
-                   std::vector<uint>        & tris,
-                   std::vector<vec3d>       & norms)
+                   const double               func[],
+                         uint                 e[])
 {
     /* FIXME: for all configurations where two verts >= isoval
      * and the other two are < isoval, this method will try to
@@ -103,219 +140,276 @@ void marching_tets(const Tetmesh<M,V,E,F,P> & m,
      * vertex (<,>,=). In this case each configuration will be 100% correct
     */
 
-    std::vector<unsigned char> c(m.num_polys(),0x0);
-    std::vector<bool> swapped(m.num_polys(), false);
-
-    for(uint pid=0; pid<m.num_polys(); ++pid)
+    unsigned char c = 0x0;
+    bool swapped = false;
+
+    if (isovalue >= func[0]) c |= C_1000;
+    if (isovalue >= func[1]) c |= C_0100;
+    if (isovalue >= func[2]) c |= C_0010;
+    if (isovalue >= func[3]) c |= C_0001;
+
+    /* If the isosurface does not intersect the tet,
+     * one should get C_1111 using ">=", and C_0000
+     * inverting to "<=".
+     *
+     * This does not happen if the isosurface passes
+     * exhactly through one face. In this case one will
+     * get C_1111 using ">=", and something like
+     * C_0111 using "<=".
+     *
+     * Normally this does not create any trouble, as the
+     * face-adjacent tet will trigger the generation of
+     * that triangle. But if the tet is exposed on the
+     * surface, then that triangle will be missing in the
+     * final iso-surface.
+     *
+     * To avoid these missing triangles, whenever I get
+     * a C_1111 I invert the sign, and assign to the tet
+     * the configuration produced using "<="
+    */
+    if (c == C_1111)
     {
-        double func[] =
-        {
-            m.vert_data(m.poly_vert_id(pid,0)).uvw[0],
-            m.vert_data(m.poly_vert_id(pid,1)).uvw[0],
-            m.vert_data(m.poly_vert_id(pid,2)).uvw[0],
-            m.vert_data(m.poly_vert_id(pid,3)).uvw[0]
-        };
-
-        if (isovalue >= func[0]) c.at(pid) |= C_1000;
-        if (isovalue >= func[1]) c.at(pid) |= C_0100;
-        if (isovalue >= func[2]) c.at(pid) |= C_0010;
-        if (isovalue >= func[3]) c.at(pid) |= C_0001;
-
-        /* If the isosurface does not intersect the tet,
-         * one should get C_1111 using ">=", and C_0000
-         * inverting to "<=".
-         *
-         * This does not happen if the isosurface passes
-         * exhactly through one face. In this case one will
-         * get C_1111 using ">=", and something like
-         * C_0111 using "<=".
-         *
-         * Normally this does not create any trouble, as the
-         * face-adjacent tet will trigger the generation of
-         * that triangle. But if the tet is exposed on the
-         * surface, then that triangle will be missing in the
-         * final iso-surface.
-         *
-         * To avoid these missing triangles, whenever I get
-         * a C_1111 I invert the sign, and assign to the tet
-         * the configuration produced using "<="
-        */
-        if (c.at(pid) == C_1111)
-        {
-            swapped.at(pid) = true;
-            c.at(pid) = 0x0;
-            if (isovalue <= func[0]) c.at(pid) |= C_1000;
-            if (isovalue <= func[1]) c.at(pid) |= C_0100;
-            if (isovalue <= func[2]) c.at(pid) |= C_0010;
-            if (isovalue <= func[3]) c.at(pid) |= C_0001;
-        }
+        swapped = true;
+        c = 0x0;
+        if (isovalue <= func[0]) c |= C_1000;
+        if (isovalue <= func[1]) c |= C_0100;
+        if (isovalue <= func[2]) c |= C_0010;
+        if (isovalue <= func[3]) c |= C_0001;
     }
 
-    std::map<ipair,uint> e2v_map;
-
-    for(uint pid=0; pid<m.num_polys(); ++pid)
+    bool v_on_iso[] =
     {
-        uint vids[] =
-        {
-            m.poly_vert_id(pid,0),
-            m.poly_vert_id(pid,1),
-            m.poly_vert_id(pid,2),
-            m.poly_vert_id(pid,3)
-        };
-
-        double func[] =
-        {
-            m.vert_data(vids[0]).uvw[0],
-            m.vert_data(vids[1]).uvw[0],
-            m.vert_data(vids[2]).uvw[0],
-            m.vert_data(vids[3]).uvw[0]
-        };
-
-        bool v_on_iso[] =
-        {
-            func[0] == isovalue,
-            func[1] == isovalue,
-            func[2] == isovalue,
-            func[3] == isovalue
-        };
+        func[0] == isovalue,
+        func[1] == isovalue,
+        func[2] == isovalue,
+        func[3] == isovalue
+    };
+
+    // not uint because it may be -1 if there is no adjacent tet!
+    auto adj_tet = [&](const uint i) -> int
+    {
+        return m.poly_adj_through_face(pid, m.poly_face_id(pid,i));
+    };
 
-        int adj_tet[] // not uint because it may be -1 if there is no adjacent tet!
-        {
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,0)),
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,1)),
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,2)),
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,3)),
-        };
-
-        // Avoid triangle duplication and collapsed triangle generation when the iso-surface
-        // passes EXACTLY through a vertex/edge/face shared between many tetrahedra.
-        //
-        switch (c.at(pid))
-        {
-            // iso-surface passes on a face : make sure only one tet (MUST BE the one with higher id) triggers triangle generation...
-            // Notice that if the adjacent tet is collapsed (C_1111), then it make sense to use the current one regardless the tid order
-            case C_1110 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[2] && (int)pid < adj_tet[0] && c.at(adj_tet[0]) != C_1111) c.at(pid) = C_0000; break;
-            case C_1101 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[3] && (int)pid < adj_tet[1] && c.at(adj_tet[1]) != C_1111) c.at(pid) = C_0000; break;
-            case C_1011 : if (v_on_iso[0] && v_on_iso[2] && v_on_iso[3] && (int)pid < adj_tet[2] && c.at(adj_tet[2]) != C_1111) c.at(pid) = C_0000; break;
-            case C_0111 : if (v_on_iso[1] && v_on_iso[2] && v_on_iso[3] && (int)pid < adj_tet[3] && c.at(adj_tet[3]) != C_1111) c.at(pid) = C_0000; break;
-
-            // iso-surface passes on a edge : do nothing
-            case C_0101 : if (v_on_iso[1] && v_on_iso[3]) c.at(pid) = C_0000; break;
-            case C_1010 : if (v_on_iso[0] && v_on_iso[2]) c.at(pid) = C_0000; break;
-            case C_0011 : if (v_on_iso[2] && v_on_iso[3]) c.at(pid) = C_0000; break;
-            case C_1100 : if (v_on_iso[0] && v_on_iso[1]) c.at(pid) = C_0000; break;
-            case C_1001 : if (v_on_iso[0] && v_on_iso[3]) c.at(pid) = C_0000; break;
-            case C_0110 : if (v_on_iso[1] && v_on_iso[2]) c.at(pid) = C_0000; break;
-
-            // iso-surface passes on a vertex : do nothing
-            case C_1000 : if (v_on_iso[0]) c.at(pid) = C_0000; break;
-            case C_0100 : if (v_on_iso[1]) c.at(pid) = C_0000; break;
-            case C_0010 : if (v_on_iso[2]) c.at(pid) = C_0000; break;
-            case C_0001 : if (v_on_iso[3]) c.at(pid) = C_0000; break;
-
-            default : break;
-        }
+    // Avoid triangle duplication and collapsed triangle generation when the iso-surface
+    // passes EXACTLY through a vertex/edge/face shared between many tetrahedra.
+    //
+    switch (c)
+    {
+        // iso-surface passes on a face : make sure only one tet (MUST BE the one with higher id) triggers triangle generation...
+        // Notice that if the adjacent tet is collapsed (i.e. it lies entirely on the iso-surface), then it make sense to use
+        // the current one regardless the tid order
+        case C_1110 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[2] && (int)pid < adj_tet(0) && !tet_on_iso(m, adj_tet(0), isovalue)) c = C_0000; break;
+        case C_1101 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[3] && (int)pid < adj_tet(1) && !tet_on_iso(m, adj_tet(1), isovalue)) c = C_0000; break;
+        case C_1011 : if (v_on_iso[0] && v_on_iso[2] && v_on_iso[3] && (int)pid < adj_tet(2) && !tet_on_iso(m, adj_tet(2), isovalue)) c = C_0000; break;
+        case C_0111 : if (v_on_iso[1] && v_on_iso[2] && v_on_iso[3] && (int)pid < adj_tet(3) && !tet_on_iso(m, adj_tet(3), isovalue)) c = C_0000; break;
+
+        // iso-surface passes on a edge : do nothing
+        case C_0101 : if (v_on_iso[1] && v_on_iso[3]) c = C_0000; break;
+        case C_1010 : if (v_on_iso[0] && v_on_iso[2]) c = C_0000; break;
+        case C_0011 : if (v_on_iso[2] && v_on_iso[3]) c = C_0000; break;
+        case C_1100 : if (v_on_iso[0] && v_on_iso[1]) c = C_0000; break;
+        case C_1001 : if (v_on_iso[0] && v_on_iso[3]) c = C_0000; break;
+        case C_0110 : if (v_on_iso[1] && v_on_iso[2]) c = C_0000; break;
+
+        // iso-surface passes on a vertex : do nothing
+        case C_1000 : if (v_on_iso[0]) c = C_0000; break;
+        case C_0100 : if (v_on_iso[1]) c = C_0000; break;
+        case C_0010 : if (v_on_iso[2]) c = C_0000; break;
+        case C_0001 : if (v_on_iso[3]) c = C_0000; break;
+
+        default : break;
+    }
 
-        // triangle generation
-        switch (c.at(pid))
-        {
-            case C_1000 : { make_triangle(m, isovalue, vids, func, {2,0,4}, e2v_map, verts, tris, norms); break; }
-            case C_0111 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {2,0,4}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {0,2,4}, e2v_map, verts, tris, norms); break; }
-            case C_1011 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {1,2,3}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {2,1,3}, e2v_map, verts, tris, norms); break; }
-            case C_0100 : { make_triangle(m, isovalue, vids, func, {1,2,3}, e2v_map, verts, tris, norms); break; }
-            case C_1101 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {0,1,5}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {1,0,5}, e2v_map, verts, tris, norms); break; }
-            case C_0010 : { make_triangle(m, isovalue, vids, func, {0,1,5}, e2v_map, verts, tris, norms); break; }
-            case C_0001 : { make_triangle(m, isovalue, vids, func, {5,3,4}, e2v_map, verts, tris, norms); break; }
-            case C_1110 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {5,3,4}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {3,5,4}, e2v_map, verts, tris, norms); break; }
-            case C_0101 : { make_triangle(m, isovalue, vids, func, {5,2,4}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {2,5,1}, e2v_map, verts, tris, norms); break; }
-            case C_1010 : { make_triangle(m, isovalue, vids, func, {2,5,4}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {5,2,1}, e2v_map, verts, tris, norms); break; }
-            case C_0011 : { make_triangle(m, isovalue, vids, func, {3,4,1}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {1,4,0}, e2v_map, verts, tris, norms); break; }
-            case C_1100 : { make_triangle(m, isovalue, vids, func, {4,3,1}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {4,1,0}, e2v_map, verts, tris, norms); break; }
-            case C_1001 : { make_triangle(m, isovalue, vids, func, {3,2,0}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {5,3,0}, e2v_map, verts, tris, norms); break; }
-            case C_0110 : { make_triangle(m, isovalue, vids, func, {2,3,0}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {3,5,0}, e2v_map, verts, tris, norms); break; }
-            default : break;
-        }
+    uint n = 0;
+    auto tri = [&](const uint e0, const uint e1, const uint e2)
+    {
+        e[3*n+0] = e0;
+        e[3*n+1] = e1;
+        e[3*n+2] = e2;
+        ++n;
+    };
+
+    // triangle generation
+    switch (c)
+    {
+        case C_1000 : { tri(2,0,4); break; }
+        case C_0111 : { swapped ? tri(2,0,4) : tri(0,2,4); break; }
+        case C_1011 : { swapped ? tri(1,2,3) : tri(2,1,3); break; }
+        case C_0100 : { tri(1,2,3); break; }
+        case C_1101 : { swapped ? tri(0,1,5) : tri(1,0,5); break; }
+        case C_0010 : { tri(0,1,5); break; }
+        case C_0001 : { tri(5,3,4); break; }
+        case C_1110 : { swapped ? tri(5,3,4) : tri(3,5,4); break; }
+        case C_0101 : { tri(5,2,4); tri(2,5,1); break; }
+        case C_1010 : { tri(2,5,4); tri(5,2,1); break; }
+        case C_0011 : { tri(3,4,1); tri(1,4,0); break; }
+        case C_1100 : { tri(4,3,1); tri(4,1,0); break; }
+        case C_1001 : { tri(3,2,0); tri(5,3,0); break; }
+        case C_0110 : { tri(2,3,0); tri(3,5,0); break; }
+        default : break;
     }
+    return n;
+}
+
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
-void make_triangle(const Tetmesh<M,V,E,F,P> & m,
+void marching_tets(const Tetmesh<M,V,E,F,P> & m,
                    const double               isovalue,
-                   const uint                 vids[],
-                   const double               func[],
-                   const std::array<uint,3> & e,
-                   std::map<ipair,uint>     & e2v_map,
                    std::vector<vec3d>       & verts,
                    std::vector<uint>        & tris,
                    std::vector<vec3d>       & norms)
 {
-    assert(isovalue >= *std::min_element(func, func+4));
-    assert(isovalue <= *std::max_element(func, func+4));
+    std::vector<std::vector<vec3d>> v;
+    std::vector<std::vector<uint>>  t;
+    std::vector<std::vector<vec3d>> n;
+    marching_tets(m, std::vector<double>(1,isovalue), v, t, n);
+    verts.swap(v.front());
+    tris.swap (t.front());
+    norms.swap(n.front());
+}
 
-    vec3d tri_verts[3];
-    uint  fresh_vid = uint(verts.size());
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<3; ++i)
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void marching_tets(const Tetmesh<M,V,E,F,P>         & m,
+                   const std::vector<double>        & isovalues,
+                   std::vector<std::vector<vec3d>>  & verts,
+                   std::vector<std::vector<uint>>   & tris,
+                   std::vector<std::vector<vec3d>>  & norms,
+                   const TetFieldRanges             * ranges)
+{
+    uint n_iso = uint(isovalues.size());
+    verts.assign(n_iso, std::vector<vec3d>());
+    tris.assign (n_iso, std::vector<uint>());
+    norms.assign(n_iso, std::vector<vec3d>());
+    if(n_iso==0 || m.num_polys()==0) return;
+
+    TetFieldRanges tmp;
+    if(ranges==nullptr)
     {
-        uint v_a = vids[TET_EDGES[e[i]][0]];
-        uint v_b = vids[TET_EDGES[e[i]][1]];
+        tmp    = TetFieldRanges(m);
+        ranges = &tmp;
+    }
+    assert(ranges->num_tets==m.num_polys());
+
+    // sort the isovalues, so that those within the range of a tet can be found by binary search
+    std::vector<uint> order(n_iso);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const uint a, const uint b){ return isovalues[a]<isovalues[b]; });
+    std::vector<double> iso(n_iso);
+    for(uint k=0; k<n_iso; ++k) iso[k] = isovalues[order[k]];
+
+    // each chunk of blocks stores the triangles of each isovalue in a private buffer,
+    // as triplets of ids of the mesh edges that contain the triangle vertices
+    const uint blocks_per_chunk = 16;
+    uint n_blocks = ranges->num_blocks();
+    uint n_chunks = (n_blocks+blocks_per_chunk-1)/blocks_per_chunk;
+    std::vector<std::vector<uint>> buf(size_t(n_chunks)*n_iso);
+    PARALLEL_FOR(0, n_chunks, 1, 1, [&](uint ch)
+    {
+        for(uint bid=ch*blocks_per_chunk; bid<std::min(n_blocks, (ch+1)*blocks_per_chunk); ++bid)
+        {
+            auto it = std::lower_bound(iso.begin(), iso.end(), ranges->min[bid]);
+            if(it==iso.end() || *it>ranges->max[bid]) continue; // no isovalue crosses the block
 
-        // avoid duplicated vertices. If an edge has already
-        // been visited retrieve its id and coordinates
-        //
-        ipair pair  = unique_pair(v_a, v_b);
-        auto  query = e2v_map.find(pair);
+            uint end = std::min(ranges->num_tets, ranges->block_begin(bid)+ranges->block_size);
+            for(uint pid=ranges->block_begin(bid); pid<end; ++pid)
+            {
+                uint   vids[4];
+                double func[4];
+                for(uint i=0; i<4; ++i)
+                {
+                    vids[i] = m.poly_vert_id(pid,i);
+                    func[i] = m.vert_data(vids[i]).uvw[0];
+                }
+                double f_min = *std::min_element(func, func+4);
+                double f_max = *std::max_element(func, func+4);
+
+                uint eids[6];
+                bool has_eids = false;
+                for(uint k=uint(std::lower_bound(iso.begin(), iso.end(), f_min)-iso.begin()); k<n_iso && iso[k]<=f_max; ++k)
+                {
+                    uint e[6];
+                    uint n = tet_triangles(m, pid, iso[k], func, e);
+                    if(n==0) continue;
+                    if(!has_eids)
+                    {
+                        for(uint i=0; i<6; ++i)
+                        {
+                            eids[i] = m.poly_edge_id(pid, vids[TET_EDGES[i][0]], vids[TET_EDGES[i][1]]);
+                        }
+                        has_eids = true;
+                    }
+                    std::vector<uint> & b = buf[size_t(ch)*n_iso+k];
+                    for(uint i=0; i<3*n; ++i) b.push_back(eids[e[i]]);
+                }
+            }
+        }
+    });
 
-        if (query != e2v_map.end())
+    std::vector<uint> e2v(m.num_edges(), max_uint);
+    for(uint k=0; k<n_iso; ++k)
+    {
+        // concatenate the buffers of all chunks
+        std::vector<size_t> off(n_chunks+1,0);
+        for(uint ch=0; ch<n_chunks; ++ch) off[ch+1] = off[ch] + buf[size_t(ch)*n_iso+k].size();
+        std::vector<uint> & t = tris.at(order[k]);
+        t.resize(off.back());
+        PARALLEL_FOR(0, n_chunks, 64, [&](uint ch)
         {
-            uint vid = query->second;
-            tri_verts[i] = vec3d(verts.at(vid));
-            tris.push_back(vid);
-        }
-        else
+            std::vector<uint> & b = buf[size_t(ch)*n_iso+k];
+            std::copy(b.begin(), b.end(), t.begin()+off[ch]);
+            std::vector<uint>().swap(b);
+        });
+
+        // number verts by order of appearance, and turn edge ids into vert ids
+        std::vector<uint> v2e;
+        for(uint & id : t)
         {
-            double f_a = func[TET_EDGES[e[i]][0]];
-            double f_b = func[TET_EDGES[e[i]][1]];
+            if(e2v[id]==max_uint)
+            {
+                e2v[id] = uint(v2e.size());
+                v2e.push_back(id);
+            }
+            id = e2v[id];
+        }
+        for(uint eid : v2e) e2v[eid] = max_uint;
 
+        double isovalue = iso[k];
+        std::vector<vec3d> & v = verts.at(order[k]);
+        v.resize(v2e.size());
+        PARALLEL_FOR(0, uint(v2e.size()), 1000, [&](uint vid)
+        {
+            uint   v_a = m.edge_vert_id(v2e[vid],0);
+            uint   v_b = m.edge_vert_id(v2e[vid],1);
+            double f_a = m.vert_data(v_a).uvw[0];
+            double f_b = m.vert_data(v_b).uvw[0];
             if (f_a < f_b)
             {
                 std::swap(v_a, v_b);
                 std::swap(f_a, f_b);
             }
-
-            double alpha = (isovalue - f_a) / (f_b - f_a);
-
-            tri_verts[i] = (1.0 - alpha) * m.vert(v_a) + alpha * m.vert(v_b);
-
-            verts.push_back(tri_verts[i]);
-
-            tris.push_back(fresh_vid);
-            e2v_map[pair] = fresh_vid++;
-        }
+            assert(isovalue>=f_b && isovalue<=f_a);
+            double alpha = (f_a==f_b) ? 0.0 : (isovalue - f_a) / (f_b - f_a);
+            v[vid] = (1.0 - alpha) * m.vert(v_a) + alpha * m.vert(v_b);
+        });
+
+        std::vector<vec3d> & n = norms.at(order[k]);
+        n.resize(t.size()/3);
+        PARALLEL_FOR(0, uint(n.size()), 1000, [&](uint tid)
+        {
+            vec3d u = v[t[3*tid+1]] - v[t[3*tid]]; u.normalize();
+            vec3d w = v[t[3*tid+2]] - v[t[3*tid]]; w.normalize();
+            n[tid] = u.cross(w);
+            n[tid].normalize();
+        });
     }
-
-    vec3d u  = tri_verts[1] - tri_verts[0]; u.normalize();
-    vec3d w  = tri_verts[2] - tri_verts[0]; w.normalize();
-    vec3d n = u.cross(w);
-    n.normalize();
-    norms.push_back(n);
 }
 
 }
@@ -37,7 +37,6 @@
 #define CINO_MARCHING_TETS_H
 
 #include <vector>
-#include <map>
 #include <sys/types.h>
 #include <cinolib/cino_inline.h>
 #include <cinolib/ipair.h>
@@ -46,6 +45,47 @@
 namespace cinolib
 {
 
+/* Min/max of a scalar field (stored in the first vertex coordinate uvw[0]) over
+ * blocks of consecutive tetrahedra. Marching tets uses it to skip whole blocks
+ * that cannot be crossed by any of the requested isovalues. It can be built once
+ * and reused for multiple extractions, as long as the field does not change.
+*/
+
+class TetFieldRanges
+{
+    public:
+
+        explicit TetFieldRanges() {}
+
+        template<class M, class V, class E, class F, class P>
+        explicit TetFieldRanges(const Tetmesh<M,V,E,F,P> & m, const uint block_size = 256);
+
+        uint num_blocks()                   const { return uint(min.size()); }
+        uint block_begin(const uint bid)    const { return bid*block_size; }
+        bool block_contains(const uint bid, const double iso) const { return iso>=min[bid] && iso<=max[bid]; }
+
+        uint                block_size = 256;
+        uint                num_tets   = 0;
+        std::vector<double> min;
+        std::vector<double> max;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* Extracts the isosurfaces of the scalar field stored in uvw[0] at the vertices
+ * of a tetmesh. Tets are processed in parallel, in chunks of consecutive tets
+ * that store their triangles in private buffers. Buffers are then concatenated
+ * in chunk order (with a prefix sum over their sizes), hence the output does not
+ * depend on the number of threads. Vertices along the isosurface are indexed
+ * by the id of the mesh edge they lie on (no maps or hash tables are involved),
+ * and are numbered by order of appearance in the list of triangles.
+ *
+ * The multi isovalue version visits each tet only once, processing all the
+ * isovalues that fall in the range of the field within the tet. Blocks of
+ * tets that do not contain any of the isovalues are skipped entirely. The
+ * i-th output surface corresponds to isovalues[i].
+*/
+
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void marching_tets(const Tetmesh<M,V,E,F,P> & m,
@@ -53,6 +93,17 @@ void marching_tets(const Tetmesh<M,V,E,F,P> & m,
                    std::vector<vec3d>       & verts,
                    std::vector<uint>        & tris,
                    std::vector<vec3d>       & norms);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void marching_tets(const Tetmesh<M,V,E,F,P>         & m,
+                   const std::vector<double>        & isovalues,
+                   std::vector<std::vector<vec3d>>  & verts,
+                   std::vector<std::vector<uint>>   & tris,
+                   std::vector<std::vector<vec3d>>  & norms,
+                   const TetFieldRanges             * ranges = nullptr); // built on the fly if not provided
 }
 
 #ifndef  CINO_STATIC_LIB
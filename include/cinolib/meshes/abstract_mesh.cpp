@@ -37,6 +37,9 @@
 #include <cinolib/meshes/mesh_attributes.h>
 #include <cinolib/stl_container_utilities.h>
 #include <cinolib/min_max_inf.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/vector_serialization.h>
+#include <algorithm>
 #include <map>
 #include <unordered_set>
 #include <unordered_map>
@@ -108,6 +111,269 @@ void AbstractMesh<M,V,E,P>::clear()
     e2p.clear();
     p2e.clear();
     p2p.clear();
+    //
+    frozen = false;
+    v2v_packed.clear();
+    v2e_packed.clear();
+    v2p_packed.clear();
+    e2p_packed.clear();
+    p2e_packed.clear();
+    p2p_packed.clear();
+    //
+    dirty_verts.clear();
+    dirty_polys.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::freeze_connectivity()
+{
+    if(frozen) return;
+
+    v2v_packed.pack(v2v); std::vector<std::vector<uint>>().swap(v2v);
+    v2e_packed.pack(v2e); std::vector<std::vector<uint>>().swap(v2e);
+    v2p_packed.pack(v2p); std::vector<std::vector<uint>>().swap(v2p);
+    e2p_packed.pack(e2p); std::vector<std::vector<uint>>().swap(e2p);
+    p2e_packed.pack(p2e); std::vector<std::vector<uint>>().swap(p2e);
+    p2p_packed.pack(p2p); std::vector<std::vector<uint>>().swap(p2p);
+
+    frozen = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::unfreeze_connectivity()
+{
+    if(!frozen) return;
+
+    v2v_packed.unpack(v2v); v2v_packed.clear();
+    v2e_packed.unpack(v2e); v2e_packed.clear();
+    v2p_packed.unpack(v2p); v2p_packed.clear();
+    e2p_packed.unpack(e2p); e2p_packed.clear();
+    p2e_packed.unpack(p2e); p2e_packed.clear();
+    p2p_packed.unpack(p2p); p2p_packed.clear();
+
+    frozen = false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::begin_batch()
+{
+    ++batch_depth;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::end_batch()
+{
+    assert(batch_depth>0);
+    if(--batch_depth>0) return;
+
+    // elements may have been touched many times, or removed after being touched
+    auto compact = [](std::vector<uint> & ids, const uint n)
+    {
+        REMOVE_DUPLICATES_FROM_VEC(ids);
+        ids.erase(std::lower_bound(ids.begin(), ids.end(), n), ids.end());
+    };
+    compact(dirty_verts, num_verts());
+    compact(dirty_polys, num_polys());
+
+    update_dirty_elements();
+
+    // the bbox is enlarged to contain the touched verts, but it is never shrunk (use update_bbox() for that)
+    if(m_data.update_bbox)
+    {
+        for(uint vid : dirty_verts)
+        {
+            bb.min = bb.min.min(verts.at(vid));
+            bb.max = bb.max.max(verts.at(vid));
+        }
+    }
+
+    dirty_verts.clear();
+    dirty_polys.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::export_CINOBIN(std::vector<CinobinSection> & sections) const
+{
+    auto adj = [this](const PackedAdjacency & packed, const std::vector<std::vector<uint>> & lists)
+    {
+        return frozen ? packed.serialize() : PackedAdjacency(lists).serialize();
+    };
+
+    sections.emplace_back("verts", serialized_xyz_from_vec3d(verts));
+    sections.emplace_back("edges", edges);
+    sections.emplace_back("polys", PackedAdjacency(polys).serialize());
+    sections.emplace_back("v2v",   adj(v2v_packed, v2v));
+    sections.emplace_back("v2e",   adj(v2e_packed, v2e));
+    sections.emplace_back("v2p",   adj(v2p_packed, v2p));
+    sections.emplace_back("e2p",   adj(e2p_packed, e2p));
+    sections.emplace_back("p2e",   adj(p2e_packed, p2e));
+    sections.emplace_back("p2p",   adj(p2p_packed, p2p));
+
+    std::vector<double>  v_uvw, v_normal;
+    std::vector<Color>   v_color;
+    std::vector<int>     v_label;
+    std::vector<uint8_t> v_flags;
+    for(const V & d : v_data)
+    {
+        v_uvw.insert(v_uvw.end(), d.uvw.ptr(), d.uvw.ptr()+3);
+        v_normal.insert(v_normal.end(), d.normal.ptr(), d.normal.ptr()+3);
+        v_color.push_back(d.color);
+        v_label.push_back(d.label);
+        v_flags.push_back(uint8_t(d.flags.to_ulong()));
+    }
+    sections.emplace_back("v_uvw",    v_uvw);
+    sections.emplace_back("v_normal", v_normal);
+    sections.emplace_back("v_color",  v_color);
+    sections.emplace_back("v_label",  v_label);
+    sections.emplace_back("v_flags",  v_flags);
+
+    std::vector<Color>   e_color;
+    std::vector<int>     e_label;
+    std::vector<uint8_t> e_flags;
+    for(const E & d : e_data)
+    {
+        e_color.push_back(d.color);
+        e_label.push_back(d.label);
+        e_flags.push_back(uint8_t(d.flags.to_ulong()));
+    }
+    sections.emplace_back("e_color", e_color);
+    sections.emplace_back("e_label", e_label);
+    sections.emplace_back("e_flags", e_flags);
+
+    std::vector<Color>   p_color;
+    std::vector<int>     p_label;
+    std::vector<uint8_t> p_flags;
+    for(const P & d : p_data)
+    {
+        p_color.push_back(d.color);
+        p_label.push_back(d.label);
+        p_flags.push_back(uint8_t(d.flags.to_ulong()));
+    }
+    sections.emplace_back("p_color", p_color);
+    sections.emplace_back("p_label", p_label);
+    sections.emplace_back("p_flags", p_flags);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// verts, elements and adjacency are mandatory. Attributes are
+// optional, and are ignored if their size does not match the mesh
+template<class M, class V, class E, class P>
+CINO_INLINE
+bool AbstractMesh<M,V,E,P>::import_CINOBIN(const CinobinFile & f)
+{
+    auto adj = [&f](const std::string & name, PackedAdjacency & packed)
+    {
+        return f.has(name) && packed.deserialize((const uint*)f.data(name), f.bytes(name)/sizeof(uint));
+    };
+
+    std::vector<double> xyz;
+    PackedAdjacency     tmp;
+    if(!f.read("verts", xyz)   || xyz.size()%3!=0 ||
+       !f.read("edges", edges) || edges.size()%2!=0 ||
+       !adj("polys", tmp)      ||
+       !adj("v2v", v2v_packed) ||
+       !adj("v2e", v2e_packed) ||
+       !adj("v2p", v2p_packed) ||
+       !adj("e2p", e2p_packed) ||
+       !adj("p2e", p2e_packed) ||
+       !adj("p2p", p2p_packed)) return false;
+
+    verts = vec3d_from_serialized_xyz(xyz);
+    tmp.unpack(polys);
+    frozen = true;
+    if(v2v_packed.size()!=num_verts() || v2e_packed.size()!=num_verts() || v2p_packed.size()!=num_verts() ||
+       e2p_packed.size()!=num_edges() || p2e_packed.size()!=num_polys() || p2p_packed.size()!=num_polys()) return false;
+
+    // element ids must be in range (polys are checked by derived classes, as
+    // they refer to verts for surface meshes and to faces for volume meshes)
+    if(std::any_of(edges.begin(), edges.end(), [this](const uint vid){ return vid>=num_verts(); }) ||
+       !v2v_packed.ids_below(num_verts()) || !v2e_packed.ids_below(num_edges()) || !v2p_packed.ids_below(num_polys()) ||
+       !e2p_packed.ids_below(num_polys()) || !p2e_packed.ids_below(num_edges()) || !p2p_packed.ids_below(num_polys())) return false;
+
+    v_data.resize(num_verts());
+    e_data.resize(num_edges());
+    p_data.resize(num_polys());
+
+    std::vector<double>  xyz_uvw, xyz_normal;
+    std::vector<Color>   color;
+    std::vector<int>     label;
+    std::vector<uint8_t> flags;
+    if(f.read("v_uvw",    xyz_uvw)    && xyz_uvw.size()   ==3*num_verts()) for(uint vid=0; vid<num_verts(); ++vid) v_data.at(vid).uvw    = vec3d(&xyz_uvw.at(3*vid));
+    if(f.read("v_normal", xyz_normal) && xyz_normal.size()==3*num_verts()) for(uint vid=0; vid<num_verts(); ++vid) v_data.at(vid).normal = vec3d(&xyz_normal.at(3*vid));
+    if(f.read("v_color",  color)      && color.size()==num_verts())        for(uint vid=0; vid<num_verts(); ++vid) v_data.at(vid).color  = color.at(vid);
+    if(f.read("v_label",  label)      && label.size()==num_verts())        for(uint vid=0; vid<num_verts(); ++vid) v_data.at(vid).label  = label.at(vid);
+    if(f.read("v_flags",  flags)      && flags.size()==num_verts())        for(uint vid=0; vid<num_verts(); ++vid) v_data.at(vid).flags  = flags.at(vid);
+    if(f.read("e_color",  color)      && color.size()==num_edges())        for(uint eid=0; eid<num_edges(); ++eid) e_data.at(eid).color  = color.at(eid);
+    if(f.read("e_label",  label)      && label.size()==num_edges())        for(uint eid=0; eid<num_edges(); ++eid) e_data.at(eid).label  = label.at(eid);
+    if(f.read("e_flags",  flags)      && flags.size()==num_edges())        for(uint eid=0; eid<num_edges(); ++eid) e_data.at(eid).flags  = flags.at(eid);
+    if(f.read("p_color",  color)      && color.size()==num_polys())        for(uint pid=0; pid<num_polys(); ++pid) p_data.at(pid).color  = color.at(pid);
+    if(f.read("p_label",  label)      && label.size()==num_polys())        for(uint pid=0; pid<num_polys(); ++pid) p_data.at(pid).label  = label.at(pid);
+    if(f.read("p_flags",  flags)      && flags.size()==num_polys())        for(uint pid=0; pid<num_polys(); ++pid) p_data.at(pid).flags  = flags.at(pid);
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::save_CINOBIN(const char * filename) const
+{
+    std::vector<CinobinSection> sections;
+    export_CINOBIN(sections);
+    write_CINOBIN(filename, mesh_type(), sections);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::load_CINOBIN(const char * filename)
+{
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    this->clear();
+    this->mesh_data().filename = std::string(filename);
+
+    CinobinFile f(filename);
+    if(!f.is_open()) return;
+    if(f.mesh_type()!=mesh_type())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_CINOBIN() : mesh type mismatch (" << f.mesh_type() << " in file, " << mesh_type() << " expected)" << std::endl;
+        return;
+    }
+    if(!import_CINOBIN(f))
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_CINOBIN() : corrupted file " << filename << std::endl;
+        this->clear();
+        return;
+    }
+    update_bbox();
+
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    std::cout << "load mesh\t"     <<
+                 this->num_verts() << "V / " <<
+                 this->num_edges() << "E / ";
+    // faces are only known to volume meshes (and were validated by their import_CINOBIN)
+    if(f.has("faces")) std::cout << ((const uint*)f.data("faces"))[0] << "F / ";
+    std::cout << this->num_polys() << "P  [" <<
+                 how_many_seconds(t0,t1) << "s]" << std::endl;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
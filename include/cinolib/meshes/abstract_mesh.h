@@ -45,6 +45,10 @@
 #include <cinolib/color.h>
 #include <cinolib/symbols.h>
 #include <cinolib/ipair.h>
+#include <cinolib/span.h>
+#include <cinolib/meshes/packed_adjacency.h>
+#include <cinolib/io/read_CINOBIN.h>
+#include <cinolib/io/write_CINOBIN.h>
 
 typedef enum
 {
@@ -87,6 +91,21 @@ class AbstractMesh
         std::vector<std::vector<uint>> p2e; // poly to edge adjacency
         std::vector<std::vector<uint>> p2p; // poly to poly adjacency
 
+        bool            frozen = false; // if true, adjacencies are stored in the packed arrays below
+        PackedAdjacency v2v_packed;
+        PackedAdjacency v2e_packed;
+        PackedAdjacency v2p_packed;
+        PackedAdjacency e2p_packed;
+        PackedAdjacency p2e_packed;
+        PackedAdjacency p2p_packed;
+
+        uint              batch_depth = 0; // >0 while inside begin_batch()/end_batch()
+        std::vector<uint> dirty_verts;     // verts whose normal update was deferred
+        std::vector<uint> dirty_polys;     // polys whose normal/tessellation/quality update was deferred
+
+        // recomputes the attributes of the elements touched inside a batch (lists are sorted and free of duplicates)
+        virtual void update_dirty_elements() = 0;
+
     public:
 
         typedef M M_type;
@@ -112,6 +131,25 @@ class AbstractMesh
         virtual void load(const char * filename) = 0;
         virtual void save(const char * filename) const = 0;
 
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // In frozen mode v2v, v2e, v2p, e2p, p2e and p2p are stored in compact CSR arrays,
+        // which use much less memory and are faster to traverse. Any topological edit
+        // (e.g. adding or removing elements) automatically unfreezes the mesh
+        void freeze_connectivity();
+        void unfreeze_connectivity();
+        bool connectivity_is_frozen() const { return frozen; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // Inside a batch the local updates of normals, tessellations and quality that
+        // follow each edit (e.g. edge split/collapse/flip, vert relocation) are not
+        // executed, but deferred to end_batch(), which runs them once per touched element.
+        // Until then these attributes (and the bbox) may be stale. Batches can be nested
+        void begin_batch();
+        void end_batch();
+        bool in_batch() const { return batch_depth>0; }
+
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
                 void update_bbox();
@@ -137,7 +175,7 @@ class AbstractMesh
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         virtual uint verts_per_poly(const uint pid) const = 0;
-        virtual uint edges_per_poly(const uint pid) const { return uint(this->p2e.at(pid).size()); }
+        virtual uint edges_per_poly(const uint pid) const { return uint(this->adj_p2e(pid).size()); }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -178,23 +216,27 @@ class AbstractMesh
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-                const std::vector<uint> & adj_v2v(const uint vid) const { return v2v.at(vid); }
-                      std::vector<uint> & adj_v2v(const uint vid)       { return v2v.at(vid); }
-                const std::vector<uint> & adj_v2e(const uint vid) const { return v2e.at(vid); }
-                      std::vector<uint> & adj_v2e(const uint vid)       { return v2e.at(vid); }
-                const std::vector<uint> & adj_v2p(const uint vid) const { return v2p.at(vid); }
-                      std::vector<uint> & adj_v2p(const uint vid)       { return v2p.at(vid); }
+                      Span<uint>          adj_v2v(const uint vid) const { return frozen ? v2v_packed(vid) : Span<uint>(v2v.at(vid)); }
+                      Span<uint>          adj_v2e(const uint vid) const { return frozen ? v2e_packed(vid) : Span<uint>(v2e.at(vid)); }
+                      Span<uint>          adj_v2p(const uint vid) const { return frozen ? v2p_packed(vid) : Span<uint>(v2p.at(vid)); }
                       std::vector<uint>   adj_e2v(const uint eid) const;
                       std::vector<uint>   adj_e2e(const uint eid) const;
-                const std::vector<uint> & adj_e2p(const uint eid) const { return e2p.at(eid); }
-                      std::vector<uint> & adj_e2p(const uint eid)       { return e2p.at(eid); }
-                const std::vector<uint> & adj_p2e(const uint pid) const { return p2e.at(pid); }
-                      std::vector<uint> & adj_p2e(const uint pid)       { return p2e.at(pid); }
-                const std::vector<uint> & adj_p2p(const uint pid) const { return p2p.at(pid); }
-                      std::vector<uint> & adj_p2p(const uint pid)       { return p2p.at(pid); }
+                      Span<uint>          adj_e2p(const uint eid) const { return frozen ? e2p_packed(eid) : Span<uint>(e2p.at(eid)); }
+                      Span<uint>          adj_p2e(const uint pid) const { return frozen ? p2e_packed(pid) : Span<uint>(p2e.at(pid)); }
+                      Span<uint>          adj_p2p(const uint pid) const { return frozen ? p2p_packed(pid) : Span<uint>(p2p.at(pid)); }
         virtual const std::vector<uint> & adj_p2v(const uint pid) const = 0;
         virtual       std::vector<uint> & adj_p2v(const uint pid)       = 0;
 
+        // editable adjacency lists, for code that modifies the connectivity in place (these
+        // replace the former non-const overloads of the accessors above). If the mesh is
+        // frozen it is unfrozen first, hence do not use them for read-only traversals
+        std::vector<uint> & adj_v2v_mutable(const uint vid) { unfreeze_connectivity(); return v2v.at(vid); }
+        std::vector<uint> & adj_v2e_mutable(const uint vid) { unfreeze_connectivity(); return v2e.at(vid); }
+        std::vector<uint> & adj_v2p_mutable(const uint vid) { unfreeze_connectivity(); return v2p.at(vid); }
+        std::vector<uint> & adj_e2p_mutable(const uint eid) { unfreeze_connectivity(); return e2p.at(eid); }
+        std::vector<uint> & adj_p2e_mutable(const uint pid) { unfreeze_connectivity(); return p2e.at(pid); }
+        std::vector<uint> & adj_p2p_mutable(const uint pid) { unfreeze_connectivity(); return p2p.at(pid); }
+
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         const M & mesh_data()               const { return m_data;         }
@@ -301,6 +343,16 @@ class AbstractMesh
         virtual void               poly_set_color             (const Color & c);
         virtual void               poly_set_alpha             (const float alpha);
         virtual void               poly_export_element        (const uint pid, std::vector<vec3d> & verts, std::vector<std::vector<uint>> & faces) const = 0;
+
+    protected:
+
+        // CINOBIN serialization (see io/write_CINOBIN.h). Each class in the hierarchy
+        // stores (restores) its own data, and delegates the rest to its parent class.
+        // Meshes are restored in frozen mode, without recomputing any adjacency
+        virtual void export_CINOBIN(std::vector<CinobinSection> & sections) const;
+        virtual bool import_CINOBIN(const CinobinFile & f);
+                void save_CINOBIN  (const char * filename) const;
+                void load_CINOBIN  (const char * filename);
 };
 
 }
@@ -36,12 +36,14 @@
 #include <cinolib/meshes/abstract_polygonmesh.h>
 #include <cinolib/to_openGL_unified_verts.h>
 #include <cinolib/io/read_write.h>
+#include <cinolib/string_utilities.h>
 #include <cinolib/quality.h>
 #include <cinolib/stl_container_utilities.h>
 #include <cinolib/geometry/polygon_utils.h>
 #include <cinolib/vector_serialization.h>
 #include <cinolib/how_many_seconds.h>
 #include <cinolib/deg_rad.h>
+#include <cinolib/parallel_for.h>
 #include <unordered_set>
 #include <cinolib/ANSI_color_codes.h>
 #include <queue>
@@ -70,8 +72,13 @@ void AbstractPolygonMesh<M,V,E,P>::load(const char * filename)
     std::string str(filename);
     std::string filetype = str.substr(str.size()-4,4);
 
-    if (filetype.compare(".off") == 0 ||
-        filetype.compare(".OFF") == 0)
+    if (get_file_extension(str).compare("cinobin") == 0)
+    {
+        this->load_CINOBIN(filename);
+        return;
+    }
+    else if (filetype.compare(".off") == 0 ||
+             filetype.compare(".OFF") == 0)
     {
         read_OFF(filename, pos, poly_pos, poly_col);
     }
@@ -107,8 +114,12 @@ void AbstractPolygonMesh<M,V,E,P>::save(const char * filename) const
     std::string str(filename);
     std::string filetype = str.substr(str.size()-3,3);
 
-    if (filetype.compare("off") == 0 ||
-        filetype.compare("OFF") == 0)
+    if (get_file_extension(str).compare("cinobin") == 0)
+    {
+        this->save_CINOBIN(filename);
+    }
+    else if (filetype.compare("off") == 0 ||
+             filetype.compare("OFF") == 0)
     {
         write_OFF(filename, coords, this->polys);
     }
@@ -143,6 +154,62 @@ void AbstractPolygonMesh<M,V,E,P>::save(const char * filename) const
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractPolygonMesh<M,V,E,P>::export_CINOBIN(std::vector<CinobinSection> & sections) const
+{
+    AbstractMesh<M,V,E,P>::export_CINOBIN(sections);
+
+    std::vector<double> p_normal;
+    p_normal.reserve(3*this->num_polys());
+    for(uint pid=0; pid<this->num_polys(); ++pid)
+    {
+        const vec3d & n = this->poly_data(pid).normal;
+        p_normal.insert(p_normal.end(), n.ptr(), n.ptr()+3);
+    }
+    sections.emplace_back("p_normal",       p_normal);
+    sections.emplace_back("poly_triangles", PackedAdjacency(poly_triangles).serialize());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// normals and tessellations are recomputed if missing
+template<class M, class V, class E, class P>
+CINO_INLINE
+bool AbstractPolygonMesh<M,V,E,P>::import_CINOBIN(const CinobinFile & f)
+{
+    if(!AbstractMesh<M,V,E,P>::import_CINOBIN(f)) return false;
+
+    for(const auto & p : this->polys)
+    {
+        for(uint vid : p) if(vid>=this->num_verts()) return false;
+    }
+
+    PackedAdjacency tris;
+    if(f.has("poly_triangles") &&
+       tris.deserialize((const uint*)f.data("poly_triangles"), f.bytes("poly_triangles")/sizeof(uint)) &&
+       tris.size()==this->num_polys() && tris.ids_below(this->num_verts()))
+    {
+        tris.unpack(poly_triangles);
+    }
+    else
+    {
+        poly_triangles.resize(this->num_polys());
+        update_p_tessellations();
+    }
+
+    std::vector<double> p_normal;
+    if(f.read("p_normal", p_normal) && p_normal.size()==3*this->num_polys())
+    {
+        for(uint pid=0; pid<this->num_polys(); ++pid) this->poly_data(pid).normal = vec3d(&p_normal.at(3*pid));
+    }
+    else update_p_normals();
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::clear()
@@ -158,6 +225,8 @@ CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::init(const std::vector<vec3d>             & verts,
                                         const std::vector<std::vector<uint>> & polys)
 {
+    this->unfreeze_connectivity();
+
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
 
     // pre-allocate memory
@@ -180,7 +249,7 @@ void AbstractPolygonMesh<M,V,E,P>::init(const std::vector<vec3d>             & v
 
     // initialize mesh connectivity (and normals)
     for(auto v : verts) this->vert_add(v);
-    for(auto p : polys) this->poly_add(p);
+    this->polys_add(polys);
 
     if(this->mesh_data().update_normals) this->update_v_normals();
 
@@ -292,6 +361,12 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::update_p_tessellation(const uint pid)
 {
+    if(this->in_batch())
+    {
+        this->dirty_polys.push_back(pid);
+        return;
+    }
+
     // Assume convexity and try trivial tessellation first. If something flips
     // apply earcut algorithm to get a valid triangulation
 
@@ -344,6 +419,12 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::update_v_normal(const uint vid)
 {
+    if(this->in_batch())
+    {
+        this->dirty_verts.push_back(vid);
+        return;
+    }
+
     vec3d n(0,0,0);
     for(uint pid : this->adj_v2p(vid))
     {
@@ -359,6 +440,12 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::update_p_normal(const uint pid)
 {
+    if(this->in_batch())
+    {
+        this->dirty_polys.push_back(pid);
+        return;
+    }
+
     // compute the best fitting plane
     std::vector<vec3d> points;
     for(uint off=0; off<this->verts_per_poly(pid); ++off) points.push_back(this->poly_vert(pid,off));
@@ -413,6 +500,24 @@ void AbstractPolygonMesh<M,V,E,P>::update_normals()
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractPolygonMesh<M,V,E,P>::update_dirty_elements()
+{
+    // poly normals first, as vert normals are computed from them. The
+    // normals of the verts of the touched polys are updated as well
+    for(uint pid : this->dirty_polys)
+    {
+        update_p_tessellation(pid);
+        update_p_normal(pid);
+        for(uint vid : this->adj_p2v(pid)) this->dirty_verts.push_back(vid);
+    }
+    REMOVE_DUPLICATES_FROM_VEC(this->dirty_verts);
+    for(uint vid : this->dirty_verts) update_v_normal(vid);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 int AbstractPolygonMesh<M,V,E,P>::Euler_characteristic() const
@@ -560,6 +665,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::vert_order_all_one_rings()
 {
+    this->unfreeze_connectivity();
+
     for(uint vid=0; vid<this->num_verts(); ++vid)
     {
         std::vector<uint> v_link;
@@ -567,9 +674,9 @@ void AbstractPolygonMesh<M,V,E,P>::vert_order_all_one_rings()
         std::vector<uint> e_star;
         std::vector<uint> e_link;
         this->vert_ordered_one_ring(vid,v_link,f_star,e_star,e_link);
-        this->adj_v2v(vid) = v_link;
-        this->adj_v2e(vid) = e_star;
-        this->adj_v2p(vid) = f_star;
+        this->v2v.at(vid) = v_link;
+        this->v2e.at(vid) = e_star;
+        this->v2p.at(vid) = f_star;
     }
 }
 
@@ -889,6 +996,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractPolygonMesh<M,V,E,P>::vert_add(const vec3d & pos)
 {
+    this->unfreeze_connectivity();
+
     uint vid = this->num_verts();
     //
     this->verts.push_back(pos);
@@ -915,6 +1024,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 bool AbstractPolygonMesh<M,V,E,P>::vert_merge(const uint vid0, const uint vid1)
 {
+    this->unfreeze_connectivity();
+
     std::vector<uint> old_polys = this->adj_v2p(vid1);
     std::vector<std::vector<uint>> new_polys;
     for(uint pid : old_polys)
@@ -939,6 +1050,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::vert_switch_id(const uint vid0, const uint vid1)
 {
+    this->unfreeze_connectivity();
+
     // [28 Aug 2017] Tested on 10K random id switches : PASSED
 
     if (vid0 == vid1) return;
@@ -949,6 +1062,12 @@ void AbstractPolygonMesh<M,V,E,P>::vert_switch_id(const uint vid0, const uint vi
     std::swap(this->v2e.at(vid0),    this->v2e.at(vid1));
     std::swap(this->v2p.at(vid0),    this->v2p.at(vid1));
 
+    if(this->in_batch()) // deferred updates follow the elements
+    {
+        this->dirty_verts.push_back(vid0);
+        this->dirty_verts.push_back(vid1);
+    }
+
     std::unordered_set<uint> verts_to_update;
     verts_to_update.insert(this->adj_v2v(vid0).begin(), this->adj_v2v(vid0).end());
     verts_to_update.insert(this->adj_v2v(vid1).begin(), this->adj_v2v(vid1).end());
@@ -1001,6 +1120,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::vert_remove(const uint vid)
 {
+    this->unfreeze_connectivity();
+
     polys_remove(this->adj_v2p(vid));
 }
 
@@ -1010,6 +1131,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::vert_remove_unreferenced(const uint vid)
 {
+    this->unfreeze_connectivity();
+
     this->v2v.at(vid).clear();
     this->v2e.at(vid).clear();
     this->v2p.at(vid).clear();
@@ -1106,6 +1229,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractPolygonMesh<M,V,E,P>::edge_add(const uint vid0, const uint vid1)
 {
+    this->unfreeze_connectivity();
+
     assert(this->edge_id(vid0, vid1)==-1); // make sure it doesn't exist already
     assert(vid0 < this->num_verts());
     assert(vid1 < this->num_verts());
@@ -1138,6 +1263,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::edge_switch_id(const uint eid0, const uint eid1)
 {
+    this->unfreeze_connectivity();
+
     // [28 Aug 2017] Tested on 10K random id switches : PASSED
 
     if (eid0 == eid1) return;
@@ -1182,6 +1309,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::edge_remove(const uint eid)
 {
+    this->unfreeze_connectivity();
+
     polys_remove(this->adj_e2p(eid));
 }
 
@@ -1191,6 +1320,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::edge_remove_unreferenced(const uint eid)
 {
+    this->unfreeze_connectivity();
+
     this->e2p.at(eid).clear();
     edge_switch_id(eid, this->num_edges()-1);
     this->edges.resize(this->edges.size()-2);
@@ -1409,6 +1540,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::poly_switch_id(const uint pid0, const uint pid1)
 {
+    this->unfreeze_connectivity();
+
     // [28 Aug 2017] Tested on 10K random id switches : PASSED
 
     if (pid0 == pid1) return;
@@ -1419,6 +1552,12 @@ void AbstractPolygonMesh<M,V,E,P>::poly_switch_id(const uint pid0, const uint pi
     std::swap(this->p2p.at(pid0),            this->p2p.at(pid1));
     std::swap(this->poly_triangles.at(pid0), this->poly_triangles.at(pid1));
 
+    if(this->in_batch()) // deferred updates follow the elements
+    {
+        this->dirty_polys.push_back(pid0);
+        this->dirty_polys.push_back(pid1);
+    }
+
     std::unordered_set<uint> verts_to_update;
     verts_to_update.insert(this->adj_p2v(pid0).begin(), this->adj_p2v(pid0).end());
     verts_to_update.insert(this->adj_p2v(pid1).begin(), this->adj_p2v(pid1).end());
@@ -1465,6 +1604,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractPolygonMesh<M,V,E,P>::poly_add(const std::vector<uint> & vlist)
 {
+    this->unfreeze_connectivity();
+
     if(poly_id(vlist)!=-1)
     {
         std::cout << ANSI_fg_color_red << "WARNING: adding duplicated poly!" << ANSI_fg_color_default << std::endl;
@@ -1527,10 +1668,253 @@ uint AbstractPolygonMesh<M,V,E,P>::poly_add(const std::vector<uint> & vlist)
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractPolygonMesh<M,V,E,P>::polys_add(const std::vector<std::vector<uint>> & plist)
+{
+    this->unfreeze_connectivity();
+
+    // Batch counterpart of poly_add. Rather than searching edges and polys incrementally,
+    // half edges are bucketed by their lowest vertex and sorted only once, and all the
+    // adjacency relations are emitted in a single pass. The output is identical to the
+    // one obtained by calling poly_add on each polygon in sequence (same ids, same
+    // ordering of all adjacency lists). The batch path only applies to meshes that do
+    // not have edges or polygons yet, otherwise incremental insertion is used instead.
+
+    if(this->num_polys()>0 || this->num_edges()>0)
+    {
+        for(const auto & p : plist) poly_add(p);
+        return;
+    }
+
+    uint nv = this->num_verts();
+
+    // detect duplicated polygons (i.e. polygons having the same set of vertices, as in poly_id)
+    std::vector<uint> sorted_off(plist.size()+1,0);
+    for(uint i=0; i<plist.size(); ++i) sorted_off.at(i+1) = sorted_off.at(i) + uint(plist.at(i).size());
+    std::vector<uint> sorted_vids(sorted_off.back());
+    PARALLEL_FOR(0, uint(plist.size()), 1000, [&](const uint i)
+    {
+        assert(!plist.at(i).empty());
+        std::copy(plist.at(i).begin(), plist.at(i).end(), sorted_vids.begin()+sorted_off.at(i));
+        std::sort(sorted_vids.begin()+sorted_off.at(i), sorted_vids.begin()+sorted_off.at(i+1));
+    });
+    std::vector<uint> bucket_off(nv+1,0);
+    for(uint i=0; i<plist.size(); ++i)
+    {
+#ifndef NDEBUG
+        for(uint vid : plist.at(i)) assert(vid < nv);
+#endif
+        ++bucket_off.at(sorted_vids.at(sorted_off.at(i))+1);
+    }
+    for(uint vid=0; vid<nv; ++vid) bucket_off.at(vid+1) += bucket_off.at(vid);
+    std::vector<uint> bucket(plist.size());
+    {
+        std::vector<uint> pos(bucket_off.begin(), bucket_off.end()-1);
+        for(uint i=0; i<plist.size(); ++i) bucket.at(pos.at(sorted_vids.at(sorted_off.at(i)))++) = i;
+    }
+    std::vector<int> dup_of(plist.size(),-1);
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
+    {
+        auto beg = bucket.begin() + bucket_off.at(vid);
+        auto end = bucket.begin() + bucket_off.at(vid+1);
+        auto key = [&](const uint i)
+        {
+            return std::make_pair(sorted_vids.begin()+sorted_off.at(i), sorted_vids.begin()+sorted_off.at(i+1));
+        };
+        auto same_key = [&](const uint i, const uint j)
+        {
+            auto a = key(i), b = key(j);
+            return (a.second-a.first)==(b.second-b.first) && std::equal(a.first, a.second, b.first);
+        };
+        auto less_key = [&](const uint i, const uint j)
+        {
+            auto a = key(i), b = key(j);
+            return std::lexicographical_compare(a.first, a.second, b.first, b.second);
+        };
+        std::stable_sort(beg, end, less_key);
+        for(auto it=beg; it!=end; ++it)
+        {
+            auto first = it;
+            while(it+1!=end && same_key(*first,*(it+1))) dup_of.at(*(++it)) = int(*first);
+        }
+    });
+    std::vector<uint>().swap(sorted_vids);
+    std::vector<uint>().swap(sorted_off);
+    std::vector<uint>().swap(bucket);
+
+    // flatten the non duplicated polygons into half edges
+    std::vector<uint> p_off(1,0);
+    std::vector<uint> h_vid;
+    p_off.reserve(plist.size()+1);
+    for(uint i=0; i<plist.size(); ++i)
+    {
+        if(dup_of.at(i)>=0)
+        {
+            std::cout << ANSI_fg_color_red << "WARNING: adding duplicated poly!" << ANSI_fg_color_default << std::endl;
+            continue;
+        }
+        p_off.push_back(p_off.back() + uint(plist.at(i).size()));
+    }
+    uint np = uint(p_off.size()-1);
+    uint nh = p_off.back();
+    h_vid.reserve(nh);
+    for(uint i=0; i<plist.size(); ++i)
+    {
+        if(dup_of.at(i)<0) h_vid.insert(h_vid.end(), plist.at(i).begin(), plist.at(i).end());
+    }
+    std::vector<int>().swap(dup_of);
+    std::vector<uint> h_pid(nh);
+    PARALLEL_FOR(0, np, 1000, [&](const uint pid)
+    {
+        std::fill(h_pid.begin()+p_off.at(pid), h_pid.begin()+p_off.at(pid+1), pid);
+    });
+    auto h_next = [&](const uint h)
+    {
+        uint pid = h_pid.at(h);
+        return (h+1<p_off.at(pid+1)) ? h_vid.at(h+1) : h_vid.at(p_off.at(pid));
+    };
+
+    // bucket half edges by their lowest endpoint, then sort each bucket by the highest endpoint.
+    // Sorting is stable, hence within each group of coincident half edges the first one is the
+    // one that would have created the edge in the incremental construction
+    std::fill(bucket_off.begin(), bucket_off.end(), 0);
+    for(uint h=0; h<nh; ++h) ++bucket_off.at(std::min(h_vid.at(h),h_next(h))+1);
+    for(uint vid=0; vid<nv; ++vid) bucket_off.at(vid+1) += bucket_off.at(vid);
+    bucket.resize(nh);
+    {
+        std::vector<uint> pos(bucket_off.begin(), bucket_off.end()-1);
+        for(uint h=0; h<nh; ++h) bucket.at(pos.at(std::min(h_vid.at(h),h_next(h)))++) = h;
+    }
+    std::vector<uint> h_lead(nh);
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
+    {
+        auto beg = bucket.begin() + bucket_off.at(vid);
+        auto end = bucket.begin() + bucket_off.at(vid+1);
+        std::stable_sort(beg, end, [&](const uint h0, const uint h1)
+        {
+            return std::max(h_vid.at(h0),h_next(h0)) < std::max(h_vid.at(h1),h_next(h1));
+        });
+        for(auto it=beg; it!=end; ++it)
+        {
+            uint lead = *it;
+            uint vmax = std::max(h_vid.at(lead),h_next(lead));
+            h_lead.at(lead) = lead;
+            while(it+1!=end && std::max(h_vid.at(*(it+1)),h_next(*(it+1)))==vmax) h_lead.at(*(++it)) = lead;
+        }
+    });
+
+    // edge ids follow the order of first appearance
+    std::vector<uint> h_eid(nh);
+    uint ne = 0;
+    for(uint h=0; h<nh; ++h)
+    {
+        if(h_lead.at(h)==h) h_eid.at(h) = ne++;
+        else                h_eid.at(h) = h_eid.at(h_lead.at(h));
+    }
+    this->edges.resize(2*ne);
+    PARALLEL_FOR(0, nh, 1000, [&](const uint h)
+    {
+        if(h_lead.at(h)!=h) return;
+        this->edges.at(2*h_eid.at(h)  ) = h_vid.at(h);
+        this->edges.at(2*h_eid.at(h)+1) = h_next(h);
+    });
+    this->e_data.resize(ne);
+
+    // poly to edge, edge to poly
+    this->polys.resize(np);
+    this->p2e.resize(np);
+    PARALLEL_FOR(0, np, 1000, [&](const uint pid)
+    {
+        this->polys.at(pid).assign(h_vid.begin()+p_off.at(pid), h_vid.begin()+p_off.at(pid+1));
+        this->p2e.at(pid).assign(h_eid.begin()+p_off.at(pid), h_eid.begin()+p_off.at(pid+1));
+    });
+    this->e2p.resize(ne);
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
+    {
+        for(uint i=bucket_off.at(vid); i<bucket_off.at(vid+1); ++i)
+        {
+            uint h = bucket.at(i);
+            this->e2p.at(h_eid.at(h)).push_back(h_pid.at(h));
+        }
+    });
+    std::vector<uint>().swap(bucket);
+    std::vector<uint>().swap(bucket_off);
+    std::vector<uint>().swap(h_lead);
+
+    // vert to vert, vert to edge, vert to poly
+    std::vector<uint> v_count(nv,0);
+    for(uint eid=0; eid<ne; ++eid)
+    {
+        ++v_count.at(this->edges.at(2*eid  ));
+        ++v_count.at(this->edges.at(2*eid+1));
+    }
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
+    {
+        this->v2v.at(vid).reserve(v_count.at(vid));
+        this->v2e.at(vid).reserve(v_count.at(vid));
+    });
+    for(uint eid=0; eid<ne; ++eid)
+    {
+        uint vid0 = this->edges.at(2*eid  );
+        uint vid1 = this->edges.at(2*eid+1);
+        this->v2v.at(vid1).push_back(vid0);
+        this->v2v.at(vid0).push_back(vid1);
+        this->v2e.at(vid0).push_back(eid);
+        this->v2e.at(vid1).push_back(eid);
+    }
+    std::fill(v_count.begin(), v_count.end(), 0);
+    for(uint vid : h_vid) ++v_count.at(vid);
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
+    {
+        this->v2p.at(vid).reserve(v_count.at(vid));
+    });
+    for(uint h=0; h<nh; ++h) this->v2p.at(h_vid.at(h)).push_back(h_pid.at(h));
+
+    // poly to poly: each poly first lists the adjacent polys that precede it (sorted
+    // by edge), and then the adjacent polys that follow it (sorted by id)
+    this->p2p.resize(np);
+    PARALLEL_FOR(0, np, 1000, [&](const uint pid)
+    {
+        for(uint eid : this->p2e.at(pid))
+        for(uint nbr : this->e2p.at(eid))
+        {
+            if(nbr>=pid) break;
+            if(DOES_NOT_CONTAIN_VEC(this->p2p.at(pid), nbr)) this->p2p.at(pid).push_back(nbr);
+        }
+    });
+    std::vector<uint> n_prev(np);
+    for(uint pid=0; pid<np; ++pid) n_prev.at(pid) = uint(this->p2p.at(pid).size());
+    for(uint pid=0; pid<np; ++pid)
+    {
+        for(uint i=0; i<n_prev.at(pid); ++i) this->p2p.at(this->p2p.at(pid).at(i)).push_back(pid);
+    }
+
+    // per poly attributes, normals and tessellations. Inside a batch the updates are
+    // deferred, and the new polys are marked dirty here once (and serially, as the
+    // dirty list is not thread safe) rather than by each update_p_* call
+    this->p_data.resize(np);
+    this->poly_triangles.resize(np);
+    if(this->in_batch())
+    {
+        for(uint pid=0; pid<np; ++pid) this->dirty_polys.push_back(pid);
+        return;
+    }
+    PARALLEL_FOR(0, np, 1000, [&](const uint pid)
+    {
+        if(this->mesh_data().update_normals) this->update_p_normal(pid);
+        update_p_tessellation(pid);
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::polys_remove(const std::vector<uint> & pids)
 {
+    this->unfreeze_connectivity();
+
     // in order to avoid id conflicts remove all the
     // polys starting from the one with highest id
     //
@@ -1546,6 +1930,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::poly_remove(const uint pid)
 {
+    this->unfreeze_connectivity();
+
     // [28 Aug 2017] Tested on progressive random removal until almost no polys are left: PASSED
 
     std::set<uint,std::greater<uint>> dangling_verts; // higher ids first
@@ -1598,6 +1984,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::poly_remove_unreferenced(const uint pid)
 {
+    this->unfreeze_connectivity();
+
     this->polys.at(pid).clear();
     this->p2e.at(pid).clear();
     this->p2p.at(pid).clear();
@@ -1698,6 +2086,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::operator+=(const AbstractPolygonMesh<M,V,E,P> & m)
 {
+    this->unfreeze_connectivity();
+
     uint nv = this->num_verts();
     uint ne = this->num_edges();
     uint np = this->num_polys();
@@ -1712,11 +2102,11 @@ void AbstractPolygonMesh<M,V,E,P>::operator+=(const AbstractPolygonMesh<M,V,E,P>
         this->p_data.push_back(m.poly_data(pid));
 
         tmp.clear();
-        for(uint eid : m.p2e.at(pid)) tmp.push_back(ne + eid);
+        for(uint eid : m.adj_p2e(pid)) tmp.push_back(ne + eid);
         this->p2e.push_back(tmp);
 
         tmp.clear();
-        for(uint nbr : m.p2p.at(pid)) tmp.push_back(np + nbr);
+        for(uint nbr : m.adj_p2p(pid)) tmp.push_back(np + nbr);
         this->p2p.push_back(tmp);
 
         tmp.clear();
@@ -1731,7 +2121,7 @@ void AbstractPolygonMesh<M,V,E,P>::operator+=(const AbstractPolygonMesh<M,V,E,P>
         this->e_data.push_back(m.edge_data(eid));
 
         tmp.clear();
-        for(uint tid : m.e2p.at(eid)) tmp.push_back(np + tid);
+        for(uint tid : m.adj_e2p(eid)) tmp.push_back(np + tid);
         this->e2p.push_back(tmp);
     }
     for(uint vid=0; vid<m.num_verts(); ++vid)
@@ -1740,15 +2130,15 @@ void AbstractPolygonMesh<M,V,E,P>::operator+=(const AbstractPolygonMesh<M,V,E,P>
         this->v_data.push_back(m.vert_data(vid));
 
         tmp.clear();
-        for(uint eid : m.v2e.at(vid)) tmp.push_back(ne + eid);
+        for(uint eid : m.adj_v2e(vid)) tmp.push_back(ne + eid);
         this->v2e.push_back(tmp);
 
         tmp.clear();
-        for(uint tid : m.v2p.at(vid)) tmp.push_back(np + tid);
+        for(uint tid : m.adj_v2p(vid)) tmp.push_back(np + tid);
         this->v2p.push_back(tmp);
 
         tmp.clear();
-        for(uint nbr : m.v2v.at(vid)) tmp.push_back(nv + nbr);
+        for(uint nbr : m.adj_v2v(vid)) tmp.push_back(nv + nbr);
         this->v2v.push_back(tmp);
     }
 
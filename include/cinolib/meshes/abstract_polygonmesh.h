@@ -55,6 +55,8 @@ class AbstractPolygonMesh : public AbstractMesh<M,V,E,P>
         std::vector<std::vector<uint>> poly_triangles; // triangles covering each quad. Useful for
                                                        // robust normal estimation and rendering
 
+        void update_dirty_elements() override;
+
     public:
 
         explicit AbstractPolygonMesh() : AbstractMesh<M,V,E,P>() {}
@@ -185,6 +187,7 @@ class AbstractPolygonMesh : public AbstractMesh<M,V,E,P>
               void                 poly_switch_id          (const uint pid0, const uint pid1);
               bool                 poly_is_boundary        (const uint pid) const;
               uint                 poly_add                (const std::vector<uint> & vlist);
+              void                 polys_add               (const std::vector<std::vector<uint>> & plist);
               void                 poly_remove_unreferenced(const uint pid);
               void                 poly_remove             (const uint pid);
               void                 polys_remove            (const std::vector<uint> & pids);
@@ -197,6 +200,10 @@ class AbstractPolygonMesh : public AbstractMesh<M,V,E,P>
               std::vector<uint>    poly_inner_edges        (const uint pid) const;
               std::vector<uint>    poly_boundary_verts     (const uint pid) const;
               std::vector<uint>    poly_inner_verts        (const uint pid) const;
+    protected:
+
+        void export_CINOBIN(std::vector<CinobinSection> & sections) const override;
+        bool import_CINOBIN(const CinobinFile & f) override;
 };
 
 }
@@ -37,10 +37,12 @@
 #include <cinolib/geometry/triangle.h>
 #include <cinolib/geometry/polygon_utils.h>
 #include <cinolib/how_many_seconds.h>
+#include <cinolib/stl_container_utilities.h>
 #include <unordered_set>
 #include <unordered_map>
 #include <cinolib/ANSI_color_codes.h>
 #include <queue>
+#include <algorithm>
 
 namespace cinolib
 {
@@ -63,6 +65,8 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::clear()
     f2f.clear();
     f2p.clear();
     p2v.clear();
+    //
+    dirty_faces.clear();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -74,6 +78,8 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::init(const std::vector<vec3d>
                                              const std::vector<std::vector<uint>> & polys,
                                              const std::vector<std::vector<bool>> & polys_face_winding)
 {
+    this->unfreeze_connectivity();
+
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
 
     // pre-allocate memory
@@ -128,6 +134,8 @@ CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::init(const std::vector<vec3d>             & verts,
                                              const std::vector<std::vector<uint>> & polys)
 {
+    this->unfreeze_connectivity();
+
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
 
     // pre-allocate memory
@@ -171,6 +179,8 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::init(const std::vector<vec3d>
                                              const std::vector<int>               & vert_labels,
                                              const std::vector<int>               & poly_labels)
 {
+    this->unfreeze_connectivity();
+
     init(verts, polys);
 
     if(vert_labels.size()==this->num_verts())
@@ -195,6 +205,127 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::init(const std::vector<vec3d>
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void AbstractPolyhedralMesh<M,V,E,F,P>::export_CINOBIN(std::vector<CinobinSection> & sections) const
+{
+    AbstractMesh<M,V,E,P>::export_CINOBIN(sections);
+
+    std::vector<uint8_t> winding; // same layout of polys
+    for(const auto & w : polys_face_winding) winding.insert(winding.end(), w.begin(), w.end());
+
+    sections.emplace_back("faces",              PackedAdjacency(faces).serialize());
+    sections.emplace_back("polys_face_winding", winding);
+    sections.emplace_back("v2f",                PackedAdjacency(v2f).serialize());
+    sections.emplace_back("e2f",                PackedAdjacency(e2f).serialize());
+    sections.emplace_back("f2e",                PackedAdjacency(f2e).serialize());
+    sections.emplace_back("f2f",                PackedAdjacency(f2f).serialize());
+    sections.emplace_back("f2p",                PackedAdjacency(f2p).serialize());
+    sections.emplace_back("p2v",                PackedAdjacency(p2v).serialize());
+    sections.emplace_back("face_triangles",     PackedAdjacency(face_triangles).serialize());
+
+    std::vector<double>  f_normal;
+    std::vector<Color>   f_color;
+    std::vector<int>     f_label;
+    std::vector<uint8_t> f_flags;
+    for(const F & d : f_data)
+    {
+        f_normal.insert(f_normal.end(), d.normal.ptr(), d.normal.ptr()+3);
+        f_color.push_back(d.color);
+        f_label.push_back(d.label);
+        f_flags.push_back(uint8_t(d.flags.to_ulong()));
+    }
+    sections.emplace_back("f_normal", f_normal);
+    sections.emplace_back("f_color",  f_color);
+    sections.emplace_back("f_label",  f_label);
+    sections.emplace_back("f_flags",  f_flags);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// face normals and tessellations are recomputed if missing
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+bool AbstractPolyhedralMesh<M,V,E,F,P>::import_CINOBIN(const CinobinFile & f)
+{
+    if(!AbstractMesh<M,V,E,P>::import_CINOBIN(f)) return false;
+
+    auto adj = [&f](const std::string & name, std::vector<std::vector<uint>> & lists)
+    {
+        PackedAdjacency tmp;
+        if(!f.has(name) || !tmp.deserialize((const uint*)f.data(name), f.bytes(name)/sizeof(uint))) return false;
+        tmp.unpack(lists);
+        return true;
+    };
+
+    std::vector<uint8_t> winding;
+    if(!f.read("polys_face_winding", winding) ||
+       !adj("faces", faces) ||
+       !adj("v2f",   v2f)   ||
+       !adj("e2f",   e2f)   ||
+       !adj("f2e",   f2e)   ||
+       !adj("f2f",   f2f)   ||
+       !adj("f2p",   f2p)   ||
+       !adj("p2v",   p2v)) return false;
+
+    if(v2f.size()!=this->num_verts() || e2f.size()!=this->num_edges() ||
+       f2e.size()!=this->num_faces() || f2f.size()!=this->num_faces() ||
+       f2p.size()!=this->num_faces() || p2v.size()!=this->num_polys()) return false;
+
+    // element ids must be in range
+    auto ids_below = [](const std::vector<std::vector<uint>> & lists, const uint n)
+    {
+        for(const auto & l : lists) for(uint id : l) if(id>=n) return false;
+        return true;
+    };
+    if(!ids_below(this->polys, this->num_faces()) ||
+       !ids_below(faces, this->num_verts()) ||
+       !ids_below(v2f,   this->num_faces()) ||
+       !ids_below(e2f,   this->num_faces()) ||
+       !ids_below(f2e,   this->num_edges()) ||
+       !ids_below(f2f,   this->num_faces()) ||
+       !ids_below(f2p,   this->num_polys()) ||
+       !ids_below(p2v,   this->num_verts())) return false;
+
+    size_t n_windings = 0;
+    for(const auto & p : this->polys) n_windings += p.size();
+    if(winding.size()!=n_windings) return false;
+    polys_face_winding.resize(this->num_polys());
+    auto it = winding.begin();
+    for(uint pid=0; pid<this->num_polys(); ++pid)
+    {
+        polys_face_winding.at(pid).assign(it, it+this->polys.at(pid).size());
+        it += this->polys.at(pid).size();
+    }
+
+    f_data.resize(this->num_faces());
+    std::vector<double>  f_normal;
+    std::vector<Color>   f_color;
+    std::vector<int>     f_label;
+    std::vector<uint8_t> f_flags;
+    if(f.read("f_color", f_color) && f_color.size()==this->num_faces()) for(uint fid=0; fid<this->num_faces(); ++fid) f_data.at(fid).color = f_color.at(fid);
+    if(f.read("f_label", f_label) && f_label.size()==this->num_faces()) for(uint fid=0; fid<this->num_faces(); ++fid) f_data.at(fid).label = f_label.at(fid);
+    if(f.read("f_flags", f_flags) && f_flags.size()==this->num_faces()) for(uint fid=0; fid<this->num_faces(); ++fid) f_data.at(fid).flags = f_flags.at(fid);
+    if(f.read("f_normal", f_normal) && f_normal.size()==3*this->num_faces())
+    {
+        for(uint fid=0; fid<this->num_faces(); ++fid) f_data.at(fid).normal = vec3d(&f_normal.at(3*fid));
+    }
+    else update_f_normals();
+
+    if(!adj("face_triangles", face_triangles) || face_triangles.size()!=this->num_faces() ||
+       !ids_below(face_triangles, this->num_verts()))
+    {
+        face_triangles.resize(this->num_faces());
+        update_f_tessellation();
+    }
+
+    // quality is not stored in the file
+    this->update_quality();
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
 double AbstractPolyhedralMesh<M,V,E,F,P>::mesh_srf_area() const
@@ -309,6 +440,33 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::update_normals()
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void AbstractPolyhedralMesh<M,V,E,F,P>::update_dirty_elements()
+{
+    REMOVE_DUPLICATES_FROM_VEC(dirty_faces);
+    dirty_faces.erase(std::lower_bound(dirty_faces.begin(), dirty_faces.end(), this->num_faces()), dirty_faces.end());
+
+    // face normals first, as vert normals are computed from them. The
+    // normals of the verts of the touched surface faces are updated as well
+    for(uint fid : dirty_faces)
+    {
+        this->update_f_normal(fid);
+        update_f_tessellation(fid);
+        if(this->face_is_on_srf(fid))
+        {
+            for(uint vid : this->adj_f2v(fid)) this->dirty_verts.push_back(vid);
+        }
+    }
+    REMOVE_DUPLICATES_FROM_VEC(this->dirty_verts);
+    for(uint pid : this->dirty_polys) update_p_quality(pid);
+    for(uint vid : this->dirty_verts) update_v_normal(vid);
+
+    dirty_faces.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
 std::vector<uint> AbstractPolyhedralMesh<M,V,E,F,P>::get_surface_verts() const
@@ -380,9 +538,16 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::update_f_tessellation(const uint fid)
 {
+    if(this->in_batch())
+    {
+        dirty_faces.push_back(fid);
+        return;
+    }
+
     // Assume convexity and try trivial tessellation first. If something flips
     // apply earcut algorithm to get a valid triangulation
 
+    face_triangles.at(fid).clear();
     std::vector<vec3d> n;
     for (uint i=2; i<this->verts_per_face(fid); ++i)
     {
@@ -439,6 +604,12 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::update_p_quality(const uint pid)
 {
+    if(this->in_batch())
+    {
+        this->dirty_polys.push_back(pid);
+        return;
+    }
+
     if(this->poly_is_tetrahedron(pid))
     {
         this->poly_data(pid).quality = float(tet_scaled_jacobian(this->poly_vert(pid,0),
@@ -477,6 +648,12 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::update_v_normal(const uint vid)
 {
+    if(this->in_batch())
+    {
+        this->dirty_verts.push_back(vid);
+        return;
+    }
+
     vec3d n(0,0,0);
     for(uint fid : adj_v2f(vid))
     {        
@@ -634,6 +811,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::face_split_in_triangles(const uint fid, const vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     assert(this->face_has_no_duplicate_verts(fid));
 
     uint new_vid = this->vert_add(p);
@@ -673,6 +852,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::face_split_along_new_edge(const uint fid, uint vid0, uint vid1)
 {
+    this->unfreeze_connectivity();
+
     assert(this->verts_per_face(fid)>3);
     assert(this->face_contains_vert(fid, vid0));
     assert(this->face_contains_vert(fid, vid1));
@@ -718,6 +899,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::poly_split_along_new_face(const uint pid, const std::vector<uint> & f)
 {
+    this->unfreeze_connectivity();
+
 #ifndef NDEBUG
     for(uint vid : f) assert(this->poly_contains_vert(pid,vid));
 #endif
@@ -918,6 +1101,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::edge_split(const uint eid, const vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     uint new_vid = this->vert_add(p);
     uint v0      = this->edge_vert_id(eid, 0);
     uint v1      = this->edge_vert_id(eid, 1);
@@ -1970,6 +2155,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::vert_switch_id(const uint vid0, const uint vid1)
 {
+    this->unfreeze_connectivity();
+
     if(vid0 == vid1) return;
 
     std::swap(this->verts.at(vid0),   this->verts.at(vid1));
@@ -1979,6 +2166,12 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::vert_switch_id(const uint vid0, const ui
     std::swap(this->v2p.at(vid0),     this->v2p.at(vid1));
     std::swap(this->v_data.at(vid0),  this->v_data.at(vid1));
 
+    if(this->in_batch()) // deferred updates follow the elements
+    {
+        this->dirty_verts.push_back(vid0);
+        this->dirty_verts.push_back(vid1);
+    }
+
     std::unordered_set<uint> verts_to_update;
     verts_to_update.insert(this->adj_v2v(vid0).begin(), this->adj_v2v(vid0).end());
     verts_to_update.insert(this->adj_v2v(vid1).begin(), this->adj_v2v(vid1).end());
@@ -2044,6 +2237,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::vert_remove(const uint vid)
 {
+    this->unfreeze_connectivity();
+
     polys_remove(this->adj_v2p(vid));
 }
 
@@ -2053,6 +2248,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::vert_remove_unreferenced(const uint vid)
 {
+    this->unfreeze_connectivity();
+
     this->v2v.at(vid).clear();
     this->v2e.at(vid).clear();
     this->v2f.at(vid).clear();
@@ -2072,6 +2269,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::vert_add(const vec3d & pos)
 {
+    this->unfreeze_connectivity();
+
     uint vid = this->num_verts();
     //
     this->verts.push_back(pos);
@@ -2097,6 +2296,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::edge_switch_id(const uint eid0, const uint eid1)
 {
+    this->unfreeze_connectivity();
+
     if (eid0 == eid1) return;
 
     for(uint off=0; off<2; ++off) std::swap(this->edges.at(2*eid0+off), this->edges.at(2*eid1+off));
@@ -2152,6 +2353,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::edge_add(const uint vid0, const uint vid1)
 {
+    this->unfreeze_connectivity();
+
     assert(this->edge_id(vid0, vid1)==-1); // make sure it doesn't exist already
     assert(vid0 < this->num_verts());
     assert(vid1 < this->num_verts());
@@ -2186,6 +2389,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::edge_remove(const uint eid)
 {
+    this->unfreeze_connectivity();
+
     polys_remove(this->adj_e2p(eid));
 }
 
@@ -2195,6 +2400,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::edge_remove_unreferenced(const uint eid)
 {
+    this->unfreeze_connectivity();
+
     this->e2f.at(eid).clear();
     this->e2p.at(eid).clear();
     edge_switch_id(eid, this->num_edges()-1);
@@ -2221,6 +2428,12 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::face_switch_id(const uint fid0, const ui
     std::swap(this->f2p.at(fid0),            this->f2p.at(fid1));
     std::swap(this->face_triangles.at(fid0), this->face_triangles.at(fid1));
 
+    if(this->in_batch()) // deferred updates follow the elements
+    {
+        dirty_faces.push_back(fid0);
+        dirty_faces.push_back(fid1);
+    }
+
     std::unordered_set<uint> verts_to_update;
     verts_to_update.insert(this->adj_f2v(fid0).begin(), this->adj_f2v(fid0).end());
     verts_to_update.insert(this->adj_f2v(fid1).begin(), this->adj_f2v(fid1).end());
@@ -2280,6 +2493,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::face_add(const std::vector<uint> & f)
 {
+    this->unfreeze_connectivity();
+
     if(face_id(f)!=-1)
     {
         std::cout << ANSI_fg_color_red << "WARNING: adding duplicated face!" << ANSI_fg_color_default << std::endl;
@@ -2334,7 +2549,7 @@ uint AbstractPolyhedralMesh<M,V,E,F,P>::face_add(const std::vector<uint> & f)
         this->f2e.at(fid).push_back(eid);
     }
 
-    this->update_f_normal(fid);
+    if(!this->in_batch()) this->update_f_normal(fid); // otherwise deferred, together with the tessellation
     this->face_triangles.push_back(std::vector<uint>());
     update_f_tessellation(fid);
 
@@ -2347,6 +2562,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::face_remove(const uint fid)
 {
+    this->unfreeze_connectivity();
+
     polys_remove(this->adj_f2p(fid));
 }
 
@@ -2356,6 +2573,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::face_remove_unreferenced(const uint fid)
 {
+    this->unfreeze_connectivity();
+
     this->faces.at(fid).clear();
     this->f2e.at(fid).clear();
     this->f2f.at(fid).clear();
@@ -2376,6 +2595,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::poly_switch_id(const uint pid0, const uint pid1)
 {
+    this->unfreeze_connectivity();
+
     if (pid0 == pid1) return;
 
     std::swap(this->polys.at(pid0),              this->polys.at(pid1));
@@ -2385,6 +2606,12 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::poly_switch_id(const uint pid0, const ui
     std::swap(this->p2p.at(pid0),                this->p2p.at(pid1));
     std::swap(this->polys_face_winding.at(pid0), this->polys_face_winding.at(pid1));
 
+    if(this->in_batch()) // deferred updates follow the elements
+    {
+        this->dirty_polys.push_back(pid0);
+        this->dirty_polys.push_back(pid1);
+    }
+
     std::unordered_set<uint> verts_to_update;
     verts_to_update.insert(this->adj_p2v(pid0).begin(), this->adj_p2v(pid0).end());
     verts_to_update.insert(this->adj_p2v(pid1).begin(), this->adj_p2v(pid1).end());
@@ -2445,6 +2672,8 @@ CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::poly_add(const std::vector<uint> & flist,
                                                  const std::vector<bool> & fwinding)
 {
+    this->unfreeze_connectivity();
+
     if(poly_id(flist)!=-1)
     {
         std::cout << ANSI_fg_color_red << "WARNING: adding duplicated poly!" << ANSI_fg_color_default << std::endl;
@@ -2518,6 +2747,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::poly_add(const std::vector<uint> & vlist)
 {
+    this->unfreeze_connectivity();
+
     if(vlist.size()==4) // tetrahedron
     {
         // detect faces
@@ -2721,6 +2952,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::poly_remove_unreferenced(const uint pid)
 {
+    this->unfreeze_connectivity();
+
     this->polys.at(pid).clear();
     this->p2v.at(pid).clear();
     this->p2e.at(pid).clear();
@@ -2741,6 +2974,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::poly_remove(const uint pid, const bool delete_dangling_elements)
 {
+    this->unfreeze_connectivity();
+
     std::set<uint,std::greater<uint>> dangling_verts; // higher ids first
     std::set<uint,std::greater<uint>> dangling_edges; // higher ids first
     std::set<uint,std::greater<uint>> dangling_faces; // higher ids first
@@ -2823,6 +3058,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::polys_remove(const std::vector<uint> & pids)
 {
+    this->unfreeze_connectivity();
+
     // in order to avoid id conflicts remove all the
     // polys starting from the one with highest id
     //
@@ -66,6 +66,10 @@ class AbstractPolyhedralMesh : public AbstractMesh<M,V,E,P>
 
         std::vector<std::vector<uint>> face_triangles; // per face serialized triangulation (e.g., for rendering)
 
+        std::vector<uint> dirty_faces; // faces whose normal/tessellation update was deferred (see begin_batch())
+
+        void update_dirty_elements() override;
+
     public:
 
         typedef F F_type;
@@ -309,7 +313,10 @@ class AbstractPolyhedralMesh : public AbstractMesh<M,V,E,P>
                 bool               poly_is_prism               (const uint pid) const;
                 bool               poly_is_prism               (const uint pid, const uint fid) const; // check if it is a prism using fid as base
                 bool               poly_is_hexable_w_midpoint  (const uint pid) const; // check if this element can be hexed with midpoint subdivision
+    protected:
 
+        void export_CINOBIN(std::vector<CinobinSection> & sections) const override;
+        bool import_CINOBIN(const CinobinFile & f) override;
 };
 
 }
@@ -106,20 +106,25 @@ void Hexmesh<M,V,E,F,P>::load(const char * filename)
     std::string str(filename);
     std::string filetype = "." + get_file_extension(str);
 
-    if (filetype.compare(".mesh") == 0 ||
-        filetype.compare(".MESH") == 0)
+    if (filetype.compare(".cinobin") == 0)
+    {
+        this->load_CINOBIN(filename);
+        return;
+    }
+    else if (filetype.compare(".mesh") == 0 ||
+             filetype.compare(".MESH") == 0)
     {
         read_MESH(filename, tmp_verts, tmp_polys, vert_labels, poly_labels);
     }
     else if (filetype.compare(".vtu") == 0 ||
              filetype.compare(".VTU") == 0)
     {
-        read_VTU(filename, tmp_verts, tmp_polys);
+        read_VTU(filename, tmp_verts, tmp_polys, vert_labels, poly_labels);
     }
     else if (filetype.compare(".vtk") == 0 ||
              filetype.compare(".VTK") == 0)
     {
-        read_VTK(filename, tmp_verts, tmp_polys);
+        read_VTK(filename, tmp_verts, tmp_polys, vert_labels, poly_labels);
     }
     else
     {
@@ -138,8 +143,12 @@ void Hexmesh<M,V,E,F,P>::save(const char * filename) const
     std::string str(filename);
     std::string filetype = get_file_extension(str);
 
-    if (filetype.compare("mesh") == 0 ||
-        filetype.compare("MESH") == 0)
+    if (filetype.compare("cinobin") == 0)
+    {
+        this->save_CINOBIN(filename);
+    }
+    else if (filetype.compare("mesh") == 0 ||
+             filetype.compare("MESH") == 0)
     {
         if(this->polys_are_labeled())
         {
@@ -150,12 +159,20 @@ void Hexmesh<M,V,E,F,P>::save(const char * filename) const
     else if (filetype.compare("vtu") == 0 ||
              filetype.compare("VTU") == 0)
     {
-        write_VTU(filename, this->verts, this->p2v);
+        if(this->polys_are_labeled())
+        {
+            write_VTU(filename, this->verts, this->p2v, std::vector<int>(), this->vector_poly_labels());
+        }
+        else write_VTU(filename, this->verts, this->p2v);
     }
     else if (filetype.compare("vtk") == 0 ||
              filetype.compare("VTK") == 0)
     {
-        write_VTK(filename, this->verts, this->p2v);
+        if(this->polys_are_labeled())
+        {
+            write_VTK(filename, this->verts, this->p2v, std::vector<int>(), this->vector_poly_labels());
+        }
+        else write_VTK(filename, this->verts, this->p2v);
     }
     else if (filetype.compare("hedra") == 0 ||
              filetype.compare("HEDRA") == 0)
@@ -0,0 +1,118 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/meshes/packed_adjacency.h>
+#include <cinolib/parallel_for.h>
+#include <algorithm>
+
+namespace cinolib
+{
+
+CINO_INLINE
+void PackedAdjacency::pack(const std::vector<std::vector<uint>> & lists)
+{
+    offset.resize(lists.size()+1);
+    offset.front() = 0;
+    for(uint i=0; i<lists.size(); ++i) offset.at(i+1) = offset.at(i) + uint(lists.at(i).size());
+    offset.shrink_to_fit();
+
+    index.resize(offset.back());
+    index.shrink_to_fit();
+    PARALLEL_FOR(0, uint(lists.size()), 10000, [&](const uint i)
+    {
+        std::copy(lists.at(i).begin(), lists.at(i).end(), index.begin()+offset.at(i));
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void PackedAdjacency::unpack(std::vector<std::vector<uint>> & lists) const
+{
+    lists.resize(size());
+    PARALLEL_FOR(0, size(), 10000, [&](const uint i)
+    {
+        lists.at(i).assign(index.begin()+offset.at(i), index.begin()+offset.at(i+1));
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+std::vector<uint> PackedAdjacency::serialize() const
+{
+    std::vector<uint> data;
+    data.reserve(1 + offset.size() + index.size());
+    data.push_back(size());
+    if(offset.empty()) data.push_back(0);
+    data.insert(data.end(), offset.begin(), offset.end());
+    data.insert(data.end(), index.begin(),  index.end());
+    return data;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// returns false if data is not a valid (i.e. consistent) flat representation
+CINO_INLINE
+bool PackedAdjacency::deserialize(const uint * data, const size_t size)
+{
+    if(size<2 || size_t(data[0])+2>size) return false;
+    const uint * off = data+1;
+    const size_t n   = data[0];
+    if(off[0]!=0 || size_t(off[n])!=size-n-2) return false;
+    for(size_t i=0; i<n; ++i) if(off[i]>off[i+1]) return false;
+    offset.assign(off, off+n+1);
+    index.assign(off+n+1, data+size);
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool PackedAdjacency::ids_below(const uint n) const
+{
+    return std::all_of(index.begin(), index.end(), [n](const uint id){ return id<n; });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void PackedAdjacency::clear()
+{
+    std::vector<uint>().swap(offset);
+    std::vector<uint>().swap(index);
+}
+
+}
@@ -0,0 +1,102 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_PACKED_ADJACENCY_H
+#define CINO_PACKED_ADJACENCY_H
+
+#include <vector>
+#include <sys/types.h>
+#include <cinolib/cino_inline.h>
+#include <cinolib/span.h>
+
+namespace cinolib
+{
+
+/* Compressed Sparse Row (CSR) storage for a list of lists of indices.
+ * All lists are stored back to back in a single array (index), and
+ * offset[i] tells where the i-th list begins. Compared to a vector of
+ * vectors this saves one heap allocation and 24 bytes of header per
+ * list, and keeps all data contiguous in memory. It is used by meshes
+ * to store adjacency relations in frozen (i.e. read-only) mode.
+*/
+
+class PackedAdjacency
+{
+    public:
+
+        explicit PackedAdjacency() {}
+        explicit PackedAdjacency(const std::vector<std::vector<uint>> & lists) { pack(lists); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void pack  (const std::vector<std::vector<uint>> & lists);
+        void unpack(std::vector<std::vector<uint>> & lists) const;
+        void clear ();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // flat representation for binary IO: [#lists, offset, index]
+        std::vector<uint> serialize  () const;
+        bool              deserialize(const uint * data, const size_t size);
+
+        // true if all the indices are smaller than n (used to validate deserialized data)
+        bool ids_below(const uint n) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint   size()        const { return offset.empty() ? 0 : uint(offset.size()-1); }
+        size_t memory_size() const { return (offset.capacity() + index.capacity())*sizeof(uint); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        Span<uint> operator()(const uint i) const
+        {
+            uint beg = offset.at(i);
+            return Span<uint>(index.data()+beg, offset.at(i+1)-beg);
+        }
+
+    private:
+
+        std::vector<uint> offset;
+        std::vector<uint> index;
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "packed_adjacency.cpp"
+#endif
+
+#endif // CINO_PACKED_ADJACENCY_H
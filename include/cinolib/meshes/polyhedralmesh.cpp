@@ -89,8 +89,13 @@ void Polyhedralmesh<M,V,E,F,P>::load(const char * filename)
     std::string str(filename);
     std::string filetype = "." + get_file_extension(str);
 
-    if (filetype.compare(".hybrid") == 0 ||
-        filetype.compare(".HYBRID") == 0)
+    if (filetype.compare(".cinobin") == 0)
+    {
+        this->load_CINOBIN(filename);
+        return;
+    }
+    else if (filetype.compare(".hybrid") == 0 ||
+             filetype.compare(".HYBRID") == 0)
     {
         read_HYBDRID(filename, tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding);
         this->init(tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding);
@@ -110,14 +115,30 @@ void Polyhedralmesh<M,V,E,F,P>::load(const char * filename)
     else if (filetype.compare(".vtu") == 0 ||
              filetype.compare(".VTU") == 0)
     {
-        read_VTU(filename, tmp_verts, tmp_polys);
-        this->init(tmp_verts, tmp_polys, vert_labels, poly_labels);
+        read_VTU(filename, tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding, vert_labels, poly_labels);
+        this->init(tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding);
+        if(vert_labels.size()==this->num_verts())
+        {
+            for(uint vid=0; vid<this->num_verts(); ++vid) this->vert_data(vid).label = vert_labels.at(vid);
+        }
+        if(poly_labels.size()==this->num_polys())
+        {
+            for(uint pid=0; pid<this->num_polys(); ++pid) this->poly_data(pid).label = poly_labels.at(pid);
+        }
     }
     else if (filetype.compare(".vtk") == 0 ||
              filetype.compare(".VTK") == 0)
     {
-        read_VTK(filename, tmp_verts, tmp_polys);
-        this->init(tmp_verts, tmp_polys, vert_labels, poly_labels);
+        read_VTK(filename, tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding, vert_labels, poly_labels);
+        this->init(tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding);
+        if(vert_labels.size()==this->num_verts())
+        {
+            for(uint vid=0; vid<this->num_verts(); ++vid) this->vert_data(vid).label = vert_labels.at(vid);
+        }
+        if(poly_labels.size()==this->num_polys())
+        {
+            for(uint pid=0; pid<this->num_polys(); ++pid) this->poly_data(pid).label = poly_labels.at(pid);
+        }
     }
     else
     {
@@ -134,8 +155,12 @@ void Polyhedralmesh<M,V,E,F,P>::save(const char * filename) const
     std::string str(filename);
     std::string filetype = get_file_extension(str);
 
-    if (filetype.compare("mesh") == 0 ||
-        filetype.compare("MESH") == 0)
+    if (filetype.compare("cinobin") == 0)
+    {
+        this->save_CINOBIN(filename);
+    }
+    else if (filetype.compare("mesh") == 0 ||
+             filetype.compare("MESH") == 0)
     {
         if(this->polys_are_labeled())
         {
@@ -153,6 +178,20 @@ void Polyhedralmesh<M,V,E,F,P>::save(const char * filename) const
     {
         write_OVM(filename, *this);
     }
+    else if(filetype.compare("vtu") == 0 ||
+            filetype.compare("VTU") == 0)
+    {
+        std::vector<int> poly_labels;
+        if(this->polys_are_labeled()) poly_labels = this->vector_poly_labels();
+        write_VTU(filename, this->verts, this->faces, this->polys, this->polys_face_winding, std::vector<int>(), poly_labels);
+    }
+    else if(filetype.compare("vtk") == 0 ||
+            filetype.compare("VTK") == 0)
+    {
+        std::vector<int> poly_labels;
+        if(this->polys_are_labeled()) poly_labels = this->vector_poly_labels();
+        write_VTK(filename, this->verts, this->faces, this->polys, this->polys_face_winding, std::vector<int>(), poly_labels);
+    }
     else
     {
         std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : write() : file format not supported yet " << std::endl;
@@ -102,20 +102,25 @@ void Tetmesh<M,V,E,F,P>::load(const char * filename)
     std::string str(filename);
     std::string filetype = "." + get_file_extension(str);
 
-    if (filetype.compare(".mesh") == 0 ||
-        filetype.compare(".MESH") == 0)
+    if (filetype.compare(".cinobin") == 0)
+    {
+        this->load_CINOBIN(filename);
+        return;
+    }
+    else if (filetype.compare(".mesh") == 0 ||
+             filetype.compare(".MESH") == 0)
     {
         read_MESH(filename, tmp_verts, tmp_polys, vert_labels, poly_labels);
     }
     else if (filetype.compare(".vtu") == 0 ||
              filetype.compare(".VTU") == 0)
     {
-        read_VTU(filename, tmp_verts, tmp_polys);
+        read_VTU(filename, tmp_verts, tmp_polys, vert_labels, poly_labels);
     }
     else if (filetype.compare(".vtk") == 0 ||
              filetype.compare(".VTK") == 0)
     {
-        read_VTK(filename, tmp_verts, tmp_polys);
+        read_VTK(filename, tmp_verts, tmp_polys, vert_labels, poly_labels);
     }
     else if (filetype.compare(".tet") == 0 ||
              filetype.compare(".TET") == 0)
@@ -139,8 +144,12 @@ void Tetmesh<M,V,E,F,P>::save(const char * filename) const
     std::string str(filename);
     std::string filetype = get_file_extension(str);
 
-    if (filetype.compare("mesh") == 0 ||
-        filetype.compare("MESH") == 0)
+    if (filetype.compare("cinobin") == 0)
+    {
+        this->save_CINOBIN(filename);
+    }
+    else if (filetype.compare("mesh") == 0 ||
+             filetype.compare("MESH") == 0)
     {
         if(this->polys_are_labeled())
         {
@@ -156,12 +165,20 @@ void Tetmesh<M,V,E,F,P>::save(const char * filename) const
     else if (filetype.compare("vtu") == 0 ||
              filetype.compare("VTU") == 0)
     {
-        write_VTU(filename, this->verts, this->p2v);
+        if(this->polys_are_labeled())
+        {
+            write_VTU(filename, this->verts, this->p2v, std::vector<int>(), this->vector_poly_labels());
+        }
+        else write_VTU(filename, this->verts, this->p2v);
     }
     else if (filetype.compare("vtk") == 0 ||
              filetype.compare("VTK") == 0)
     {
-        write_VTK(filename, this->verts, this->p2v);
+        if(this->polys_are_labeled())
+        {
+            write_VTK(filename, this->verts, this->p2v, std::vector<int>(), this->vector_poly_labels());
+        }
+        else write_VTK(filename, this->verts, this->p2v);
     }
     else if (filetype.compare("hedra") == 0 ||
              filetype.compare("HEDRA") == 0)
@@ -214,6 +231,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::edge_split(const uint eid, const double lambda)
 {
+    this->unfreeze_connectivity();
+
     return edge_split(eid, this->edge_sample_at(eid,lambda));
 }
 
@@ -223,6 +242,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::edge_split(const uint eid, const uint split_point)
 {
+    this->unfreeze_connectivity();
+
     assert(this->edge_valence(eid)>0);
     // create sub-elements
     for(uint pid : this->adj_e2p(eid))
@@ -239,6 +260,7 @@ uint Tetmesh<M,V,E,F,P>::edge_split(const uint eid, const uint split_point)
             if(this->poly_face_is_CCW(pid,fid)) std::swap(tet[1],tet[2]);
             uint new_pid = this->poly_add(tet);
             this->poly_data(new_pid) = this->poly_data(pid);
+            this->update_p_quality(new_pid);
         }
     }
 
@@ -256,12 +278,19 @@ uint Tetmesh<M,V,E,F,P>::edge_split(const uint eid, const uint split_point)
          int f1   = this->face_id({vid1,split_point,vopp}); assert(f1>=0);
          this->face_data(f0) = this->face_data(fid);
          this->face_data(f1) = this->face_data(fid);
+         this->update_f_normal(f0); // restore the normals overwritten by the copy
+         this->update_f_normal(f1);
     }
 
-    if(this->mesh_data().update_normals && this->vert_is_on_srf(split_point)) this->update_v_normal(split_point);
-
     // remove old edge and all elements attached to it
     this->edge_remove(eid);
+
+    // the umbrellas of split_point and of the verts around it have changed
+    if(this->mesh_data().update_normals)
+    {
+        if(this->vert_is_on_srf(split_point)) this->update_v_normal(split_point);
+        for(uint vid : this->adj_v2v(split_point)) if(this->vert_is_on_srf(vid)) this->update_v_normal(vid);
+    }
     return split_point;
 }
 
@@ -271,6 +300,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::edge_split(const uint eid, const vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     assert(this->edge_valence(eid)>0);
     uint split_point = this->vert_add(p);
     return edge_split(eid,split_point);
@@ -392,6 +423,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 int Tetmesh<M,V,E,F,P>::edge_collapse(const uint eid, const double lambda, const double topologic_check, const double geometric_check)
 {
+    this->unfreeze_connectivity();
+
     vec3d p = this->edge_sample_at(eid, lambda);
     return edge_collapse(eid, p, topologic_check, geometric_check);
 }
@@ -402,6 +435,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 int Tetmesh<M,V,E,F,P>::edge_collapse(const uint eid, const vec3d & p, const double topologic_check, const double geometric_check)
 {
+    this->unfreeze_connectivity();
+
     if(topologic_check && !edge_is_topologically_collapsible(eid))    return -1;
     if(geometric_check && !edge_is_geometrically_collapsible(eid, p)) return -1;
 
@@ -423,22 +458,19 @@ int Tetmesh<M,V,E,F,P>::edge_collapse(const uint eid, const vec3d & p, const dou
         vlist.at(off) = vert_to_keep;
         uint new_pid = this->poly_add(vlist);
         this->poly_data(new_pid) = this->poly_data(pid);
-
-        if(this->mesh_data().update_normals)
-        {
-            for(uint fid: this->adj_p2f(pid))
-            {
-                if(this->face_is_on_srf(fid)) this->update_f_normal(fid);
-            }
-        }
-    }
-    if(this->mesh_data().update_normals && this->vert_is_on_srf(vert_to_keep))
-    {
-        this->update_v_normal(vert_to_keep);
     }
 
     this->vert_remove(vert_to_remove);
 
+    // vert_to_keep has moved: refresh the elements around it
+    for(uint pid : this->adj_v2p(vert_to_keep)) this->update_p_quality(pid);
+    if(this->mesh_data().update_normals)
+    {
+        for(uint fid : this->adj_v2f(vert_to_keep)) this->update_f_normal(fid);
+        if(this->vert_is_on_srf(vert_to_keep)) this->update_v_normal(vert_to_keep);
+        for(uint nbr : this->adj_v2v(vert_to_keep)) if(this->vert_is_on_srf(nbr)) this->update_v_normal(nbr);
+    }
+
     if(topologic_check)
     {
 #ifndef NDEBUG
@@ -613,6 +645,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::face_split(const uint fid, const vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     uint new_vid = this->vert_add(p);
 
     for(uint pid : this->adj_f2p(fid))
@@ -631,6 +665,7 @@ uint Tetmesh<M,V,E,F,P>::face_split(const uint fid, const vec3d & p)
             if(flip_face) std::swap(tet[1],tet[2]);
             uint new_pid = this->poly_add(tet);
             this->poly_data(new_pid) = this->poly_data(pid);
+            this->update_p_quality(new_pid);
         }
     }
 
@@ -674,6 +709,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::vert_split(const uint vid, const std::vector<uint> & f_umbrella)
 {
+    this->unfreeze_connectivity();
+
     vec3d p(inf_double,inf_double,inf_double);
     return vert_split(vid,f_umbrella,p);
 }
@@ -684,6 +721,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::vert_split(const uint vid, const std::vector<uint> & f_umbrella, vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     // reset local flags for faces and tets
     for(uint pid : this->adj_v2p(vid)) this->poly_data(pid).flags[MARKED_LOCAL] = false;
     for(uint fid : this->adj_v2f(vid)) this->face_data(fid).flags[MARKED_LOCAL] = false;
@@ -867,6 +906,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void Tetmesh<M,V,E,F,P>::polys_split(const std::vector<uint> & pids)
 {
+    this->unfreeze_connectivity();
+
     // in order to avoid id conflicts split all the
     // polys starting from the one with highest id
     //
@@ -880,6 +921,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::poly_split(const uint pid, const std::vector<double> & bc)
 {
+    this->unfreeze_connectivity();
+
     assert(bc.size()==4);
 
     vec3d p = this->poly_vert(pid,0) * bc.at(0) +
@@ -896,6 +939,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::poly_split(const uint pid, const vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     uint vid = this->vert_add(p);
     return this->poly_split(pid,vid);
 }
@@ -906,6 +951,8 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint Tetmesh<M,V,E,F,P>::poly_split(const uint pid, const uint vid)
 {
+    this->unfreeze_connectivity();
+
     assert(this->vert_valence(vid)==0);
     for(uint fid : this->adj_p2f(pid))
     {        
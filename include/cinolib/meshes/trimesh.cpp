@@ -100,6 +100,11 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void Trimesh<M,V,E,P>::update_p_normal(const uint pid)
 {
+    if(this->in_batch())
+    {
+        this->dirty_polys.push_back(pid);
+        return;
+    }
     this->poly_data(pid).normal = triangle_normal(this->poly_vert(pid,0),
                                                   this->poly_vert(pid,1),
                                                   this->poly_vert(pid,2));
@@ -195,8 +200,9 @@ bool Trimesh<M,V,E,P>::edge_is_geometrically_collapsible(const uint eid, const d
         }
         // avoid tiny triangles
         if(triangle_area(v[0], v[1], v[2]) < 1e-10) return false;
-        // avoid flips and collapses
-        if(triangle_normal(v[0], v[1], v[2]).dot(this->poly_data(pid).normal) <= 0) return false;
+        // avoid flips and collapses (normals are computed on the fly, as cached ones may be stale inside a batch)
+        vec3d n = triangle_normal(this->poly_vert(pid,0), this->poly_vert(pid,1), this->poly_vert(pid,2));
+        if(triangle_normal(v[0], v[1], v[2]).dot(n) <= 0) return false;
     }
 
     return true;
@@ -207,7 +213,9 @@ bool Trimesh<M,V,E,P>::edge_is_geometrically_collapsible(const uint eid, const d
 template<class M, class V, class E, class P>
 CINO_INLINE
 uint Trimesh<M,V,E,P>::vert_split(const uint eid0, const uint eid1)
-{    
+{
+    this->unfreeze_connectivity();
+
     uint v0 = this->vert_shared(eid0, eid1);
     uint v1 = this->vert_add(vec3d(0,0,0));
 
@@ -277,6 +285,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 int Trimesh<M,V,E,P>::edge_collapse(const uint eid, const double lambda, const bool topologic_check, const bool geometric_check)
 {
+    this->unfreeze_connectivity();
+
     if(topologic_check && !edge_is_topologically_collapsible(eid))         return -1;
     if(geometric_check && !edge_is_geometrically_collapsible(eid, lambda)) return -1;
 
@@ -300,12 +310,18 @@ int Trimesh<M,V,E,P>::edge_collapse(const uint eid, const double lambda, const b
         uint new_pid = this->poly_add(vlist);
 
         this->poly_data(new_pid) = this->poly_data(pid);
-        if(this->mesh_data().update_normals) this->update_p_normal(new_pid);
     }
-    if(this->mesh_data().update_normals) this->update_v_normal(vert_to_keep);
 
     this->vert_remove(vert_to_remove);
 
+    // vert_to_keep has moved: refresh the elements around it
+    if(this->mesh_data().update_normals)
+    {
+        for(uint pid : this->adj_v2p(vert_to_keep)) this->update_p_normal(pid);
+        for(uint nbr : this->adj_v2v(vert_to_keep)) this->update_v_normal(nbr);
+        this->update_v_normal(vert_to_keep);
+    }
+
     if(topologic_check)
     {
 #ifndef NDEBUG
@@ -322,6 +338,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint Trimesh<M,V,E,P>::edge_split(const uint eid, const double lambda)
 {
+    this->unfreeze_connectivity();
+
     vec3d split_point = this->edge_sample_at(eid,lambda);
     uint  v_split     = this->vert_add(split_point);
     return edge_split(eid,v_split);
@@ -333,6 +351,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint Trimesh<M,V,E,P>::edge_split(const uint eid, const vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     uint v_split = this->vert_add(p);
     return edge_split(eid,v_split);
 }
@@ -343,6 +363,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint Trimesh<M,V,E,P>::edge_split(const uint eid, const uint v_split)
 {
+    this->unfreeze_connectivity();
+
     uint vid0 = this->edge_vert_id(eid,0);
     uint vid1 = this->edge_vert_id(eid,1);
 
@@ -366,6 +388,12 @@ uint Trimesh<M,V,E,P>::edge_split(const uint eid, const uint v_split)
     this->edge_data(eid1) = this->edge_data(eid);
 
     this->polys_remove(this->adj_e2p(eid));
+
+    // the umbrellas of all the verts around v_split have changed
+    if(this->mesh_data().update_normals)
+    {
+        for(uint vid : this->adj_v2v(v_split)) this->update_v_normal(vid);
+    }
     return v_split;
 }
 
@@ -387,8 +415,8 @@ bool Trimesh<M,V,E,P>::edge_is_flippable(const uint eid)
     uint  opp0 = this->vert_opposite_to(pid0,vid0,vid1);
     uint  opp1 = this->vert_opposite_to(pid1,vid0,vid1);
     if(!this->poly_verts_are_CCW(pid0, vid1, vid0)) std::swap(vid0,vid1);
-    vec3d n0   = this->poly_data(pid0).normal;
-    vec3d n1   = this->poly_data(pid1).normal;
+    vec3d n0   = triangle_normal(this->poly_vert(pid0,0),this->poly_vert(pid0,1),this->poly_vert(pid0,2)); // not the cached normals,
+    vec3d n1   = triangle_normal(this->poly_vert(pid1,0),this->poly_vert(pid1,1),this->poly_vert(pid1,2)); // which may be stale inside a batch
     if(triangle_area(this->vert(opp0),this->vert(vid0),this->vert(opp1))<1e-5) return false;
     if(triangle_area(this->vert(opp1),this->vert(vid1),this->vert(opp0))<1e-5) return false;
     vec3d n2   = triangle_normal(this->vert(opp0),this->vert(vid0),this->vert(opp1));
@@ -434,6 +462,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 int Trimesh<M,V,E,P>::edge_flip(const uint eid, const bool geometric_check)
 {
+    this->unfreeze_connectivity();
+
     if(geometric_check && !edge_is_flippable(eid)) return -1;
 
     assert(this->adj_e2p(eid).size()==2);
@@ -451,6 +481,11 @@ int Trimesh<M,V,E,P>::edge_flip(const uint eid, const bool geometric_check)
 
     this->edge_remove(eid);
 
+    if(this->mesh_data().update_normals)
+    {
+        for(uint vid : {vid0, vid1, opp0, opp1}) this->update_v_normal(vid);
+    }
+
     // copy edge data
     int new_eid = this->edge_id(opp0,opp1); assert(new_eid>=0);
     this->edge_data(new_eid) = this->edge_data(eid);
@@ -497,6 +532,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint Trimesh<M,V,E,P>::poly_split(const uint pid)
 {
+    this->unfreeze_connectivity();
+
     // uses centroid as default split point
     return this->poly_split(pid, this->poly_centroid(pid));
 }
@@ -507,6 +544,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint Trimesh<M,V,E,P>::poly_split(const uint pid, const vec3d & p)
 {
+    this->unfreeze_connectivity();
+
     uint vids[4] =
     {
         this->poly_vert_id(pid, 0),
@@ -572,6 +611,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint Trimesh<M,V,E,P>::poly_add(const uint vid0, const uint vid1, const uint vid2)
 {
+    this->unfreeze_connectivity();
+
     std::vector<uint> p = { vid0, vid1, vid2 };
     return this->poly_add(p);
 }
@@ -36,33 +36,13 @@
 #include <cinolib/octree.h>
 #include <cinolib/how_many_seconds.h>
 #include <cinolib/parallel_for.h>
-#include <cinolib/geometry/point.h>
-#include <cinolib/geometry/sphere.h>
-#include <cinolib/geometry/segment.h>
-#include <cinolib/geometry/triangle.h>
-#include <cinolib/geometry/tetrahedron.h>
+#include <cstdint>
+#include <numeric>
 #include <stack>
 
 namespace cinolib
 {
 
-CINO_INLINE
-OctreeNode::~OctreeNode()
-{
-    // "in a tree's node destructor, you only need to destroy the children pointers that are manually
-    //  allocated by you. You don't need to worry about the deallocation of the node itself."
-    //  https://stackoverflow.com/questions/34170164/destructor-for-binary-search-tree
-    for(int i=0; i<8; ++i)
-    {
-        if(children[i]!=nullptr)
-        {
-            delete children[i];
-        }
-    }
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
 CINO_INLINE
 Octree::Octree(const uint max_depth,
                const uint items_per_leaf)
@@ -72,22 +52,6 @@ Octree::Octree(const uint max_depth,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-CINO_INLINE
-Octree::~Octree()
-{
-    // delete Octree
-    if(root!=nullptr) delete root;
-
-    // delete item list
-    while(!items.empty())
-    {
-        delete items.back();
-        items.pop_back();
-    }
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
 CINO_INLINE
 void Octree::build()
 {
@@ -95,82 +59,176 @@ void Octree::build()
     Time::time_point t0 = Time::now();
 
     if(items.empty()) return;
-
-    // initialize root with all items, also updating its AABB
-    assert(root==nullptr);
-    root = new OctreeNode(AABB());
-    root->item_indices.resize(items.size());
-    std::iota(root->item_indices.begin(),root->item_indices.end(),0);
-    for(auto it : items) root->bbox.push(it->aabb);
-
-    root->bbox.scale(1.5); // enlarge bbox to account for queries outside legal area.
-                           // this should disappear eventually....
-
-    if(root->item_indices.size()<items_per_leaf || max_depth==1)
+    assert(nodes.empty());
+
+    // fit the root to the items
+    AABB root_bbox = PARALLEL_REDUCE(0, num_items(), 1000, AABB(),
+                                     [&](uint i) -> const AABB & { return item(i).aabb; },
+                                     [](AABB a, const AABB & b){ a.push(b); return a; });
+
+    root_bbox.scale(1.5); // enlarge bbox to account for queries outside legal area.
+                          // this should disappear eventually....
+    nodes.push_back(OctreeNode(root_bbox));
+    tree_depth = 1;
+
+    // The tree is built one level at a time. The nodes that must be split at the
+    // current level (frontier) store their items in a flat buffer, and each
+    // level is processed in parallel, splitting the buffer in chunks of items
+    // that belong to the same node. Items are distributed to the children in
+    // order, hence leaves list their items by increasing index
+    struct Chunk
     {
-        leaves.push_back(root);
-        tree_depth = 1;
+        uint node; // position of the node in the frontier
+        uint beg;
+        uint end;
+    };
+    const uint chunk_size = 1024;
+    const uint LEAF       = 0xFFFFFFFF;
+
+    std::vector<uint> frontier; // nodes to be split
+    std::vector<uint> buf;      // items of the frontier nodes
+    std::vector<uint> off;      // items of frontier[i] are in buf[off[i]..off[i+1])
+
+    if(items.size()<items_per_leaf || max_depth==1)
+    {
+        leaf_items.resize(items.size());
+        std::iota(leaf_items.begin(), leaf_items.end(), 0);
+        nodes.front().end = num_items();
+        leaves.push_back(0);
     }
     else
     {
-        subdivide(root);
+        frontier.push_back(0);
+        buf.resize(items.size());
+        std::iota(buf.begin(), buf.end(), 0);
+        off = { 0, num_items() };
+    }
+
+    while(!frontier.empty())
+    {
+        ++tree_depth; // depth of the children being created
+        uint n_front = uint(frontier.size());
+        uint first   = uint(nodes.size());
+        nodes.resize(first + 8*n_front);
 
-        if(max_depth==2)
+        // create children octants
+        PARALLEL_FOR(0, n_front, 1000, [&](uint i)
         {
-            tree_depth = 2;
-            for(int i=0; i<8; ++i) leaves.push_back(root->children[i]);
+            OctreeNode & node = nodes[frontier[i]];
+            node.first_child = first + 8*i;
+            vec3d min = node.bbox.min;
+            vec3d max = node.bbox.max;
+            vec3d avg = node.bbox.center();
+            nodes[node.child(0)].bbox = AABB(vec3d(min[0], min[1], min[2]), vec3d(avg[0], avg[1], avg[2]));
+            nodes[node.child(1)].bbox = AABB(vec3d(avg[0], min[1], min[2]), vec3d(max[0], avg[1], avg[2]));
+            nodes[node.child(2)].bbox = AABB(vec3d(avg[0], avg[1], min[2]), vec3d(max[0], max[1], avg[2]));
+            nodes[node.child(3)].bbox = AABB(vec3d(min[0], avg[1], min[2]), vec3d(avg[0], max[1], avg[2]));
+            nodes[node.child(4)].bbox = AABB(vec3d(min[0], min[1], avg[2]), vec3d(avg[0], avg[1], max[2]));
+            nodes[node.child(5)].bbox = AABB(vec3d(avg[0], min[1], avg[2]), vec3d(max[0], avg[1], max[2]));
+            nodes[node.child(6)].bbox = AABB(vec3d(avg[0], avg[1], avg[2]), vec3d(max[0], max[1], max[2]));
+            nodes[node.child(7)].bbox = AABB(vec3d(min[0], avg[1], avg[2]), vec3d(avg[0], max[1], max[2]));
+        });
+
+        std::vector<Chunk> chunks;
+        for(uint i=0; i<n_front; ++i)
+        {
+            for(uint beg=off[i]; beg<off[i+1]; beg+=chunk_size)
+            {
+                chunks.push_back({i, beg, std::min(beg+chunk_size, off[i+1])});
+            }
         }
-        else
+        uint n_chunks = uint(chunks.size());
+
+        // find the children overlapped by each item, and count them per chunk.
+        // Items always overlap their node, hence it suffices to compare them
+        // with the splitting planes: bit c of the mask is set iff the item
+        // intersects the AABB of the c-th child
+        static const uint8_t below[3] = { 0x99, 0x33, 0x0F }; // children on the min side of x,y,z
+        std::vector<uint8_t> mask(buf.size());
+        std::vector<uint>    chunk_count(8*n_chunks,0);
+        PARALLEL_FOR(0, n_chunks, 1, [&](uint ch)
         {
-            // WORK IN PARALLEL ON EACH OCTANT
-            // To fully avoid syncrhonization between the threads global information
-            // such as vector of leaves and tree depth are duplicated, and will be
-            // merged after convergence.
-
-            uint octant_depth[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
-            std::vector<const OctreeNode*> octant_leaves[8];
-
-            std::queue<std::pair<OctreeNode*,uint>> splitlist[8]; // (node, depth)
-            for(int i=0; i<8; ++i)
+            vec3d avg   = nodes[frontier[chunks[ch].node]].bbox.center();
+            uint *count = &chunk_count[8*ch];
+            for(uint j=chunks[ch].beg; j<chunks[ch].end; ++j)
             {
-                if(root->children[i]->item_indices.size()>items_per_leaf)
+                const AABB & b = item(buf[j]).aabb;
+                uint8_t m = 0xFF;
+                for(uint d=0; d<3; ++d)
                 {
-                    splitlist[i].push(std::make_pair(root->children[i],2));
+                    if(b.min[d]>avg[d]) m &= uint8_t(~below[d]);
+                    if(b.max[d]<avg[d]) m &=         below[d];
                 }
-                else octant_leaves[i].push_back(root->children[i]);
+                assert(m!=0); // no orphans
+                for(uint c=0; c<8; ++c) if(m & (1<<c)) ++count[c];
+                mask[j] = m;
             }
+        });
 
-            PARALLEL_FOR(0,8,0,[&](uint i)
+        // turn per chunk counts into offsets relative to the beginning of each child
+        std::vector<uint> count(8*n_front,0);
+        for(uint ch=0; ch<n_chunks; ++ch)
+        {
+            for(uint c=0; c<8; ++c)
             {
-                while(!splitlist[i].empty())
-                {
-                    auto pair  = splitlist[i].front();
-                    auto node  = pair.first;
-                    uint depth = pair.second + 1;
-                    splitlist[i].pop();
+                uint & tot = count[8*chunks[ch].node+c];
+                uint   n   = chunk_count[8*ch+c];
+                chunk_count[8*ch+c] = tot;
+                tot += n;
+            }
+        }
 
-                    subdivide(node);
+        // children that are still too crowded form the next frontier, the others are leaves
+        std::vector<uint> next_frontier;
+        std::vector<uint> next_off(1,0);
+        std::vector<uint> slot(8*n_front); // position in the next frontier (or LEAF)
+        std::vector<uint> dest(8*n_front); // first position in next_buf (or leaf_items)
+        uint n_leaf_items = uint(leaf_items.size());
+        for(uint i=0; i<8*n_front; ++i)
+        {
+            uint nid = first + i;
+            if(tree_depth<max_depth && count[i]>items_per_leaf)
+            {
+                slot[i] = uint(next_frontier.size());
+                dest[i] = next_off.back();
+                next_frontier.push_back(nid);
+                next_off.push_back(next_off.back()+count[i]);
+            }
+            else
+            {
+                slot[i] = LEAF;
+                dest[i] = n_leaf_items;
+                nodes[nid].begin = n_leaf_items;
+                nodes[nid].end   = n_leaf_items + count[i];
+                n_leaf_items    += count[i];
+                leaves.push_back(nid);
+            }
+        }
 
-                    for(int j=0; j<8; ++j)
+        // distribute items to the children
+        std::vector<uint> next_buf(next_off.back());
+        leaf_items.resize(n_leaf_items);
+        PARALLEL_FOR(0, n_chunks, 1, [&](uint ch)
+        {
+            uint k0 = 8*chunks[ch].node;
+            uint pos[8];
+            for(uint c=0; c<8; ++c) pos[c] = dest[k0+c] + chunk_count[8*ch+c];
+            for(uint j=chunks[ch].beg; j<chunks[ch].end; ++j)
+            {
+                for(uint c=0; c<8; ++c)
+                {
+                    if(mask[j] & (1<<c))
                     {
-                        if(depth<max_depth && node->children[j]->item_indices.size()>items_per_leaf)
-                        {
-                            splitlist[i].push(std::make_pair(node->children[j], depth));
-                        }
-                        else octant_leaves[i].push_back(node->children[j]);
+                        if(slot[k0+c]==LEAF) leaf_items[pos[c]++] = buf[j];
+                        else                   next_buf[pos[c]++] = buf[j];
                     }
-
-                    octant_depth[i] = std::max(octant_depth[i], depth);
                 }
-            });
-
-            // global merge of octant data
-            tree_depth = *std::max_element(octant_depth, octant_depth+8);
-            for(int i=0; i<8; ++i)
-            {
-                std::copy(octant_leaves[i].begin(), octant_leaves[i].end(), std::back_inserter(leaves));
             }
-        }
+        });
+
+        frontier.swap(next_frontier);
+        buf.swap(next_buf);
+        off.swap(next_off);
     }
 
     if(print_debug_info)
@@ -192,77 +250,10 @@ void Octree::build()
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void Octree::subdivide(OctreeNode * node)
+Span<uint> Octree::node_items(const uint nid) const
 {
-    // create children octants
-    vec3d min = node->bbox.min;
-    vec3d max = node->bbox.max;
-    vec3d avg = node->bbox.center();
-    node->children[0] = new OctreeNode(AABB(vec3d(min[0], min[1], min[2]), vec3d(avg[0], avg[1], avg[2])));
-    node->children[1] = new OctreeNode(AABB(vec3d(avg[0], min[1], min[2]), vec3d(max[0], avg[1], avg[2])));
-    node->children[2] = new OctreeNode(AABB(vec3d(avg[0], avg[1], min[2]), vec3d(max[0], max[1], avg[2])));
-    node->children[3] = new OctreeNode(AABB(vec3d(min[0], avg[1], min[2]), vec3d(avg[0], max[1], avg[2])));
-    node->children[4] = new OctreeNode(AABB(vec3d(min[0], min[1], avg[2]), vec3d(avg[0], avg[1], max[2])));
-    node->children[5] = new OctreeNode(AABB(vec3d(avg[0], min[1], avg[2]), vec3d(max[0], avg[1], max[2])));
-    node->children[6] = new OctreeNode(AABB(vec3d(avg[0], avg[1], avg[2]), vec3d(max[0], max[1], max[2])));
-    node->children[7] = new OctreeNode(AABB(vec3d(min[0], avg[1], avg[2]), vec3d(avg[0], max[1], max[2])));
-
-    for(uint it : node->item_indices)
-    {
-        bool orphan = true;
-        for(int i=0; i<8; ++i)
-        {
-            assert(node->children[i]!=nullptr);
-            if(node->children[i]->bbox.intersects_box(items.at(it)->aabb))
-            {
-                node->children[i]->item_indices.push_back(it);
-                orphan = false;
-            }
-        }
-        assert(!orphan);
-    }
-
-    node->item_indices.clear();
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-CINO_INLINE
-void Octree::push_point(const uint id, const vec3d & v)
-{
-    items.push_back(new Point(id,v));
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-CINO_INLINE
-void Octree::push_sphere(const uint id, const vec3d & c, const double r)
-{
-    items.push_back(new Sphere(id,c,r));
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-CINO_INLINE
-void Octree::push_segment(const uint id, const vec3d & v0, const vec3d & v1)
-{
-    items.push_back(new Segment(id,v0,v1));
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-CINO_INLINE
-void Octree::push_triangle(const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2)
-{
-    items.push_back(new Triangle(id,v0,v1,v2));
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-CINO_INLINE
-void Octree::push_tetrahedron(const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2, const vec3d & v3)
-{
-    items.push_back(new Tetrahedron(id,v0,v1,v2,v3));
+    const OctreeNode & node = nodes.at(nid);
+    return Span<uint>(leaf_items.data()+node.begin, node.num_items());
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -271,20 +262,12 @@ CINO_INLINE
 uint Octree::max_items_per_leaf() const
 {
     uint max=0;
-    for(auto l : leaves) max = std::max(max,(uint)l->item_indices.size());
+    for(uint nid : leaves) max = std::max(max,nodes.at(nid).num_items());
     return max;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-CINO_INLINE
-void Octree::debug_mode(const bool b)
-{
-    print_debug_info = b;
-}
-
-//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
 CINO_INLINE
 vec3d Octree::closest_point(const vec3d & p) const
 {
@@ -298,63 +281,58 @@ vec3d Octree::closest_point(const vec3d & p) const
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 // https://stackoverflow.com/questions/41306122/nearest-neighbor-search-in-octree
+// Branch and bound: nodes are visited in order of distance from their AABB, and
+// discarded as soon as they are farther than the closest item found so far. The
+// same bound is used to skip items without computing their closest point
 CINO_INLINE
 void Octree::closest_point(const vec3d  & p,          // query point
                                  uint   & id,         // id of the item T closest to p
                                  vec3d  & pos,        // point in T closest to p
                                  double & dist) const // distance between pos and p
 {
-    assert(root != nullptr);
+    assert(!nodes.empty());
 
     typedef std::chrono::steady_clock Time;
     Time::time_point t0 = Time::now();
 
+    int    best_index = -1;
+    double best_dist  = inf_double;
+    vec3d  best_pos;
+
     PrioQueue q;
-    if(root->is_inner())
-    {
-        Obj obj;
-        obj.node = root;
-        obj.dist = root->bbox.dist_sqrd(p);
-        q.push(obj);
-    }
-    else // in case the root is alrady a leaf...
-    {
-        for(uint index : root->item_indices)
-        {
-            Obj obj;
-            obj.node  = root;
-            obj.index = index;
-            obj.pos   = items.at(index)->point_closest_to(p);
-            obj.dist  = obj.pos.dist_sqrd(p);
-            q.push(obj);
-        }
-    }
+    Obj root;
+    root.node = 0;
+    root.dist = nodes.front().bbox.dist_sqrd(p);
+    q.push(root);
 
-    while(q.top().node->is_inner())
+    while(!q.empty() && q.top().dist<best_dist)
     {
-        Obj obj = q.top();
+        const OctreeNode & node = nodes[q.top().node];
         q.pop();
 
-        for(int i=0; i<8; ++i)
+        if(node.is_inner())
         {
-            OctreeNode *child = obj.node->children[i];
-            if(child->is_inner())
+            for(uint i=0; i<8; ++i)
             {
                 Obj obj;
-                obj.node = child;
-                obj.dist = child->bbox.dist_sqrd(p);
-                q.push(obj);
+                obj.node = node.child(i);
+                obj.dist = nodes[obj.node].bbox.dist_sqrd(p);
+                if(obj.dist<best_dist) q.push(obj);
             }
-            else
+        }
+        else
+        {
+            for(uint i=node.begin; i<node.end; ++i)
             {
-                for(uint index : child->item_indices)
+                uint index = leaf_items[i];
+                if(item(index).aabb.dist_sqrd(p)>=best_dist) continue;
+                vec3d  pos = item_point_closest_to(index, p);
+                double d   = pos.dist_sqrd(p);
+                if(d<best_dist)
                 {
-                    Obj obj;
-                    obj.node  = child;
-                    obj.index = index;
-                    obj.pos   = items.at(index)->point_closest_to(p);
-                    obj.dist  = obj.pos.dist_sqrd(p);
-                    q.push(obj);
+                    best_index = int(index);
+                    best_dist  = d;
+                    best_pos   = pos;
                 }
             }
         }
@@ -366,10 +344,10 @@ void Octree::closest_point(const vec3d  & p,          // query point
         std::cout << "Closest point\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
     }
 
-    assert(q.top().index>=0);
-    id   = items.at(q.top().index)->id;
-    pos  = q.top().pos;
-    dist = q.top().dist;
+    assert(best_index>=0);
+    id   = item(best_index).id;
+    pos  = best_pos;
+    dist = best_dist;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -381,32 +359,32 @@ bool Octree::contains(const vec3d & p, const bool strict, uint & id) const
     typedef std::chrono::steady_clock Time;
     Time::time_point t0 = Time::now();
 
-    std::stack<OctreeNode*> lifo;
-    if(root && root->bbox.contains(p,strict))
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.contains(p,strict))
     {
-        lifo.push(root);
+        lifo.push(0);
     }
 
     while(!lifo.empty())
     {
-        OctreeNode *node = lifo.top();
+        const OctreeNode & node = nodes[lifo.top()];
         lifo.pop();
-        assert(node->bbox.contains(p, strict));
+        assert(node.bbox.contains(p, strict));
 
-        if(node->is_inner())
+        if(node.is_inner())
         {
-            for(int i=0; i<8; ++i)
+            for(uint i=0; i<8; ++i)
             {
-                if(node->children[i]->bbox.contains(p,strict)) lifo.push(node->children[i]);
+                if(nodes[node.child(i)].bbox.contains(p,strict)) lifo.push(node.child(i));
             }
         }
         else
         {
-            for(uint i : node->item_indices)
+            for(uint i=node.begin; i<node.end; ++i)
             {
-                if(items.at(i)->contains(p,strict))
+                if(item_contains(leaf_items[i],p,strict))
                 {
-                    id = items.at(i)->id;
+                    id = item(leaf_items[i]).id;
                     if(print_debug_info)
                     {
                         Time::time_point t1 = Time::now();
@@ -430,32 +408,32 @@ bool Octree::contains(const vec3d & p, const bool strict, std::unordered_set<uin
     typedef std::chrono::steady_clock Time;
     Time::time_point t0 = Time::now();
 
-    std::stack<OctreeNode*> lifo;
-    if(root && root->bbox.contains(p,strict))
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.contains(p,strict))
     {
-        lifo.push(root);
+        lifo.push(0);
     }
 
     while(!lifo.empty())
     {
-        OctreeNode *node = lifo.top();
+        const OctreeNode & node = nodes[lifo.top()];
         lifo.pop();
-        assert(node->bbox.contains(p,strict));
+        assert(node.bbox.contains(p,strict));
 
-        if(node->is_inner())
+        if(node.is_inner())
         {
-            for(int i=0; i<8; ++i)
+            for(uint i=0; i<8; ++i)
             {
-                if(node->children[i]->bbox.contains(p,strict)) lifo.push(node->children[i]);
+                if(nodes[node.child(i)].bbox.contains(p,strict)) lifo.push(node.child(i));
             }
         }
         else
         {
-            for(uint i : node->item_indices)
+            for(uint i=node.begin; i<node.end; ++i)
             {
-                if(items.at(i)->contains(p,strict))
+                if(item_contains(leaf_items[i],p,strict))
                 {
-                    ids.insert(items.at(i)->id);
+                    ids.insert(item(leaf_items[i]).id);
                 }
             }
         }
@@ -472,56 +450,15 @@ bool Octree::contains(const vec3d & p, const bool strict, std::unordered_set<uin
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// same strategy of closest_point: leaves enter the queue with the entry point of the ray
+// in their AABB, and their items are tested only when they reach the top of the queue
 CINO_INLINE
 bool Octree::intersects_ray(const vec3d & p, const vec3d & dir, double & min_t, uint & id) const
 {
     typedef std::chrono::steady_clock Time;
     Time::time_point t0 = Time::now();
 
-    vec3d  pos;
-    double t=0.0;
-    if(root && !root->bbox.intersects_ray(p, dir, t, pos)) return false;
-    Obj obj;
-    obj.node = root;
-    obj.dist = t;
-
-    PrioQueue q;
-    q.push(obj);
-
-    while(!q.empty() && q.top().node->is_inner())
-    {
-        Obj obj = q.top();
-        q.pop();
-
-        for(int i=0; i<8; ++i)
-        {
-            OctreeNode *child = obj.node->children[i];
-            if(child->bbox.intersects_ray(p, dir, t, pos))
-            {
-                if(child->is_inner())
-                {
-                    Obj obj;
-                    obj.node = child;
-                    obj.dist = t;
-                    q.push(obj);
-                }
-                else
-                {
-                    for(uint i : child->item_indices)
-                    {
-                        if(items.at(i)->intersects_ray(p, dir, t, pos))
-                        {
-                            Obj obj;
-                            obj.node  = child;
-                            obj.index = items.at(i)->id;
-                            obj.dist  = t;
-                            q.push(obj);
-                        }
-                    }
-                }
-            }
-        }
-    }
+    int index = first_hit(p, dir, -1, min_t);
 
     if(print_debug_info)
     {
@@ -529,10 +466,8 @@ bool Octree::intersects_ray(const vec3d & p, const vec3d & dir, double & min_t,
         std::cout << "Intersects ray\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
     }
 
-    if(q.empty()) return false;
-    assert(q.top().index>=0);
-    id    = items.at(q.top().index)->id;
-    min_t = q.top().dist;
+    if(index<0) return false;
+    id = item(index).id;
     return true;
 }
 
@@ -546,42 +481,32 @@ bool Octree::intersects_ray(const vec3d & p, const vec3d & dir, std::set<std::pa
 
     vec3d  pos;
     double t=0.0;
-    if(root && !root->bbox.intersects_ray(p, dir, t, pos)) return false;
-    Obj obj;
-    obj.node = root;
-    obj.dist = t;
-
-    PrioQueue q;
-    q.push(obj);
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.intersects_ray(p, dir, t, pos))
+    {
+        lifo.push(0);
+    }
 
-    while(!q.empty())
+    while(!lifo.empty())
     {
-        Obj obj = q.top();
-        q.pop();
+        const OctreeNode & node = nodes[lifo.top()];
+        lifo.pop();
 
-        for(int i=0; i<8; ++i)
+        if(node.is_inner())
         {
-            OctreeNode *child = obj.node->children[i];
-            if(child->bbox.intersects_ray(p, dir, t, pos))
+            for(uint i=0; i<8; ++i)
             {
-                if(child->is_inner())
-                {
-                    Obj obj;
-                    obj.node = child;
-                    obj.dist = t;
-                    q.push(obj);
-                }
-                else
+                if(nodes[node.child(i)].bbox.intersects_ray(p, dir, t, pos)) lifo.push(node.child(i));
+            }
+        }
+        else
+        {
+            for(uint i=node.begin; i<node.end; ++i)
+            {
+                if(item_intersects_ray(leaf_items[i], p, dir, t, pos))
                 {
-                    for(uint i : child->item_indices)
-                    {
-                        if(items.at(i)->intersects_ray(p, dir, t, pos))
-                        {
-                            all_hits.insert(std::make_pair(t,items.at(i)->id));
-                        }
-                    }
+                    all_hits.insert(std::make_pair(t,item(leaf_items[i]).id));
                 }
-
             }
         }
     }
@@ -598,116 +523,165 @@ bool Octree::intersects_ray(const vec3d & p, const vec3d & dir, std::set<std::pa
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// this query becomes exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
 CINO_INLINE
-bool Octree::intersects_triangle(const vec3d t[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const
+void Octree::intersects_rays(const std::vector<vec3d>  & p,
+                             const std::vector<vec3d>  & dir,
+                                   std::vector<double> & min_t,
+                                   std::vector<int>    & ids,
+                             const std::vector<int>    & ignore) const
 {
+    assert(p.size()==dir.size());
+    assert(ignore.empty() || ignore.size()==p.size());
+
     typedef std::chrono::steady_clock Time;
     Time::time_point t0 = Time::now();
 
-    std::unordered_set<uint> tmp;
-    std::vector<vec3d> list = {t[0],t[1],t[2]};
-    intersects_box(AABB(list), tmp);
-
-    for(uint i : tmp)
+    min_t.assign(p.size(), inf_double);
+    ids.assign(p.size(), -1);
+    PARALLEL_FOR(0, uint(p.size()), 100, [&](uint i)
     {
-        if(items.at(i)->intersects_triangle(t, ignore_if_valid_complex))
-        {
-            ids.insert(items.at(i)->id);
-        }
-    }
+        int index = first_hit(p[i], dir[i], ignore.empty() ? -1 : ignore[i], min_t[i]);
+        if(index>=0) ids[i] = int(item(index).id);
+    });
 
     if(print_debug_info)
     {
         Time::time_point t1 = Time::now();
-        std::cout << "Intersects triangle\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+        std::cout << "Intersects " << p.size() << " rays\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
     }
-
-    return !ids.empty();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// this query becomes exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
 CINO_INLINE
-bool Octree::intersects_segment(const vec3d s[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const
+int Octree::first_hit(const vec3d & p, const vec3d & dir, const int ignore, double & min_t) const
 {
-    typedef std::chrono::steady_clock Time;
-    Time::time_point t0 = Time::now();
+    vec3d  pos;
+    double t=0.0;
+    if(nodes.empty() || !nodes.front().bbox.intersects_ray(p, dir, t, pos)) return -1;
+    Obj root;
+    root.node = 0;
+    root.dist = t;
 
-    std::unordered_set<uint> tmp;
-    intersects_box(AABB(s[0],s[1]), tmp);
+    PrioQueue q;
+    q.push(root);
 
-    for(uint i : tmp)
+    while(!q.empty() && q.top().index<0)
     {
-        if(items.at(i)->intersects_segment(s, ignore_if_valid_complex))
+        const OctreeNode & node = nodes[q.top().node];
+        q.pop();
+
+        if(node.is_inner())
+        {
+            for(uint i=0; i<8; ++i)
+            {
+                if(nodes[node.child(i)].bbox.intersects_ray(p, dir, t, pos))
+                {
+                    Obj obj;
+                    obj.node = node.child(i);
+                    obj.dist = t;
+                    q.push(obj);
+                }
+            }
+        }
+        else
         {
-            ids.insert(items.at(i)->id);
+            for(uint i=node.begin; i<node.end; ++i)
+            {
+                if(ignore>=0 && int(item(leaf_items[i]).id)==ignore) continue;
+                if(item_intersects_ray(leaf_items[i], p, dir, t, pos))
+                {
+                    Obj obj;
+                    obj.index = int(leaf_items[i]);
+                    obj.dist  = t;
+                    q.push(obj);
+                }
+            }
         }
     }
 
-    if(print_debug_info)
-    {
-        Time::time_point t1 = Time::now();
-        std::cout << "Intersects segment\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
-    }
-
-    return !ids.empty();
+    if(q.empty()) return -1;
+    assert(q.top().index>=0);
+    min_t = q.top().dist;
+    return q.top().index;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// WARNING: this function may return false positives because it only checks intersection between
-// the box b and the AABB of the items in the tree. This is a partial result that it is useful for
-// some of the queries above, where a more expensive test between the geometric entity approximated
-// by box b and the actual items will be performed
 CINO_INLINE
-bool Octree::intersects_box(const AABB & b, std::unordered_set<uint> & ids) const
+void Octree::items_intersecting_box(const AABB & b, std::vector<uint> & list) const
 {
-    typedef std::chrono::steady_clock Time;
-    Time::time_point t0 = Time::now();
-
-    std::stack<OctreeNode*> lifo;
-    if(root && root->bbox.intersects_box(b))
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.intersects_box(b))
     {
-        lifo.push(root);
+        lifo.push(0);
     }
 
     while(!lifo.empty())
-    {        
-        OctreeNode *node = lifo.top();
+    {
+        const OctreeNode & node = nodes[lifo.top()];
         lifo.pop();
-        assert(node->bbox.intersects_box(b));
+        assert(node.bbox.intersects_box(b));
 
-        if(node->is_inner())
-        {            
-            for(int i=0; i<8; ++i)
+        if(node.is_inner())
+        {
+            for(uint i=0; i<8; ++i)
             {
-                if(node->children[i]->bbox.intersects_box(b))
-                {
-                    lifo.push(node->children[i]);
-                }
+                if(nodes[node.child(i)].bbox.intersects_box(b)) lifo.push(node.child(i));
             }
         }
         else
         {
-            for(uint i : node->item_indices)
+            for(uint i=node.begin; i<node.end; ++i)
             {
-                if(items.at(i)->aabb.intersects_box(b))
-                {
-                    ids.insert(items.at(i)->id);
-                }
+                if(item(leaf_items[i]).aabb.intersects_box(b)) list.push_back(leaf_items[i]);
             }
         }
     }
 
-    if(print_debug_info)
+    // items spanning multiple leaves may have been found more than once
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void Octree::items_within(const vec3d & c, const double r, std::vector<uint> & ids) const
+{
+    ids.clear();
+    double r2 = r*r;
+    std::stack<uint> lifo;
+    if(!nodes.empty() && nodes.front().bbox.dist_sqrd(c)<=r2)
     {
-        Time::time_point t1 = Time::now();
-        std::cout << "Intersects box\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+        lifo.push(0);
     }
 
-    return !ids.empty();
+    while(!lifo.empty())
+    {
+        const OctreeNode & node = nodes[lifo.top()];
+        lifo.pop();
+
+        if(node.is_inner())
+        {
+            for(uint i=0; i<8; ++i)
+            {
+                if(nodes[node.child(i)].bbox.dist_sqrd(c)<=r2) lifo.push(node.child(i));
+            }
+        }
+        else
+        {
+            for(uint i=node.begin; i<node.end; ++i)
+            {
+                const SpatialDataStructureItem & it = item(leaf_items[i]);
+                if(it.aabb.dist_sqrd(c)<=r2) ids.push_back(it.id);
+            }
+        }
+    }
+
+    // items spanning multiple leaves may have been found more than once
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
 }
 
 }
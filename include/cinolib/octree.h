@@ -36,25 +36,32 @@
 #ifndef CINO_OCTREE_H
 #define CINO_OCTREE_H
 
-#include <cinolib/geometry/spatial_data_structure_item.h>
-#include <cinolib/meshes/meshes.h>
+#include <cinolib/spatial_data_structure.h>
+#include <cinolib/span.h>
 #include <queue>
 
 namespace cinolib
 {
 
+/* Nodes are stored in a linear array (Octree::nodes), with the root at position zero.
+ * The eight children of an inner node are stored consecutively, starting at position
+ * first_child. Leaves do not own their items, but refer to the range [begin,end) of the
+ * flat buffer Octree::leaf_items, which stores the indices of the items in each leaf
+*/
+
 class OctreeNode
 {
     public:
+        OctreeNode() {}
         OctreeNode(const AABB & bbox) : bbox(bbox) {}
-       ~OctreeNode();
-        AABB              bbox;
-        std::vector<uint> item_indices; // index Octree::items, avoiding to store a copy of the same object multiple times in each node it appears
-        OctreeNode       *children[8] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
-        bool              is_inner() const { return children[0]!=nullptr; }
+        AABB bbox;
+        uint first_child = 0; // the root is never a child, hence zero means leaf
+        uint begin       = 0;
+        uint end         = 0;
+        bool is_inner()  const { return first_child>0; }
+        uint child(const uint i) const { return first_child+i; }
+        uint num_items() const { return end-begin; }
 };
-// https://stackoverflow.com/questions/4306186/structure-padding-and-packing
-// http://www.catb.org/esr/structure-packing/
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -63,128 +70,33 @@ class OctreeNode
  *  i)   Create an empty octree
  *  ii)  Use the push_segment/triangle/tetrahedron facilities to populate it
  *  iii) Call build to make the tree
+ *
+ * The tree is built top down, one level at a time, processing all the
+ * nodes (and all their items) of each level in parallel.
 */
 
-class Octree
+class Octree : public SpatialDataStructure
 {
     public:
 
         explicit Octree(const uint max_depth      = 7,
                         const uint items_per_leaf = 50);
 
-        virtual ~Octree();
-
-        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-        void push_point      (const uint id, const vec3d &  v);
-        void push_sphere     (const uint id, const vec3d &  c, const double   r);
-        void push_segment    (const uint id, const vec3d & v0, const vec3d & v1);
-        void push_triangle   (const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2);
-        void push_tetrahedron(const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2, const vec3d & v3);
-
-        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-        void build();
-
-        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-        void subdivide(OctreeNode *node);
-
-        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-        template<class M, class V, class E, class P>
-        void build_from_mesh_polys(const AbstractPolygonMesh<M,V,E,P> & m)
-        {
-            assert(items.empty());
-            items.reserve(m.num_polys());
-            for(uint pid=0; pid<m.num_polys(); ++pid)
-            {
-                for(uint i=0; i<m.poly_tessellation(pid).size()/3; ++i)
-                {
-                    vec3d v0 = m.vert(m.poly_tessellation(pid).at(3*i+0));
-                    vec3d v1 = m.vert(m.poly_tessellation(pid).at(3*i+1));
-                    vec3d v2 = m.vert(m.poly_tessellation(pid).at(3*i+2));
-                    push_triangle(pid,v0,v1,v2);
-                }
-            }
-            build();
-        }
-
-        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-        template<class M, class V, class E, class F, class P>
-        void build_from_mesh_polys(const AbstractPolyhedralMesh<M,V,E,F,P> & m)
-        {
-            assert(items.empty());
-            items.reserve(m.num_polys());
-            for(uint pid=0; pid<m.num_polys(); ++pid)
-            {
-                switch(m.mesh_type())
-                {
-                    case TETMESH : push_tetrahedron(pid,
-                                                    m.poly_vert(pid,0),
-                                                    m.poly_vert(pid,1),
-                                                    m.poly_vert(pid,2),
-                                                    m.poly_vert(pid,3)); break;
-                    default: assert(false && "Unsupported element");
-                }
-            }
-            build();
-        }
-
-        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-        void build_from_vectors(const std::vector<vec3d> & verts,
-                                const std::vector<uint>  & tris)
-        {
-            assert(items.empty());
-            items.reserve(tris.size()/3);
-            for(uint i=0; i<tris.size(); i+=3)
-            {
-                push_triangle(i/3, verts.at(tris.at(i  )),
-                                   verts.at(tris.at(i+1)),
-                                   verts.at(tris.at(i+2)));
-            }
-            build();
-        }
+        virtual ~Octree() {}
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        template<class M, class V, class E, class P>
-        void build_from_mesh_edges(const AbstractMesh<M,V,E,P> & m)
-        {
-            assert(items.empty());
-            items.reserve(m.num_edges());
-            for(uint eid=0; eid<m.num_edges(); ++eid)
-            {
-                push_segment(eid, m.edge_vert(eid,0),
-                                  m.edge_vert(eid,1));
-            }
-            build();
-        }
+        void build() override;
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        template<class M, class V, class E, class P>
-        void build_from_mesh_points(const AbstractMesh<M,V,E,P> & m)
-        {
-            assert(items.empty());
-            items.reserve(m.num_verts());
-            for(uint vid=0; vid<m.num_verts(); ++vid)
-            {
-                push_point(vid, m.vert(vid));
-            }
-            build();
-        }
+        // indices of the items contained in a leaf node (empty for inner nodes)
+        Span<uint> node_items(const uint nid) const;
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         uint max_items_per_leaf() const;
 
-        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-        void debug_mode(const bool b);
-
         // QUERIES :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         // returns pos, id and distance of the item that is closest to query point p
@@ -200,23 +112,22 @@ class Octree
         // between items in the octree and a ray R(t) := p + t * dir
         bool intersects_ray(const vec3d & p, const vec3d & dir, double & min_t, uint & id) const; // first hit
         bool intersects_ray(const vec3d & p, const vec3d & dir, std::set<std::pair<double,uint>> & all_hits) const;
+        void intersects_rays(const std::vector<vec3d>  & p,
+                             const std::vector<vec3d>  & dir,
+                                   std::vector<double> & min_t,
+                                   std::vector<int>    & ids,
+                             const std::vector<int>    & ignore = {}) const override;
 
-        // note: these queries become exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
-        bool intersects_segment (const vec3d s[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
-        bool intersects_triangle(const vec3d t[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
-
-        // WARNING: this function may return false positives because it only checks intersection between
-        // the box b and the AABB of the items in the tree. This is a partial result that it is useful for
-        // some of the queries above, where a more expensive test between the geometric entity approximated
-        // by box b and the actual items will be performed
-        bool intersects_box(const AABB & b, std::unordered_set<uint> & ids) const;
+        // collects the ids of the items whose bounding box is within distance r from point c
+        // (exact for points). The list is sorted and free of duplicates
+        void items_within(const vec3d & c, const double r, std::vector<uint> & ids) const;
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        // all items live here, and leaf nodes only store indices to items
-        std::vector<SpatialDataStructureItem*> items;
-        OctreeNode                            *root = nullptr;
-        std::vector<const OctreeNode*>         leaves;
+        // nodes live here (root first), and leaf nodes only store ranges of leaf_items
+        std::vector<OctreeNode>  nodes;
+        std::vector<uint>        leaf_items;
+        std::vector<uint>        leaves;
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -225,16 +136,15 @@ class Octree
         uint max_depth;      // maximum allowed depth of the tree
         uint items_per_leaf; // prescribed number of items per leaf (can't go deeper than max_depth anyways)
         uint tree_depth = 0; // actual depth of the tree
-        bool print_debug_info = false;
 
         // SUPPORT STRUCTURES ::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         struct Obj
         {
-            double      dist  = inf_double;
-            OctreeNode *node  = nullptr;
-            int         index = -1; // note: this is the item ID, NOT necessarily the index of vector items!!
-            vec3d       pos;        // closest point
+            double dist  = inf_double;
+            uint   node  = 0;
+            int    index = -1;             // index of vector items (-1 if this is a node)
+            vec3d  pos   = vec3d(0,0,0); // closest point
         };
         struct Greater
         {
@@ -244,6 +154,14 @@ class Octree
             }
         };
         typedef std::priority_queue<Obj,std::vector<Obj>,Greater> PrioQueue;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // index (NOT the id) of the first item hit by ray R(t) := p + t * dir, skipping the item
+        // with id ignore (if not negative). Returns -1 if the ray does not hit any item
+        int first_hit(const vec3d & p, const vec3d & dir, const int ignore, double & min_t) const;
+
+        void items_intersecting_box(const AABB & b, std::vector<uint> & list) const override;
 };
 
 }
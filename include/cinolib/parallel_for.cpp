@@ -34,23 +34,47 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/parallel_for.h>
-#include <thread>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
 #include <vector>
-#include <cmath>
 
 namespace cinolib
 {
 
+CINO_INLINE
+uint default_chunk_size(const uint n, const uint chunk_size)
+{
+    if(chunk_size>0) return chunk_size;
+    return std::max(uint(1), n/(8*ThreadPool::instance().num_threads()));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename Func>
+CINO_INLINE
+static void PARALLEL_FOR(      uint   beg,
+                               uint   end,
+                         const uint   serial_if_less_than,
+                         const Func & func)
+{
+    PARALLEL_FOR(beg, end, serial_if_less_than, 0, func);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<typename Func>
 CINO_INLINE
 static void PARALLEL_FOR(      uint   beg,
                                uint   end,
                          const uint   serial_if_less_than,
+                         const uint   chunk_size,
                          const Func & func)
 {
+    if(beg>=end) return;
+
 #ifndef SERIALIZE_PARALLEL_FOR
 
-    uint n = end - beg + 1;
+    uint n = end - beg;
 
     if(n<serial_if_less_than)
     {
@@ -58,42 +82,83 @@ static void PARALLEL_FOR(      uint   beg,
     }
     else
     {
-        // estimate number of threads in the pool
-        const static unsigned n_threads_hint = std::thread::hardware_concurrency();
-        const static unsigned n_threads      = (n_threads_hint==0u) ? 8u : n_threads_hint;
-
-        // split the full range into sub ranges of equal size
-        uint slice = (uint)std::round(n/static_cast<double>(n_threads));
-        slice = std::max(slice,uint(1));
+        uint size     = default_chunk_size(n, chunk_size);
+        uint n_chunks = (n-1)/size + 1;
 
-        // helper function that handles a sub range
-        auto subrange_helper = [&func](uint k1, uint k2)
+        ThreadPool::instance().run(n_chunks, [&](const uint k)
         {
-            for(uint k=k1; k<k2; ++k) func(k);
-        };
-
-        // create pool and launch jobs
-        std::vector<std::thread> pool;
-        pool.reserve(n_threads);
-        uint i1 = beg;
-        uint i2 = std::min(beg + slice, end);
-        for(uint i=0; i+1<n_threads && i1<end; ++i)
-        {
-            pool.emplace_back(subrange_helper, i1, i2);
-            i1 = i2;
-            i2 = std::min(i2+slice, end);
-        }
-        if(i1<end) pool.emplace_back(subrange_helper, i1, end);
-
-        // Wait for jobs to finish
-        for(std::thread & t : pool)
-        {
-            if(t.joinable()) t.join();
-        }
+            uint k1 = beg + k*size;
+            uint k2 = std::min(k1 + size, end);
+            for(uint i=k1; i<k2; ++i) func(i);
+        });
     }
 #else
+    (void)serial_if_less_than;
+    (void)chunk_size;
     for(uint i=beg; i<end; ++i) func(i);
 #endif
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename T, typename Func, typename Reduce>
+CINO_INLINE
+static T PARALLEL_REDUCE(      uint     beg,
+                               uint     end,
+                         const uint     serial_if_less_than,
+                         const T      & identity,
+                         const Func   & func,
+                         const Reduce & reduce)
+{
+    return PARALLEL_REDUCE(beg, end, serial_if_less_than, 0, identity, func, reduce);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename T, typename Func, typename Reduce>
+CINO_INLINE
+static T PARALLEL_REDUCE(      uint     beg,
+                               uint     end,
+                         const uint     serial_if_less_than,
+                         const uint     chunk_size,
+                         const T      & identity,
+                         const Func   & func,
+                         const Reduce & reduce)
+{
+    T res = identity;
+    if(beg>=end) return res;
+
+#ifndef SERIALIZE_PARALLEL_FOR
+
+    uint n = end - beg;
+
+    if(n<serial_if_less_than)
+    {
+        for(uint i=beg; i<end; ++i) res = reduce(res, func(i));
+    }
+    else
+    {
+        uint size     = default_chunk_size(n, chunk_size);
+        uint n_chunks = (n-1)/size + 1;
+
+        struct Partial { T val; }; // avoids the std::vector<bool> specialization
+        std::vector<Partial> partial(n_chunks, Partial{identity});
+        ThreadPool::instance().run(n_chunks, [&](const uint k)
+        {
+            uint k1 = beg + k*size;
+            uint k2 = std::min(k1 + size, end);
+            T & acc = partial[k].val;
+            for(uint i=k1; i<k2; ++i) acc = reduce(acc, func(i));
+        });
+        for(const Partial & p : partial) res = reduce(res, p.val);
+    }
+#else
+    (void)serial_if_less_than;
+    (void)chunk_size;
+    for(uint i=beg; i<end; ++i) res = reduce(res, func(i));
+#endif
+
+    return res;
+}
+
 }
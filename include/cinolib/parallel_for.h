@@ -45,16 +45,21 @@ namespace cinolib
 /* OpenMP-like parallel for loop realized in plain C++11
  * Thanks to Jeremy Dumas for his code (https://ideone.com/Z7zldb)
  *
- * DISCLAIMER: this routine is as good as OpenMP with STATIC scheduling.
- * That is, it works best when computational cost is equally distributed
- * across all threads. In case of unbalanced distribution, performances
- * may degrade, and using the DYNAMIC scheduling of a library such as OpenMP
- * will greatly benefit performances.
+ * Loops are executed on a process-wide pool of persistent threads (see
+ * thread_pool.h), hence there is no thread creation overhead at each call.
+ * The range is split into chunks of consecutive indices, and idle threads
+ * steal chunks from busy ones. This is similar to the DYNAMIC scheduling
+ * of OpenMP, and works well also when the computational cost is unevenly
+ * distributed across the range.
  *
- * PARALLEL_FOR has three arguments
+ * PARALLEL_FOR has four arguments (plus an optional one)
  *
  *     beg,end             : define a range of indices
  *     serial_if_less_than : avoid paying the overhead if the range is smaller than...
+ *     chunk_size          : (optional) number of consecutive indices processed as a
+ *                           single unit of work. If omitted (or zero) the range is
+ *                           split in a few chunks per thread. Use small chunks when
+ *                           the cost per index is highly variable
  *     func                : is the function that implements the body of the loop.
  *                           It takes as unique argument the loop index. This will
  *                           typically be a lambda function inlined in the call
@@ -75,16 +80,62 @@ namespace cinolib
  *    m.update_p_normal(pid);
  * });
  *
+ * PARALLEL_REDUCE has the same arguments of PARALLEL_FOR, plus:
+ *
+ *     identity : neutral element of the reduction (e.g. 0 for sums)
+ *     func     : maps the loop index to a value of the same type of identity
+ *     reduce   : binary associative operator that combines two values
+ *
+ * Partial results are computed per chunk and combined in chunk order,
+ * hence for a given number of threads the result is deterministic.
+ * Example of usage: compute the total area of a mesh
+ *
+ * double area = PARALLEL_REDUCE(0, m.num_polys(), 1000, 0.0,
+ *                               [&m](uint pid){ return m.poly_area(pid); },
+ *                               [](double a, double b){ return a+b; });
+ *
  * NOTE: if symbol SERIALIZE_PARALLEL_FOR is defined at compilation time,
- * the loop will be executed in standard serial mode.
+ * loops will be executed in standard serial mode.
 */
 
+// chunk size used for a range of n indices: chunk_size, or (if zero) a few chunks per
+// thread, so that stealing can compensate for an uneven distribution of the workload
+CINO_INLINE
+uint default_chunk_size(const uint n, const uint chunk_size);
+
 template<typename Func>
 CINO_INLINE
 static void PARALLEL_FOR(      uint   beg,
                                uint   end,
                          const uint   serial_if_less_than,
                          const Func & func);
+
+template<typename Func>
+CINO_INLINE
+static void PARALLEL_FOR(      uint   beg,
+                               uint   end,
+                         const uint   serial_if_less_than,
+                         const uint   chunk_size,
+                         const Func & func);
+
+template<typename T, typename Func, typename Reduce>
+CINO_INLINE
+static T PARALLEL_REDUCE(      uint     beg,
+                               uint     end,
+                         const uint     serial_if_less_than,
+                         const T      & identity,
+                         const Func   & func,
+                         const Reduce & reduce);
+
+template<typename T, typename Func, typename Reduce>
+CINO_INLINE
+static T PARALLEL_REDUCE(      uint     beg,
+                               uint     end,
+                         const uint     serial_if_less_than,
+                         const uint     chunk_size,
+                         const T      & identity,
+                         const Func   & func,
+                         const Reduce & reduce);
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -0,0 +1,720 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/quadric_decimation.h>
+#include <cinolib/editable_triangle_soup.h>
+#include <cinolib/indexed_heap.h>
+#include <cinolib/parallel_for.h>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <atomic>
+
+namespace cinolib
+{
+
+namespace
+{
+
+// Generalized quadric in R^N (position, then attributes). The upper
+// triangle of the symmetric matrix A is stored row by row
+//
+template<int N>
+class Quadric
+{
+    public:
+
+        static const int S = N*(N+1)/2;
+
+        double A[S];
+        double b[N];
+        double c = 0;
+        double w = 0; // area of the triangles accumulated so far
+
+        Quadric()
+        {
+            std::fill(A, A+S, 0.0);
+            std::fill(b, b+N, 0.0);
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        static int idx(const int i, const int j) // i<=j
+        {
+            return i*N - i*(i-1)/2 + (j-i);
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        Quadric & operator+=(const Quadric & q)
+        {
+            for(int i=0; i<S; ++i) A[i] += q.A[i];
+            for(int i=0; i<N; ++i) b[i] += q.b[i];
+            c += q.c;
+            w += q.w;
+            return *this;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // squared distance from the plane spanned by triangle p0,p1,p2 (in R^N)
+        void add_triangle(const double *p0, const double *p1, const double *p2, const double wgt)
+        {
+            double e1[N], e2[N];
+            double l1 = 0, l2 = 0, d = 0;
+            for(int k=0; k<N; ++k) { e1[k] = p1[k]-p0[k]; l1 += e1[k]*e1[k]; }
+            if(l1<=0) return;
+            l1 = std::sqrt(l1);
+            for(int k=0; k<N; ++k) { e1[k] /= l1; e2[k] = p2[k]-p0[k]; d += e2[k]*e1[k]; }
+            for(int k=0; k<N; ++k) { e2[k] -= d*e1[k]; l2 += e2[k]*e2[k]; }
+            if(l2<=0) return;
+            l2 = std::sqrt(l2);
+            for(int k=0; k<N; ++k) e2[k] /= l2;
+
+            double pe1 = 0, pe2 = 0, pp = 0;
+            for(int k=0; k<N; ++k)
+            {
+                pe1 += p0[k]*e1[k];
+                pe2 += p0[k]*e2[k];
+                pp  += p0[k]*p0[k];
+            }
+            for(int i=0; i<N; ++i)
+            {
+                for(int j=i; j<N; ++j) A[idx(i,j)] += wgt*(((i==j) ? 1.0 : 0.0) - e1[i]*e1[j] - e2[i]*e2[j]);
+                b[i] += wgt*(pe1*e1[i] + pe2*e2[i] - p0[i]);
+            }
+            c += wgt*(pp - pe1*pe1 - pe2*pe2);
+            w += wgt;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // squared distance from the plane n*x+d=0 in R^3 (attributes are not involved)
+        void add_plane(const vec3d & n, const double d, const double wgt)
+        {
+            for(int i=0; i<3; ++i)
+            {
+                for(int j=i; j<3; ++j) A[idx(i,j)] += wgt*n[i]*n[j];
+                b[i] += wgt*d*n[i];
+            }
+            c += wgt*d*d;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // area weighted mean squared distance of v from the accumulated planes
+        double error(const double *v) const
+        {
+            double e = c;
+            for(int i=0; i<N; ++i)
+            {
+                e += (2.0*b[i] + A[idx(i,i)]*v[i])*v[i];
+                for(int j=i+1; j<N; ++j) e += 2.0*A[idx(i,j)]*v[i]*v[j];
+            }
+            return std::max(0.0,e)/std::max(w,1e-300);
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // point of minimum error (false if the quadric is singular)
+        bool minimizer(double *v) const
+        {
+            Eigen::Matrix<double,N,N> M;
+            Eigen::Matrix<double,N,1> rhs;
+            for(int i=0; i<N; ++i)
+            {
+                for(int j=i; j<N; ++j) M(i,j) = M(j,i) = A[idx(i,j)];
+                rhs(i) = -b[i];
+            }
+            Eigen::FullPivLU<Eigen::Matrix<double,N,N>> lu(M);
+            lu.setThreshold(1e-8);
+            if(!lu.isInvertible()) return false;
+            Eigen::Matrix<double,N,1> x = lu.solve(rhs);
+            for(int i=0; i<N; ++i) v[i] = x(i);
+            return true;
+        }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum
+{
+    FEATURE_BIT = 1,
+    MARKED_BIT  = 2,
+    CREASE_BIT  = 4
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Working space of the decimator (topology in EditableTriangleSoup), where collapses
+// only flag dead elements. No element is ever created, hence threads that operate on
+// disjoint sets of verts (and triangles incident to them) can decimate concurrently
+//
+template<int N>
+class QEMDecimator : public EditableTriangleSoup<QEMDecimator<N>>
+{
+    public:
+
+        typedef EditableTriangleSoup<QEMDecimator<N>> Soup;
+        using Soup::tris;
+        using Soup::v2t;
+        using Soup::v_bnd;
+        using Soup::tri_vert;
+        using Soup::tri_has;
+        using Soup::tri_opposite;
+        using Soup::tri_replace;
+        using Soup::edge_tris;
+        using Soup::valence;
+        using Soup::remove_tri_from_vert;
+        using Soup::collapse_is_valid;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        std::vector<double>            x;       // N coordinates per vertex
+        std::vector<Quadric<N>>        q;
+        std::vector<char>              v_alive;
+        std::vector<char>              v_lock;  // 0: free, 1: along a feature line, 2: feature corner
+        std::vector<int>               v_block; // block each vertex belongs to (parallel decimation)
+        std::vector<char>              t_alive;
+        std::vector<char>              e_flags; // per triangle edge (i,i+1)
+        std::vector<uint>              t_local; // position of each triangle in the set being decimated
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        vec3d vert(const uint vid) const
+        {
+            return vec3d(x[N*vid], x[N*vid+1], x[N*vid+2]);
+        }
+
+        int tri_edge(const uint tid, const uint a, const uint b) const // position of edge (a,b) in tid (-1 if none)
+        {
+            for(uint i=0; i<3; ++i)
+            {
+                uint u = tris[3*tid+i];
+                uint v = tris[3*tid+(i+1)%3];
+                if((u==a && v==b) || (u==b && v==a)) return int(i);
+            }
+            return -1;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        char edge_flags(const uint a, const uint b) const
+        {
+            char f = 0;
+            for(uint tid : v2t[a])
+            {
+                int i = tri_edge(tid,a,b);
+                if(i>=0) f |= e_flags[3*tid+i];
+            }
+            return f;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // error of the best collapse of edge (u,v). Vertex a is removed, b is kept and moved to p
+        double collapse_cost(const uint u, const uint v, uint & a, uint & b, double *p) const
+        {
+            // feature verts only collapse along their own feature line, and corners never go away
+            a = u;
+            b = v;
+            if(v_lock[a]>v_lock[b]) std::swap(a,b);
+            if(v_lock[a]==2) return inf_double;
+            if(v_lock[a]==1 && !(edge_flags(a,b) & FEATURE_BIT)) return inf_double;
+
+            Quadric<N> Q = q[a];
+            Q += q[b];
+            const double *xa = &x[N*a];
+            const double *xb = &x[N*b];
+
+            if(v_lock[b]>0)
+            {
+                double err = Q.error(xb);
+                if(v_lock[a]==v_lock[b])
+                {
+                    double err_a = Q.error(xa);
+                    if(err_a<err)
+                    {
+                        std::swap(a,b);
+                        std::swap(xa,xb);
+                        err = err_a;
+                    }
+                }
+                std::copy(xb, xb+N, p);
+                return err;
+            }
+
+            // optimal placement, unless it falls far away from the edge (almost singular quadric)
+            double mid[N];
+            for(int i=0; i<N; ++i) mid[i] = 0.5*(xa[i]+xb[i]);
+            if(Q.minimizer(p) && vert(a).dist(vert(b)) >= vec3d(p[0],p[1],p[2]).dist(vec3d(mid[0],mid[1],mid[2])))
+            {
+                return Q.error(p);
+            }
+            double err = inf_double;
+            for(const double *c : {xa, xb, (const double*)mid})
+            {
+                double e = Q.error(c);
+                if(e<err)
+                {
+                    err = e;
+                    std::copy(c, c+N, p);
+                }
+            }
+            return err;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // merges a into b, which is moved to p. Returns the number of triangles removed
+        uint collapse(const uint a, const uint b, const double *p)
+        {
+            uint count = 0;
+            for(uint tid : v2t[a])
+            {
+                if(!tri_has(tid,b)) continue;
+
+                // edges (a,c) and (b,c) become one: it inherits the flags of both
+                uint c = tri_opposite(tid,a,b);
+                char f = e_flags[3*tid+tri_edge(tid,a,c)] | e_flags[3*tid+tri_edge(tid,b,c)];
+                for(uint nbr : v2t[c])
+                {
+                    if(nbr==tid || !t_alive[nbr]) continue;
+                    int i = tri_edge(nbr,a,c);
+                    if(i<0) i = tri_edge(nbr,b,c);
+                    if(i>=0) e_flags[3*nbr+i] |= f;
+                }
+
+                t_alive[tid] = false;
+                for(uint i=0; i<3; ++i)
+                {
+                    uint vid = tri_vert(tid,i);
+                    if(vid!=a) remove_tri_from_vert(vid,tid);
+                }
+                ++count;
+            }
+            for(uint tid : v2t[a])
+            {
+                if(!t_alive[tid]) continue;
+                tri_replace(tid,a,b);
+                v2t[b].push_back(tid);
+            }
+            v2t[a].clear();
+            v_alive[a] = false;
+            q[b] += q[a];
+            std::copy(p, p+N, &x[N*b]);
+            return count;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool one_ring_in_block(const uint a, const uint b, const int block) const
+        {
+            for(uint vid : {a,b})
+            for(uint tid : v2t[vid])
+            for(uint i=0; i<3; ++i)
+            {
+                if(v_block[tri_vert(tid,i)]!=block) return false;
+            }
+            return true;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // Each edge is represented in a queue by one of its half edges (3*i+j, where i is the
+        // position of the triangle in tids): the one going from the lower to the higher vid,
+        // or the only one for boundary edges. If block>=0 only verts in the block are touched
+        //
+        struct Queue
+        {
+            std::vector<uint> tids;
+            int               block = -1;
+            IndexedHeap       heap;
+        };
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        double update(Queue & queue, const uint tid, const uint i) const
+        {
+            uint   id   = 3*t_local[tid]+i;
+            uint   u    = tri_vert(tid,i);
+            uint   v    = tri_vert(tid,(i+1)%3);
+            double cost = inf_double;
+            uint   t[2], a, b;
+            double p[N];
+            if((u<v || edge_tris(u,v,t)==1) &&
+               (queue.block<0 || (v_block[u]==queue.block && v_block[v]==queue.block)))
+            {
+                cost = collapse_cost(u,v,a,b,p);
+            }
+            if(cost<inf_double) queue.heap.push(id,cost);
+            else                queue.heap.remove(id);
+            return cost;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // fills the queue, and (optionally) reports the cost of the edges in it
+        void init(Queue & queue, std::vector<double> * costs = nullptr)
+        {
+            queue.heap.clear();
+            queue.heap.reserve(3*uint(queue.tids.size()));
+            for(uint i=0; i<queue.tids.size(); ++i) t_local[queue.tids[i]] = i;
+            for(uint tid : queue.tids)
+            {
+                if(!t_alive[tid]) continue;
+                for(uint i=0; i<3; ++i)
+                {
+                    double cost = update(queue,tid,i);
+                    if(costs!=nullptr && cost<inf_double) costs->push_back(cost);
+                }
+            }
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // collapses edges in order of cost, until n_tris drops to target or the cheapest
+        // collapse costs more than max_cost. Blocks share n_tris, hence it is atomic
+        void decimate(      Queue             & queue,
+                      const double              max_cost,
+                      const uint                target,
+                            std::atomic<uint> & n_tris,
+                            double            & max_err)
+        {
+            while(!queue.heap.empty() && n_tris>target && queue.heap.top_key()<=max_cost)
+            {
+                uint id  = queue.heap.pop();
+                uint tid = queue.tids[id/3];
+                if(!t_alive[tid]) continue;
+
+                uint   a, b;
+                double p[N];
+                double cost = collapse_cost(tri_vert(tid,id%3), tri_vert(tid,(id%3+1)%3), a, b, p);
+                if(cost==inf_double) continue;
+                if(queue.block>=0 && !one_ring_in_block(a,b,queue.block)) continue;
+                if(!collapse_is_valid(a,b,vec3d(p[0],p[1],p[2]))) continue;
+
+                n_tris -= collapse(a,b,p);
+                max_err = std::max(max_err,cost);
+
+                // only edges incident to b changed their cost (or their representative half edge)
+                for(uint nbr : v2t[b])
+                for(uint i=0; i<3; ++i)
+                {
+                    if(tri_vert(nbr,i)==b || tri_vert(nbr,(i+1)%3)==b) update(queue,nbr,i);
+                }
+            }
+        }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// splits the verts in n_blocks spatially coherent blocks with (roughly) the same size,
+// recursively cutting along the longest side of the bounding box at the median vertex
+template<int N>
+CINO_INLINE
+void split_in_blocks(const QEMDecimator<N>       & d,
+                     std::vector<uint>::iterator   beg,
+                     std::vector<uint>::iterator   end,
+                     const uint                    n_blocks,
+                     int                         & next_block,
+                     std::vector<int>            & v_block)
+{
+    if(n_blocks<=1 || end-beg<2)
+    {
+        for(auto it=beg; it!=end; ++it) v_block.at(*it) = next_block;
+        ++next_block;
+        return;
+    }
+    AABB box;
+    for(auto it=beg; it!=end; ++it) box.push(d.vert(*it));
+    vec3d delta = box.delta();
+    uint  axis  = (delta.x()>=delta.y() && delta.x()>=delta.z()) ? 0 : ((delta.y()>=delta.z()) ? 1 : 2);
+    uint  n0    = n_blocks/2;
+    auto  mid   = beg + (end-beg)*n0/n_blocks;
+    std::nth_element(beg, mid, end, [&](const uint v0, const uint v1)
+    {
+        return d.x[N*v0+axis] < d.x[N*v1+axis];
+    });
+    split_in_blocks(d, beg, mid, n0,          next_block, v_block);
+    split_in_blocks(d, mid, end, n_blocks-n0, next_block, v_block);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<int N, class M, class V, class E, class P>
+CINO_INLINE
+double decimate_with_quadrics(Trimesh<M,V,E,P>               & m,
+                              const QuadricDecimationOptions & opt)
+{
+    QEMDecimator<N> d;
+    uint nv = m.num_verts();
+    uint np = m.num_polys();
+
+    // per vertex coordinates: position, then scaled attributes
+    double uv_scale = opt.uv_weight     * m.bbox().diag();
+    double n_scale  = opt.normal_weight * m.bbox().diag();
+    d.x.resize(N*nv);
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        double *xv = &d.x[N*vid];
+        uint k = 0;
+        for(uint i=0; i<3; ++i) xv[k++] = m.vert(vid)[i];
+        if(opt.use_uv)
+        {
+            xv[k++] = uv_scale*m.vert_data(vid).uvw[0];
+            xv[k++] = uv_scale*m.vert_data(vid).uvw[1];
+        }
+        if(opt.use_normals)
+        {
+            for(uint i=0; i<3; ++i) xv[k++] = n_scale*m.vert_data(vid).normal[i];
+        }
+        assert(k==N);
+    }
+
+    d.tris = serialized_vids_from_polys(m.vector_polys());
+    d.t_alive.assign(np, true);
+    d.t_local.resize(np);
+    d.e_flags.assign(3*np, 0);
+    d.v_alive.assign(nv, true);
+    d.v_bnd.resize(nv);
+    d.v_lock.assign(nv, 0);
+    d.v2t.resize(nv);
+    for(uint pid=0; pid<np; ++pid)
+    {
+        for(uint vid : m.adj_p2v(pid)) d.v2t.at(vid).push_back(pid);
+    }
+
+    // features, and planes that hold them in place
+    d.q.resize(nv);
+    std::vector<uint> n_feat(nv,0);
+    for(uint eid=0; eid<m.num_edges(); ++eid)
+    {
+        char f = 0;
+        if(m.edge_data(eid).flags[MARKED]) f |= MARKED_BIT;
+        if(m.edge_data(eid).flags[CREASE]) f |= CREASE_BIT;
+        bool is_feature = m.edge_is_boundary(eid) || !m.edge_is_manifold(eid) || (opt.preserve_features && f!=0);
+        if(!is_feature && opt.preserve_labels)
+        {
+            for(uint pid : m.adj_e2p(eid)) if(m.poly_data(pid).label!=m.poly_data(m.adj_e2p(eid).front()).label) is_feature = true;
+        }
+        if(is_feature) f |= FEATURE_BIT;
+        if(f==0) continue;
+
+        uint v0 = m.edge_vert_id(eid,0);
+        uint v1 = m.edge_vert_id(eid,1);
+        for(uint pid : m.adj_e2p(eid))
+        {
+            d.e_flags.at(3*pid+d.tri_edge(pid,v0,v1)) = f;
+        }
+        if(!is_feature) continue;
+        ++n_feat.at(v0);
+        ++n_feat.at(v1);
+        vec3d  e = m.vert(v1) - m.vert(v0);
+        double w = opt.feature_weight * e.dot(e);
+        for(uint pid : m.adj_e2p(eid))
+        {
+            vec3d n = e.cross(m.poly_data(pid).normal);
+            if(n.norm()==0) continue;
+            n.normalize();
+            double off = -n.dot(m.vert(v0));
+            d.q.at(v0).add_plane(n, off, w);
+            d.q.at(v1).add_plane(n, off, w);
+        }
+    }
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        d.v_bnd.at(vid) = m.vert_is_boundary(vid);
+        if(n_feat.at(vid)==2) d.v_lock.at(vid) = 1;
+        if(n_feat.at(vid)==1 || n_feat.at(vid)>2 || !m.vert_is_manifold(vid)) d.v_lock.at(vid) = 2;
+    }
+
+    // per vertex quadrics: sum of the (area weighted) quadrics of the incident triangles
+    PARALLEL_FOR(0, nv, 1000, [&](uint vid)
+    {
+        for(uint pid : d.v2t.at(vid))
+        {
+            d.q.at(vid).add_triangle(&d.x[N*d.tri_vert(pid,0)],
+                                     &d.x[N*d.tri_vert(pid,1)],
+                                     &d.x[N*d.tri_vert(pid,2)],
+                                     m.poly_area(pid));
+        }
+    });
+
+    double max_cost = (opt.max_error<inf_double) ? opt.max_error*opt.max_error : inf_double;
+    double max_err  = 0;
+
+    std::atomic<uint> n_tris(np);
+
+    if(opt.n_partitions>1)
+    {
+        // rounds of parallel decimation of blocks, collapsing only edges whose one ring does
+        // not touch other blocks. At each round blocks collapse the edges cheaper than the median
+        // cost, then the mesh is split again with different cuts, so that the seams of a round
+        // fall inside blocks in the next one. Rounds stop at twice the target, leaving the last
+        // collapses to the serial pass
+        d.v_block.assign(nv,-1);
+        uint target = 2*opt.target_polys;
+        for(uint round=0; n_tris>target; ++round)
+        {
+            std::vector<uint> vids;
+            for(uint vid=0; vid<nv; ++vid) if(d.v_alive.at(vid)) vids.push_back(vid);
+            int n_blocks = 0;
+            split_in_blocks(d, vids.begin(), vids.end(), opt.n_partitions + round%2, n_blocks, d.v_block);
+
+            std::vector<typename QEMDecimator<N>::Queue> queues(n_blocks);
+            for(uint pid=0; pid<np; ++pid)
+            {
+                if(!d.t_alive.at(pid)) continue;
+                int block = d.v_block.at(d.tri_vert(pid,0));
+                if(d.v_block.at(d.tri_vert(pid,1))==block &&
+                   d.v_block.at(d.tri_vert(pid,2))==block) queues.at(block).tids.push_back(pid);
+            }
+            std::vector<std::vector<double>> costs(n_blocks);
+            PARALLEL_FOR(0, uint(n_blocks), 2, 1, [&](uint block)
+            {
+                queues.at(block).block = int(block);
+                d.init(queues.at(block), &costs.at(block));
+            });
+            std::vector<double> all_costs;
+            for(const auto & c : costs) all_costs.insert(all_costs.end(), c.begin(), c.end());
+            if(all_costs.empty()) break;
+            std::nth_element(all_costs.begin(), all_costs.begin()+all_costs.size()/2, all_costs.end());
+            double threshold = std::min(max_cost, all_costs.at(all_costs.size()/2));
+
+            uint n_before = n_tris;
+            std::vector<double> block_err(n_blocks,0);
+            PARALLEL_FOR(0, uint(n_blocks), 2, 1, [&](uint block)
+            {
+                d.decimate(queues.at(block), threshold, target, n_tris, block_err.at(block));
+            });
+            for(double err : block_err) max_err = std::max(max_err,err);
+            if(n_tris==n_before) break;
+        }
+    }
+
+    // serial pass on the whole mesh (seams and leftovers, if partitioned)
+    typename QEMDecimator<N>::Queue queue;
+    for(uint pid=0; pid<np; ++pid) if(d.t_alive.at(pid)) queue.tids.push_back(pid);
+    d.init(queue);
+    d.decimate(queue, max_cost, opt.target_polys, n_tris, max_err);
+
+    // rebuild the mesh, dropping dead elements. No element was ever created, so
+    // each vert/poly inherits the attributes of the input vert/poly it comes from
+    std::vector<int>   v_map(nv, -1);
+    std::vector<uint>  v_orig;
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    std::vector<uint>  t_orig;
+    for(uint pid=0; pid<np; ++pid)
+    {
+        if(!d.t_alive.at(pid)) continue;
+        for(uint i=0; i<3; ++i)
+        {
+            uint vid = d.tri_vert(pid,i);
+            if(v_map.at(vid)<0)
+            {
+                v_map.at(vid) = int(verts.size());
+                verts.push_back(d.vert(vid));
+                v_orig.push_back(vid);
+            }
+            tris.push_back(uint(v_map.at(vid)));
+        }
+        t_orig.push_back(pid);
+    }
+    std::vector<V> v_data(v_orig.size());
+    std::vector<P> p_data(t_orig.size());
+    for(uint i=0; i<v_orig.size(); ++i) v_data.at(i) = m.vert_data(v_orig.at(i));
+    for(uint i=0; i<t_orig.size(); ++i) p_data.at(i) = m.poly_data(t_orig.at(i));
+    std::vector<char> flags;
+    for(uint pid : t_orig) for(uint i=0; i<3; ++i) flags.push_back(d.e_flags.at(3*pid+i));
+
+    M m_data = m.mesh_data();
+    m.clear();
+    m.mesh_data() = m_data;
+    m.init(verts, polys_from_serialized_vids(tris,3));
+
+    for(uint vid=0; vid<m.num_verts(); ++vid)
+    {
+        vec3d n = m.vert_data(vid).normal;
+        m.vert_data(vid) = v_data.at(vid);
+        m.vert_data(vid).normal = n;
+        if(opt.use_uv)
+        {
+            m.vert_data(vid).uvw[0] = d.x[N*v_orig.at(vid)+3]/uv_scale;
+            m.vert_data(vid).uvw[1] = d.x[N*v_orig.at(vid)+4]/uv_scale;
+        }
+    }
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        vec3d n = m.poly_data(pid).normal;
+        m.poly_data(pid) = p_data.at(pid);
+        m.poly_data(pid).normal = n;
+        for(uint i=0; i<3; ++i)
+        {
+            char f = flags.at(3*pid+i);
+            if(f==0) continue;
+            uint eid = m.poly_edge_id(pid, m.poly_vert_id(pid,i), m.poly_vert_id(pid,(i+1)%3));
+            if(f & MARKED_BIT) m.edge_data(eid).flags[MARKED] = true;
+            if(f & CREASE_BIT) m.edge_data(eid).flags[CREASE] = true;
+        }
+    }
+    return std::sqrt(max_err);
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+double quadric_decimation(Trimesh<M,V,E,P>               & m,
+                          const QuadricDecimationOptions & opt)
+{
+    if(m.num_polys()==0) return 0;
+
+    // the dimension of the quadrics depends on the attributes in use
+    uint n_attr = (opt.use_uv ? 2 : 0) + (opt.use_normals ? 3 : 0);
+    switch(n_attr)
+    {
+        case 0 : return decimate_with_quadrics<3>(m,opt);
+        case 2 : return decimate_with_quadrics<5>(m,opt);
+        case 3 : return decimate_with_quadrics<6>(m,opt);
+        default: return decimate_with_quadrics<8>(m,opt);
+    }
+}
+
+}
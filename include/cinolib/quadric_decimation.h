@@ -0,0 +1,114 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_QUADRIC_DECIMATION_H
+#define CINO_QUADRIC_DECIMATION_H
+
+#include <cinolib/meshes/trimesh.h>
+
+namespace cinolib
+{
+
+/* Triangle mesh simplification by iterative edge collapses, ordered by the
+ * Quadric Error Metric described in:
+ *
+ *   Surface Simplification Using Quadric Error Metrics
+ *   M.Garland, P.Heckbert
+ *   SIGGRAPH 1997
+ *
+ * Optionally, per vertex uv coordinates and normals are included in the metric,
+ * using the generalized quadrics described in:
+ *
+ *   New Quadric Metric for Simplifying Meshes with Appearance Attributes
+ *   H.Hoppe
+ *   IEEE Visualization 1999
+ *
+ * Each vertex is placed where it minimizes the quadric error, or on the best
+ * among the edge endpoints and midpoint if the quadric is singular. The error
+ * of a collapse is the area weighted mean squared distance between the new
+ * vertex and the planes of the triangles it stems from, and its square root
+ * is used as a distance bound (max_error) and returned at the end.
+ *
+ * Boundary edges, non manifold edges and (optionally) edges flagged as MARKED
+ * or CREASE, or shared by polygons with different labels, are features. They
+ * are simplified only along their own lines, and are held in place by planes
+ * orthogonal to their incident triangles (weighted by feature_weight). Corners
+ * (verts incident to one or more than two feature edges) are never removed.
+ * Collapses that violate the link condition or flip triangles are discarded,
+ * with the same criteria as Trimesh::edge_is_collapsible.
+ *
+ * If n_partitions is greater than one, the mesh is split in spatially coherent
+ * blocks with the same number of verts, and blocks are decimated in parallel,
+ * collapsing only edges whose one ring is fully contained in the block. This
+ * is done in rounds: at each round blocks collapse edges cheaper than the median
+ * cost, and the mesh is split again with different cuts, so that seams do not
+ * lag behind. When the mesh is down to twice the target, a serial pass on the
+ * whole mesh performs the remaining collapses in global order.
+ *
+ * The mesh is rebuilt at the end. Verts and polys keep the attributes of their
+ * input counterparts (uv coordinates are overwritten if use_uv is true), and
+ * feature edges keep their MARKED and CREASE flags.
+*/
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct QuadricDecimationOptions
+{
+    uint   target_polys      = 0;          // stop when the mesh has this many triangles (or less)
+    double max_error         = inf_double; // stop when the cheapest collapse has a larger error
+    bool   preserve_features = true;       // edges flagged as MARKED or CREASE are features
+    bool   preserve_labels   = true;       // edges between polys with different labels are features
+    double feature_weight    = 1e3;        // weight of the planes that hold features in place
+    bool   use_uv            = false;      // include per vertex uv coordinates in the metric
+    bool   use_normals       = false;      // include per vertex normals in the metric
+    double uv_weight         = 0.1;        // scale of uv coordinates, relative to the bbox diagonal
+    double normal_weight     = 0.1;        // scale of normals, relative to the bbox diagonal
+    uint   n_partitions      = 1;          // >1 enables parallel decimation of mesh blocks
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// returns the largest error among the collapses performed
+template<class M, class V, class E, class P>
+CINO_INLINE
+double quadric_decimation(Trimesh<M,V,E,P>               & m,
+                          const QuadricDecimationOptions & opt = QuadricDecimationOptions());
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "quadric_decimation.cpp"
+#endif
+
+#endif // CINO_QUADRIC_DECIMATION_H
@@ -55,6 +55,10 @@ void remesh_Botsch_Kobbelt_2004(Trimesh<M,V,E,P> & m,
 {
     double l = (target_edge_length>0) ? target_edge_length : m.edge_avg_length();
 
+    // splits, collapses and flips do not rely on cached normals: updates are deferred
+    // to the end of step 3, and done only once for each element touched by these edits
+    m.begin_batch();
+
     // 1) split too long edges
     //
     uint count = 0;
@@ -161,6 +165,7 @@ void remesh_Botsch_Kobbelt_2004(Trimesh<M,V,E,P> & m,
     }
     std::cout << "\t" << count << " edge flip were performed to normalize vertex valence to 6" << std::endl;
 
+    m.end_batch();
 
     // 4) relocate vertices by tangential smoothing
     //
@@ -0,0 +1,752 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/remesh_isotropic.h>
+#include <cinolib/editable_triangle_soup.h>
+#include <cinolib/bvh.h>
+#include <cinolib/parallel_for.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/geometry/triangle_utils.h>
+#include <queue>
+#include <unordered_set>
+#include <algorithm>
+
+namespace cinolib
+{
+
+namespace
+{
+
+struct RemeshEdge
+{
+    double length;
+    uint   a, b;
+    bool operator<(const RemeshEdge & e) const { return length < e.length; }
+    bool operator>(const RemeshEdge & e) const { return length > e.length; }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Working space of the remesher (topology in EditableTriangleSoup). Topological
+// edits only flag dead elements, which are dropped when the mesh is rebuilt
+//
+class RemeshBuffers : public EditableTriangleSoup<RemeshBuffers>
+{
+    public:
+
+        std::vector<vec3d>             pos;       // vertex positions
+        std::vector<vec3d>             nor;       // vertex normals
+        std::vector<double>            len;       // per vertex target edge length
+        std::vector<char>              v_alive;
+        std::vector<char>              v_lock;    // 0: free, 1: along a feature line, 2: feature corner
+        std::vector<char>              t_alive;
+        std::vector<uint>              t_origin;  // input triangle each triangle originates from
+        std::unordered_set<uint64_t>   features;  // boundary, non manifold and marked edges
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        static uint64_t key(const uint a, const uint b)
+        {
+            return (a<b) ? (uint64_t(a)<<32 | b) : (uint64_t(b)<<32 | a);
+        }
+
+        bool is_feature(const uint a, const uint b) const
+        {
+            return features.count(key(a,b))>0;
+        }
+
+        const vec3d & vert(const uint vid) const
+        {
+            return pos[vid];
+        }
+
+        double edge_target(const uint a, const uint b) const
+        {
+            return 0.5*(len[a]+len[b]);
+        }
+
+        int valence_deviation(const uint vid, const int delta) const
+        {
+            int d = int(valence(vid)) + delta - (v_bnd[vid] ? 4 : 6);
+            return d*d;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // gathers (in parallel) all edges for which pred(a,b,length) is true
+        template<typename Pred>
+        std::vector<RemeshEdge> select_edges(Pred pred) const
+        {
+            uint nt = uint(t_alive.size());
+            std::vector<RemeshEdge> e(3*nt);
+            std::vector<char>       ok(3*nt, false);
+            PARALLEL_FOR(0, nt, 1000, [&](uint tid)
+            {
+                if(!t_alive[tid]) return;
+                for(uint i=0; i<3; ++i)
+                {
+                    uint a = tri_vert(tid,i);
+                    uint b = tri_vert(tid,(i+1)%3);
+                    uint t[2];
+                    // interior edges are seen from both sides, boundary edges only from one
+                    if(a>b && edge_tris(a,b,t)!=1) continue;
+                    double l = pos[a].dist(pos[b]);
+                    if(pred(a,b,l))
+                    {
+                        e[3*tid+i]  = {l,a,b};
+                        ok[3*tid+i] = true;
+                    }
+                }
+            });
+            uint n = 0;
+            for(uint i=0; i<e.size(); ++i) if(ok[i]) e[n++] = e[i];
+            e.resize(n);
+            return e;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint split(const uint a, const uint b)
+        {
+            std::vector<uint> e_tris;
+            for(uint tid : v2t[a]) if(tri_has(tid,b)) e_tris.push_back(tid);
+
+            uint vid = uint(pos.size());
+            vec3d n = nor[a] + nor[b];
+            if(n.norm()>0) n.normalize();
+            pos.push_back(0.5*(pos[a]+pos[b]));
+            nor.push_back(n);
+            len.push_back(edge_target(a,b));
+            v_alive.push_back(true);
+            v_bnd.push_back(e_tris.size()==1);
+            v_lock.push_back(0);
+            v2t.push_back(std::vector<uint>());
+
+            if(is_feature(a,b))
+            {
+                features.erase (key(a,b));
+                features.insert(key(a,vid));
+                features.insert(key(vid,b));
+                v_lock.back() = 1;
+            }
+
+            for(uint tid : e_tris)
+            {
+                // tid keeps the half incident to a, and a new triangle takes the half incident to b
+                uint c   = tri_opposite(tid,a,b);
+                uint nid = uint(t_alive.size());
+                for(uint i=0; i<3; ++i) tris.push_back(tri_vert(tid,i));
+                t_alive.push_back(true);
+                t_origin.push_back(t_origin[tid]);
+                tri_replace(nid,a,vid);
+                tri_replace(tid,b,vid);
+                std::replace(v2t[b].begin(), v2t[b].end(), tid, nid);
+                v2t[c].push_back(nid);
+                v2t[vid].push_back(tid);
+                v2t[vid].push_back(nid);
+            }
+            return vid;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // checks whether vertex a can be merged into b, moving b to p, without creating edges longer than max_len
+        bool collapse_is_valid(const uint a, const uint b, const vec3d & p, const double max_len) const
+        {
+            bool b_moves = (p.dist(pos[b])>0);
+            for(uint vid : {a,b})
+            {
+                if(vid==b && !b_moves) continue;
+                for(uint tid : v2t[vid])
+                {
+                    if(tri_has(tid,a) && tri_has(tid,b)) continue;
+                    for(uint i=0; i<3; ++i)
+                    {
+                        uint v = tri_vert(tid,i);
+                        if(v!=vid && p.dist(pos[v]) > max_len) return false;
+                    }
+                }
+            }
+            return EditableTriangleSoup::collapse_is_valid(a,b,p);
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // merges a into b, which is moved to p
+        void collapse(const uint a, const uint b, const vec3d & p)
+        {
+            for(uint tid : v2t[a])
+            {
+                if(!tri_has(tid,b)) continue;
+                t_alive[tid] = false;
+                for(uint i=0; i<3; ++i)
+                {
+                    uint vid = tri_vert(tid,i);
+                    if(vid!=a) remove_tri_from_vert(vid,tid);
+                }
+            }
+            for(uint tid : v2t[a])
+            {
+                if(!t_alive[tid]) continue;
+                for(uint i=0; i<3; ++i)
+                {
+                    uint vid = tri_vert(tid,i);
+                    if(vid==a || vid==b) continue;
+                    if(is_feature(a,vid))
+                    {
+                        features.erase (key(a,vid));
+                        features.insert(key(b,vid));
+                    }
+                }
+                tri_replace(tid,a,b);
+                v2t[b].push_back(tid);
+            }
+            features.erase(key(a,b));
+            v2t[a].clear();
+            v_alive[a] = false;
+            pos[b]     = p;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // if edge (a,b) is flippable, returns the gain in terms of squared valence deviation
+        // and the two incident triangles, ordered so that t0=(a,b,c) and t1=(b,a,d)
+        int flip_gain(const uint a, const uint b, uint & t0, uint & t1, uint & c, uint & d) const
+        {
+            uint t[2];
+            if(edge_tris(a,b,t)!=2) return 0;
+            if(is_feature(a,b)) return 0;
+            t0 = t[0];
+            t1 = t[1];
+            // t0 must contain the oriented edge a->b
+            for(uint i=0; i<3; ++i) if(tri_vert(t0,i)==b && tri_vert(t0,(i+1)%3)==a) std::swap(t0,t1);
+            for(uint i=0; i<3; ++i) if(tri_vert(t0,i)==b && tri_vert(t0,(i+1)%3)==a) return 0; // inconsistent orientation
+            c = tri_opposite(t0,a,b);
+            d = tri_opposite(t1,a,b);
+            if(c==d || edge_exists(c,d)) return 0;
+            if(valence(a)<=3 || valence(b)<=3) return 0;
+
+            int before = valence_deviation(a, 0) + valence_deviation(b, 0) + valence_deviation(c, 0) + valence_deviation(d, 0);
+            int after  = valence_deviation(a,-1) + valence_deviation(b,-1) + valence_deviation(c,+1) + valence_deviation(d,+1);
+            if(after>=before) return 0;
+
+            // new triangles (a,d,c) and (b,c,d) must not fold over
+            vec3d n_old = tri_normal(t0) + tri_normal(t1);
+            vec3d n0    = (pos[d]-pos[a]).cross(pos[c]-pos[a]);
+            vec3d n1    = (pos[c]-pos[b]).cross(pos[d]-pos[b]);
+            if(n0.dot(n1)<=0 || n0.dot(n_old)<=0 || n1.dot(n_old)<=0) return 0;
+            double eps = 1e-10*n_old.norm();
+            if(n0.norm()<=eps || n1.norm()<=eps) return 0;
+
+            return before-after;
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void flip(const uint a, const uint b, const uint t0, const uint t1, const uint c, const uint d)
+        {
+            tris[3*t0] = a; tris[3*t0+1] = d; tris[3*t0+2] = c;
+            tris[3*t1] = b; tris[3*t1+1] = c; tris[3*t1+2] = d;
+            remove_tri_from_vert(a,t1);
+            remove_tri_from_vert(b,t0);
+            v2t[c].push_back(t1);
+            v2t[d].push_back(t0);
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void update_v_normals()
+        {
+            PARALLEL_FOR(0, uint(pos.size()), 1000, [&](uint vid)
+            {
+                if(!v_alive[vid]) return;
+                vec3d n(0,0,0);
+                for(uint tid : v2t[vid]) n += tri_normal(tid); // area weighted
+                if(n.norm()>0) n.normalize();
+                nor[vid] = n;
+            });
+        }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint split_long_edges(RemeshBuffers & rb)
+{
+    // longest first: every split halves the longest edge, and children are re-inserted if still too long
+    std::priority_queue<RemeshEdge> q(std::less<RemeshEdge>(), rb.select_edges([&](uint a, uint b, double l)
+    {
+        return l > 4./3.*rb.edge_target(a,b);
+    }));
+
+    uint count = 0;
+    while(!q.empty())
+    {
+        RemeshEdge e = q.top();
+        q.pop();
+        if(!rb.edge_exists(e.a,e.b)) continue; // already split
+
+        uint vid = rb.split(e.a,e.b);
+        ++count;
+
+        for(uint tid : rb.v2t[vid])
+        for(uint i=0; i<3; ++i)
+        {
+            uint nbr = rb.tri_vert(tid,i);
+            if(nbr==vid) continue;
+            double l = rb.pos[vid].dist(rb.pos[nbr]);
+            if(l > 4./3.*rb.edge_target(vid,nbr)) q.push({l,vid,nbr});
+        }
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint collapse_short_edges(RemeshBuffers & rb)
+{
+    // shortest first. Edges change length as verts move, so queue entries are validated when popped
+    std::priority_queue<RemeshEdge,std::vector<RemeshEdge>,std::greater<RemeshEdge>> q(std::greater<RemeshEdge>(), rb.select_edges([&](uint a, uint b, double l)
+    {
+        return l < 4./5.*rb.edge_target(a,b);
+    }));
+
+    uint count = 0;
+    while(!q.empty())
+    {
+        RemeshEdge e = q.top();
+        q.pop();
+        if(!rb.v_alive[e.a] || !rb.v_alive[e.b] || !rb.edge_exists(e.a,e.b)) continue;
+        double target = rb.edge_target(e.a,e.b);
+        double l      = rb.pos[e.a].dist(rb.pos[e.b]);
+        if(l >= 4./5.*target) continue;
+
+        // feature verts stay where they are: free verts merge into feature verts, and feature
+        // verts can only merge along the feature line they belong to. Corners never move
+        uint  a = e.a;
+        uint  b = e.b;
+        if(rb.v_lock[a]>rb.v_lock[b]) std::swap(a,b);
+        bool  feat = rb.is_feature(a,b);
+        vec3d p    = 0.5*(rb.pos[a]+rb.pos[b]);
+        if(rb.v_lock[a]==2) continue;
+        if(rb.v_lock[a]==1 && !feat) continue;
+        if(rb.v_lock[a]==0 && feat) continue;
+        if(rb.v_lock[b]>0) p = rb.pos[b];
+        if(!rb.collapse_is_valid(a, b, p, 4./3.*target))
+        {
+            if(rb.v_lock[b]>0 && rb.v_lock[a]==rb.v_lock[b])
+            {
+                std::swap(a,b); // try the other way around
+                p = rb.pos[b];
+                if(!rb.collapse_is_valid(a, b, p, 4./3.*target)) continue;
+            }
+            else continue;
+        }
+
+        if(rb.v_lock[b]==0) rb.len[b] = target;
+        rb.collapse(a,b,p);
+        ++count;
+
+        for(uint tid : rb.v2t[b])
+        for(uint i=0; i<3; ++i)
+        {
+            uint nbr = rb.tri_vert(tid,i);
+            if(nbr==b) continue;
+            double l = rb.pos[b].dist(rb.pos[nbr]);
+            if(l < 4./5.*rb.edge_target(b,nbr)) q.push({l,b,nbr});
+        }
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint equalize_valences(RemeshBuffers & rb, const uint max_rounds = 10)
+{
+    struct Flip { uint a, b, t0, t1, c, d; };
+
+    uint count = 0;
+    uint nt    = uint(rb.t_alive.size());
+    std::vector<int>  gain(3*nt, 0);
+    std::vector<char> busy (rb.pos.size(), false);
+    std::vector<char> dirty(rb.pos.size(), true);
+    for(uint round=0; round<max_rounds; ++round)
+    {
+        // evaluate edges in parallel. Each interior edge is seen from both its triangles,
+        // and evaluated only from the one where it appears as (a,b) with a<b. After the first
+        // round, only edges close to previous flips may have changed their gain
+        PARALLEL_FOR(0, nt, 1000, [&](uint tid)
+        {
+            if(!rb.t_alive[tid]) return;
+            for(uint i=0; i<3; ++i)
+            {
+                uint a = rb.tri_vert(tid,i);
+                uint b = rb.tri_vert(tid,(i+1)%3);
+                uint t0, t1, c, d;
+                if(a>b) gain[3*tid+i] = 0; else
+                if(dirty[a] || dirty[b]) gain[3*tid+i] = rb.flip_gain(a,b,t0,t1,c,d);
+            }
+        });
+
+        // greedily select an independent set of flips (no shared verts), best gain first
+        int max_gain = 0;
+        for(int g : gain) max_gain = std::max(max_gain,g);
+        if(max_gain==0) break;
+        std::vector<Flip> flips;
+        for(int g=max_gain; g>0; --g)
+        for(uint i=0; i<gain.size(); ++i)
+        {
+            if(gain[i]!=g) continue;
+            Flip f;
+            f.a = rb.tri_vert(i/3, i%3);
+            f.b = rb.tri_vert(i/3, (i%3+1)%3);
+            if(busy[f.a] || busy[f.b]) continue;
+            rb.flip_gain(f.a, f.b, f.t0, f.t1, f.c, f.d);
+            if(busy[f.c] || busy[f.d]) continue;
+            busy[f.a] = busy[f.b] = busy[f.c] = busy[f.d] = true;
+            flips.push_back(f);
+        }
+
+        // flips in the set touch disjoint verts and triangles, and can be applied concurrently
+        PARALLEL_FOR(0, uint(flips.size()), 1000, [&](uint i)
+        {
+            const Flip & f = flips.at(i);
+            rb.flip(f.a, f.b, f.t0, f.t1, f.c, f.d);
+        });
+
+        // gains depend on the valence of the endpoints and of the opposite verts, hence edges
+        // to be re-evaluated are those incident to triangles that touch a flipped vertex
+        std::fill(dirty.begin(), dirty.end(), false);
+        for(const Flip & f : flips)
+        for(uint vid : {f.a, f.b, f.c, f.d})
+        for(uint tid : rb.v2t[vid])
+        for(uint i=0; i<3; ++i)
+        {
+            dirty[rb.tri_vert(tid,i)] = true;
+        }
+        for(const Flip & f : flips) busy[f.a] = busy[f.b] = busy[f.c] = busy[f.d] = false;
+        count += uint(flips.size());
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void tangential_relaxation(      RemeshBuffers       & rb,
+                           const Trimesh<M,V,E,P>    & m,
+                           const BVH                 & bvh,
+                           const std::vector<double> & sizing, // per vertex target length on m (empty if uniform)
+                           const bool                  reproject)
+{
+    rb.update_v_normals();
+
+    // Jacobi style: all verts move towards the centroid of their neighbors at once
+    std::vector<vec3d> new_pos(rb.pos.size());
+    PARALLEL_FOR(0, uint(rb.pos.size()), 1000, [&](uint vid)
+    {
+        new_pos[vid] = rb.pos[vid];
+        if(!rb.v_alive[vid] || rb.v_lock[vid]>0) return;
+
+        vec3d c(0,0,0);
+        uint  n = 0;
+        for(uint tid : rb.v2t[vid])
+        for(uint i=0; i<3; ++i)
+        {
+            uint nbr = rb.tri_vert(tid,i);
+            if(nbr==vid) continue;
+            c += rb.pos[nbr]; // interior verts: each neighbor is counted twice, uniform weights anyways
+            ++n;
+        }
+        if(n==0) return;
+        vec3d d = c/double(n) - rb.pos[vid];
+        new_pos[vid] += d - rb.nor[vid]*rb.nor[vid].dot(d);
+    });
+
+    if(!reproject && sizing.empty())
+    {
+        rb.pos.swap(new_pos);
+        return;
+    }
+
+    PARALLEL_FOR(0, uint(rb.pos.size()), 1000, [&](uint vid)
+    {
+        if(!rb.v_alive[vid] || rb.v_lock[vid]>0) return;
+        uint   pid;
+        vec3d  p;
+        double dist;
+        bvh.closest_point(new_pos[vid], pid, p, dist);
+        if(reproject) new_pos[vid] = p;
+        if(!sizing.empty())
+        {
+            double w[3];
+            triangle_barycentric_coords(m.poly_vert(pid,0), m.poly_vert(pid,1), m.poly_vert(pid,2), p, w);
+            double l = 0;
+            for(uint i=0; i<3; ++i) l += std::max(0.0,w[i]) * sizing.at(m.poly_vert_id(pid,i));
+            double w_sum = std::max(0.0,w[0]) + std::max(0.0,w[1]) + std::max(0.0,w[2]);
+            if(w_sum>0) rb.len[vid] = l/w_sum;
+        }
+    });
+    rb.pos.swap(new_pos);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Per vertex target edge length, such that edges deviate from a surface with max curvature k
+// at most eps. Curvature is estimated as max_j |2 n_i*(p_j - p_i)| / |p_j - p_i|^2
+//
+template<class M, class V, class E, class P>
+CINO_INLINE
+std::vector<double> curvature_sizing(const Trimesh<M,V,E,P> & m,
+                                     const double             target,
+                                     const RemeshOptions    & opt)
+{
+    std::vector<double> k(m.num_verts(),0);
+    PARALLEL_FOR(0, m.num_verts(), 1000, [&](uint vid)
+    {
+        const vec3d & n = m.vert_data(vid).normal;
+        for(uint nbr : m.adj_v2v(vid))
+        {
+            vec3d  d  = m.vert(nbr) - m.vert(vid);
+            double l2 = d.dot(d);
+            if(l2>0) k.at(vid) = std::max(k.at(vid), std::fabs(2.0*n.dot(d))/l2);
+        }
+    });
+
+    // smooth out noise
+    for(uint it=0; it<2; ++it)
+    {
+        std::vector<double> tmp(k.size());
+        PARALLEL_FOR(0, m.num_verts(), 1000, [&](uint vid)
+        {
+            double s = k.at(vid);
+            for(uint nbr : m.adj_v2v(vid)) s += k.at(nbr);
+            tmp.at(vid) = s/double(m.adj_v2v(vid).size()+1);
+        });
+        k.swap(tmp);
+    }
+
+    double min_l = (opt.min_edge_length>0) ? opt.min_edge_length : 0.2*target;
+    double max_l = (opt.max_edge_length>0) ? opt.max_edge_length : 5.0*target;
+    double eps   = opt.approx_error;
+    if(eps<=0)
+    {
+        // pick eps so that verts with median curvature get the target length
+        std::vector<double> tmp = k;
+        std::nth_element(tmp.begin(), tmp.begin()+tmp.size()/2, tmp.end());
+        double km = tmp.at(tmp.size()/2);
+        double x  = 1.0 - km*km*target*target/3.0;
+        eps = (km<=0) ? 0 : ((x>0) ? (1.0-std::sqrt(x))/km : 1.0/km);
+    }
+
+    std::vector<double> sizing(m.num_verts());
+    for(uint vid=0; vid<m.num_verts(); ++vid)
+    {
+        double l = max_l;
+        if(k.at(vid)>0)
+        {
+            double l2 = 6.0*eps/k.at(vid) - 3.0*eps*eps;
+            l = (l2>0) ? std::sqrt(l2) : min_l;
+        }
+        sizing.at(vid) = std::min(max_l, std::max(min_l, l));
+    }
+    return sizing;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void edge_length_stats(const RemeshBuffers & rb, RemeshStats & stats)
+{
+    double sum = 0, sum_sqrd = 0;
+    uint   in_range = 0;
+    std::vector<RemeshEdge> edges = rb.select_edges([](uint, uint, double){ return true; });
+    for(const RemeshEdge & e : edges)
+    {
+        double r  = e.length / rb.edge_target(e.a,e.b);
+        sum      += r;
+        sum_sqrd += r*r;
+        if(r>=4./5. && r<=4./3.) ++in_range;
+    }
+    uint n = uint(edges.size());
+    if(n==0) return;
+    stats.avg_edge_length = sum/n;
+    stats.std_edge_length = std::sqrt(std::max(0.0, sum_sqrd/n - stats.avg_edge_length*stats.avg_edge_length));
+    stats.in_range        = double(in_range)/n;
+    stats.n_polys         = 0;
+    stats.n_verts         = 0;
+    for(char alive : rb.t_alive) if(alive) ++stats.n_polys;
+    for(char alive : rb.v_alive) if(alive) ++stats.n_verts;
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+std::vector<RemeshStats> remesh_isotropic(Trimesh<M,V,E,P>    & m,
+                                          const RemeshOptions & opt)
+{
+    typedef std::chrono::steady_clock Time;
+
+    std::vector<RemeshStats> stats;
+    if(m.num_polys()==0) return stats;
+
+    double target = (opt.target_edge_length>0) ? opt.target_edge_length : m.edge_avg_length();
+
+    // input surface, for reprojection and sizing
+    std::vector<double> sizing;
+    if(opt.adaptive) sizing = curvature_sizing(m, target, opt);
+    BVH bvh;
+    if(opt.reproject || opt.adaptive) bvh.build_from_mesh_polys(m);
+
+    RemeshBuffers rb;
+    rb.pos      = m.vector_verts();
+    rb.nor.resize(m.num_verts());
+    rb.len      = (opt.adaptive) ? sizing : std::vector<double>(m.num_verts(), target);
+    rb.v_alive  = std::vector<char>(m.num_verts(), true);
+    rb.v_bnd    = std::vector<char>(m.num_verts(), false);
+    rb.v_lock   = std::vector<char>(m.num_verts(), 0);
+    rb.v2t      = std::vector<std::vector<uint>>(m.num_verts());
+    rb.tris     = serialized_vids_from_polys(m.vector_polys());
+    rb.t_alive  = std::vector<char>(m.num_polys(), true);
+    rb.t_origin.resize(m.num_polys());
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        rb.t_origin.at(pid) = pid;
+        for(uint vid : m.adj_p2v(pid)) rb.v2t.at(vid).push_back(pid);
+    }
+    std::vector<uint> n_feat(m.num_verts(),0);
+    for(uint eid=0; eid<m.num_edges(); ++eid)
+    {
+        // boundary and non manifold edges are always preserved
+        if(m.edge_is_boundary(eid) || !m.edge_is_manifold(eid) ||
+           (opt.preserve_features && m.edge_data(eid).flags[MARKED]))
+        {
+            uint v0 = m.edge_vert_id(eid,0);
+            uint v1 = m.edge_vert_id(eid,1);
+            rb.features.insert(RemeshBuffers::key(v0,v1));
+            ++n_feat.at(v0);
+            ++n_feat.at(v1);
+        }
+    }
+    for(uint vid=0; vid<m.num_verts(); ++vid)
+    {
+        rb.v_bnd.at(vid) = m.vert_is_boundary(vid);
+        if(n_feat.at(vid)==2) rb.v_lock.at(vid) = 1;
+        if(n_feat.at(vid)==1 || n_feat.at(vid)>2 || !m.vert_is_manifold(vid)) rb.v_lock.at(vid) = 2;
+    }
+    rb.update_v_normals();
+
+    for(uint it=0; it<opt.n_iters; ++it)
+    {
+        Time::time_point t0 = Time::now();
+
+        RemeshStats s;
+        s.n_splits    = split_long_edges(rb);
+        s.n_collapses = collapse_short_edges(rb);
+        s.n_flips     = equalize_valences(rb);
+        tangential_relaxation(rb, m, bvh, sizing, opt.reproject);
+        edge_length_stats(rb, s);
+
+        Time::time_point t1 = Time::now();
+        s.seconds = how_many_seconds(t0,t1);
+        stats.push_back(s);
+
+        if(opt.verbose)
+        {
+            std::cout << "remesh iter " << it << "\t"
+                      << s.n_splits    << " splits / "
+                      << s.n_collapses << " collapses / "
+                      << s.n_flips     << " flips\t"
+                      << s.n_verts     << "V / " << s.n_polys << "P\t"
+                      << "edge length " << s.avg_edge_length << " +/- " << s.std_edge_length << " (target 1), "
+                      << 100.0*s.in_range << "% in [4/5,4/3]\t"
+                      << "[" << s.seconds << "s]" << std::endl;
+        }
+
+        if(s.n_splits+s.n_collapses+s.n_flips <= opt.min_change*s.n_polys) break; // converged
+    }
+
+    // rebuild the mesh, dropping dead elements
+    std::vector<int>   v_map(rb.pos.size(), -1);
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    std::vector<uint>  origin;
+    for(uint tid=0; tid<rb.t_alive.size(); ++tid)
+    {
+        if(!rb.t_alive.at(tid)) continue;
+        for(uint i=0; i<3; ++i)
+        {
+            uint vid = rb.tri_vert(tid,i);
+            if(v_map.at(vid)<0)
+            {
+                v_map.at(vid) = int(verts.size());
+                verts.push_back(rb.pos.at(vid));
+            }
+            tris.push_back(uint(v_map.at(vid)));
+        }
+        origin.push_back(rb.t_origin.at(tid));
+    }
+    std::vector<P> p_data(m.num_polys());
+    for(uint pid=0; pid<m.num_polys(); ++pid) p_data.at(pid) = m.poly_data(pid);
+
+    M m_data = m.mesh_data();
+    m.clear();
+    m.mesh_data() = m_data;
+    m.init(verts, polys_from_serialized_vids(tris,3));
+
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        vec3d n = m.poly_data(pid).normal;
+        m.poly_data(pid) = p_data.at(origin.at(pid));
+        m.poly_data(pid).normal = n;
+    }
+    for(uint64_t k : rb.features)
+    {
+        int v0 = v_map.at(uint(k>>32));
+        int v1 = v_map.at(uint(k & 0xFFFFFFFF));
+        if(v0<0 || v1<0) continue;
+        int eid = m.edge_id(uint(v0),uint(v1));
+        if(eid>=0) m.edge_data(eid).flags[MARKED] = true;
+    }
+    return stats;
+}
+
+}
@@ -0,0 +1,125 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_REMESH_ISOTROPIC_H
+#define CINO_REMESH_ISOTROPIC_H
+
+#include <cinolib/meshes/trimesh.h>
+
+namespace cinolib
+{
+
+/* Isotropic remeshing of a triangle mesh, in the spirit of:
+ *
+ *   A Remeshing Approach to Multiresolution Modeling
+ *   M.Botsch, L.Kobbelt
+ *   Symposium on Geomtry Processing, 2004
+ *
+ * Differently from remesh_Botsch_Kobbelt_2004, which performs a single iteration
+ * directly on the mesh, this is a complete remesher meant for large inputs. Each
+ * iteration:
+ *
+ *  - splits edges longer than 4/3 of the target length, longest first;
+ *  - collapses edges shorter than 4/5 of the target length, shortest first, unless
+ *    this creates edges longer than 4/3 of the target, folds or non manifold configurations;
+ *  - flips edges to drive vertex valence towards 6 (4 on the boundary). Flips are
+ *    evaluated in parallel, and applied in parallel on independent sets of edges
+ *    that do not share any vertex;
+ *  - relaxes vertices in their tangent plane (in parallel, Jacobi style), and
+ *    projects them back onto the input surface with a BVH.
+ *
+ * The target length can be adapted to the local curvature, so that the distance
+ * between each edge and the surface stays below a tolerance eps. As in:
+ *
+ *   Adaptive Remeshing for Real-Time Mesh Deformation
+ *   J.Dunyach, D.Vanderhaeghe, L.Barthe, M.Botsch
+ *   Eurographics 2013 (short papers)
+ *
+ * the edge length at a vertex with max curvature k is sqrt(6*eps/k - 3*eps^2).
+ *
+ * Boundary edges, non manifold edges and (optionally) edges marked as features
+ * are preserved, and their endpoints are held in place. Edges generated by the
+ * split of a feature edge are features too.
+ *
+ * Editing is done on compact internal buffers, and the mesh is rebuilt only once
+ * at the end. Per polygon attributes are inherited from the input polygon each
+ * new polygon originates from. Per vertex and per edge attributes are not preserved,
+ * except for the MARKED flag on feature edges.
+*/
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct RemeshOptions
+{
+    double target_edge_length = 0;     // if <=0 the average edge length of the input mesh is used
+    uint   n_iters            = 10;    // max # of iterations
+    double min_change         = 1e-3;  // stop when an iteration edits less than this fraction of the triangles
+    bool   preserve_features  = true;  // preserve edges marked in the input mesh (and their endpoints)
+    bool   reproject          = true;  // project vertices back onto the input surface after each relaxation
+    bool   adaptive           = false; // adapt edge length to the local curvature
+    double approx_error       = 0;     // max distance from the surface for adaptive edges. If <=0, the median curvature maps to the target length
+    double min_edge_length    = 0;     // shortest adaptive edge. If <=0, 1/5 of the target length
+    double max_edge_length    = 0;     // longest  adaptive edge. If <=0, 5x the target length
+    bool   verbose            = false; // print per iteration stats
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct RemeshStats
+{
+    uint   n_splits        = 0;
+    uint   n_collapses     = 0;
+    uint   n_flips         = 0;
+    uint   n_verts         = 0;
+    uint   n_polys         = 0;
+    double avg_edge_length = 0; // relative to the target length (1 means on target)
+    double std_edge_length = 0; // standard deviation of the relative edge length
+    double in_range        = 0; // fraction of edges with length within [4/5,4/3] of the target
+    double seconds         = 0;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+std::vector<RemeshStats> remesh_isotropic(Trimesh<M,V,E,P>    & m,
+                                          const RemeshOptions & opt = RemeshOptions());
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "remesh_isotropic.cpp"
+#endif
+
+#endif // CINO_REMESH_ISOTROPIC_H
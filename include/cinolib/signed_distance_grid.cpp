@@ -0,0 +1,528 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2022: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/signed_distance_grid.h>
+#include <cinolib/fast_winding_number.h>
+#include <cinolib/geometry/triangle_utils.h>
+#include <cinolib/serialize_index.h>
+#include <cinolib/parallel_for.h>
+#include <algorithm>
+#include <limits>
+#include <stack>
+
+namespace cinolib
+{
+
+CINO_INLINE
+double SignedDistanceGrid::value(const uint i, const uint j, const uint k) const
+{
+    assert(i<dim[0] && j<dim[1] && k<dim[2]);
+    if(!is_sparse()) return values[serialize_3D_index(i,j,k,dim[1],dim[2])];
+    uint s = slots[serialize_3D_index(i>>SVG_BRICK_BITS, j>>SVG_BRICK_BITS, k>>SVG_BRICK_BITS, bdim[1], bdim[2])];
+    if(s & SVG_TILE) return (s & ~SVG_TILE) ? -band : band;
+    const uint m = SVG_BRICK_SIDE-1;
+    return values[size_t(s)*SVG_BRICK_SIZE + serialize_3D_index(i&m, j&m, k&m, SVG_BRICK_SIDE, SVG_BRICK_SIDE)];
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double SignedDistanceGrid::sample(const vec3d & p) const
+{
+    // cell containing p, and local coordinates of p within the cell
+    uint   c[3];
+    double t[3];
+    for(uint i=0; i<3; ++i)
+    {
+        double x = std::min(std::max((p[i]-bbox.min[i])/len, 0.0), double(dim[i]-1));
+        c[i] = std::min(uint(x), (dim[i]>1) ? dim[i]-2 : 0);
+        t[i] = std::min(x-c[i], 1.0);
+    }
+    uint c1[3];
+    for(uint i=0; i<3; ++i) c1[i] = std::min(c[i]+1, dim[i]-1);
+
+    double v00 = value(c[0],c [1],c[2])*(1-t[2]) + value(c[0],c [1],c1[2])*t[2];
+    double v01 = value(c[0],c1[1],c[2])*(1-t[2]) + value(c[0],c1[1],c1[2])*t[2];
+    double v10 = value(c1[0],c [1],c[2])*(1-t[2]) + value(c1[0],c [1],c1[2])*t[2];
+    double v11 = value(c1[0],c1[1],c[2])*(1-t[2]) + value(c1[0],c1[1],c1[2])*t[2];
+    double v0  = v00*(1-t[1]) + v01*t[1];
+    double v1  = v10*(1-t[1]) + v11*t[1];
+    return v0*(1-t[0]) + v1*t[0];
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t SignedDistanceGrid::memory_usage() const
+{
+    return sizeof(SignedDistanceGrid)          +
+           values.capacity() * sizeof(float) +
+           slots.capacity()  * sizeof(uint);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SignedDistanceGrid::to_dense(std::vector<double> & v) const
+{
+    v.resize(num_nodes());
+    PARALLEL_FOR(0, dim[0], 16, [&](uint i)
+    {
+        for(uint j=0; j<dim[1]; ++j)
+        for(uint k=0; k<dim[2]; ++k)
+        {
+            v[serialize_3D_index(i,j,k,dim[1],dim[2])] = value(i,j,k);
+        }
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+/* Parallel fast sweeping. The grid is swept along the 8 diagonal directions. Each sweep
+ * visits the bricks of 8x8x8 nodes one plane bi+bj+bk=const at a time, and sweeps the nodes
+ * of each brick serially, in the same direction. Bricks in the same plane are not adjacent,
+ * hence they are processed in parallel, and all the upwind neighbors of a node are updated
+ * before it, as in the serial sweep. Compared to visiting the nodes one plane i+j+k=const at
+ * a time this keeps memory accesses local. Frozen nodes are never changed, and far nodes take
+ * the sign of the neighbor they inherit their distance from. Sweeps are repeated until
+ * convergence.
+*/
+CINO_INLINE
+void fast_sweeping(const uint                   dim[3],
+                   const double                 len,
+                   const std::vector<uint8_t> & frozen,
+                         std::vector<float>   & u)
+{
+    const float  inf = std::numeric_limits<float>::infinity();
+    const double tol = 1e-3*len; // far below the first order accuracy of the scheme
+    const int    n[3] = { int(dim[0]), int(dim[1]), int(dim[2]) };
+
+    const uint stride[3] = { dim[1]*dim[2], dim[2], 1 };
+
+    // Godunov upwind update of node (i,j,k). Returns true if its value changed
+    auto update = [&](const int i, const int j, const int k) -> bool
+    {
+        uint id = i*stride[0] + j*stride[1] + k;
+        if(frozen[id]) return false;
+
+        const int ijk[3] = { i, j, k };
+        double a[3];
+        float  sign = 1;
+        double best = inf;
+        for(uint d=0; d<3; ++d)
+        {
+            float v0 = (ijk[d]>0)      ? u[id-stride[d]] : inf;
+            float v1 = (ijk[d]<n[d]-1) ? u[id+stride[d]] : inf;
+            float v  = (std::fabs(v0)<std::fabs(v1)) ? v0 : v1;
+            a[d] = std::fabs(v);
+            if(a[d]<best)
+            {
+                best = a[d];
+                sign = (v<0) ? -1.f : 1.f;
+            }
+        }
+        if(best==inf) return false;
+        // quick exit: the update is never smaller than best + len/sqrt(3)
+        if(std::fabs(u[id]) - tol <= best + 0.577*len) return false;
+
+        std::sort(a, a+3);
+        double h = len;
+        double x = a[0] + h;
+        if(x > a[1])
+        {
+            x = 0.5*(a[0] + a[1] + sqrt(2*h*h - (a[0]-a[1])*(a[0]-a[1])));
+            if(x > a[2])
+            {
+                double s = a[0] + a[1] + a[2];
+                double q = a[0]*a[0] + a[1]*a[1] + a[2]*a[2] - h*h;
+                x = (s + sqrt(std::max(s*s - 3*q, 0.0)))/3.0;
+            }
+        }
+        // compare the stored (float) value, or rounding may trigger endless updates
+        float xf = float(x);
+        if(xf < std::fabs(u[id]) - tol)
+        {
+            u[id] = sign*xf;
+            return true;
+        }
+        return false;
+    };
+
+    const uint S     = SVG_BRICK_SIDE;
+    const int  nb[3] = { int((dim[0]+S-1)/S), int((dim[1]+S-1)/S), int((dim[2]+S-1)/S) };
+    const int  n_levels = nb[0] + nb[1] + nb[2] - 2;
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+        for(uint dir=0; dir<8; ++dir)
+        {
+            // maps sweep coordinates to grid coordinates
+            auto flip = [&](const int x, const uint d) { return (dir & (1u<<d)) ? n[d]-1-x : x; };
+
+            for(int L=0; L<n_levels; ++L)
+            {
+                int i_beg = std::max(0, L-(nb[1]-1)-(nb[2]-1));
+                int i_end = std::min(nb[0]-1, L);
+                changed |= PARALLEL_REDUCE(uint(i_beg), uint(i_end+1), 2, 1, false, [&](uint bi) -> bool
+                {
+                    bool c = false;
+                    int  j_beg = std::max(0, L-int(bi)-(nb[2]-1));
+                    int  j_end = std::min(nb[1]-1, L-int(bi));
+                    for(int bj=j_beg; bj<=j_end; ++bj)
+                    {
+                        int bk = L-int(bi)-bj;
+                        for(int i=int(bi*S); i<std::min(int(bi+1)*int(S),n[0]); ++i)
+                        for(int j=int(bj*S); j<std::min(int(bj+1)*int(S),n[1]); ++j)
+                        for(int k=int(bk*S); k<std::min(int(bk+1)*int(S),n[2]); ++k)
+                        {
+                            c |= update(flip(i,0), flip(j,1), flip(k,2));
+                        }
+                    }
+                    return c;
+                },
+                [](bool a, bool b){ return a || b; });
+            }
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Signs the tiles of a sparse grid. Tiles adjacent to a brick take the sign of the brick
+// node across their shared face, and flood the tiles they touch. Tiles that cannot be
+// reached from any brick (e.g. the surface does not cross the grid) query the winding number
+CINO_INLINE
+void sign_tiles(SignedDistanceGrid & g, const FastWindingNumber & fwn)
+{
+    const uint S = SVG_BRICK_SIDE;
+    const uint nb[3] = { g.bdim[0], g.bdim[1], g.bdim[2] };
+    const uint unknown = SVG_TILE | 2;
+
+    std::stack<uint> front;
+    auto flood = [&]()
+    {
+        while(!front.empty())
+        {
+            uint  sid = front.top();
+            front.pop();
+            vec3u b = deserialize_3D_index(sid, nb[1], nb[2]);
+            for(uint d=0; d<3; ++d)
+            for(int off : { -1, 1 })
+            {
+                vec3u c = b;
+                if((off<0 && c[d]==0) || (off>0 && c[d]+1==nb[d])) continue;
+                c[d] += off;
+                uint nid = serialize_3D_index(c[0], c[1], c[2], nb[1], nb[2]);
+                if(g.slots[nid]!=unknown) continue;
+                g.slots[nid] = g.slots[sid];
+                front.push(nid);
+            }
+        }
+    };
+
+    for(uint & s : g.slots) if(s & SVG_TILE) s = unknown;
+
+    // seeds: tiles next to a brick
+    for(uint sid=0; sid<g.slots.size(); ++sid)
+    {
+        uint s = g.slots[sid];
+        if(s & SVG_TILE) continue;
+        vec3u b = deserialize_3D_index(sid, nb[1], nb[2]);
+        for(uint d=0; d<3; ++d)
+        for(int off : { -1, 1 })
+        {
+            vec3u c = b;
+            if((off<0 && c[d]==0) || (off>0 && c[d]+1==nb[d])) continue;
+            c[d] += off;
+            uint nid = serialize_3D_index(c[0], c[1], c[2], nb[1], nb[2]);
+            if(g.slots[nid]!=unknown) continue;
+            // brick node on the shared face (the face center, clamped to the grid)
+            vec3u v;
+            for(uint e=0; e<3; ++e) v[e] = std::min(b[e]*S + S/2, g.dim[e]-1) - b[e]*S;
+            v[d] = (off>0) ? S-1 : 0;
+            float x = g.values[size_t(s)*SVG_BRICK_SIZE + serialize_3D_index(v[0], v[1], v[2], S, S)];
+            g.slots[nid] = SVG_TILE | ((x<0) ? 1 : 0);
+            front.push(nid);
+        }
+    }
+    flood();
+
+    for(uint sid=0; sid<g.slots.size(); ++sid)
+    {
+        if(g.slots[sid]!=unknown) continue;
+        vec3u b = deserialize_3D_index(sid, nb[1], nb[2]) * S;
+        g.slots[sid] = SVG_TILE | (fwn.is_inside(g.node(b[0],b[1],b[2])) ? 1 : 0);
+        front.push(sid);
+        flood();
+    }
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+SignedDistanceGrid signed_distance_grid(const AbstractPolygonMesh<M,V,E,P> & m,
+                                        const AABB                         & bbox,
+                                        const uint                           res,
+                                        const SignedDistanceOptions        & opt)
+{
+    assert(res>0);
+    const uint S = SVG_BRICK_SIDE;
+
+    SignedDistanceGrid g;
+    g.bbox = bbox;
+    g.len  = bbox.delta().max_entry()/res;
+    g.band = std::max(opt.band, 1.0)*g.len;
+    for(uint i=0; i<3; ++i)
+    {
+        g.dim [i] = uint(ceil(bbox.delta()[i]/g.len)) + 1;
+        g.bdim[i] = (g.dim[i] + S - 1) >> SVG_BRICK_BITS;
+    }
+
+    std::vector<uint> tris;
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        const std::vector<uint> & tess = m.poly_tessellation(pid);
+        tris.insert(tris.end(), tess.begin(), tess.end());
+    }
+    const uint n_tris = uint(tris.size()/3);
+    FastWindingNumber fwn(m.vector_verts(), tris, opt.beta);
+
+    // range [beg,end) of nodes that are closer than band to the bounding box of a triangle
+    auto node_range = [&](const uint tid, vec3u & beg, vec3u & end) -> bool
+    {
+        vec3d mn = m.vert(tris[3*tid]).min(m.vert(tris[3*tid+1])).min(m.vert(tris[3*tid+2]));
+        vec3d mx = m.vert(tris[3*tid]).max(m.vert(tris[3*tid+1])).max(m.vert(tris[3*tid+2]));
+        for(uint i=0; i<3; ++i)
+        {
+            double b = (mn[i] - g.band - bbox.min[i])/g.len;
+            double e = (mx[i] + g.band - bbox.min[i])/g.len;
+            beg[i] = uint(std::min(std::max(ceil (b),   0.0), double(g.dim[i])));
+            end[i] = uint(std::min(std::max(floor(e)+1, 0.0), double(g.dim[i])));
+            if(beg[i]>=end[i]) return false;
+        }
+        return true;
+    };
+
+    // bin triangles into the bricks of nodes they are close to, as pairs (slot,tid)
+    uint chunk    = 1024;
+    uint n_chunks = (n_tris+chunk-1)/chunk;
+    std::vector<std::vector<uint64_t>> bins(n_chunks);
+    PARALLEL_FOR(0, n_chunks, 1, [&](uint c)
+    {
+        for(uint tid=c*chunk; tid<std::min(n_tris,(c+1)*chunk); ++tid)
+        {
+            vec3u beg, end;
+            if(!node_range(tid, beg, end)) continue;
+            for(uint i=beg[0]>>SVG_BRICK_BITS; i<=(end[0]-1)>>SVG_BRICK_BITS; ++i)
+            for(uint j=beg[1]>>SVG_BRICK_BITS; j<=(end[1]-1)>>SVG_BRICK_BITS; ++j)
+            for(uint k=beg[2]>>SVG_BRICK_BITS; k<=(end[2]-1)>>SVG_BRICK_BITS; ++k)
+            {
+                bins[c].push_back(uint64_t(serialize_3D_index(i,j,k,g.bdim[1],g.bdim[2])) << 32 | tid);
+            }
+        }
+    });
+    std::vector<uint64_t> pairs;
+    for(auto & b : bins)
+    {
+        pairs.insert(pairs.end(), b.begin(), b.end());
+        std::vector<uint64_t>().swap(b);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    std::vector<uint> brick_beg;
+    for(uint i=0; i<pairs.size(); ++i)
+    {
+        if(i==0 || (pairs[i]>>32)!=(pairs[i-1]>>32)) brick_beg.push_back(i);
+    }
+    uint n_bricks = uint(brick_beg.size());
+    brick_beg.push_back(uint(pairs.size()));
+
+    std::vector<uint8_t> frozen;
+    if(opt.sparse)
+    {
+        g.slots.assign(size_t(g.bdim[0])*g.bdim[1]*g.bdim[2], SVG_TILE);
+        g.values.resize(size_t(n_bricks)*SVG_BRICK_SIZE);
+        for(uint bid=0; bid<n_bricks; ++bid) g.slots[pairs[brick_beg[bid]]>>32] = bid;
+    }
+    else
+    {
+        g.values.assign(g.num_nodes(), std::numeric_limits<float>::infinity());
+        frozen.assign(g.num_nodes(), false);
+    }
+
+    // exact distances within the band. Each brick is processed by a single thread, hence no locks are needed
+    PARALLEL_FOR(0, n_bricks, 16, 1, [&](uint bid)
+    {
+        vec3u  b = deserialize_3D_index(uint(pairs[brick_beg[bid]]>>32), g.bdim[1], g.bdim[2]) * S;
+        double d2[SVG_BRICK_SIZE];
+        std::fill_n(d2, SVG_BRICK_SIZE, g.band*g.band);
+
+        for(uint p=brick_beg[bid]; p<brick_beg[bid+1]; ++p)
+        {
+            uint  tid = uint(pairs[p] & 0xFFFFFFFF);
+            vec3u beg, end;
+            if(!node_range(tid, beg, end)) continue;
+            const vec3d & A = m.vert(tris[3*tid  ]);
+            const vec3d & B = m.vert(tris[3*tid+1]);
+            const vec3d & C = m.vert(tris[3*tid+2]);
+            // bounding sphere of the triangle, used to skip nodes that already have a closer triangle
+            vec3d  c = (A+B+C)/3.0;
+            double r = sqrt(std::max({c.dist_sqrd(A), c.dist_sqrd(B), c.dist_sqrd(C)}));
+            for(uint i=std::max(beg[0],b[0]); i<std::min(end[0],b[0]+S); ++i)
+            for(uint j=std::max(beg[1],b[1]); j<std::min(end[1],b[1]+S); ++j)
+            for(uint k=std::max(beg[2],b[2]); k<std::min(end[2],b[2]+S); ++k)
+            {
+                vec3d    q  = g.node(i,j,k);
+                double & d  = d2[serialize_3D_index(i-b[0], j-b[1], k-b[2], S, S)];
+                double   lb = std::max(q.dist(c)-r, 0.0);
+                if(lb*lb >= d) continue;
+                d = std::min(d, point_to_triangle_dist_sqrd(q,A,B,C));
+            }
+        }
+
+        // sign the nodes of the brick. The surface cannot cross an edge whose endpoints are
+        // farther than len from it, hence the sign flows along such edges, and the winding
+        // number is only queried once per group of connected nodes
+        vec3u   e = (vec3u(g.dim[0],g.dim[1],g.dim[2]) - b).min(vec3u(S,S,S)); // brick extent within the grid
+        double  d[SVG_BRICK_SIZE];
+        int8_t  sign[SVG_BRICK_SIZE] = {};
+        uint16_t stack[SVG_BRICK_SIZE];
+        for(uint lid=0; lid<SVG_BRICK_SIZE; ++lid) d[lid] = sqrt(d2[lid]);
+        for(uint i=0; i<e[0]; ++i)
+        for(uint j=0; j<e[1]; ++j)
+        for(uint k=0; k<e[2]; ++k)
+        {
+            uint lid = serialize_3D_index(i, j, k, S, S);
+            if(sign[lid]) continue;
+            sign[lid] = fwn.is_inside(g.node(b[0]+i, b[1]+j, b[2]+k)) ? -1 : 1;
+            uint top = 0;
+            stack[top++] = uint16_t(lid);
+            while(top>0)
+            {
+                uint  cur = stack[--top];
+                vec3u c   = deserialize_3D_index(cur, S, S);
+                for(uint a=0; a<3; ++a)
+                for(int off : { -1, 1 })
+                {
+                    if((off<0 && c[a]==0) || (off>0 && c[a]+1>=e[a])) continue;
+                    vec3u n = c;
+                    n[a] += off;
+                    uint nid = serialize_3D_index(n[0], n[1], n[2], S, S);
+                    if(sign[nid] || d[cur]+d[nid]<=g.len) continue;
+                    sign[nid] = sign[cur];
+                    stack[top++] = uint16_t(nid);
+                }
+            }
+        }
+
+        // store the values. Dense grids only keep the band, and sweep the rest later
+        for(uint i=0; i<e[0]; ++i)
+        for(uint j=0; j<e[1]; ++j)
+        for(uint k=0; k<e[2]; ++k)
+        {
+            uint  lid = serialize_3D_index(i, j, k, S, S);
+            float v   = float(sign[lid]*d[lid]);
+            if(opt.sparse)
+            {
+                g.values[size_t(bid)*SVG_BRICK_SIZE + lid] = v;
+            }
+            else if(d[lid] < g.band)
+            {
+                uint id = serialize_3D_index(b[0]+i, b[1]+j, b[2]+k, g.dim[1], g.dim[2]);
+                g.values[id] = v;
+                frozen  [id] = true;
+            }
+        }
+    });
+
+    // exact signed distance of a node, from the BVH of the winding number
+    auto exact_value = [&](const uint i, const uint j, const uint k) -> float
+    {
+        vec3d  q = g.node(i,j,k);
+        vec3d  pos;
+        uint   tid;
+        double d2;
+        fwn.tree().closest_point(q, tid, pos, d2);
+        return float(fwn.is_inside(q) ? -sqrt(d2) : sqrt(d2));
+    };
+
+    if(opt.sparse)
+    {
+        sign_tiles(g, fwn);
+    }
+    else if(n_bricks>0)
+    {
+        // if the grid crops the surface, the parts of the surface outside of it seed no band,
+        // and the sweep alone would overestimate the distance from them. The nodes on the
+        // boundary of the grid then get their exact distances, which the sweep propagates inwards
+        AABB mesh_bbox(m.vector_verts());
+        if(!bbox.contains(mesh_bbox.min) || !bbox.contains(mesh_bbox.max))
+        {
+            PARALLEL_FOR(0, g.dim[0], 1, [&](uint i)
+            {
+                for(uint j=0; j<g.dim[1]; ++j)
+                for(uint k=0; k<g.dim[2]; ++k)
+                {
+                    if(i>0 && i+1<g.dim[0] && j>0 && j+1<g.dim[1] && k>0 && k+1<g.dim[2]) continue;
+                    uint id = serialize_3D_index(i, j, k, g.dim[1], g.dim[2]);
+                    if(frozen[id]) continue;
+                    g.values[id] = exact_value(i,j,k);
+                    frozen  [id] = true;
+                }
+            });
+        }
+        fast_sweeping(g.dim, g.len, frozen, g.values);
+    }
+    else if(n_tris>0)
+    {
+        // the surface is far from all nodes: there is no band to propagate from, hence
+        // query the BVH of the winding number for the closest point of each node
+        PARALLEL_FOR(0, g.num_nodes(), 1000, [&](uint id)
+        {
+            vec3u ijk = deserialize_3D_index(id, g.dim[1], g.dim[2]);
+            g.values[id] = exact_value(ijk[0], ijk[1], ijk[2]);
+        });
+    }
+    return g;
+}
+
+}
@@ -0,0 +1,135 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2022: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_SIGNED_DISTANCE_GRID_H
+#define CINO_SIGNED_DISTANCE_GRID_H
+
+#include <cinolib/sparse_voxel_grid.h>
+#include <cinolib/meshes/abstract_polygonmesh.h>
+
+namespace cinolib
+{
+
+/* Signed distance field sampled at the nodes of a regular grid. Node (i,j,k) is located
+ * at bbox.min + (i,j,k)*len. Distances are negative inside the object and positive outside.
+ *
+ * The grid is either dense (one value per node, in serialize_3D_index order), or sparse.
+ * Sparse grids follow the same two level layout of SparseVoxelGrid: nodes are grouped in
+ * bricks of 8x8x8 elements, and only the bricks crossed by the narrow band around the
+ * surface store their values. All other bricks are tiles, which only store whether they
+ * are inside or outside. Sparse grids are truncated: values are clamped to [-band,band].
+*/
+
+class SignedDistanceGrid
+{
+    public:
+
+        SignedDistanceGrid() {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        double value (const uint i, const uint j, const uint k) const; // value at node (i,j,k)
+        double sample(const vec3d & p) const;                          // trilinear interpolation (p is clamped to the grid)
+        vec3d  node  (const uint i, const uint j, const uint k) const { return bbox.min + vec3d(i,j,k)*len; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool   is_sparse()    const { return !slots.empty(); }
+        uint   num_nodes()    const { return dim[0]*dim[1]*dim[2]; }
+        size_t memory_usage() const; // bytes
+
+        // all the node values, in serialize_3D_index order
+        void to_dense(std::vector<double> & v) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint   dim [3] = {0,0,0}; // number of nodes along XYZ axis
+        uint   bdim[3] = {0,0,0}; // number of bricks along XYZ axis (sparse grids only)
+        AABB   bbox;              // bbox.min is the position of node (0,0,0)
+        double len  = 0;          // distance between adjacent nodes
+        double band = 0;          // half width of the narrow band where distances are exact
+
+        std::vector<float> values; // dense: one per node. Sparse: SVG_BRICK_SIZE per allocated brick
+        std::vector<uint>  slots;  // sparse only. One per brick: SVG_TILE | inside, or brick index
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct SignedDistanceOptions
+{
+    double band   = 3;     // half width of the narrow band where distances are exact (in grid cells, at least 1)
+    bool   sparse = false; // only store the narrow band (far values are clamped to +/- band)
+    double beta   = 2;     // accuracy of the fast winding number used for the sign (see FastWindingNumber)
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* Samples the signed distance from the surface of a polygon mesh at the nodes of a grid
+ * that spans bbox, having res cells along its longest side. Nodes coincide with the voxel
+ * corners sampled by voxelize(f, bbox, res, g), hence the grid can be directly used to
+ * voxelize the object (or to extract iso surfaces):
+ *
+ *    SignedDistanceGrid sdf = signed_distance_grid(m, bbox, res);
+ *    voxelize([&](const vec3d & p){ return sdf.sample(p); }, bbox, res, g);
+ *
+ * Triangles are binned into the bricks of nodes that are closer than opt.band to them, and
+ * each brick computes the exact distances of its nodes in parallel, without locks. The sign
+ * comes from the hierarchical fast winding number, which is robust to holes and self
+ * intersections. It is queried once per group of brick nodes connected by edges that the
+ * surface cannot cross, and flows to the other nodes in the group. Far nodes of dense grids
+ * are filled with a parallel fast sweeping method, inheriting their sign from the narrow
+ * band. Far regions of sparse grids just inherit the sign, brick by brick. If bbox crops
+ * the surface, the boundary nodes of a dense grid get exact distances before sweeping, so
+ * that the parts of the surface outside the grid are accounted for. If the surface is so
+ * far from the grid that there is no band at all, each node of a dense grid queries the
+ * BVH of the winding number for its closest point instead.
+ *
+ * Ref: A parallel fast sweeping method for the Eikonal equation
+ *      M. Detrixhe, F. Gibou, C. Min
+ *      Journal of Computational Physics, 2013
+*/
+template<class M, class V, class E, class P>
+CINO_INLINE
+SignedDistanceGrid signed_distance_grid(const AbstractPolygonMesh<M,V,E,P> & m,
+                                        const AABB                         & bbox,
+                                        const uint                           res,
+                                        const SignedDistanceOptions        & opt = SignedDistanceOptions());
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "signed_distance_grid.cpp"
+#endif
+
+#endif // CINO_SIGNED_DISTANCE_GRID_H
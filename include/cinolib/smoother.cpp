@@ -224,6 +224,8 @@ void mesh_smoother(      AbstractPolygonMesh<M1,V1,E1,P1> & m,
     };
 
     // SMOOTHING ITERATIONS
+    // (normal equations are re-analyzed only if the sparsity pattern changes between iterations)
+    SparseSolverCache solver;
     for(uint i=0; i<opt.n_iters; ++i)
     {
         laplacian();
@@ -242,8 +244,12 @@ void mesh_smoother(      AbstractPolygonMesh<M1,V1,E1,P1> & m,
         A.setFromTriplets(entries.begin(), entries.end());
         Eigen::VectorXd RHS = Eigen::Map<Eigen::VectorXd>(rhs.data(), rhs.size());
         Eigen::VectorXd W   = Eigen::Map<Eigen::VectorXd>(w.data(), w.size());
-        Eigen::VectorXd res;
-        solve_weighted_least_squares(A, W, RHS, res);
+        Eigen::SparseMatrix<double> At   = A.transpose();
+        Eigen::SparseMatrix<double> AtWA = At * W.asDiagonal() * A;
+        Eigen::VectorXd             AtWb = At * W.asDiagonal() * RHS;
+        Eigen::VectorXd             res;
+        solver.factorize(AtWA);
+        solver.solve(AtWb, res);
 
         uint nv = m.num_verts();
         for(uint vid=0; vid<nv; ++vid)
@@ -0,0 +1,102 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_SPAN_H
+#define CINO_SPAN_H
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <cinolib/cino_inline.h>
+
+namespace cinolib
+{
+
+/* Read-only view over a contiguous range of elements (a minimal C++11
+ * replacement for std::span). It exposes the read-only subset of the
+ * std::vector interface, so that it can be used in range-based loops,
+ * STL algorithms, and wherever a std::vector is expected (in which case
+ * the elements are copied). The view does not own the data, and it is
+ * invalidated as soon as the container it refers to is modified.
+*/
+
+template<typename T>
+class Span
+{
+    public:
+
+        typedef T         value_type;
+        typedef const T * iterator;
+        typedef const T * const_iterator;
+        typedef size_t    size_type;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        Span() : ptr(nullptr), n(0) {}
+        Span(const T * ptr, const size_t n) : ptr(ptr), n(n) {}
+        Span(const std::vector<T> & v) : ptr(v.data()), n(v.size()) {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        const T * begin() const { return ptr;   }
+        const T * end()   const { return ptr+n; }
+        const T * data()  const { return ptr;   }
+        size_t    size()  const { return n;     }
+        bool      empty() const { return n==0;  }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        const T & operator[](const size_t i) const { return ptr[i];   }
+        const T & front()                    const { return ptr[0];   }
+        const T & back()                     const { return ptr[n-1]; }
+        const T & at(const size_t i) const
+        {
+            if(i>=n) throw std::out_of_range("Span::at()");
+            return ptr[i];
+        }
+
+    private:
+
+        const T * ptr;
+        size_t    n;
+};
+
+}
+
+#endif // CINO_SPAN_H
@@ -0,0 +1,71 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_SPARSE_MATRIX_ALLOC_H
+#define CINO_SPARSE_MATRIX_ALLOC_H
+
+#include <cinolib/cino_inline.h>
+#include <Eigen/Sparse>
+#include <sys/types.h>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Allocates a sparse matrix in compressed form, knowing in advance how many
+ * non zero entries each outer vector will have (columns for column major
+ * matrices, rows for row major matrices). Inner indices and values are left
+ * uninitialized. Each outer vector i owns the disjoint range
+ *
+ *     [A.outerIndexPtr()[i], A.outerIndexPtr()[i+1])
+ *
+ * of A.innerIndexPtr() and A.valuePtr(), hence the caller can fill them in
+ * parallel, with no need to pass through a list of triplets. Inner indices
+ * must be written in increasing order, and without duplicates.
+*/
+
+template<typename T, int Options>
+CINO_INLINE
+void sparse_matrix_alloc(Eigen::SparseMatrix<T,Options> & A,
+                         const uint                       rows,
+                         const uint                       cols,
+                         const std::vector<uint>        & outer_nnz);
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "sparse_matrix_alloc.cpp"
+#endif
+
+#endif // CINO_SPARSE_MATRIX_ALLOC_H
@@ -0,0 +1,223 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2022: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/sparse_voxel_grid.h>
+#include <cinolib/serialize_index.h>
+#include <cinolib/parallel_for.h>
+#include <algorithm>
+
+namespace cinolib
+{
+
+CINO_INLINE
+void SparseVoxelGrid::init(const AABB & bbox, const double len, const uint dim[3], const int state)
+{
+    this->bbox = bbox;
+    this->len  = len;
+    for(uint i=0; i<3; ++i)
+    {
+        this->dim[i] = dim[i];
+        bdim[i] = (dim[i] + SVG_BRICK_SIDE - 1) >> SVG_BRICK_BITS;
+    }
+    slots.assign(size_t(bdim[0])*bdim[1]*bdim[2], SVG_TILE | code(state));
+    bricks.clear();
+    brick_slot.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+int SparseVoxelGrid::voxel(const uint i, const uint j, const uint k) const
+{
+    assert(i<dim[0] && j<dim[1] && k<dim[2]);
+    uint s = slots[slot_index(i>>SVG_BRICK_BITS, j>>SVG_BRICK_BITS, k>>SVG_BRICK_BITS)];
+    if(s & SVG_TILE) return flag(uint8_t(s & ~SVG_TILE));
+    const uint m = SVG_BRICK_SIDE-1;
+    return flag(brick(s)[serialize_3D_index(i&m, j&m, k&m, SVG_BRICK_SIDE, SVG_BRICK_SIDE)]);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseVoxelGrid::set_voxel(const uint i, const uint j, const uint k, const int state)
+{
+    assert(i<dim[0] && j<dim[1] && k<dim[2]);
+    uint sid = slot_index(i>>SVG_BRICK_BITS, j>>SVG_BRICK_BITS, k>>SVG_BRICK_BITS);
+    uint8_t c = code(state);
+    if(slot_is_tile(sid))
+    {
+        if((slots[sid] & ~SVG_TILE)==c) return; // nothing to do
+        add_brick(sid);
+    }
+    const uint m = SVG_BRICK_SIDE-1;
+    brick(slots[sid])[serialize_3D_index(i&m, j&m, k&m, SVG_BRICK_SIDE, SVG_BRICK_SIDE)] = c;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint SparseVoxelGrid::slot_index(const uint bi, const uint bj, const uint bk) const
+{
+    return serialize_3D_index(bi, bj, bk, bdim[1], bdim[2]);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint SparseVoxelGrid::add_brick(const uint sid)
+{
+    assert(slot_is_tile(sid));
+    uint bid = num_bricks();
+    bricks.resize(bricks.size()+SVG_BRICK_SIZE, uint8_t(slots[sid] & ~SVG_TILE));
+    brick_slot.push_back(sid);
+    slots[sid] = bid;
+    return bid;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseVoxelGrid::prune()
+{
+    std::vector<uint8_t> uniform(num_bricks());
+    PARALLEL_FOR(0, num_bricks(), 1000, [&](uint bid)
+    {
+        const uint8_t * b = brick(bid);
+        uniform[bid] = std::all_of(b, b+SVG_BRICK_SIZE, [b](const uint8_t c){ return c==b[0]; });
+    });
+
+    // compact the surviving bricks, preserving their order
+    uint fresh = 0;
+    for(uint bid=0; bid<num_bricks(); ++bid)
+    {
+        uint sid = brick_slot[bid];
+        if(uniform[bid])
+        {
+            slots[sid] = SVG_TILE | brick(bid)[0];
+            continue;
+        }
+        if(fresh!=bid) std::copy_n(brick(bid), SVG_BRICK_SIZE, brick(fresh));
+        brick_slot[fresh] = sid;
+        slots[sid] = fresh++;
+    }
+    brick_slot.resize(fresh);
+    bricks.resize(size_t(fresh)*SVG_BRICK_SIZE);
+    bricks.shrink_to_fit();
+    brick_slot.shrink_to_fit();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseVoxelGrid::replace(const int from, const int to)
+{
+    uint8_t c_from = code(from);
+    uint8_t c_to   = code(to);
+    PARALLEL_FOR(0, uint(slots.size()), 10000, [&](uint sid)
+    {
+        if(slots[sid]==(SVG_TILE|c_from)) slots[sid] = SVG_TILE|c_to;
+    });
+    PARALLEL_FOR(0, num_bricks(), 1000, [&](uint bid)
+    {
+        uint8_t *b = brick(bid);
+        std::replace(b, b+SVG_BRICK_SIZE, c_from, c_to);
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t SparseVoxelGrid::memory_usage() const
+{
+    return sizeof(SparseVoxelGrid)                +
+           slots.capacity()      * sizeof(uint)   +
+           bricks.capacity()                      +
+           brick_slot.capacity() * sizeof(uint);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseVoxelGrid::to_dense(VoxelGrid & g) const
+{
+    g.bbox = bbox;
+    g.len  = len;
+    std::copy_n(dim, 3, g.dim);
+    delete[] g.voxels;
+    g.voxels = new int[size_t(dim[0])*dim[1]*dim[2]];
+
+    // each slot writes its own voxels
+    PARALLEL_FOR(0, uint(slots.size()), 1000, [&](uint sid)
+    {
+        vec3u b = deserialize_3D_index(sid, bdim[1], bdim[2]) * SVG_BRICK_SIDE;
+        uint  s = slots[sid];
+        for(uint i=b[0]; i<std::min(b[0]+SVG_BRICK_SIDE, dim[0]); ++i)
+        for(uint j=b[1]; j<std::min(b[1]+SVG_BRICK_SIDE, dim[1]); ++j)
+        for(uint k=b[2]; k<std::min(b[2]+SVG_BRICK_SIDE, dim[2]); ++k)
+        {
+            uint8_t c = (s & SVG_TILE) ? uint8_t(s & ~SVG_TILE)
+                                   : brick(s)[serialize_3D_index(i-b[0], j-b[1], k-b[2], SVG_BRICK_SIDE, SVG_BRICK_SIDE)];
+            g.voxels[serialize_3D_index(i,j,k,dim[1],dim[2])] = flag(c);
+        }
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint8_t SparseVoxelGrid::code(const int flag)
+{
+    switch(flag)
+    {
+        case VOXEL_UNKNOWN  : return 0;
+        case VOXEL_OUTSIDE  : return 1;
+        case VOXEL_INSIDE   : return 2;
+        case VOXEL_BOUNDARY : return 3;
+        default: assert(false && "unknown voxel state");
+    }
+    return 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+int SparseVoxelGrid::flag(const uint8_t code)
+{
+    static const int flags[4] = { VOXEL_UNKNOWN, VOXEL_OUTSIDE, VOXEL_INSIDE, VOXEL_BOUNDARY };
+    assert(code<4);
+    return flags[code];
+}
+
+}
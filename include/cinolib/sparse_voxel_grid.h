@@ -0,0 +1,128 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2022: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_SPARSE_VOXEL_GRID_H
+#define CINO_SPARSE_VOXEL_GRID_H
+
+#include <cinolib/voxel_grid.h>
+#include <cstdint>
+
+namespace cinolib
+{
+
+/* Sparse voxel grid, organized as a two level hierarchy (in the spirit of OpenVDB).
+ * Voxels are grouped in bricks of 8x8x8 elements. The top level is a dense array with
+ * one slot per brick, which either stores the state shared by all the voxels in the
+ * brick (tile), or refers to a brick that stores the state of each voxel in one byte.
+ * Bricks are allocated only where voxel states vary (e.g. along the boundary of a
+ * voxelized object), hence memory scales with the surface of the object, not with its
+ * volume. Voxel states are the same flags used by VoxelGrid (VOXEL_INSIDE, ...), which
+ * are internally stored as 2-bit codes.
+ *
+ * Note: bricks along the max sides of the grid may exceed the grid dimensions. Voxels
+ * outside the grid have no meaning, and are skipped by all the grid traversals.
+*/
+
+static const uint SVG_BRICK_BITS = 3;
+static const uint SVG_BRICK_SIDE = 1u << SVG_BRICK_BITS;
+static const uint SVG_BRICK_SIZE = SVG_BRICK_SIDE*SVG_BRICK_SIDE*SVG_BRICK_SIDE;
+static const uint SVG_TILE       = 0x80000000; // slots with this bit on are tiles
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class SparseVoxelGrid
+{
+    public:
+
+        SparseVoxelGrid() {}
+
+        // makes a grid with dim[0] x dim[1] x dim[2] voxels, all in the same state
+        void init(const AABB & bbox, const double len, const uint dim[3], const int state = VOXEL_UNKNOWN);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        int  voxel    (const uint i, const uint j, const uint k) const;
+        void set_voxel(const uint i, const uint j, const uint k, const int state); // may allocate a brick (not thread safe)
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint slot_index (const uint bi, const uint bj, const uint bk) const;
+        bool slot_is_tile(const uint sid) const { return slots.at(sid) & SVG_TILE; }
+        uint add_brick  (const uint sid); // converts a tile into a brick, returns the brick index
+
+        // pointer to the SVG_BRICK_SIZE codes of a brick (voxels are in serialize_3D_index order)
+        const uint8_t * brick(const uint bid) const { return bricks.data() + size_t(bid)*SVG_BRICK_SIZE; }
+              uint8_t * brick(const uint bid)       { return bricks.data() + size_t(bid)*SVG_BRICK_SIZE; }
+
+        // converts bricks with all voxels in the same state into tiles, and releases their memory
+        void prune();
+
+        // sets all the voxels with state from to state to
+        void replace(const int from, const int to);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint   num_bricks()   const { return uint(brick_slot.size()); }
+        size_t memory_usage() const; // bytes
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void to_dense(VoxelGrid & g) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // conversion between VOXEL_* flags and the 2-bit codes used for storage
+        static uint8_t code(const int flag);
+        static int     flag(const uint8_t code);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint   dim [3] = {0,0,0}; // number of voxels along XYZ axis
+        uint   bdim[3] = {0,0,0}; // number of bricks along XYZ axis
+        AABB   bbox;              // bounding box
+        double len = 0;           // per voxel edge length
+
+        std::vector<uint>    slots;      // one per brick: SVG_TILE | code, or brick index
+        std::vector<uint8_t> bricks;     // SVG_BRICK_SIZE codes per allocated brick
+        std::vector<uint>    brick_slot; // slot of each allocated brick
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "sparse_voxel_grid.cpp"
+#endif
+
+#endif // CINO_SPARSE_VOXEL_GRID_H
@@ -0,0 +1,274 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/spatial_data_structure.h>
+#include <cinolib/how_many_seconds.h>
+
+namespace cinolib
+{
+
+CINO_INLINE
+void SpatialDataStructure::push_point(const uint id, const vec3d & v)
+{
+    items.push_back({POINT, uint(points.size())});
+    points.emplace_back(id,v);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SpatialDataStructure::push_sphere(const uint id, const vec3d & c, const double r)
+{
+    items.push_back({SPHERE, uint(spheres.size())});
+    spheres.emplace_back(id,c,r);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SpatialDataStructure::push_segment(const uint id, const vec3d & v0, const vec3d & v1)
+{
+    items.push_back({SEGMENT, uint(segments.size())});
+    segments.emplace_back(id,v0,v1);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SpatialDataStructure::push_triangle(const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2)
+{
+    items.push_back({TRIANGLE, uint(triangles.size())});
+    triangles.emplace_back(id,v0,v1,v2);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SpatialDataStructure::push_tetrahedron(const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2, const vec3d & v3)
+{
+    items.push_back({TETRAHEDRON, uint(tets.size())});
+    tets.emplace_back(id,v0,v1,v2,v3);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const SpatialDataStructureItem & SpatialDataStructure::item(const uint i) const
+{
+    const ItemRef & it = items.at(i);
+    switch(it.type)
+    {
+        case POINT    : return points   [it.index];
+        case SPHERE   : return spheres  [it.index];
+        case SEGMENT  : return segments [it.index];
+        case TRIANGLE : return triangles[it.index];
+        default       : assert(it.type==TETRAHEDRON);
+                        return tets[it.index];
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SpatialDataStructure::debug_mode(const bool b)
+{
+    print_debug_info = b;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
+CINO_INLINE
+bool SpatialDataStructure::intersects_triangle(const vec3d t[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    std::vector<uint>  tmp;
+    std::vector<vec3d> list = {t[0],t[1],t[2]};
+    items_intersecting_box(AABB(list), tmp);
+
+    for(uint i : tmp)
+    {
+        if(item_intersects_triangle(i, t, ignore_if_valid_complex))
+        {
+            ids.insert(item(i).id);
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Intersects triangle\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+
+    return !ids.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
+CINO_INLINE
+bool SpatialDataStructure::intersects_segment(const vec3d s[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    std::vector<uint> tmp;
+    items_intersecting_box(AABB(s[0],s[1]), tmp);
+
+    for(uint i : tmp)
+    {
+        if(item_intersects_segment(i, s, ignore_if_valid_complex))
+        {
+            ids.insert(item(i).id);
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Intersects segment\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+
+    return !ids.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// WARNING: this function may return false positives because it only checks intersection between
+// the box b and the AABB of the items in the tree. This is a partial result that it is useful for
+// some of the queries above, where a more expensive test between the geometric entity approximated
+// by box b and the actual items will be performed
+CINO_INLINE
+bool SpatialDataStructure::intersects_box(const AABB & b, std::unordered_set<uint> & ids) const
+{
+    typedef std::chrono::steady_clock Time;
+    Time::time_point t0 = Time::now();
+
+    std::vector<uint> tmp;
+    items_intersecting_box(b, tmp);
+    for(uint i : tmp) ids.insert(item(i).id);
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        std::cout << "Intersects box\t" << how_many_seconds(t0,t1) << " seconds" << std::endl;
+    }
+
+    return !ids.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+vec3d SpatialDataStructure::item_point_closest_to(const uint i, const vec3d & p) const
+{
+    const ItemRef & it = items[i];
+    switch(it.type)
+    {
+        case POINT    : return points   [it.index].point_closest_to(p);
+        case SPHERE   : return spheres  [it.index].point_closest_to(p);
+        case SEGMENT  : return segments [it.index].point_closest_to(p);
+        case TRIANGLE : return triangles[it.index].point_closest_to(p);
+        default       : return tets     [it.index].point_closest_to(p);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SpatialDataStructure::item_contains(const uint i, const vec3d & p, const bool strict) const
+{
+    const ItemRef & it = items[i];
+    switch(it.type)
+    {
+        case POINT    : return points   [it.index].contains(p,strict);
+        case SPHERE   : return spheres  [it.index].contains(p,strict);
+        case SEGMENT  : return segments [it.index].contains(p,strict);
+        case TRIANGLE : return triangles[it.index].contains(p,strict);
+        default       : return tets     [it.index].contains(p,strict);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SpatialDataStructure::item_intersects_ray(const uint i, const vec3d & p, const vec3d & dir, double & t, vec3d & pos) const
+{
+    const ItemRef & it = items[i];
+    switch(it.type)
+    {
+        case POINT    : return points   [it.index].intersects_ray(p,dir,t,pos);
+        case SPHERE   : return spheres  [it.index].intersects_ray(p,dir,t,pos);
+        case SEGMENT  : return segments [it.index].intersects_ray(p,dir,t,pos);
+        case TRIANGLE : return triangles[it.index].intersects_ray(p,dir,t,pos);
+        default       : return tets     [it.index].intersects_ray(p,dir,t,pos);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SpatialDataStructure::item_intersects_segment(const uint i, const vec3d s[], const bool ignore_if_valid_complex) const
+{
+    const ItemRef & it = items[i];
+    switch(it.type)
+    {
+        case POINT    : return points   [it.index].intersects_segment(s,ignore_if_valid_complex);
+        case SPHERE   : return spheres  [it.index].intersects_segment(s,ignore_if_valid_complex);
+        case SEGMENT  : return segments [it.index].intersects_segment(s,ignore_if_valid_complex);
+        case TRIANGLE : return triangles[it.index].intersects_segment(s,ignore_if_valid_complex);
+        default       : return tets     [it.index].intersects_segment(s,ignore_if_valid_complex);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool SpatialDataStructure::item_intersects_triangle(const uint i, const vec3d t[], const bool ignore_if_valid_complex) const
+{
+    const ItemRef & it = items[i];
+    switch(it.type)
+    {
+        case POINT    : return points   [it.index].intersects_triangle(t,ignore_if_valid_complex);
+        case SPHERE   : return spheres  [it.index].intersects_triangle(t,ignore_if_valid_complex);
+        case SEGMENT  : return segments [it.index].intersects_triangle(t,ignore_if_valid_complex);
+        case TRIANGLE : return triangles[it.index].intersects_triangle(t,ignore_if_valid_complex);
+        default       : return tets     [it.index].intersects_triangle(t,ignore_if_valid_complex);
+    }
+}
+
+}
@@ -0,0 +1,242 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_SPATIAL_DATA_STRUCTURE_H
+#define CINO_SPATIAL_DATA_STRUCTURE_H
+
+#include <cinolib/geometry/spatial_data_structure_item.h>
+#include <cinolib/geometry/point.h>
+#include <cinolib/geometry/sphere.h>
+#include <cinolib/geometry/segment.h>
+#include <cinolib/geometry/triangle.h>
+#include <cinolib/geometry/tetrahedron.h>
+#include <cinolib/meshes/meshes.h>
+#include <unordered_set>
+
+namespace cinolib
+{
+
+/* Base class for hierarchical space subdivisions (e.g. Octree, BVH).
+ * It owns the items and implements the facilities to populate the
+ * structure, leaving to derived classes the construction of the
+ * hierarchy and the queries that depend on it.
+ *
+ * Items are not allocated one by one, but stored by value in contiguous arrays,
+ * one for each primitive type. The i-th pushed item is located by items[i], and
+ * can be accessed with item(i).
+*/
+
+class SpatialDataStructure
+{
+    public:
+
+        virtual ~SpatialDataStructure() {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void push_point      (const uint id, const vec3d &  v);
+        void push_sphere     (const uint id, const vec3d &  c, const double   r);
+        void push_segment    (const uint id, const vec3d & v0, const vec3d & v1);
+        void push_triangle   (const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2);
+        void push_tetrahedron(const uint id, const vec3d & v0, const vec3d & v1, const vec3d & v2, const vec3d & v3);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        virtual void build() = 0;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class M, class V, class E, class P>
+        void build_from_mesh_polys(const AbstractPolygonMesh<M,V,E,P> & m)
+        {
+            assert(items.empty());
+            items.reserve(m.num_polys());
+            triangles.reserve(m.num_polys());
+            for(uint pid=0; pid<m.num_polys(); ++pid)
+            {
+                for(uint i=0; i<m.poly_tessellation(pid).size()/3; ++i)
+                {
+                    vec3d v0 = m.vert(m.poly_tessellation(pid).at(3*i+0));
+                    vec3d v1 = m.vert(m.poly_tessellation(pid).at(3*i+1));
+                    vec3d v2 = m.vert(m.poly_tessellation(pid).at(3*i+2));
+                    push_triangle(pid,v0,v1,v2);
+                }
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class M, class V, class E, class F, class P>
+        void build_from_mesh_polys(const AbstractPolyhedralMesh<M,V,E,F,P> & m)
+        {
+            assert(items.empty());
+            items.reserve(m.num_polys());
+            tets.reserve(m.num_polys());
+            for(uint pid=0; pid<m.num_polys(); ++pid)
+            {
+                switch(m.mesh_type())
+                {
+                    case TETMESH : push_tetrahedron(pid,
+                                                    m.poly_vert(pid,0),
+                                                    m.poly_vert(pid,1),
+                                                    m.poly_vert(pid,2),
+                                                    m.poly_vert(pid,3)); break;
+                    default: assert(false && "Unsupported element");
+                }
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void build_from_vectors(const std::vector<vec3d> & verts,
+                                const std::vector<uint>  & tris)
+        {
+            assert(items.empty());
+            items.reserve(tris.size()/3);
+            triangles.reserve(tris.size()/3);
+            for(uint i=0; i<tris.size(); i+=3)
+            {
+                push_triangle(i/3, verts.at(tris.at(i  )),
+                                   verts.at(tris.at(i+1)),
+                                   verts.at(tris.at(i+2)));
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class M, class V, class E, class P>
+        void build_from_mesh_edges(const AbstractMesh<M,V,E,P> & m)
+        {
+            assert(items.empty());
+            items.reserve(m.num_edges());
+            segments.reserve(m.num_edges());
+            for(uint eid=0; eid<m.num_edges(); ++eid)
+            {
+                push_segment(eid, m.edge_vert(eid,0),
+                                  m.edge_vert(eid,1));
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class M, class V, class E, class P>
+        void build_from_mesh_points(const AbstractMesh<M,V,E,P> & m)
+        {
+            assert(items.empty());
+            items.reserve(m.num_verts());
+            points.reserve(m.num_verts());
+            for(uint vid=0; vid<m.num_verts(); ++vid)
+            {
+                push_point(vid, m.vert(vid));
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint num_items() const { return uint(items.size()); }
+
+        // generic access to the i-th item (in order of insertion)
+        const SpatialDataStructureItem & item(const uint i) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void debug_mode(const bool b);
+
+        // QUERIES :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // note: these queries become exact if CINOLIB_USES_SHEWCHUK_PREDICATES is defined
+        bool intersects_segment (const vec3d s[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
+        bool intersects_triangle(const vec3d t[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
+
+        // WARNING: this function may return false positives because it only checks intersection between
+        // the box b and the AABB of the items in the tree. This is a partial result that it is useful for
+        // some of the queries above, where a more expensive test between the geometric entity approximated
+        // by box b and the actual items will be performed
+        bool intersects_box(const AABB & b, std::unordered_set<uint> & ids) const;
+
+        // first hits of a batch of rays R_i(t) := p[i] + t * dir[i], processed in parallel.
+        // For each ray, min_t[i] and ids[i] are the parameter and id of the first item hit
+        // (inf_double and -1 if there is none). If the list is not empty, the item with id
+        // ignore[i] is not considered for ray i (e.g. to shoot rays from a mesh element)
+        virtual void intersects_rays(const std::vector<vec3d>  & p,
+                                     const std::vector<vec3d>  & dir,
+                                           std::vector<double> & min_t,
+                                           std::vector<int>    & ids,
+                                     const std::vector<int>    & ignore = {}) const = 0;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // all items live in typed arrays, and items[i] tells where the i-th item is
+        struct ItemRef
+        {
+            ItemType type;
+            uint     index; // position in the array of its type
+        };
+        std::vector<ItemRef>     items;
+        std::vector<Point>       points;
+        std::vector<Sphere>      spheres;
+        std::vector<Segment>     segments;
+        std::vector<Triangle>    triangles;
+        std::vector<Tetrahedron> tets;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        protected:
+
+        bool print_debug_info = false;
+
+        // static dispatch of the item queries to the proper typed array
+        vec3d item_point_closest_to   (const uint i, const vec3d & p) const;
+        bool  item_contains           (const uint i, const vec3d & p, const bool strict) const;
+        bool  item_intersects_ray     (const uint i, const vec3d & p, const vec3d & dir, double & t, vec3d & pos) const;
+        bool  item_intersects_segment (const uint i, const vec3d s[], const bool ignore_if_valid_complex) const;
+        bool  item_intersects_triangle(const uint i, const vec3d t[], const bool ignore_if_valid_complex) const;
+
+        // collects the indices (NOT the ids) of the items whose AABB intersects box b
+        virtual void items_intersecting_box(const AABB & b, std::vector<uint> & list) const = 0;
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "spatial_data_structure.cpp"
+#endif
+
+#endif // CINO_SPATIAL_DATA_STRUCTURE_H
@@ -0,0 +1,231 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/thread_pool.h>
+#include <algorithm>
+
+namespace cinolib
+{
+
+CINO_INLINE
+ThreadPool & ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ThreadPool::ThreadPool()
+{
+    // the calling thread always participates, hence spawn one worker less than available cores
+    unsigned n_threads = std::thread::hardware_concurrency();
+    if(n_threads==0) n_threads = 8;
+    workers.reserve(n_threads-1);
+    for(uint slot=1; slot<n_threads; ++slot)
+    {
+        workers.emplace_back(&ThreadPool::worker_loop, this, slot);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    for(std::thread & t : workers)
+    {
+        if(t.joinable()) t.join();
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// worker threads are identified by slots 1,2,...,n-1. Any other thread uses slot 0
+CINO_INLINE
+uint & ThreadPool::this_thread_slot()
+{
+    thread_local uint slot = 0;
+    return slot;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void ThreadPool::run(const uint n_chunks, const std::function<void(uint)> & chunk_func)
+{
+    if(n_chunks==0) return;
+    if(n_chunks==1 || workers.empty())
+    {
+        for(uint k=0; k<n_chunks; ++k) chunk_func(k);
+        return;
+    }
+
+    Job job;
+    job.func    = &chunk_func;
+    job.n_slots = num_threads();
+    job.ranges.reset(new std::atomic<uint64_t>[job.n_slots]);
+    job.pending = n_chunks;
+    job.users   = 0;
+    for(uint i=0; i<job.n_slots; ++i)
+    {
+        uint lo = uint((uint64_t(n_chunks)* i   )/job.n_slots);
+        uint hi = uint((uint64_t(n_chunks)*(i+1))/job.n_slots);
+        job.ranges[i] = pack_range(lo,hi);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(&job);
+    }
+    cv.notify_all();
+
+    participate(job, this_thread_slot());
+
+    // no more chunks to distribute: withdraw the job, then wait for
+    // the chunks still running on other threads to complete
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+    }
+    while(job.pending.load()>0 || job.users.load()>0) std::this_thread::yield();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void ThreadPool::worker_loop(const uint slot)
+{
+    this_thread_slot() = slot;
+
+    for(;;)
+    {
+        Job *job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]
+            {
+                if(stop) return true;
+                for(Job *j : jobs) if(has_work(*j)) { job = j; return true; }
+                return false;
+            });
+            if(stop) return;
+            job->users.fetch_add(1);
+        }
+        participate(*job, slot);
+        job->users.fetch_sub(1); // last access to the job
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void ThreadPool::participate(Job & job, const uint slot)
+{
+    uint chunk;
+    while(pop(job, slot, chunk) || steal(job, slot, chunk))
+    {
+        (*job.func)(chunk);
+        job.pending.fetch_sub(1);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// takes the first chunk from the range owned by slot
+CINO_INLINE
+bool ThreadPool::pop(Job & job, const uint slot, uint & chunk)
+{
+    std::atomic<uint64_t> & range = job.ranges[slot];
+    uint64_t r = range.load();
+    while(range_lo(r) < range_hi(r))
+    {
+        if(range.compare_exchange_weak(r, pack_range(range_lo(r)+1, range_hi(r))))
+        {
+            chunk = range_lo(r);
+            return true;
+        }
+    }
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// takes the upper half of the range of some other slot. The first stolen
+// chunk is returned, the others become the new range owned by slot
+CINO_INLINE
+bool ThreadPool::steal(Job & job, const uint slot, uint & chunk)
+{
+    for(uint i=1; i<job.n_slots; ++i)
+    {
+        std::atomic<uint64_t> & range = job.ranges[(slot+i)%job.n_slots];
+        uint64_t r = range.load();
+        while(range_lo(r) < range_hi(r))
+        {
+            uint lo  = range_lo(r);
+            uint hi  = range_hi(r);
+            uint mid = lo + (hi-lo)/2;
+            if(range.compare_exchange_weak(r, pack_range(lo,mid)))
+            {
+                // nobody else can modify an empty range, hence a plain store suffices
+                job.ranges[slot].store(pack_range(mid+1,hi));
+                chunk = mid;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool ThreadPool::has_work(const Job & job) const
+{
+    for(uint i=0; i<job.n_slots; ++i)
+    {
+        uint64_t r = job.ranges[i].load();
+        if(range_lo(r) < range_hi(r)) return true;
+    }
+    return false;
+}
+
+}
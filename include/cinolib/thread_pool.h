@@ -0,0 +1,126 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_THREAD_POOL_H
+#define CINO_THREAD_POOL_H
+
+#include <sys/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cinolib/cino_inline.h>
+
+namespace cinolib
+{
+
+/* Process-wide pool of persistent worker threads, used by PARALLEL_FOR and
+ * PARALLEL_REDUCE to avoid paying thread creation at each call.
+ *
+ * A job is a set of chunks (i.e. indices in [0,n_chunks)) that are initially
+ * split evenly among all participating threads. Each thread consumes its own
+ * chunks first, then steals half of the remaining chunks of some other thread.
+ * This yields a good balance even when the cost of the chunks is uneven. The
+ * calling thread always participates in its own job, hence jobs can be nested
+ * (e.g. a PARALLEL_FOR inside a PARALLEL_FOR) without deadlocks.
+*/
+
+class ThreadPool
+{
+    public:
+
+        static ThreadPool & instance();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // number of threads that participate in a job (workers + calling thread)
+        uint num_threads() const { return uint(workers.size()+1); }
+
+        // executes chunk_func(k) for each k in [0,n_chunks), and returns when all chunks are done
+        void run(const uint n_chunks, const std::function<void(uint)> & chunk_func);
+
+    private:
+
+        struct Job
+        {
+            const std::function<void(uint)>       * func;
+            std::unique_ptr<std::atomic<uint64_t>[]> ranges;  // per thread chunk range (lo in low bits, hi in high bits)
+            uint                                     n_slots;
+            std::atomic<uint>                        pending; // chunks not completed yet
+            std::atomic<uint>                        users;   // worker threads currently operating on the job
+        };
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        explicit ThreadPool();
+                ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool & operator=(const ThreadPool &) = delete;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        static uint & this_thread_slot();
+
+        static uint64_t pack_range(const uint lo, const uint hi) { return (uint64_t(hi) << 32) | uint64_t(lo); }
+        static uint     range_lo  (const uint64_t r)             { return uint(r & 0xFFFFFFFFu); }
+        static uint     range_hi  (const uint64_t r)             { return uint(r >> 32);         }
+
+        void worker_loop(const uint slot);
+        void participate(Job & job, const uint slot);
+        bool pop  (Job & job, const uint slot, uint & chunk);
+        bool steal(Job & job, const uint slot, uint & chunk);
+        bool has_work(const Job & job) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        std::vector<std::thread> workers;
+        std::vector<Job*>        jobs;
+        std::mutex               mutex;
+        std::condition_variable  cv;
+        bool                     stop = false;
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "thread_pool.cpp"
+#endif
+
+#endif // CINO_THREAD_POOL_H
@@ -34,48 +34,199 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/vertex_clustering.h>
-#include <cinolib/bfs.h>
+#include <cinolib/parallel_for.h>
+#include <cinolib/geometry/vec_mat.h>
+#include <cinolib/min_max_inf.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
 
 namespace cinolib
 {
 
+// coordinates used to hash vertices in the grid. Generic vertices
+// are not hashed at all (i.e., they all fall in the same cell)
+template<class Vertex>
+CINO_INLINE
+void vertex_grid_coords(const Vertex &, double *)
+{}
+
+template<uint d, class T>
+CINO_INLINE
+void vertex_grid_coords(const mat<d,1,T> & p, double * coords)
+{
+    for(uint i=0; i<std::min(d,3u); ++i) coords[i] = double(p[i]);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class Vertex>
 CINO_INLINE
 void vertex_clustering(const std::vector<Vertex>             & points,
                        const double                            proximity_thresh,
                        std::vector<std::unordered_set<uint>> & clusters)
 {
-    // build v2v connectivity based on point proximity
-    std::vector<std::vector<uint>> v2v(points.size());
-    for(uint vid0=0;      vid0<points.size()-1; ++vid0)
-    for(uint vid1=vid0+1; vid1<points.size();   ++vid1)
+    std::vector<uint> cluster_id;
+    uint n_clusters = vertex_clustering(points, proximity_thresh, cluster_id);
+
+    std::vector<uint> cluster_size(n_clusters, 0);
+    for(uint cid : cluster_id) ++cluster_size[cid];
+
+    uint offset = uint(clusters.size());
+    clusters.resize(offset+n_clusters);
+    for(uint i=0; i<n_clusters; ++i) clusters[offset+i].reserve(cluster_size[i]);
+    for(uint vid=0; vid<points.size(); ++vid) clusters[offset+cluster_id[vid]].insert(vid);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Vertex>
+CINO_INLINE
+uint vertex_clustering(const std::vector<Vertex> & points,
+                       const double                proximity_thresh,
+                       std::vector<uint>         & cluster_id)
+{
+    uint nv = uint(points.size());
+    cluster_id.assign(nv, 0);
+    if(nv==0) return 0;
+
+    // hash vertices in a grid. Cells are slightly bigger than the threshold, so that
+    // rounding errors cannot put two vertices closer than it in non adjacent cells
+    typedef std::array<int64_t,3> Cell;
+    struct Item
+    {
+        Cell cell;
+        uint vid;
+        bool operator<(const Item & i) const { return cell<i.cell; }
+    };
+    // Cells are indexed from the min corner of the bounding box, and they are never smaller
+    // than a few ulps of its extent, so that indices (and their +/-1 neighbors) always fit
+    // in 64 bits, also for tiny (or zero) thresholds
+    double min[3] = {  inf_double,  inf_double,  inf_double };
+    double max[3] = { -inf_double, -inf_double, -inf_double };
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        double coords[3] = { 0, 0, 0 };
+        vertex_grid_coords(points[vid], coords);
+        for(uint i=0; i<3; ++i)
+        {
+            min[i] = std::min(min[i], coords[i]);
+            max[i] = std::max(max[i], coords[i]);
+        }
+    }
+    double extent    = std::max({ max[0]-min[0], max[1]-min[1], max[2]-min[2] });
+    double cell_size = std::max({ proximity_thresh*1.01, extent*16*DBL_EPSILON, DBL_MIN });
+    std::vector<Item> items(nv);
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
+    {
+        double coords[3] = { 0, 0, 0 };
+        vertex_grid_coords(points[vid], coords);
+        for(uint i=0; i<3; ++i) items[vid].cell[i] = int64_t(std::floor((coords[i]-min[i])/cell_size));
+        items[vid].vid = vid;
+    });
+
+    // sort vertices by cell, and store the range of vertices of each (non empty) cell.
+    // From now on vertices are referred to by their position in the sorted list, and
+    // they are copied in this order, so that the vertices of a cell are contiguous in memory
+    std::sort(items.begin(), items.end());
+    std::vector<Vertex> sorted_points(nv, points.front());
+    std::vector<uint>   pos(nv);
+    std::vector<Cell>   cells;
+    std::vector<uint>   cell_begin;
+    for(uint i=0; i<nv; ++i)
     {
-        if (points.at(vid0).dist(points.at(vid1)) < proximity_thresh)
+        if(i==0 || items[i].cell!=cells.back())
         {
-            v2v.at(vid0).push_back(vid1);
-            v2v.at(vid1).push_back(vid0);
+            cells.push_back(items[i].cell);
+            cell_begin.push_back(i);
         }
+        sorted_points[i]   = points[items[i].vid];
+        pos[items[i].vid] = i;
     }
+    cell_begin.push_back(nv);
+    items.clear();
+    items.shrink_to_fit();
 
-    // visit the resulting graph with BFS to
-    // isolate clusters of adjacent vertices
-    uint nv   = points.size();
-    uint seed = 0;
-    std::vector<bool> visited(nv, false);
-    do
+    // concurrent union-find. Roots are always linked to the smaller root,
+    // hence parents can only decrease, and cycles cannot be created
+    std::vector<std::atomic<uint>> parent(nv);
+    for(uint i=0; i<nv; ++i) parent[i] = i;
+    auto find = [&](uint v) -> uint
+    {
+        while(true)
+        {
+            uint p = parent[v].load();
+            if(p==v) return v;
+            uint gp = parent[p].load();
+            if(gp!=p) parent[v].compare_exchange_weak(p,gp); // path halving
+            v = gp;
+        }
+    };
+    auto unite = [&](uint a, uint b)
     {
-        std::unordered_set<uint> cluster;
-        bfs(v2v, seed, cluster);
+        while(true)
+        {
+            a = find(a);
+            b = find(b);
+            if(a==b) return;
+            if(a<b) std::swap(a,b);
+            uint root = a;
+            if(parent[a].compare_exchange_strong(root,b)) return;
+        }
+    };
+    auto test = [&](const uint v0, const uint v1)
+    {
+        if(find(v0)!=find(v1) && sorted_points[v0].dist(sorted_points[v1]) < proximity_thresh) unite(v0,v1);
+    };
 
-        clusters.push_back(cluster);
-        for(uint vid : cluster) visited.at(vid) = true;
+    // test all pairs of vertices in the same cell, and in each couple of adjacent cells (each
+    // couple is visited just once). Cells are sorted lexicographically, hence cells in the same
+    // row (i.e. with same x,y) are contiguous, and each row of neighbors is found with one search
+    auto test_cells = [&](const uint cid0, const uint cid1)
+    {
+        for(uint i=cell_begin[cid0]; i<cell_begin[cid0+1]; ++i)
+        for(uint j=cell_begin[cid1]; j<cell_begin[cid1+1]; ++j)
+        {
+            test(i,j);
+        }
+    };
+    PARALLEL_FOR(0, uint(cells.size()), 100, [&](const uint cid)
+    {
+        const Cell & c = cells[cid];
+        for(uint i=cell_begin[cid]; i<cell_begin[cid+1]; ++i)
+        for(uint j=i+1;             j<cell_begin[cid+1]; ++j)
+        {
+            test(i,j);
+        }
+        if(cid+1<cells.size() && cells[cid+1]==Cell{{ c[0], c[1], c[2]+1 }}) test_cells(cid, cid+1);
+
+        // rows (x,y+1), (x+1,y-1), (x+1,y), (x+1,y+1)
+        const int64_t rows[4][2] = {{ 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }};
+        for(uint r=0; r<4; ++r)
+        {
+            Cell first = {{ c[0]+rows[r][0], c[1]+rows[r][1], c[2]-1 }};
+            auto it    = std::lower_bound(cells.begin()+cid+1, cells.end(), first);
+            for(; it!=cells.end() && (*it)[0]==first[0] && (*it)[1]==first[1] && (*it)[2]<=c[2]+1; ++it)
+            {
+                test_cells(cid, uint(it-cells.begin()));
+            }
+        }
+    });
 
-        seed = 0;
-        while (seed < nv && visited.at(seed)) ++seed;
+    // vertices are visited in ascending order, hence clusters come out
+    // sorted by their smallest vertex (as a BFS from vertex 0 would do)
+    std::vector<int> root_cluster(nv, -1);
+    uint n_clusters = 0;
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        uint root = find(pos[vid]);
+        if(root_cluster[root]<0) root_cluster[root] = int(n_clusters++);
+        cluster_id[vid] = uint(root_cluster[root]);
     }
-    while (seed < nv);
+    return n_clusters;
 }
 
-
 }
-
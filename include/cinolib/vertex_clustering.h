@@ -48,7 +48,14 @@ namespace cinolib
 /* Groups a list of vertices in clusters of elements closer
  * to each other less than a given proximity threshold
  *
- * NOTE: class Vertex should implement the dist() operator
+ * Vertices are hashed in a uniform grid with cells as big as the threshold,
+ * so that only pairs of vertices in the same or adjacent cells are tested.
+ * Cells are processed in parallel, and clusters are assembled with a
+ * concurrent union-find. Clusters are sorted by their smallest vertex id.
+ *
+ * NOTE: class Vertex should implement the dist() operator. If Vertex is a
+ *       cinolib vector (e.g. vec2d, vec3d) the grid uses (up to) its first
+ *       three coordinates, otherwise all pairs of vertices will be tested
 */
 
 template<class Vertex>
@@ -57,6 +64,17 @@ void vertex_clustering(const std::vector<Vertex>             & points,
                        const double                            proximity_thresh,
                        std::vector<std::unordered_set<uint>> & clusters);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// same as above, but for each vertex returns the index of its cluster
+// (clusters are sorted in the same way). Returns the number of clusters
+//
+template<class Vertex>
+CINO_INLINE
+uint vertex_clustering(const std::vector<Vertex> & points,
+                       const double                proximity_thresh,
+                       std::vector<uint>         & cluster_id);
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -34,6 +34,8 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/vertex_mass.h>
+#include <cinolib/sparse_matrix_alloc.h>
+#include <cinolib/parallel_for.h>
 
 namespace cinolib
 {
@@ -42,26 +44,24 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> mass_matrix(const AbstractMesh<M,V,E,P> & m, const int n)
 {
-    typedef Eigen::Triplet<double> Entry;
-
+    // diagonal matrix: one entry per column, written straight into the CSC arrays
     uint nv = m.num_verts();
-    std::vector<uint> base(n);
-    for(int i=0; i<n; ++i) base[i] = nv*i;
+    Eigen::SparseMatrix<double> MM;
+    sparse_matrix_alloc(MM, n*nv, n*nv, std::vector<uint>(n*nv,1));
+    auto   *inner = MM.innerIndexPtr();
+    double *value = MM.valuePtr();
 
-    std::vector<Entry>  entries;
-    for(uint vid=0; vid<m.num_verts(); ++vid)
+    PARALLEL_FOR(0, nv, 1000, [&](const uint vid)
     {
         double mass = m.vert_mass(vid);
-        for(int i=0; i<n; ++i) entries.push_back(Entry(base[i] + vid, base[i] + vid, mass));
-    }
-
-    nv = n*m.num_verts();
-    Eigen::SparseMatrix<double> MM(nv, nv);
-    MM.setFromTriplets(entries.begin(), entries.end());
+        for(int i=0; i<n; ++i)
+        {
+            inner[i*nv + vid] = i*nv + vid;
+            value[i*nv + vid] = mass;
+        }
+    });
 
     return MM;
 }
 
-
 }
-
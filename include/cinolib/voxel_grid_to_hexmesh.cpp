@@ -34,6 +34,8 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/voxel_grid_to_hexmesh.h>
+#include <cinolib/serialize_index.h>
+#include <unordered_map>
 
 namespace cinolib
 {
@@ -101,5 +103,82 @@ void voxel_grid_to_hexmesh(const VoxelGrid                         & g,
     }
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void voxel_grid_to_hexmesh(const SparseVoxelGrid                   & g,
+                                 AbstractPolyhedralMesh<M,V,E,F,P> & m,
+                           const int voxel_types)
+{
+    typedef SparseVoxelGrid SVG;
+
+    // sparse grids can be huge, hence vertices are hashed rather than stored in a dense map
+    std::unordered_map<uint64_t,uint> vert_map;
+    auto vert_key = [&](const vec3u & ijk, const uint off) -> uint64_t
+    {
+        uint64_t i = ijk[0] + uint(REFERENCE_HEX_VERTS[off][0]);
+        uint64_t j = ijk[1] + uint(REFERENCE_HEX_VERTS[off][1]);
+        uint64_t k = ijk[2] + uint(REFERENCE_HEX_VERTS[off][2]);
+        return (i*(g.dim[1]+1) + j)*(g.dim[2]+1) + k;
+    };
+
+    for(uint sid=0; sid<g.slots.size(); ++sid)
+    {
+        uint s = g.slots[sid];
+        if((s & SVG_TILE) && !(SVG::flag(uint8_t(s & ~SVG_TILE)) & voxel_types)) continue;
+
+        vec3u b = deserialize_3D_index(sid, g.bdim[1], g.bdim[2]) * SVG_BRICK_SIDE;
+        for(uint i=b[0]; i<std::min(b[0]+SVG_BRICK_SIDE, g.dim[0]); ++i)
+        for(uint j=b[1]; j<std::min(b[1]+SVG_BRICK_SIDE, g.dim[1]); ++j)
+        for(uint k=b[2]; k<std::min(b[2]+SVG_BRICK_SIDE, g.dim[2]); ++k)
+        {
+            uint8_t c = (s & SVG_TILE) ? uint8_t(s & ~SVG_TILE)
+                                        : g.brick(s)[serialize_3D_index(i-b[0], j-b[1], k-b[2], SVG_BRICK_SIDE, SVG_BRICK_SIDE)];
+            int type = SVG::flag(c);
+            if(!(type & voxel_types)) continue;
+
+            vec3u ijk(i,j,k);
+            std::vector<uint> verts(8);
+            std::vector<uint> faces(6);
+            std::vector<bool> winding(6,false);
+
+            // make verts
+            for(uint off=0; off<8; ++off)
+            {
+                auto it = vert_map.find(vert_key(ijk,off));
+                if(it==vert_map.end())
+                {
+                    vec3d p = voxel_corner_xyz(g.bbox, g.len, ijk.ptr(), off);
+                    it = vert_map.insert(std::make_pair(vert_key(ijk,off), m.vert_add(p))).first;
+                }
+                verts[off] = it->second;
+            }
+
+            // make faces
+            for(uint off=0; off<6; ++off)
+            {
+                std::vector<uint> face =
+                {
+                    verts[HEXA_FACES[off][0]],
+                    verts[HEXA_FACES[off][1]],
+                    verts[HEXA_FACES[off][2]],
+                    verts[HEXA_FACES[off][3]]
+                };
+                int fid = m.face_id(face);
+                if(fid<0)
+                {
+                    fid = m.face_add(face);
+                    winding[off] = true;
+                }
+                faces[off] = fid;
+            }
+            // add voxel
+            uint pid = m.poly_add(faces,winding);
+            m.poly_data(pid).label = type;
+        }
+    }
+}
+
 }
 
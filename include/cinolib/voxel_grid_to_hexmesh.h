@@ -37,6 +37,7 @@
 #define CINO_VOXEL_GRID_TO_HEXMESH_H
 
 #include <cinolib/voxel_grid.h>
+#include <cinolib/sparse_voxel_grid.h>
 #include <cinolib/meshes/hexmesh.h>
 
 namespace cinolib
@@ -54,6 +55,14 @@ CINO_INLINE
 void voxel_grid_to_hexmesh(const VoxelGrid                         & g,
                                  AbstractPolyhedralMesh<M,V,E,F,P> & m,
                            const int voxel_types = VOXEL_INSIDE | VOXEL_BOUNDARY);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void voxel_grid_to_hexmesh(const SparseVoxelGrid                   & g,
+                                 AbstractPolyhedralMesh<M,V,E,F,P> & m,
+                           const int voxel_types = VOXEL_INSIDE | VOXEL_BOUNDARY);
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -36,11 +36,186 @@
 #include <cinolib/voxelize.h>
 #include <cinolib/serialize_index.h>
 #include <cinolib/parallel_for.h>
-#include <mutex>
+#include <cstdint>
 
 namespace cinolib
 {
 
+namespace
+{
+
+// visits the voxels of slot sid on face f (0..5 => -X,+X,-Y,+Y,-Z,+Z) that are inside the
+// grid, calling func with their local index and the code of the voxel across f (in slot ns).
+// The visit stops as soon as func returns false
+template<class Func>
+CINO_INLINE
+void face_pairs(const SparseVoxelGrid & g, const uint sid, const uint f, const uint ns, const Func & func)
+{
+    const uint S  = SVG_BRICK_SIDE;
+    const uint a  = f/2;
+    const uint a1 = (a+1)%3;
+    const uint a2 = (a+2)%3;
+    vec3u base = deserialize_3D_index(sid, g.bdim[1], g.bdim[2]) * S;
+    uint  l[3], n[3];
+    l[a] = (f%2==0) ? 0 : S-1;
+    n[a] = (f%2==0) ? S-1 : 0;
+    uint s = g.slots[ns];
+    for(uint u=0; u<S && base[a1]+u<g.dim[a1]; ++u)
+    for(uint v=0; v<S && base[a2]+v<g.dim[a2]; ++v)
+    {
+        l[a1] = n[a1] = u;
+        l[a2] = n[a2] = v;
+        uint8_t c = (s & SVG_TILE) ? uint8_t(s & ~SVG_TILE) : g.brick(s)[serialize_3D_index(n[0],n[1],n[2],S,S)];
+        if(!func(serialize_3D_index(l[0],l[1],l[2],S,S), c)) return;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* 6-connected flood fill of a sparse voxel grid: voxels in state from that are connected
+ * to the seed switch to state to (voxels already in state to behave as sources too).
+ * The front advances one brick at a time: first each brick in the front collects its
+ * seeds from the faces of its neighbors (read only), then floods its own voxels (write
+ * only). Both phases run in parallel, and no locks are needed. Tiles change state as a
+ * whole, hence large empty regions are filled at the cost of a single voxel
+*/
+CINO_INLINE
+void flood_fill(SparseVoxelGrid & g, const uint seed[3], const int from, const int to)
+{
+    typedef SparseVoxelGrid SVG;
+    const uint    S      = SVG_BRICK_SIDE;
+    const uint    M      = S-1;
+    const uint8_t c_from = SVG::code(from);
+    const uint8_t c_to   = SVG::code(to);
+
+    // slot across face f (0..5 => -X,+X,-Y,+Y,-Z,+Z), or -1 if none
+    auto nbr = [&](const uint sid, const uint f) -> int
+    {
+        uint  a = f/2;
+        vec3u b = deserialize_3D_index(sid, g.bdim[1], g.bdim[2]);
+        if(f%2==0) { if(b[a]==0)           return -1; --b[a]; }
+        else       { if(b[a]+1>=g.bdim[a]) return -1; ++b[a]; }
+        return int(g.slot_index(b[0],b[1],b[2]));
+    };
+
+    std::vector<uint>    front;
+    std::vector<uint8_t> in_front(g.slots.size(), 0);
+    std::vector<std::vector<uint16_t>> seeds;
+    std::vector<uint8_t> reached;
+
+    // first round: the seed voxel only
+    uint sid0 = g.slot_index(seed[0]>>SVG_BRICK_BITS, seed[1]>>SVG_BRICK_BITS, seed[2]>>SVG_BRICK_BITS);
+    if(g.voxel(seed[0],seed[1],seed[2])!=from) return;
+    front.push_back(sid0);
+    seeds.resize(1);
+    reached.assign(1, 1);
+    seeds[0].push_back(uint16_t(serialize_3D_index(seed[0]&M, seed[1]&M, seed[2]&M, S, S)));
+    bool first = true;
+
+    while(!front.empty())
+    {
+        uint nf = uint(front.size());
+        if(!first)
+        {
+            seeds.assign(nf, std::vector<uint16_t>());
+            reached.assign(nf, 0);
+            PARALLEL_FOR(0, nf, 64, [&](uint i)
+            {
+                uint sid  = front[i];
+                bool tile = g.slot_is_tile(sid);
+                for(uint f=0; f<6 && !reached[i]; ++f)
+                {
+                    int ns = nbr(sid, f);
+                    if(ns<0) continue;
+                    if(tile)
+                    {
+                        face_pairs(g, sid, f, uint(ns), [&](const uint, const uint8_t c) -> bool
+                        {
+                            if(c==c_to) reached[i] = 1;
+                            return !reached[i];
+                        });
+                    }
+                    else
+                    {
+                        const uint8_t *b = g.brick(g.slots[sid]);
+                        face_pairs(g, sid, f, uint(ns), [&](const uint l, const uint8_t c) -> bool
+                        {
+                            if(c==c_to && b[l]==c_from) seeds[i].push_back(uint16_t(l));
+                            return true;
+                        });
+                    }
+                }
+                if(!seeds[i].empty()) reached[i] = 1;
+            });
+        }
+        first = false;
+
+        // flood each reached slot, and keep track of the faces that have been touched
+        std::vector<uint8_t> touched(nf, 0);
+        PARALLEL_FOR(0, nf, 64, [&](uint i)
+        {
+            if(!reached[i]) return;
+            uint sid = front[i];
+            if(g.slot_is_tile(sid))
+            {
+                g.slots[sid] = SVG_TILE | c_to;
+                touched[i]   = 0x3F;
+                return;
+            }
+            vec3u    base = deserialize_3D_index(sid, g.bdim[1], g.bdim[2]) * S;
+            uint8_t *b    = g.brick(g.slots[sid]);
+            uint16_t stack[SVG_BRICK_SIZE];
+            uint     top  = 0;
+            auto visit = [&](const uint l)
+            {
+                b[l] = c_to;
+                stack[top++] = uint16_t(l);
+                vec3u p = deserialize_3D_index(l,S,S);
+                for(uint a=0; a<3; ++a)
+                {
+                    if(p[a]==0) touched[i] |= uint8_t(1 << (2*a));
+                    if(p[a]==M) touched[i] |= uint8_t(1 << (2*a+1));
+                }
+            };
+            for(uint16_t l : seeds[i]) if(b[l]==c_from) visit(l);
+            while(top>0)
+            {
+                vec3u p = deserialize_3D_index(stack[--top],S,S);
+                for(uint f=0; f<6; ++f)
+                {
+                    vec3u q = p;
+                    uint  a = f/2;
+                    if(f%2==0) { if(q[a]==0) continue; --q[a]; }
+                    else       { if(q[a]==M || base[a]+q[a]+1>=g.dim[a]) continue; ++q[a]; }
+                    uint l = serialize_3D_index(q[0],q[1],q[2],S,S);
+                    if(b[l]==c_from) visit(l);
+                }
+            }
+        });
+
+        // the next front contains the neighbors that may change state
+        std::vector<uint> next;
+        for(uint i=0; i<nf; ++i)
+        {
+            for(uint f=0; f<6; ++f)
+            {
+                if(!(touched[i] & (1<<f))) continue;
+                int ns = nbr(front[i], f);
+                if(ns<0 || in_front[ns]) continue;
+                if(g.slot_is_tile(uint(ns)) && g.slots[ns]!=(SVG_TILE|c_from)) continue;
+                in_front[ns] = 1;
+                next.push_back(uint(ns));
+            }
+        }
+        for(uint sid : next) in_front[sid] = 0;
+        front.swap(next);
+    }
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 // Voxelizes an object described by a surface mesh. Voxels will be deemed
 // as being entirely inside, outside or traversed by the boundary of the
 // input surface mesh, which can contain triangles, quads or general polygons.
@@ -49,51 +224,123 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void voxelize(const AbstractPolygonMesh<M,V,E,P> & m,
               const uint                           max_voxels_per_side,
-                    VoxelGrid                    & g)
+                    SparseVoxelGrid              & g)
 {
+    typedef SparseVoxelGrid SVG;
+
     // pad the bbox to ease the subsequent inside/outside labeling
-    g.bbox = m.bbox();
-    g.len  = g.bbox.delta().max_entry() / max_voxels_per_side;
-    vec3d pad(g.len,g.len,g.len);
-    g.bbox.min -= pad;
-    g.bbox.max += pad;
+    AABB   bbox = m.bbox();
+    double len  = bbox.delta().max_entry() / max_voxels_per_side;
+    vec3d pad(len,len,len);
+    bbox.min -= pad;
+    bbox.max += pad;
 
     // determine grid size across all dimensions
-    g.dim[0] = uint(ceil(g.bbox.delta_x()/g.len));
-    g.dim[1] = uint(ceil(g.bbox.delta_y()/g.len));
-    g.dim[2] = uint(ceil(g.bbox.delta_z()/g.len));
+    uint dim[3] =
+    {
+        uint(ceil(bbox.delta_x()/len)),
+        uint(ceil(bbox.delta_y()/len)),
+        uint(ceil(bbox.delta_z()/len))
+    };
+    g.init(bbox, len, dim, VOXEL_UNKNOWN);
 
-    // allocate the grid memory and flag voxels that have
-    // non empty intersection with the input mesh elements
-    uint size = g.dim[0]*g.dim[1]*g.dim[2];
-    g.voxels = new int[size];
-    std::fill_n(g.voxels, size, VOXEL_UNKNOWN); // initialize grid
-    std::mutex mutex;
-    PARALLEL_FOR(0, m.num_polys(), 1000, [&](uint pid)
+    // range [beg,end) of voxels spanned by the bounding box of a poly
+    auto voxel_range = [&](const uint pid, vec3u & beg, vec3u & end)
     {
         AABB  box = m.poly_aabb(pid);
-        vec3d beg = (box.min - g.bbox.min)/g.len;
-        vec3d end = (box.max - g.bbox.min)/g.len;
+        vec3d b   = (box.min - bbox.min)/len;
+        vec3d e   = (box.max - bbox.min)/len;
+        for(uint i=0; i<3; ++i)
+        {
+            beg[i] = uint(floor(b[i]));
+            end[i] = std::min(std::max(uint(ceil(e[i])), beg[i]+1), dim[i]);
+        }
+    };
 
-        for(uint i=uint(floor(beg[0])); i<uint(ceil(end[0])); ++i)
-        for(uint j=uint(floor(beg[1])); j<uint(ceil(end[1])); ++j)
-        for(uint k=uint(floor(beg[2])); k<uint(ceil(end[2])); ++k)
+    // bin polys into the bricks spanned by their bounding box, as pairs (slot,pid)
+    uint chunk    = 1024;
+    uint n_chunks = (m.num_polys()+chunk-1)/chunk;
+    std::vector<std::vector<uint64_t>> bins(n_chunks);
+    PARALLEL_FOR(0, n_chunks, 1, [&](uint c)
+    {
+        for(uint pid=c*chunk; pid<std::min(m.num_polys(),(c+1)*chunk); ++pid)
         {
-            uint index = serialize_3D_index(i,j,k,g.dim[1],g.dim[2]);
-            if(g.voxels[index]==VOXEL_UNKNOWN)
+            vec3u beg, end;
+            voxel_range(pid, beg, end);
+            for(uint i=beg[0]>>SVG_BRICK_BITS; i<=(end[0]-1)>>SVG_BRICK_BITS; ++i)
+            for(uint j=beg[1]>>SVG_BRICK_BITS; j<=(end[1]-1)>>SVG_BRICK_BITS; ++j)
+            for(uint k=beg[2]>>SVG_BRICK_BITS; k<=(end[2]-1)>>SVG_BRICK_BITS; ++k)
+            {
+                bins[c].push_back(uint64_t(g.slot_index(i,j,k)) << 32 | pid);
+            }
+        }
+    });
+    std::vector<uint64_t> pairs;
+    for(auto & b : bins)
+    {
+        pairs.insert(pairs.end(), b.begin(), b.end());
+        std::vector<uint64_t>().swap(b);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    // allocate one brick for each binned slot (in slot order)
+    std::vector<uint> brick_beg;
+    for(uint i=0; i<pairs.size(); ++i)
+    {
+        if(i==0 || (pairs[i]>>32)!=(pairs[i-1]>>32)) brick_beg.push_back(i);
+    }
+    g.bricks.reserve(size_t(brick_beg.size())*SVG_BRICK_SIZE);
+    for(uint i : brick_beg) g.add_brick(uint(pairs[i]>>32));
+    brick_beg.push_back(uint(pairs.size()));
+
+    // flag voxels that have non empty intersection with the input mesh elements.
+    // Each brick is processed by a single thread, hence no locks are needed
+    const uint8_t c_boundary = SVG::code(VOXEL_BOUNDARY);
+    PARALLEL_FOR(0, g.num_bricks(), 16, 1, [&](uint bid)
+    {
+        vec3u    b   = deserialize_3D_index(g.brick_slot[bid], g.bdim[1], g.bdim[2]) * SVG_BRICK_SIDE;
+        uint8_t *vox = g.brick(bid);
+        // the signed distance (times the normal length) between the supporting plane of each
+        // triangle and the center of voxel (i,j,k) is plane[0] + i*plane[1] + j*plane[2] + k*plane[3]
+        std::vector<vec3d> tris;
+        std::vector<vec4d> planes;
+        std::vector<double> radii;
+        for(uint p=brick_beg[bid]; p<brick_beg[bid+1]; ++p)
+        {
+            uint  pid = uint(pairs[p] & 0xFFFFFFFF);
+            vec3u beg, end;
+            voxel_range(pid, beg, end);
+
+            const std::vector<uint> & tess = m.poly_tessellation(pid);
+            uint nt = uint(tess.size()/3);
+            tris.resize(3*nt);
+            planes.resize(nt);
+            radii.resize(nt);
+            for(uint t=0; t<3*nt; ++t) tris[t] = m.vert(tess[t]);
+            for(uint t=0; t<nt; ++t)
+            {
+                vec3d n = (tris[3*t+1]-tris[3*t]).cross(tris[3*t+2]-tris[3*t]);
+                vec3d o = bbox.min + vec3d(0.5*len, 0.5*len, 0.5*len) - tris[3*t];
+                planes[t] = vec4d({n.dot(o), n[0]*len, n[1]*len, n[2]*len});
+                radii [t] = 0.5*len*(std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]))*(1+1e-10);
+            }
+
+            for(uint i=std::max(beg[0],b[0]); i<std::min(end[0],b[0]+SVG_BRICK_SIDE); ++i)
+            for(uint j=std::max(beg[1],b[1]); j<std::min(end[1],b[1]+SVG_BRICK_SIDE); ++j)
+            for(uint k=std::max(beg[2],b[2]); k<std::min(end[2],b[2]+SVG_BRICK_SIDE); ++k)
             {
-                vec3u ijk(i,j,k);
-                AABB voxel = voxel_bbox(g,ijk.ptr());
-                for(uint i=0; i<m.poly_tessellation(pid).size()/3; ++i)
+                uint8_t & c = vox[serialize_3D_index(i-b[0], j-b[1], k-b[2], SVG_BRICK_SIDE, SVG_BRICK_SIDE)];
+                if(c==c_boundary) continue;
+                for(uint t=0; t<nt; ++t)
                 {
-                    vec3d t[3] = { m.vert(m.poly_tessellation(pid).at(3*i+0)),
-                                   m.vert(m.poly_tessellation(pid).at(3*i+1)),
-                                   m.vert(m.poly_tessellation(pid).at(3*i+2)) };
+                    // quick rejection: the voxel does not intersect the supporting plane of the triangle
+                    const vec4d & pl = planes[t];
+                    if(std::fabs(pl[0] + i*pl[1] + j*pl[2] + k*pl[3]) > radii[t]) continue;
 
-                    if(voxel.intersects_triangle(t))
+                    vec3u ijk(i,j,k);
+                    if(voxel_bbox(bbox, len, ijk.ptr()).intersects_triangle(&tris[3*t]))
                     {
-                        std::lock_guard<std::mutex> guard(mutex);
-                        g.voxels[index] = VOXEL_BOUNDARY;
+                        c = c_boundary;
                         break; // do not test other triangles for this boundary voxel...
                     }
                 }
@@ -101,36 +348,30 @@ void voxelize(const AbstractPolygonMesh<M,V,E,P> & m,
         }
     });
 
-    // flood the outside
-    std::queue<uint> q;
-    q.push(0); // voxel zero is guaranteed to be outside (due to the previous padding)
-    g.voxels[0]=VOXEL_OUTSIDE;
-    while(!q.empty())
-    {
-        uint index = q.front();
-        q.pop();
-        assert(g.voxels[index]==VOXEL_OUTSIDE);
+    // flood the outside, starting from voxel zero (guaranteed to be outside due to the padding)
+    uint seed[3] = { 0, 0, 0 };
+    flood_fill(g, seed, VOXEL_UNKNOWN, VOXEL_OUTSIDE);
 
-        vec3u ijk = deserialize_3D_index(index,g.dim[1],g.dim[2]);
-        std::vector<uint> n6 = voxel_n6(g.dim,ijk.ptr()); // 6 neighborhood
-        for(auto nbr : n6)
-        {
-            if(g.voxels[nbr]==VOXEL_UNKNOWN)
-            {
-                g.voxels[nbr]=VOXEL_OUTSIDE;
-                q.push(nbr);
-            }
-        }
-    }
+    // mark the rest as inside, and turn bricks that became uniform into tiles
+    g.replace(VOXEL_UNKNOWN, VOXEL_INSIDE);
+    g.prune();
+}
 
-    // mark the rest as inside
-    for(uint index=0; index<size; ++index)
-    {
-        if(g.voxels[index]==VOXEL_UNKNOWN)
-        {
-            g.voxels[index]=VOXEL_INSIDE;
-        }
-    }
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Voxelizes an object described by a surface mesh. Voxels will be deemed
+// as being entirely inside, outside or traversed by the boundary of the
+// input surface mesh, which can contain triangles, quads or general polygons.
+//
+template<class M, class V, class E, class P>
+CINO_INLINE
+void voxelize(const AbstractPolygonMesh<M,V,E,P> & m,
+              const uint                           max_voxels_per_side,
+                    VoxelGrid                    & g)
+{
+    SparseVoxelGrid sg;
+    voxelize(m, max_voxels_per_side, sg);
+    sg.to_dense(g);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
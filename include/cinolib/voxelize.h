@@ -37,6 +37,7 @@
 #define CINO_VOXELIZE_H
 
 #include <cinolib/voxel_grid.h>
+#include <cinolib/sparse_voxel_grid.h>
 #include <cinolib/meshes/abstract_polygonmesh.h>
 
 namespace cinolib
@@ -54,6 +55,19 @@ void voxelize(const AbstractPolygonMesh<M,V,E,P> & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// Same as above, but outputs a sparse grid, which only allocates memory for the voxels
+// close to the boundary of the object (enabling much higher resolutions). Boundary voxels
+// are rasterized without locks (each brick of voxels is processed by one thread only),
+// and the outside is flooded brick by brick, in parallel.
+//
+template<class M, class V, class E, class P>
+CINO_INLINE
+void voxelize(const AbstractPolygonMesh<M,V,E,P> & m,
+              const uint                           max_voxels_per_side,
+                    SparseVoxelGrid              & g);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 // Voxelizes an object described by an analytic function f. Voxels will be
 // deemed as being entirely on the positive halfspace, negative halfspace
 // or traversed by the zero level set of the function f.
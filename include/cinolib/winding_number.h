@@ -52,6 +52,9 @@ namespace cinolib
  *
  * WARNING: input meshes are assumed to be watertight 2 manifolds.
  * No explicit checks are performed.
+ *
+ * NOTE: each query visits all the triangles. For many queries, see
+ * FastWindingNumber, which costs O(log n) per query.
 */
 
 CINO_INLINE